@@ -1,11 +1,54 @@
 #include "pch.h"
 #include "CppUnitTest.h"
+#include <limits.h>
+#include <string.h>
 #include "../../src/GCodeParser.h"
+#include "../../src/GCodeDialect.h"
+#include "../../src/GCodeWriter.h"
+#include "../../src/GCodeParsedBlock.h"
+#include "../../src/GCodeLookAhead.h"
+#include "../../src/GCodeLatency.h"
+#include "../../src/GCodeArena.h"
+#include <utility>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace GCodeParserUnitTests
 {
+	static unsigned long testClockTime = 0;
+
+	static unsigned long TestClock()
+	{
+		return testClockTime += 10;
+	}
+
+	static char streamedComments[256];
+	static int streamedLength = 0;
+	static int streamedEnds = 0;
+
+	static void TestCommentCallback(const char* text, int length, bool end)
+	{
+		memcpy(&streamedComments[streamedLength], text, length);
+		streamedLength += length;
+		streamedComments[streamedLength] = '\0';
+
+		if (end)
+		{
+			streamedComments[streamedLength++] = '|';
+			streamedComments[streamedLength] = '\0';
+			streamedEnds++;
+		}
+	}
+
+	static char realtimeReceived[16];
+	static int realtimeCount = 0;
+
+	static void TestRealtimeCallback(char c)
+	{
+		realtimeReceived[realtimeCount++] = c;
+		realtimeReceived[realtimeCount] = '\0';
+	}
+
 	TEST_CLASS(GCodeParserUnitTests)
 	{
 	public:
@@ -1043,5 +1086,743 @@ namespace GCodeParserUnitTests
 			Assert::AreEqual(GCode.GetWordValue('X'), 3.2);
 			Assert::AreEqual(GCode.GetWordValue('Z'), 5.0);
 		}
+
+		TEST_METHOD(GetWordValue_SubcodeAndSign_ReturnsValue)
+		{
+			GCodeParser GCode = GCodeParser();
+
+			GCode.ParseLine("G38.2 Z-10.125 F+120 M104");
+
+			Assert::AreEqual(GCode.GetWordValue('G'), 38.2);
+			Assert::AreEqual(GCode.GetWordValue('Z'), -10.125);
+			Assert::AreEqual(GCode.GetWordValue('F'), 120.0);
+			Assert::AreEqual(GCode.GetWordValue('M'), 104.0);
+			Assert::AreEqual(GCode.GetWordIntegerValue('G'), 38L);
+			Assert::AreEqual(GCode.GetWordIntegerValue('M'), 104L);
+		}
+
+		TEST_METHOD(ParseNumber_ValidNumber_ReturnsValueAndCount)
+		{
+			double value;
+
+			Assert::AreEqual(GCodeParser::ParseNumber("12.5X", &value), 4);
+			Assert::AreEqual(value, 12.5);
+			Assert::AreEqual(GCodeParser::ParseNumber("-.5", &value), 3);
+			Assert::AreEqual(value, -0.5);
+			Assert::AreEqual(GCodeParser::ParseNumber("0.1", &value), 3);
+			Assert::AreEqual(value, 0.1);
+			Assert::AreEqual(GCodeParser::ParseNumber("123456.789012", &value), 13);
+			Assert::AreEqual(value, 123456.789012);
+			Assert::AreEqual(GCodeParser::ParseNumber("1e3", &value), 1);
+			Assert::AreEqual(value, 1.0);
+		}
+
+		TEST_METHOD(ParseNumber_NineteenDigits_ReturnsNearest)
+		{
+			double value;
+
+			// 19 significant digits, below and from 2^53, where the mantissa does not fit a double.
+			Assert::AreEqual(GCodeParser::ParseNumber("1234.567890123456789", &value), 20);
+			Assert::AreEqual(value, 1234.567890123456789);
+			Assert::AreEqual(GCodeParser::ParseNumber("56513791221352468.3", &value), 19);
+			Assert::AreEqual(value, 56513791221352472.0);
+			Assert::AreEqual(GCodeParser::ParseNumber("804060971639700531.7", &value), 20);
+			Assert::AreEqual(value, 804060971639700480.0);
+			Assert::AreEqual(GCodeParser::ParseNumber("9569844842189610.677", &value), 20);
+			Assert::AreEqual(value, 9569844842189610.0);
+		}
+
+		TEST_METHOD(ParseNumber_NoNumber_ReturnsZero)
+		{
+			double value;
+
+			Assert::AreEqual(GCodeParser::ParseNumber("X1", &value), 0);
+			Assert::AreEqual(GCodeParser::ParseNumber("-", &value), 0);
+			Assert::AreEqual(GCodeParser::ParseNumber(".", &value), 0);
+			Assert::AreEqual(value, 0.0);
+		}
+
+		TEST_METHOD(ParseInteger_StopsAtFraction)
+		{
+			long value;
+
+			Assert::AreEqual(GCodeParser::ParseInteger("38.2", &value), 2);
+			Assert::AreEqual(value, 38L);
+			Assert::AreEqual(GCodeParser::ParseInteger("-7", &value), 2);
+			Assert::AreEqual(value, -7L);
+			Assert::AreEqual(GCodeParser::ParseInteger(".5", &value), 0);
+		}
+
+		TEST_METHOD(GetWordFixedValue_ExistingWord_ReturnsScaledValue)
+		{
+			GCodeParser GCode = GCodeParser();
+
+			GCode.ParseLine("G1 X12.3456 Y-0.5 Z7 E.0004");
+
+			Assert::AreEqual(GCode.GetWordFixedValue('X', 3), 12346L);
+			Assert::AreEqual(GCode.GetWordFixedValue('Y', 3), -500L);
+			Assert::AreEqual(GCode.GetWordFixedValue('Z', 2), 700L);
+			Assert::AreEqual(GCode.GetWordFixedValue('E', 3), 0L);
+			Assert::AreEqual(GCode.GetWordFixedValue('X', 0), 12L);
+			Assert::AreEqual(GCode.GetWordFixedValue('A', 3), 0L);
+		}
+
+		TEST_METHOD(ParseFixedNumber_OutOfRange_Saturates)
+		{
+			long value;
+			bool saturated;
+
+			Assert::AreEqual(GCodeParser::ParseFixedNumber("99999999999999999999.9", 3, &value, &saturated), 22);
+			Assert::AreEqual(saturated, true);
+			Assert::AreEqual(value, (long)LONG_MAX);
+
+			GCodeParser::ParseFixedNumber("-99999999999999999999.9", 3, &value, &saturated);
+			Assert::AreEqual(saturated, true);
+			Assert::AreEqual(value, (long)LONG_MIN);
+
+			GCodeParser::ParseFixedNumber("1000.001", 3, &value, &saturated);
+			Assert::AreEqual(saturated, false);
+			Assert::AreEqual(value, 1000001L);
+		}
+
+		TEST_METHOD(GetWords_LetterSet_ReturnsValuesAndPresence)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCodeWords words;
+
+			GCode.ParseLine("G1 X10.5 Y-2 E0.25 ;Z99");
+
+			unsigned long present = GCode.GetWords("XYZEF", &words);
+
+			Assert::AreEqual(present, GCODE_LETTER('X') | GCODE_LETTER('Y') | GCODE_LETTER('E'));
+			Assert::AreEqual(words.duplicate, 0UL);
+			Assert::AreEqual(words.value['X' - 'A'], 10.5);
+			Assert::AreEqual(words.value['Y' - 'A'], -2.0);
+			Assert::AreEqual(words.value['Z' - 'A'], 0.0);
+			Assert::AreEqual(words.value['E' - 'A'], 0.25);
+		}
+
+		TEST_METHOD(GetWords_DuplicateLetter_ReportsDuplicate)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCodeWords words;
+
+			GCode.ParseLine("G1 G90 X1 X2");
+
+			GCode.GetWords(GCODE_LETTER('G') | GCODE_LETTER('X'), &words);
+
+			Assert::AreEqual(words.duplicate, GCODE_LETTER('G') | GCODE_LETTER('X'));
+			Assert::AreEqual(words.value['G' - 'A'], 1.0);
+			Assert::AreEqual(words.value['X' - 'A'], 1.0);
+		}
+
+		TEST_METHOD(IsWord_Dialect_UsesDialectLetters)
+		{
+			GCodeParser GCode = GCodeParser(&GCodeDialectMarlin);
+
+			Assert::AreEqual(GCode.IsWord('E'), true);
+
+			GCodeParser Grbl = GCodeParser(&GCodeDialectGrbl);
+
+			Assert::AreEqual(Grbl.IsWord('E'), false);
+			Assert::AreEqual(Grbl.IsWord('X'), true);
+		}
+
+		TEST_METHOD(FindCommand_Dialect_ConfirmCommands)
+		{
+			Assert::AreEqual(GCodeDialectMarlin.IsCommand('M', 104, -1), true);
+			Assert::AreEqual(GCodeDialectGrbl.IsCommand('M', 104, -1), false);
+			Assert::AreEqual(GCodeDialectGrbl.IsCommand('G', 38, 2), true);
+			Assert::AreEqual(GCodeDialectGrbl.IsCommand('G', 38, 1), false);
+			Assert::AreEqual(GCodeDialectLinuxCNC.IsCommand('G', 59, 3), true);
+			Assert::AreEqual(GCodeDialectFanuc.IsCommand('M', 98, -1), true);
+			Assert::AreEqual(GCodeDialectFanuc.IsCommand('G', 38, 2), false);
+		}
+
+		TEST_METHOD(Validate_Dialect_ConfirmResults)
+		{
+			GCodeParser GCode = GCodeParser(&GCodeDialectGrbl);
+			int position;
+
+			GCode.ParseLine("N10 G90 G1 X10 Y-2.5 F300 ;Comment");
+			Assert::AreEqual((int)GCode.Validate(), (int)GCODE_VALID);
+
+			GCode.ParseLine("X10 Y20");
+			Assert::AreEqual((int)GCode.Validate(), (int)GCODE_VALID);
+
+			GCode.ParseLine("M104 S200");
+			Assert::AreEqual((int)GCode.Validate(&position), (int)GCODE_UNKNOWN_COMMAND);
+			Assert::AreEqual(position, 0);
+
+			GCode.ParseLine("G1 E5");
+			Assert::AreEqual((int)GCode.Validate(&position), (int)GCODE_INVALID_LETTER);
+			Assert::AreEqual(position, 2);
+
+			GCode.ParseLine("G0 G1 X1");
+			Assert::AreEqual((int)GCode.Validate(&position), (int)GCODE_MODAL_GROUP_CONFLICT);
+			Assert::AreEqual(position, 2);
+
+			GCode.ParseLine("G4 X1");
+			Assert::AreEqual((int)GCode.Validate(&position), (int)GCODE_WORD_NOT_ALLOWED);
+			Assert::AreEqual(position, 2);
+
+			GCode.ParseLine("G1 X");
+			Assert::AreEqual((int)GCode.Validate(), (int)GCODE_INVALID_NUMBER);
+
+			GCodeParser Marlin = GCodeParser(&GCodeDialectMarlin);
+
+			Marlin.ParseLine("G28 X Y");
+			Assert::AreEqual((int)Marlin.Validate(), (int)GCODE_VALID);
+
+			Marlin.ParseLine("M117 Hello World");
+			Assert::AreEqual((int)Marlin.Validate(), (int)GCODE_VALID);
+
+			Marlin.ParseLine("N2 G1 X5 E1.5*57");
+			Assert::AreEqual((int)Marlin.Validate(), (int)GCODE_VALID);
+		}
+
+		TEST_METHOD(FormatNumber_Shortest_ConfirmText)
+		{
+			char text[MAX_NUMBER_SIZE];
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 0.1, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "0.1"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), -12.5, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "-12.5"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 0.1 + 0.2, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "0.30000000000000004"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), -0.0, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "0"), 0);
+
+			// Powers of two have a closer neighbour below.
+			GCodeWriter::FormatNumber(text, sizeof(text), 0.015625, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "0.015625"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 1.0000000000000002, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "1.0000000000000002"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 123456.789, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "123456.789"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 4503599627370497.0, GCODE_SHORTEST);
+			Assert::AreEqual(strcmp(text, "4503599627370497"), 0);
+
+			Assert::AreEqual(GCodeWriter::FormatNumber(text, sizeof(text), 1e19, GCODE_SHORTEST), 0);
+			Assert::AreEqual(GCodeWriter::FormatNumber(text, 3, 12.5, GCODE_SHORTEST), 0);
+		}
+
+		TEST_METHOD(FormatNumber_Shortest_ParsesBack)
+		{
+			char text[MAX_NUMBER_SIZE];
+			double value = 0.001;
+
+			for (int i = 0; i < 20000; i++)
+			{
+				value = value * 1.0009765625 + 0.0123456789;
+
+				double sign = (i & 1) ? -value : value;
+				double parsed;
+
+				GCodeWriter::FormatNumber(text, sizeof(text), sign, GCODE_SHORTEST);
+				GCodeParser::ParseNumber(text, &parsed);
+
+				Assert::AreEqual(parsed, sign);
+			}
+		}
+
+		TEST_METHOD(FormatNumber_Fixed_ConfirmText)
+		{
+			char text[MAX_NUMBER_SIZE];
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 3.14159, 3);
+			Assert::AreEqual(strcmp(text, "3.142"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 2.5, 0);
+			Assert::AreEqual(strcmp(text, "3"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), 10.1, 4);
+			Assert::AreEqual(strcmp(text, "10.1"), 0);
+
+			GCodeWriter::FormatNumber(text, sizeof(text), -0.0004, 3);
+			Assert::AreEqual(strcmp(text, "0"), 0);
+		}
+
+		TEST_METHOD(GCodeWriter_Words_ConfirmLine)
+		{
+			char buffer[64];
+			GCodeWriter writer(buffer, sizeof(buffer));
+
+			writer.AddCommand('G', 38, 2);
+			writer.AddWord('X', 10.5);
+			writer.AddWord('Y', -0.25);
+			writer.AddComment("(probe)");
+			writer.End();
+
+			Assert::AreEqual(strcmp(writer.Text(), "G38.2 X10.5 Y-0.25 (probe)\n"), 0);
+
+			writer.Begin();
+			writer.precision = 2;
+			writer.spaces = false;
+			writer.AddCommand('G', 1, -1);
+			writer.AddWord('X', 1.005);
+			writer.End();
+
+			Assert::AreEqual(strcmp(writer.Text(), "G1X1\n"), 0);
+		}
+
+		TEST_METHOD(GCodeWriter_Checksum_ConfirmLine)
+		{
+			char buffer[64];
+			GCodeWriter writer(buffer, sizeof(buffer));
+			GCodeParser GCode = GCodeParser();
+
+			writer.checksum = true;
+			GCode.ParseLine("N2 G1 X5 E1.5*99");
+			writer.AddBlock(&GCode);
+			writer.End();
+
+			Assert::AreEqual(strcmp(writer.Text(), "N2 G1 X5 E1.5*40\n"), 0);
+		}
+
+		TEST_METHOD(GCodeWriter_Overflow_KeepsCompleteWords)
+		{
+			char buffer[12];
+			GCodeWriter writer(buffer, sizeof(buffer));
+
+			Assert::AreEqual(writer.AddCommand('G', 1, -1), true);
+			Assert::AreEqual(writer.AddWord('X', 100.25), true);
+			Assert::AreEqual(writer.AddWord('Y', 100.25), false);
+			Assert::AreEqual(writer.overflow, true);
+			Assert::AreEqual(strcmp(writer.Text(), "G1 X100.25"), 0);
+		}
+
+		TEST_METHOD(GCodeWriter_AddBlock_RoundTrip)
+		{
+			char buffer[128];
+			GCodeWriter writer(buffer, sizeof(buffer));
+			GCodeParser GCode = GCodeParser();
+
+			GCode.ParseLine("G1 X10.000 Y-2.50 Z0.1 F1200 ; move");
+			writer.AddBlock(&GCode);
+			writer.End();
+
+			Assert::AreEqual(strcmp(writer.Text(), "G1 X10 Y-2.5 Z0.1 F1200 ; move\n"), 0);
+
+			// ParseLine adds its own line feed.
+			buffer[writer.Length() - 1] = '\0';
+
+			GCodeParser Reparsed = GCodeParser();
+			Reparsed.ParseLine(buffer);
+
+			Assert::AreEqual(Reparsed.GetWordValue('X'), GCode.GetWordValue('X'));
+			Assert::AreEqual(Reparsed.GetWordValue('Y'), GCode.GetWordValue('Y'));
+			Assert::AreEqual(Reparsed.GetWordValue('Z'), GCode.GetWordValue('Z'));
+			Assert::AreEqual(Reparsed.GetWordValue('F'), GCode.GetWordValue('F'));
+		}
+
+		TEST_METHOD(GetBlock_ConfirmContents)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCodeParsedBlock block;
+			char gCode[] = "G1 X10.5 Y-2 (first) X3 (second) ;last";
+
+			GCode.ParseLine(gCode);
+
+			Assert::AreEqual(GCode.GetBlock(&block), true);
+			Assert::AreEqual(strcmp(block.Code(), "G1X10.5Y-2X3"), 0);
+			Assert::AreEqual(strcmp(block.Comments(), GCode.comments), 0);
+			Assert::AreEqual(strcmp(block.LastComment(), ";last"), 0);
+			Assert::AreEqual(block.Words(), GCODE_LETTER('G') | GCODE_LETTER('X') | GCODE_LETTER('Y'));
+			Assert::AreEqual(block.DuplicateWords(), GCODE_LETTER('X'));
+			Assert::AreEqual(block.GetWordValue('G'), 1.0);
+			Assert::AreEqual(block.GetWordValue('X'), 10.5);
+			Assert::AreEqual(block.GetWordValue('Y'), -2.0);
+			Assert::AreEqual(block.GetWordValue('Z'), 0.0);
+			Assert::AreEqual(block.HasWord('Z'), false);
+
+			int length;
+			Assert::AreEqual(block.CommentCount(), 3);
+			Assert::AreEqual(strncmp(block.Comment(1, &length), "(second)", 8), 0);
+			Assert::AreEqual(length, 8);
+			Assert::AreEqual(strncmp(block.Comment(2, &length), ";last", 5), 0);
+		}
+
+		TEST_METHOD(GetBlock_Move_TransfersContents)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCodeParsedBlock block;
+			char gCode[] = "M104 S200";
+
+			GCode.ParseLine(gCode);
+			GCode.GetBlock(&block);
+
+			// The block is independent of the parser.
+			char next[] = "G28";
+			GCode.ParseLine(next);
+
+			GCodeParsedBlock moved(std::move(block));
+
+			Assert::AreEqual(block.IsEmpty(), true);
+			Assert::AreEqual(strcmp(block.Code(), ""), 0);
+			Assert::AreEqual(strcmp(moved.Code(), "M104S200"), 0);
+			Assert::AreEqual(moved.GetWordValue('S'), 200.0);
+
+			GCodeParsedBlock assigned;
+			assigned = std::move(moved);
+
+			Assert::AreEqual(moved.IsEmpty(), true);
+			Assert::AreEqual(assigned.GetWordValue('M'), 104.0);
+		}
+
+		TEST_METHOD(GetBlock_ManyComments_CountsAll)
+		{
+			static char memory[8192];
+			GCodeArena arena(memory, sizeof(memory));
+			GCodeParser GCode = GCodeParser();
+			GCode.lineArena = &arena;
+			GCodeParsedBlock block;
+
+			char text[2000];
+			int length = sprintf(text, "G1 X1 ");
+
+			for (int i = 0; i < 300; i++)
+				length += sprintf(&text[length], "(%d)", i);
+
+			GCode.ParseLine(text);
+
+			Assert::AreEqual(GCode.GetBlock(&block), true);
+			Assert::AreEqual(block.CommentCount(), 300);
+
+			int commentLength;
+			Assert::AreEqual(strncmp(block.Comment(299, &commentLength), "(299)", 5), 0);
+			Assert::AreEqual(commentLength, 5);
+			Assert::AreEqual(block.GetWordValue('X'), 1.0);
+		}
+
+		TEST_METHOD(GCodeLookAhead_PeekPop_ConfirmOrder)
+		{
+			GCodeParsedBlock window[3];
+			GCodeLookAhead lookAhead(window, 3);
+			const char* program = "G1 X1\n\nG1 X2\r\nG1 X3\nG1 X4\nG1 X5";
+			int length = strlen(program);
+
+			int taken = lookAhead.Fill(program, length);
+
+			// The ring holds three blocks, the fourth waits in the parser.
+			Assert::AreEqual(lookAhead.IsFull(), true);
+			Assert::AreEqual(lookAhead.Available(), 3);
+			Assert::AreEqual(lookAhead.Peek(0)->GetWordValue('X'), 1.0);
+			Assert::AreEqual(lookAhead.Peek(2)->GetWordValue('X'), 3.0);
+			Assert::AreEqual(lookAhead.Peek(3) == NULL, true);
+
+			GCodeParsedBlock block;
+			Assert::AreEqual(lookAhead.Pop(&block), true);
+			Assert::AreEqual(block.GetWordValue('X'), 1.0);
+			Assert::AreEqual(lookAhead.Peek(2)->GetWordValue('X'), 4.0);
+
+			taken += lookAhead.Fill(&program[taken], length - taken);
+			Assert::AreEqual(taken, length);
+			Assert::AreEqual(lookAhead.EndOfInput(), false);
+
+			lookAhead.Pop();
+			Assert::AreEqual(lookAhead.EndOfInput(), true);
+			Assert::AreEqual(lookAhead.Available(), 3);
+			Assert::AreEqual(lookAhead.Peek(2)->GetWordValue('X'), 5.0);
+		}
+
+		TEST_METHOD(GCodeLookAhead_LongLine_StopsAtOverflow)
+		{
+			GCodeParsedBlock window[4];
+			GCodeLookAhead lookAhead(window, 4);
+			char program[400];
+			int length = sprintf(program, "G1 X1\nG1 X");
+
+			while (length < 300)
+				program[length++] = '1';
+
+			length += sprintf(&program[length], "\nG1 X3\n");
+
+			// Input stops at the end of the long line, nothing is queued for it.
+			int taken = lookAhead.Fill(program, length);
+			Assert::AreEqual(lookAhead.Overflow(), true);
+			Assert::AreEqual(lookAhead.Available(), 1);
+			Assert::AreEqual(program[taken - 1], '\n');
+			Assert::AreEqual(lookAhead.Fill(&program[taken], length - taken), 0);
+			Assert::AreEqual(lookAhead.EndOfInput(), false);
+
+			lookAhead.SkipLine();
+			Assert::AreEqual(lookAhead.Overflow(), false);
+			taken += lookAhead.Fill(&program[taken], length - taken);
+
+			Assert::AreEqual(taken, length);
+			Assert::AreEqual(lookAhead.Available(), 2);
+			Assert::AreEqual(lookAhead.Peek(1)->GetWordValue('X'), 3.0);
+
+			// A long last line without a line feed is not taken for the end of the input.
+			lookAhead.Pop();
+			lookAhead.Pop();
+			program[length - 7] = '\0';
+			Assert::AreEqual(lookAhead.Fill(program, length - 7), length - 7);
+			Assert::AreEqual(lookAhead.Available(), 1);
+			Assert::AreEqual(lookAhead.Overflow(), false);
+			Assert::AreEqual(lookAhead.EndOfInput(), false);
+			Assert::AreEqual(lookAhead.Overflow(), true);
+
+			lookAhead.SkipLine();
+			Assert::AreEqual(lookAhead.EndOfInput(), true);
+			Assert::AreEqual(lookAhead.Available(), 1);
+		}
+
+		TEST_METHOD(Latency_Timestamps_ConfirmTimes)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCodeLatencyHistogram latency;
+
+			testClockTime = 0;
+			GCode.clock = TestClock;
+			GCode.latency = &latency;
+
+			GCode.AddCharToLine('G');
+			GCode.AddCharToLine('1');
+			GCode.AddCharToLine('\n');
+			GCode.ParseLine();
+
+			Assert::AreEqual(GCode.firstCharTime, 10UL);
+			Assert::AreEqual(GCode.lineEndTime, 20UL);
+			Assert::AreEqual(GCode.parseDoneTime, 30UL);
+			Assert::AreEqual(latency.Count(), 1UL);
+			Assert::AreEqual(latency.Percentile(50.0), 11UL);
+		}
+
+		TEST_METHOD(LatencyHistogram_Percentile_ConfirmBuckets)
+		{
+			GCodeLatencyHistogram latency;
+
+			Assert::AreEqual(latency.Percentile(50.0), 0UL);
+
+			for (unsigned long i = 1; i <= 1000; i++)
+				latency.Record(i);
+
+			Assert::AreEqual(latency.Count(), 1000UL);
+
+			// Results are the top of the bucket holding the percentile, within 25% above.
+			unsigned long p50 = latency.Percentile(50.0);
+			unsigned long p99 = latency.Percentile(99.0);
+			unsigned long p999 = latency.Percentile(99.9);
+
+			Assert::AreEqual(p50 >= 500 && p50 <= 625, true);
+			Assert::AreEqual(p99 >= 990 && p99 <= 1238, true);
+			Assert::AreEqual(p999 >= 999 && p999 <= 1249, true);
+
+			for (unsigned long value = 0; value < 100000; value = value * 3 / 2 + 1)
+			{
+				int bucket = GCodeLatencyHistogram::Bucket(value);
+
+				Assert::AreEqual(GCodeLatencyHistogram::BucketLowest(bucket) <= value, true);
+				Assert::AreEqual(GCodeLatencyHistogram::BucketHighest(bucket) >= value, true);
+			}
+
+			latency.Reset();
+			Assert::AreEqual(latency.Count(), 0UL);
+		}
+
+		TEST_METHOD(LongLine_NoArena_ReportsOverflow)
+		{
+			GCodeParser GCode = GCodeParser();
+
+			bool complete = false;
+
+			for (int i = 0; i < 300 && !complete; i++)
+				complete = GCode.AddCharToLine(i < 3 ? "G1 "[i] : '1');
+
+			// The line is discarded up to its line feed instead of starting again mid line.
+			Assert::AreEqual(complete, false);
+			Assert::AreEqual((int)GCode.lineStatus, (int)GCODE_LINE_OVERFLOW);
+			Assert::AreEqual(GCode.AddCharToLine('X'), false);
+			Assert::AreEqual(GCode.AddCharToLine('\n'), true);
+			GCode.ParseLine();
+			Assert::AreEqual(GCode.NoWords(), true);
+
+			GCode.ParseLine("G1 X2");
+			Assert::AreEqual((int)GCode.lineStatus, (int)GCODE_LINE_OK);
+			Assert::AreEqual(GCode.GetWordValue('X'), 2.0);
+		}
+
+		TEST_METHOD(LongLine_Arena_ParsesWords)
+		{
+			static char memory[2048];
+			GCodeArena arena(memory, sizeof(memory));
+			GCodeParser GCode = GCodeParser();
+			GCode.lineArena = &arena;
+
+			char text[1200];
+			int length = 0;
+
+			length += sprintf(&text[length], "G1 X1.5 ");
+
+			while (length < 1000)
+				length += sprintf(&text[length], "(comment %d) ", length);
+
+			sprintf(&text[length], "Y-2 ; end");
+
+			GCode.ParseLine(text);
+			Assert::AreEqual((int)GCode.lineStatus, (int)GCODE_LINE_LONG);
+			Assert::AreEqual(strcmp(GCode.line, "G1X1.5Y-2"), 0);
+			Assert::AreEqual(GCode.GetWordValue('X'), 1.5);
+			Assert::AreEqual(GCode.GetWordValue('Y'), -2.0);
+			Assert::AreEqual(strcmp(GCode.lastComment, "; end"), 0);
+			Assert::AreEqual(arena.Used(), sizeof(memory));
+
+			// The arena is given back when the next line starts.
+			GCode.ParseLine("G0 Z3");
+			Assert::AreEqual((int)GCode.lineStatus, (int)GCODE_LINE_OK);
+			Assert::AreEqual(GCode.GetWordValue('Z'), 3.0);
+			Assert::AreEqual(arena.Used(), (size_t)0);
+
+			// Longer than the arena.
+			for (int i = 0; i < 3000; i++)
+				GCode.AddCharToLine('1');
+
+			Assert::AreEqual((int)GCode.lineStatus, (int)GCODE_LINE_OVERFLOW);
+			Assert::AreEqual(arena.Used(), sizeof(memory));
+			Assert::AreEqual(GCode.AddCharToLine('\n'), true);
+			GCode.AddCharToLine('G');
+			Assert::AreEqual(arena.Used(), (size_t)0);
+		}
+
+		TEST_METHOD(CommentStream_Callback_ConfirmText)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCode.commentMode = GCODE_COMMENTS_STREAM;
+			GCode.commentCallback = TestCommentCallback;
+			streamedLength = 0;
+			streamedEnds = 0;
+
+			const char* text = "G1 X1 ; a comment longer than one chunk\r\n";
+
+			for (int i = 0; text[i] != '\0'; i++)
+				GCode.AddCharToLine(text[i]);
+
+			GCode.ParseLine();
+			Assert::AreEqual(strcmp(GCode.line, "G1X1"), 0);
+			Assert::AreEqual(strcmp(GCode.comments, ""), 0);
+			Assert::AreEqual(strcmp(streamedComments, "; a comment longer than one chunk|"), 0);
+
+			// The same through AddCharsToLine, and a semicolon which may be in a parenthesis comment stays in the line.
+			const char* program = "(a) ; b)\nG1 X2 ;second one, also longer than a chunk\n";
+			int length = strlen(program);
+			int taken = GCode.AddCharsToLine(program, length);
+			GCode.ParseLine();
+			Assert::AreEqual(strcmp(GCode.comments, "(a) ; b)"), 0);
+
+			taken += GCode.AddCharsToLine(&program[taken], length - taken);
+			Assert::AreEqual(taken, length);
+			Assert::AreEqual(GCode.completeLineIsAvailableToParse, true);
+			GCode.ParseLine();
+			Assert::AreEqual(GCode.GetWordValue('X'), 2.0);
+			Assert::AreEqual(strcmp(streamedComments, "; a comment longer than one chunk|;second one, also longer than a chunk|"), 0);
+			Assert::AreEqual(streamedEnds, 2);
+		}
+
+		TEST_METHOD(CommentSkip_Thumbnails_SkipsRegion)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCode.commentMode = GCODE_COMMENTS_STREAM;
+			GCode.commentCallback = TestCommentCallback;
+			GCode.skipThumbnails = true;
+			streamedLength = 0;
+			streamedEnds = 0;
+
+			const char* program =
+				"; thumbnail begin 16x16 120\n"
+				"; iVBORw0KGgoAAAANSUhEUgAAABAAAAAQCAYAAAAf8/9hAAAA\n"
+				"; thumbnail end\n"
+				";TYPE:WALL-OUTER\n"
+				"G1 X3 E1 ; note\n";
+			int length = strlen(program);
+			int taken = 0;
+			int lines = 0;
+
+			while (taken < length)
+			{
+				taken += GCode.AddCharsToLine(&program[taken], length - taken);
+
+				if (GCode.completeLineIsAvailableToParse)
+				{
+					GCode.ParseLine();
+					lines++;
+				}
+			}
+
+			Assert::AreEqual(lines, 5);
+			Assert::AreEqual(GCode.GetWordValue('X'), 3.0);
+			Assert::AreEqual(strcmp(streamedComments, ";TYPE:WALL-OUTER|; note|"), 0);
+
+			// Skip mode drops every semicolon comment. With skipThumbnails alone the others stay in the line.
+			GCode.commentMode = GCODE_COMMENTS_SKIP;
+			GCode.ParseLine("G1 X4 ; gone");
+			Assert::AreEqual(strcmp(GCode.comments, ""), 0);
+
+			GCode.commentMode = GCODE_COMMENTS_KEEP;
+			GCode.ParseLine("G1 X5 ; kept");
+			Assert::AreEqual(strcmp(GCode.comments, "; kept"), 0);
+			Assert::AreEqual(strcmp(GCode.lastComment, "; kept"), 0);
+		}
+
+		TEST_METHOD(Realtime_Bytes_BypassLine)
+		{
+			GCodeParser GCode = GCodeParser();
+			GCode.realtimeBytes = GCODE_GRBL_REALTIME;
+			GCode.realtimeCallback = TestRealtimeCallback;
+			realtimeCount = 0;
+
+			// A feed hold in the middle of a line is dispatched at once and left out of the line.
+			const char* text = "G1 X1";
+
+			for (int i = 0; text[i] != '\0'; i++)
+				GCode.AddCharToLine(text[i]);
+
+			Assert::AreEqual(GCode.AddCharToLine('!'), false);
+			Assert::AreEqual(realtimeCount, 1);
+
+			text = " Y2 (hold?)\n";
+
+			for (int i = 0; text[i] != '\0'; i++)
+				GCode.AddCharToLine(text[i]);
+
+			GCode.ParseLine();
+			Assert::AreEqual(strcmp(realtimeReceived, "!?"), 0);
+			Assert::AreEqual(strcmp(GCode.line, "G1X1Y2"), 0);
+			Assert::AreEqual(strcmp(GCode.comments, "(hold)"), 0);
+
+			// A real-time byte after a complete line leaves the parsed block alone.
+			Assert::AreEqual(GCode.AddCharToLine('~'), false);
+			Assert::AreEqual(strcmp(realtimeReceived, "!?~"), 0);
+			Assert::AreEqual(GCode.completeLineIsAvailableToParse, true);
+			Assert::AreEqual(GCode.GetWordValue('X'), 1.0);
+			Assert::AreEqual(GCode.GetWordValue('Y'), 2.0);
+			Assert::AreEqual(strcmp(GCode.line, "G1X1Y2"), 0);
+			Assert::AreEqual(strcmp(GCode.comments, "(hold)"), 0);
+
+			// Override bytes and bytes in a skipped comment through AddCharsToLine.
+			GCode.commentMode = GCODE_COMMENTS_SKIP;
+			const char* program = "G1 X3\x91 ; skipped ~ comment\n";
+			int length = strlen(program);
+			int taken = GCode.AddCharsToLine(program, length);
+			Assert::AreEqual(taken, length);
+			GCode.ParseLine();
+			Assert::AreEqual(GCode.GetWordValue('X'), 3.0);
+			Assert::AreEqual(strcmp(realtimeReceived, "!?~\x91~"), 0);
+
+			// Without realtimeBytes the bytes stay in the line.
+			GCode.realtimeBytes = NULL;
+			GCode.commentMode = GCODE_COMMENTS_KEEP;
+			GCode.ParseLine("G1 X4 (status?)");
+			Assert::AreEqual(strcmp(GCode.comments, "(status?)"), 0);
+			Assert::AreEqual(realtimeCount, 5);
+		}
 	};
 }
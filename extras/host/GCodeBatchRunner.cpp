@@ -0,0 +1,544 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "GCodeBatchRunner.h"
+#include "../../src/GCodeArena.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+const size_t BATCH_OPEN = (size_t)-1; // Task offset of a file not opened yet.
+
+struct BatchTask
+{
+	long file;
+	size_t offset;
+	size_t length;
+};
+
+struct BatchFile
+{
+	const char* data;
+	size_t length;
+	long chunksLeft;
+	uint64_t nanoseconds;
+	GCodeBatchResult result;
+};
+
+struct BatchRun;
+
+/// <summary>
+/// A thread's deque, parser and arena. The owner works at the tail, thieves take from the head.
+/// </summary>
+struct BatchWorker
+{
+	BatchRun* run;
+	int index;
+	pthread_mutex_t lock;
+	BatchTask* tasks;
+	long head;
+	long count;
+	long capacity;
+	GCodeParser parser;
+	GCodeArena* arena;
+	void* arenaMemory;
+	unsigned int seed;
+	long stolen;
+};
+
+struct BatchRun
+{
+	GCodeBatchRunner* runner;
+	const char* const* paths;
+	BatchFile* files;
+	BatchWorker* workers;
+	int workerCount;
+	long pending;              // Tasks not finished, including those still to be pushed by a file task.
+	pthread_mutex_t sinkLock;
+	GCodeBatchSink sink;
+	void* context;
+};
+
+/// <summary>
+/// Gets a monotonic time in nanoseconds.
+/// </summary>
+static uint64_t Nanoseconds()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/// <summary>
+/// Adds a task at the tail of a worker's deque.
+/// </summary>
+/// <returns>False if the deque cannot grow.</returns>
+static bool Push(BatchWorker* worker, const BatchTask* task)
+{
+	pthread_mutex_lock(&worker->lock);
+
+	if (worker->count == worker->capacity)
+	{
+		long capacity = worker->capacity == 0 ? 64 : worker->capacity * 2;
+		BatchTask* tasks = (BatchTask*)malloc(capacity * sizeof(BatchTask));
+
+		if (tasks == NULL)
+		{
+			pthread_mutex_unlock(&worker->lock);
+			return false;
+		}
+
+		for (long i = 0; i < worker->count; i++)
+			tasks[i] = worker->tasks[(worker->head + i) % worker->capacity];
+
+		free(worker->tasks);
+		worker->tasks = tasks;
+		worker->head = 0;
+		worker->capacity = capacity;
+	}
+
+	worker->tasks[(worker->head + worker->count) % worker->capacity] = *task;
+	worker->count++;
+
+	pthread_mutex_unlock(&worker->lock);
+
+	return true;
+}
+
+/// <summary>
+/// Takes a task from a worker's deque: the newest for its owner, the oldest for a thief.
+/// </summary>
+static bool Take(BatchWorker* worker, bool newest, BatchTask* task)
+{
+	pthread_mutex_lock(&worker->lock);
+
+	bool found = worker->count > 0;
+
+	if (found)
+	{
+		if (newest)
+			*task = worker->tasks[(worker->head + worker->count - 1) % worker->capacity];
+		else
+		{
+			*task = worker->tasks[worker->head];
+			worker->head = (worker->head + 1) % worker->capacity;
+		}
+
+		worker->count--;
+	}
+
+	pthread_mutex_unlock(&worker->lock);
+
+	return found;
+}
+
+struct BatchCounts
+{
+	uint64_t lines;
+	uint64_t blocks;
+	uint64_t words;
+	uint64_t commented;
+	uint64_t invalid;
+	uint64_t longLines;
+};
+
+/// <summary>
+/// Counts the line just completed and hands it to the block hook.
+/// </summary>
+static void CountLine(BatchWorker* worker, long fileIndex, BatchCounts* counts)
+{
+	GCodeBatchRunner* runner = worker->run->runner;
+	GCodeParser* parser = &worker->parser;
+
+	parser->ParseLine();
+	counts->lines++;
+
+	if (parser->lineStatus != GCODE_LINE_OK)
+		counts->longLines++;
+
+	if (parser->line[0] != '\0')
+	{
+		GCodeWords found;
+		counts->blocks++;
+		counts->words += __builtin_popcountl(parser->GetWords(GCODE_ALL_LETTERS, &found));
+
+		if (parser->dialect != NULL && parser->Validate() != GCODE_VALID)
+			counts->invalid++;
+	}
+
+	if (parser->comments[0] != '\0')
+		counts->commented++;
+
+	if (runner->blockHook != NULL)
+		runner->blockHook(parser, worker->index, fileIndex, runner->hookContext);
+}
+
+/// <summary>
+/// Counts the lines of part of a file and adds the counts to its result.
+/// </summary>
+static void ParseChunk(BatchWorker* worker, long fileIndex, size_t offset, size_t length)
+{
+	BatchFile* file = &worker->run->files[fileIndex];
+	GCodeParser* parser = &worker->parser;
+	const char* data = file->data + offset;
+	uint64_t start = Nanoseconds();
+	BatchCounts counts;
+	size_t pointer = 0;
+	size_t source = 0;
+
+	memset(&counts, 0, sizeof(counts));
+	parser->Initialize();
+
+	while (pointer < length)
+	{
+		int part = length - pointer > INT_MAX ? INT_MAX : (int)(length - pointer);
+		int taken = parser->AddCharsToLine(data + pointer, part);
+		pointer += taken;
+		source += taken;
+
+		if (parser->completeLineIsAvailableToParse)
+		{
+			CountLine(worker, fileIndex, &counts);
+			source = 0;
+		}
+	}
+
+	// A last line without a line feed.
+	if (source > 0 && parser->AddCharToLine('\n'))
+		CountLine(worker, fileIndex, &counts);
+
+	GCodeBatchResult* result = &file->result;
+	__atomic_fetch_add(&result->lines, counts.lines, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&result->blocks, counts.blocks, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&result->words, counts.words, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&result->commentedBlocks, counts.commented, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&result->invalid, counts.invalid, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&result->longLines, counts.longLines, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&file->nanoseconds, Nanoseconds() - start, __ATOMIC_RELAXED);
+}
+
+/// <summary>
+/// Passes a file's result to the sink and unmaps it.
+/// </summary>
+static void FinishFile(BatchRun* run, long fileIndex)
+{
+	BatchFile* file = &run->files[fileIndex];
+	GCodeBatchRunner* runner = run->runner;
+
+	if (file->data != NULL)
+		munmap((void*)file->data, file->length);
+
+	file->data = NULL;
+	file->result.parseSeconds = file->nanoseconds / 1e9;
+
+	pthread_mutex_lock(&run->sinkLock);
+
+	if (file->result.read)
+	{
+		runner->filesDone++;
+		runner->bytesDone += file->result.bytes;
+	}
+	else
+		runner->filesFailed++;
+
+	if (run->sink != NULL)
+		run->sink(&file->result, run->context);
+
+	pthread_mutex_unlock(&run->sinkLock);
+}
+
+/// <summary>
+/// Opens a file and either counts it or splits it into chunk tasks for the worker's deque.
+/// </summary>
+static void OpenFile(BatchWorker* worker, long fileIndex)
+{
+	BatchRun* run = worker->run;
+	BatchFile* file = &run->files[fileIndex];
+	size_t chunkSize = run->runner->chunkSize > 0 ? run->runner->chunkSize : BATCH_CHUNK_SIZE;
+	int fd = open(run->paths[fileIndex], O_RDONLY);
+	struct stat status;
+
+	if (fd < 0 || fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+	{
+		if (fd >= 0)
+			close(fd);
+
+		FinishFile(run, fileIndex);
+		return;
+	}
+
+	file->length = status.st_size;
+	file->result.bytes = status.st_size;
+
+	if (file->length > 0)
+	{
+		void* data = mmap(NULL, file->length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data == MAP_FAILED)
+		{
+			close(fd);
+			FinishFile(run, fileIndex);
+			return;
+		}
+
+		madvise(data, file->length, MADV_SEQUENTIAL);
+		file->data = (const char*)data;
+	}
+
+	close(fd);
+	file->result.read = true;
+
+	if (file->length <= chunkSize)
+	{
+		file->result.chunks = 1;
+		ParseChunk(worker, fileIndex, 0, file->length);
+		FinishFile(run, fileIndex);
+		return;
+	}
+
+	// Chunks end after a line feed so each one starts a line. The first pass counts them so
+	// the file's count and the pending tasks are set before a thief can finish one.
+	int chunks = 0;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		size_t offset = 0;
+
+		while (offset < file->length)
+		{
+			size_t end = offset + chunkSize < file->length ? offset + chunkSize : file->length;
+			const char* lineFeed = end < file->length ? (const char*)memchr(file->data + end - 1, '\n', file->length - end + 1) : NULL;
+			end = lineFeed != NULL ? (size_t)(lineFeed - file->data) + 1 : file->length;
+
+			if (pass == 0)
+				chunks++;
+			else
+			{
+				BatchTask task = { fileIndex, offset, end - offset };
+
+				// A chunk that cannot be queued is counted here.
+				if (!Push(worker, &task))
+				{
+					ParseChunk(worker, fileIndex, offset, end - offset);
+
+					if (__atomic_sub_fetch(&file->chunksLeft, 1, __ATOMIC_ACQ_REL) == 0)
+						FinishFile(run, fileIndex);
+
+					__atomic_fetch_sub(&run->pending, 1, __ATOMIC_RELEASE);
+				}
+			}
+
+			offset = end;
+		}
+
+		if (pass == 0)
+		{
+			file->result.chunks = chunks;
+			file->chunksLeft = chunks;
+			__atomic_fetch_add(&run->pending, chunks, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+/// <summary>
+/// Runs tasks until every task of the batch is finished.
+/// </summary>
+static void* BatchWorkerMain(void* argument)
+{
+	BatchWorker* worker = (BatchWorker*)argument;
+	BatchRun* run = worker->run;
+	BatchTask task;
+
+	while (true)
+	{
+		bool found = Take(worker, true, &task);
+
+		// Steal the oldest task of another worker, starting from a random one.
+		for (int i = 0; !found && i < run->workerCount - 1; i++)
+		{
+			int victim = (worker->index + 1 + (rand_r(&worker->seed) + i) % (run->workerCount - 1)) % run->workerCount;
+
+			if (Take(&run->workers[victim], false, &task))
+			{
+				found = true;
+				worker->stolen++;
+			}
+		}
+
+		if (!found)
+		{
+			if (__atomic_load_n(&run->pending, __ATOMIC_ACQUIRE) == 0)
+				break;
+
+			// Another worker is still opening a file and may push chunks.
+			sched_yield();
+			continue;
+		}
+
+		if (task.offset == BATCH_OPEN)
+			OpenFile(worker, task.file);
+		else
+		{
+			ParseChunk(worker, task.file, task.offset, task.length);
+
+			if (__atomic_sub_fetch(&run->files[task.file].chunksLeft, 1, __ATOMIC_ACQ_REL) == 0)
+				FinishFile(run, task.file);
+		}
+
+		__atomic_fetch_sub(&run->pending, 1, __ATOMIC_RELEASE);
+	}
+
+	return NULL;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeBatchRunner::GCodeBatchRunner()
+{
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+	threads = processors > 0 ? (int)processors : 1;
+	chunkSize = BATCH_CHUNK_SIZE;
+	dialect = NULL;
+	blockHook = NULL;
+	hookContext = NULL;
+	filesDone = 0;
+	filesFailed = 0;
+	tasksStolen = 0;
+	bytesDone = 0;
+	seconds = 0;
+}
+
+/// <summary>
+/// Parses and checks a list of files, passing each file's result to a sink as it completes.
+/// </summary>
+/// <param name="paths">The files.</param>
+/// <param name="count">The number of files.</param>
+/// <param name="sink">Receives the results, one call at a time. May be NULL.</param>
+/// <param name="context">Passed to the sink.</param>
+/// <returns>False if the workers could not be set up. Files that cannot be read are reported to the sink.</returns>
+bool GCodeBatchRunner::Run(const char* const* paths, long count, GCodeBatchSink sink, void* context)
+{
+	int workerCount = threads > 0 ? threads : 1;
+	BatchRun run;
+	run.runner = this;
+	run.paths = paths;
+	run.files = (BatchFile*)calloc(count > 0 ? count : 1, sizeof(BatchFile));
+	run.workers = new BatchWorker[workerCount];
+	run.workerCount = workerCount;
+	run.pending = count;
+	run.sink = sink;
+	run.context = context;
+
+	filesDone = 0;
+	filesFailed = 0;
+	tasksStolen = 0;
+	bytesDone = 0;
+
+	if (run.files == NULL)
+	{
+		delete[] run.workers;
+		return false;
+	}
+
+	pthread_mutex_init(&run.sinkLock, NULL);
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		BatchWorker* worker = &run.workers[i];
+		worker->run = &run;
+		worker->index = i;
+		worker->tasks = NULL;
+		worker->head = 0;
+		worker->count = 0;
+		worker->capacity = 0;
+		worker->parser.dialect = dialect;
+		worker->arena = NULL;
+		worker->arenaMemory = malloc(BATCH_ARENA_SIZE);
+		worker->seed = i + 1;
+		worker->stolen = 0;
+		pthread_mutex_init(&worker->lock, NULL);
+
+		if (worker->arenaMemory != NULL)
+		{
+			worker->arena = new GCodeArena(worker->arenaMemory, BATCH_ARENA_SIZE);
+			worker->parser.lineArena = worker->arena;
+		}
+	}
+
+	bool result = true;
+
+	for (long i = 0; i < count && result; i++)
+	{
+		run.files[i].result.path = paths[i];
+		run.files[i].result.file = i;
+
+		BatchTask task = { i, BATCH_OPEN, 0 };
+		result = Push(&run.workers[i % workerCount], &task);
+	}
+
+	if (result)
+	{
+		pthread_t* started = workerCount > 1 ? (pthread_t*)malloc((workerCount - 1) * sizeof(pthread_t)) : NULL;
+		int startedCount = 0;
+		uint64_t start = Nanoseconds();
+
+		// Threads that cannot be started leave their files to be stolen by the others.
+		while (started != NULL && startedCount < workerCount - 1 &&
+			pthread_create(&started[startedCount], NULL, BatchWorkerMain, &run.workers[startedCount + 1]) == 0)
+			startedCount++;
+
+		BatchWorkerMain(&run.workers[0]);
+
+		for (int i = 0; i < startedCount; i++)
+			pthread_join(started[i], NULL);
+
+		free(started);
+		seconds = (Nanoseconds() - start) / 1e9;
+	}
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		BatchWorker* worker = &run.workers[i];
+		tasksStolen += worker->stolen;
+		delete worker->arena;
+		free(worker->arenaMemory);
+		free(worker->tasks);
+		pthread_mutex_destroy(&worker->lock);
+	}
+
+	pthread_mutex_destroy(&run.sinkLock);
+	free(run.files);
+	delete[] run.workers;
+
+	return result;
+}
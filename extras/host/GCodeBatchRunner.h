@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GCodeBatchRunner_h
+#define GCodeBatchRunner_h
+
+#include "../../src/GCodeParser.h"
+#include "../../src/GCodeDialect.h"
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t BATCH_CHUNK_SIZE = 4 * 1024 * 1024;  // Files larger than this are split (default).
+const size_t BATCH_ARENA_SIZE = 1024 * 1024;      // Per thread memory for lines longer than MAX_LINE_SIZE.
+
+/// <summary>
+/// What the batch runner found in a file.
+/// </summary>
+struct GCodeBatchResult
+{
+	const char* path;
+	long file;                 // Index in the paths given to Run.
+	bool read;                 // False if the file could not be opened or mapped.
+	int chunks;                // Pieces the file was split into, 1 for most files.
+	uint64_t bytes;
+	uint64_t lines;
+	uint64_t blocks;           // Lines with code.
+	uint64_t words;
+	uint64_t commentedBlocks;
+	uint64_t invalid;          // Blocks the dialect rejects, 0 without a dialect.
+	uint64_t longLines;        // Lines longer than MAX_LINE_SIZE.
+	double parseSeconds;       // Summed over the chunks.
+};
+
+typedef void (*GCodeBatchSink)(const GCodeBatchResult* result, void* context);
+typedef void (*GCodeBatchBlockHook)(GCodeParser* parser, int worker, long file, void* context);
+
+/// <summary>
+/// Parses and checks many programs at once with a work stealing scheduler (Linux host only).
+/// </summary>
+/// <remark>
+/// One process does the work of one per file: each thread has its own deque of tasks, its
+/// own GCodeParser and its own arena for long lines, all reused from task to task. The
+/// files are dealt out to the deques; a thread takes its newest task and, when its deque
+/// is empty, steals the oldest task of another thread, so threads stay busy however the
+/// file sizes vary. A file larger than chunkSize is memory mapped and split at line ends
+/// into chunk tasks pushed on the deque of the thread which opened it, so the other threads
+/// steal its chunks instead of waiting behind it.
+///
+/// Each chunk is counted on its own and the counts are added to its file's result; the
+/// thread finishing a file's last chunk passes the result to the sink. Sink calls are
+/// serialized, in the order the files complete. A blockHook sees every parsed block with
+/// the index of the thread calling it, so it can keep per thread state without locks; the
+/// blocks of a file split into chunks arrive in order within each chunk only.
+///
+///   GCodeBatchRunner runner;
+///   runner.dialect = &amp;GCodeDialectMarlin;
+///   runner.Run(paths, count, PrintResult, NULL);
+/// </remark>
+class GCodeBatchRunner
+{
+public:
+	int threads;               // Worker threads, the calling thread included (default the processors online).
+	size_t chunkSize;          // Split files larger than this (default BATCH_CHUNK_SIZE).
+	const GCodeDialect* dialect; // Validate each block (default NULL).
+	GCodeBatchBlockHook blockHook; // Called for each parsed line (default NULL).
+	void* hookContext;
+	long filesDone;
+	long filesFailed;
+	long tasksStolen;
+	uint64_t bytesDone;
+	double seconds;
+
+	GCodeBatchRunner();
+
+	bool Run(const char* const* paths, long count, GCodeBatchSink sink, void* context);
+};
+
+#endif
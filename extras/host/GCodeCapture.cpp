@@ -0,0 +1,429 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeCapture.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const char CAPTURE_MAGIC[8] = { 'G', 'C', 'O', 'D', 'E', 'C', 'A', 'P' };
+const unsigned char CAPTURE_VERSION = 1;
+const char CAPTURE_DATA = 'D';
+const char CAPTURE_END = 'E';
+
+const uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+/// <summary>
+/// Gets a clock in microseconds.
+/// </summary>
+static uint64_t Microseconds(clockid_t clock)
+{
+	struct timespec now;
+	clock_gettime(clock, &now);
+
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/// <summary>
+/// Writes an unsigned LEB128 varint.
+/// </summary>
+static bool WriteVarint(FILE* file, uint64_t value)
+{
+	do {
+		unsigned char byte = value & 0x7F;
+		value >>= 7;
+
+		if (value != 0)
+			byte |= 0x80;
+
+		if (putc(byte, file) == EOF)
+			return false;
+	} while (value != 0);
+
+	return true;
+}
+
+/// <summary>
+/// Reads an unsigned LEB128 varint.
+/// </summary>
+static bool ReadVarint(FILE* file, uint64_t* value)
+{
+	*value = 0;
+
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		int byte = getc(file);
+
+		if (byte == EOF)
+			return false;
+
+		*value |= (uint64_t)(byte & 0x7F) << shift;
+
+		if (!(byte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+/// <summary>
+/// Writes a 64 bit value, least significant byte first.
+/// </summary>
+static bool WriteFixed64(FILE* file, uint64_t value)
+{
+	unsigned char bytes[8];
+
+	for (int i = 0; i < 8; i++)
+		bytes[i] = (unsigned char)(value >> (8 * i));
+
+	return fwrite(bytes, 1, 8, file) == 8;
+}
+
+/// <summary>
+/// Reads a 64 bit value, least significant byte first.
+/// </summary>
+static bool ReadFixed64(FILE* file, uint64_t* value)
+{
+	unsigned char bytes[8];
+
+	if (fread(bytes, 1, 8, file) != 8)
+		return false;
+
+	*value = 0;
+
+	for (int i = 0; i < 8; i++)
+		*value |= (uint64_t)bytes[i] << (8 * i);
+
+	return true;
+}
+
+/// <summary>
+/// Folds text and its null into a FNV-1a hash.
+/// </summary>
+static uint64_t HashText(uint64_t hash, const char* text)
+{
+	do {
+		hash ^= (unsigned char)*text;
+		hash *= FNV_PRIME;
+	} while (*text++ != '\0');
+
+	return hash;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeBlockSequence::GCodeBlockSequence()
+{
+	Reset();
+}
+
+/// <summary>
+/// Starts a new sequence.
+/// </summary>
+void GCodeBlockSequence::Reset()
+{
+	parser.Initialize();
+	blocks = 0;
+	hash = FNV_OFFSET;
+}
+
+/// <summary>
+/// Feeds bytes to the parser and adds the blocks they complete.
+/// </summary>
+void GCodeBlockSequence::Add(const char* bytes, int length)
+{
+	for (int i = 0; i < length; i++)
+	{
+		if (parser.AddCharToLine(bytes[i]))
+		{
+			parser.ParseLine();
+
+			hash = HashText(hash, parser.line);
+			hash = HashText(hash, parser.comments);
+			blocks++;
+		}
+	}
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeCaptureWriter::GCodeCaptureWriter()
+{
+	file = NULL;
+	lastTime = 0;
+	chunks = 0;
+	bytes = 0;
+}
+
+/// <summary>
+/// Class destructor. Closes the capture.
+/// </summary>
+GCodeCaptureWriter::~GCodeCaptureWriter()
+{
+	Close();
+}
+
+/// <summary>
+/// Creates a capture file and writes its header.
+/// </summary>
+/// <returns>False if the file could not be created.</returns>
+bool GCodeCaptureWriter::Open(const char* path)
+{
+	Close();
+
+	file = fopen(path, "wb");
+
+	if (file == NULL)
+		return false;
+
+	lastTime = Microseconds(CLOCK_MONOTONIC);
+	sequence.Reset();
+	chunks = 0;
+	bytes = 0;
+
+	fwrite(CAPTURE_MAGIC, 1, sizeof(CAPTURE_MAGIC), file);
+	putc(CAPTURE_VERSION, file);
+
+	return WriteFixed64(file, Microseconds(CLOCK_REALTIME));
+}
+
+/// <summary>
+/// Records a chunk of bytes received at a given time.
+/// </summary>
+/// <param name="data">The bytes as received.</param>
+/// <param name="length">The number of bytes, chunks over CAPTURE_MAX_CHUNK are split.</param>
+/// <param name="time">When the bytes arrived, CLOCK_MONOTONIC microseconds.</param>
+/// <returns>False if the capture is not open or the write failed.</returns>
+bool GCodeCaptureWriter::Write(const char* data, int length, uint64_t time)
+{
+	if (file == NULL)
+		return false;
+
+	while (length > 0)
+	{
+		int part = length < CAPTURE_MAX_CHUNK ? length : CAPTURE_MAX_CHUNK;
+		uint64_t delay = time > lastTime ? time - lastTime : 0;
+
+		if (putc(CAPTURE_DATA, file) == EOF || !WriteVarint(file, delay) || !WriteVarint(file, part)
+			|| fwrite(data, 1, part, file) != (size_t)part)
+			return false;
+
+		sequence.Add(data, part);
+
+		lastTime = time > lastTime ? time : lastTime;
+		chunks++;
+		bytes += part;
+		data += part;
+		length -= part;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Records a chunk of bytes received now.
+/// </summary>
+bool GCodeCaptureWriter::Write(const char* data, int length)
+{
+	return Write(data, length, Microseconds(CLOCK_MONOTONIC));
+}
+
+/// <summary>
+/// Writes the end record with the block sequence and closes the file.
+/// </summary>
+/// <returns>False if the capture could not be completed.</returns>
+bool GCodeCaptureWriter::Close()
+{
+	if (file == NULL)
+		return true;
+
+	bool result = putc(CAPTURE_END, file) != EOF && WriteVarint(file, sequence.blocks) && WriteFixed64(file, sequence.hash);
+
+	if (fclose(file) != 0)
+		result = false;
+
+	file = NULL;
+
+	return result;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeCaptureReader::GCodeCaptureReader()
+{
+	file = NULL;
+	chunk = NULL;
+	startTime = 0;
+	recordedBlocks = -1;
+	recordedHash = 0;
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeCaptureReader::~GCodeCaptureReader()
+{
+	Close();
+	free(chunk);
+}
+
+/// <summary>
+/// Opens a capture file and reads its header.
+/// </summary>
+/// <returns>False if the file could not be read or is not a capture.</returns>
+bool GCodeCaptureReader::Open(const char* path)
+{
+	Close();
+
+	if (chunk == NULL)
+		chunk = (char*)malloc(CAPTURE_MAX_CHUNK);
+
+	file = fopen(path, "rb");
+
+	if (file == NULL || chunk == NULL)
+		return false;
+
+	char magic[sizeof(CAPTURE_MAGIC)];
+	recordedBlocks = -1;
+
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0
+		|| getc(file) != CAPTURE_VERSION || !ReadFixed64(file, &startTime))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Reads the next chunk.
+/// </summary>
+/// <param name="data">Receives the bytes, valid until the next call.</param>
+/// <param name="delay">Receives the microseconds since the previous chunk arrived.</param>
+/// <returns>The number of bytes, 0 at the end of the capture or -1 if it is damaged.</returns>
+int GCodeCaptureReader::Next(const char** data, uint64_t* delay)
+{
+	if (file == NULL)
+		return 0;
+
+	int type = getc(file);
+
+	if (type == CAPTURE_END)
+	{
+		uint64_t blocks;
+
+		if (!ReadVarint(file, &blocks) || !ReadFixed64(file, &recordedHash))
+			return -1;
+
+		recordedBlocks = (long)blocks;
+
+		return 0;
+	}
+
+	uint64_t length;
+
+	if (type != CAPTURE_DATA || !ReadVarint(file, delay) || !ReadVarint(file, &length)
+		|| length == 0 || length > (uint64_t)CAPTURE_MAX_CHUNK || fread(chunk, 1, length, file) != length)
+	{
+		// A capture cut short (i.e. the recorder was killed) ends at its last complete record.
+		return feof(file) ? 0 : -1;
+	}
+
+	*data = chunk;
+
+	return (int)length;
+}
+
+/// <summary>
+/// Closes the capture file.
+/// </summary>
+void GCodeCaptureReader::Close()
+{
+	if (file != NULL)
+		fclose(file);
+
+	file = NULL;
+}
+
+/// <summary>
+/// Replays a capture through the parser.
+/// </summary>
+/// <param name="path">The capture file.</param>
+/// <param name="realTime">Deliver each chunk at its original time instead of as fast as possible.</param>
+/// <param name="statistics">Receives the counters and whether the block sequence matched.</param>
+/// <returns>False if the capture could not be read. Check statistics->verified for the blocks.</returns>
+bool GCodeCaptureReader::Replay(const char* path, bool realTime, GCodeReplayStatistics* statistics)
+{
+	memset(statistics, 0, sizeof(*statistics));
+
+	if (!Open(path))
+		return false;
+
+	GCodeBlockSequence* sequence = new GCodeBlockSequence();
+	uint64_t start = Microseconds(CLOCK_MONOTONIC);
+	uint64_t due = start;
+	uint64_t parsing = 0;
+	uint64_t recorded = 0;
+	const char* data;
+	uint64_t delay;
+	int length;
+
+	while ((length = Next(&data, &delay)) > 0)
+	{
+		recorded += delay;
+
+		if (realTime)
+		{
+			due += delay;
+			uint64_t now = Microseconds(CLOCK_MONOTONIC);
+
+			if (due > now)
+				usleep(due - now);
+		}
+
+		uint64_t before = Microseconds(CLOCK_MONOTONIC);
+		sequence->Add(data, length);
+		parsing += Microseconds(CLOCK_MONOTONIC) - before;
+
+		statistics->chunks++;
+		statistics->bytes += length;
+	}
+
+	statistics->seconds = (Microseconds(CLOCK_MONOTONIC) - start) / 1e6;
+	statistics->parseSeconds = parsing / 1e6;
+	statistics->recordedSeconds = recorded / 1e6;
+	statistics->blocks = sequence->blocks;
+	statistics->verified = length == 0 && recordedBlocks == sequence->blocks && recordedHash == sequence->hash;
+
+	delete sequence;
+	Close();
+
+	return length == 0;
+}
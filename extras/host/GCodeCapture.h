@@ -0,0 +1,129 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeCapture_h
+#define GCodeCapture_h
+
+#include "../../src/GCodeParser.h"
+#include <stdio.h>
+#include <stdint.h>
+
+const int CAPTURE_MAX_CHUNK = 65536; // Largest chunk of bytes in one record.
+
+/// <summary>
+/// The sequence of blocks a byte stream produces, reduced to a count and a hash.
+/// </summary>
+/// <remark>
+/// Every byte is fed to AddCharToLine exactly as a controller would. Each complete line is
+/// parsed and the code and comments are folded into a 64 bit FNV-1a hash, so two streams
+/// give the same result only if they produce the same blocks in the same order, whatever
+/// their chunking or timing.
+/// </remark>
+class GCodeBlockSequence
+{
+public:
+	GCodeParser parser;
+	long blocks;
+	uint64_t hash;
+
+	GCodeBlockSequence();
+
+	void Reset();
+	void Add(const char* bytes, int length);
+};
+
+/// <summary>
+/// Writes a capture file of raw input bytes with their arrival times (host only).
+/// </summary>
+/// <remark>
+/// The file starts with the magic "GCODECAP", a version byte and the wall clock start time.
+/// Each chunk of bytes, as it was received (i.e. one read from the serial port), is a 'D'
+/// record: the microseconds since the previous chunk and the length as LEB128 varints,
+/// then the bytes. Close writes an 'E' record with the number of blocks and the block
+/// sequence hash the bytes produced, which the replayer verifies.
+/// </remark>
+class GCodeCaptureWriter
+{
+private:
+	FILE* file;
+	uint64_t lastTime;
+
+public:
+	GCodeBlockSequence sequence;
+	long chunks;
+	uint64_t bytes;
+
+	GCodeCaptureWriter();
+	~GCodeCaptureWriter();
+
+	bool Open(const char* path);
+	bool Write(const char* data, int length, uint64_t time);
+	bool Write(const char* data, int length);
+	bool Close();
+};
+
+/// <summary>
+/// Counters from replaying a capture.
+/// </summary>
+struct GCodeReplayStatistics
+{
+	long chunks;
+	uint64_t bytes;
+	long blocks;
+	double seconds;         // Time spent replaying, including waits in real time mode.
+	double parseSeconds;    // Time spent in AddCharToLine and ParseLine.
+	double recordedSeconds; // Length of the original capture.
+	bool verified;          // The block sequence matches the one recorded.
+};
+
+/// <summary>
+/// Reads a capture file and feeds it to the parser (host only).
+/// </summary>
+/// <remark>
+/// With realTime set each chunk is delivered at its original offset from the start, so
+/// timing related faults can be reproduced. Otherwise chunks are fed as fast as possible,
+/// which makes captures of real traffic a parsing benchmark.
+/// </remark>
+class GCodeCaptureReader
+{
+private:
+	FILE* file;
+	char* chunk;
+
+public:
+	uint64_t startTime;     // Wall clock microseconds when the capture started.
+	long recordedBlocks;    // From the end record, -1 if the capture was cut short.
+	uint64_t recordedHash;
+
+	GCodeCaptureReader();
+	~GCodeCaptureReader();
+
+	bool Open(const char* path);
+	int Next(const char** data, uint64_t* delay);
+	void Close();
+
+	bool Replay(const char* path, bool realTime, GCodeReplayStatistics* statistics);
+};
+
+#endif
@@ -0,0 +1,711 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeColumns.h"
+#include "../../src/GCodeArena.h"
+#include "../../src/GCodeDialect.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const long INITIAL_ROW_CAPACITY = 4096;
+const int READ_BUFFER_SIZE = 65536;
+const size_t COLUMNS_ARENA_SIZE = 1 << 20;
+const uint32_t COLUMN_FILE_VERSION = 2;
+const int COLUMN_NAME_SIZE = 16;
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeColumns::GCodeColumns()
+{
+	capacity = 0;
+	rowCount = 0;
+	longLine = 0;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		value[i] = NULL;
+		present[i] = NULL;
+	}
+
+	gCommand = NULL;
+	mCommand = NULL;
+	lineNumber = NULL;
+	commentId = NULL;
+	memset(&summary, 0, sizeof(summary));
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeColumns::~GCodeColumns()
+{
+	Clear();
+}
+
+/// <summary>
+/// Frees all columns.
+/// </summary>
+void GCodeColumns::Clear()
+{
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		free(value[i]);
+		free(present[i]);
+		value[i] = NULL;
+		present[i] = NULL;
+	}
+
+	free(gCommand);
+	free(mCommand);
+	free(lineNumber);
+	free(commentId);
+	commentPool.Clear();
+
+	gCommand = NULL;
+	mCommand = NULL;
+	lineNumber = NULL;
+	commentId = NULL;
+	capacity = 0;
+	rowCount = 0;
+	memset(&summary, 0, sizeof(summary));
+}
+
+/// <summary>
+/// Grows a column to the capacity provided.
+/// </summary>
+static bool Grow(void** column, long oldCount, long newCount, size_t elementSize)
+{
+	void* grown = realloc(*column, newCount * elementSize);
+
+	if (grown == NULL)
+		return false;
+
+	memset((char*)grown + oldCount * elementSize, 0, (newCount - oldCount) * elementSize);
+	*column = grown;
+
+	return true;
+}
+
+/// <summary>
+/// Makes room for at least the number of rows provided in every allocated column.
+/// </summary>
+bool GCodeColumns::Reserve(long rows)
+{
+	if (rows <= capacity)
+		return true;
+
+	long newCapacity = capacity == 0 ? INITIAL_ROW_CAPACITY : capacity;
+
+	while (newCapacity < rows)
+		newCapacity *= 2;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (value[i] == NULL)
+			continue;
+
+		if (!Grow((void**)&value[i], capacity, newCapacity, sizeof(double)) ||
+			!Grow((void**)&present[i], (capacity + 7) / 8, (newCapacity + 7) / 8, 1))
+			return false;
+	}
+
+	if (!Grow((void**)&gCommand, capacity, newCapacity, sizeof(unsigned int)) ||
+		!Grow((void**)&mCommand, capacity, newCapacity, sizeof(unsigned int)) ||
+		!Grow((void**)&lineNumber, capacity, newCapacity, sizeof(long)) ||
+		!Grow((void**)&commentId, capacity, newCapacity, sizeof(int32_t)))
+		return false;
+
+	capacity = newCapacity;
+
+	return true;
+}
+
+/// <summary>
+/// Allocates the value and presence columns for a letter the first time it is seen.
+/// </summary>
+bool GCodeColumns::ReserveLetter(int letter)
+{
+	if (value[letter] != NULL)
+		return true;
+
+	return Grow((void**)&value[letter], 0, capacity, sizeof(double)) &&
+		Grow((void**)&present[letter], 0, (capacity + 7) / 8, 1);
+}
+
+/// <summary>
+/// Gets the key of the first G or M command on a parsed line.
+/// </summary>
+static unsigned int FirstCommandKey(const char* line, char letter)
+{
+	int pointer = 0;
+
+	while (line[pointer] != '\0' && line[pointer] != letter)
+		pointer++;
+
+	if (line[pointer] == '\0')
+		return GCODE_COMMAND_EMPTY;
+
+	pointer++;
+
+	long code;
+	int count = GCodeParser::ParseInteger(&line[pointer], &code);
+
+	if (count == 0)
+		return GCODE_COMMAND_EMPTY;
+
+	pointer += count;
+
+	int subcode = -1;
+
+	if (line[pointer] == '.' && line[pointer + 1] >= '0' && line[pointer + 1] <= '9')
+		subcode = line[pointer + 1] - '0';
+
+	return GCodeDialect::CommandKey(letter, code, subcode);
+}
+
+/// <summary>
+/// Adds the parsed line as a row.
+/// </summary>
+bool GCodeColumns::AddBlock(GCodeParser* parser, long sourceLine)
+{
+	// An overflowed line parses as an empty block, which must not be taken for a blank line.
+	if (parser->lineStatus == GCODE_LINE_OVERFLOW)
+	{
+		longLine = sourceLine;
+		return false;
+	}
+
+	if (parser->line[0] == '\0' && parser->comments[0] == '\0')
+		return true;
+
+	if (!Reserve(rowCount + 1))
+		return false;
+
+	GCodeWords words;
+	unsigned long found = parser->GetWords(GCODE_ALL_LETTERS, &words);
+	long row = rowCount;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (!(found & (1UL << i)))
+			continue;
+
+		if (!ReserveLetter(i))
+			return false;
+
+		value[i][row] = words.value[i];
+		present[i][row / 8] |= (unsigned char)(1 << (row % 8));
+		summary.letterCount[i]++;
+		summary.words++;
+	}
+
+	gCommand[row] = FirstCommandKey(parser->line, 'G');
+	mCommand[row] = FirstCommandKey(parser->line, 'M');
+	lineNumber[row] = sourceLine;
+	commentId[row] = -1;
+
+	if (parser->comments[0] != '\0')
+	{
+		long id = commentPool.Intern(parser->comments);
+
+		if (id < 0)
+			return false;
+
+		commentId[row] = (int32_t)id;
+
+		summary.commentedBlocks++;
+	}
+
+	rowCount++;
+	summary.blocks++;
+
+	return true;
+}
+
+/// <summary>
+/// Parses a program file into the columns, appending to any rows already present.
+/// </summary>
+/// <param name="path">The G-Code file.</param>
+/// <returns>False if the file cannot be read, memory runs out or a line is too long (see longLine).</returns>
+bool GCodeColumns::ParseFile(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = ParseStream(file);
+	fclose(file);
+
+	return result;
+}
+
+/// <summary>
+/// Parses a program from an open stream into the columns, appending to any rows already present.
+/// </summary>
+/// <param name="file">The stream, read to the end.</param>
+/// <returns>False if the stream cannot be read, memory runs out or a line is too long (see longLine).</returns>
+bool GCodeColumns::ParseStream(FILE* file)
+{
+	longLine = 0;
+
+	char* buffer = (char*)malloc(READ_BUFFER_SIZE);
+	void* memory = malloc(COLUMNS_ARENA_SIZE);
+
+	if (buffer == NULL || memory == NULL)
+	{
+		free(buffer);
+		free(memory);
+		return false;
+	}
+
+	GCodeArena arena(memory, COLUMNS_ARENA_SIZE);
+	GCodeParser parser;
+	parser.lineArena = &arena;
+	long sourceLine = 1;
+	bool result = true;
+	size_t count;
+
+	while (result && (count = fread(buffer, 1, READ_BUFFER_SIZE, file)) > 0)
+	{
+		summary.sourceBytes += count;
+
+		for (size_t i = 0; i < count && result; i++)
+		{
+			if (parser.AddCharToLine(buffer[i]))
+			{
+				parser.ParseLine();
+				result = AddBlock(&parser, sourceLine);
+				sourceLine++;
+			}
+		}
+	}
+
+	if (ferror(file))
+		result = false;
+
+	summary.sourceLines += sourceLine - 1;
+
+	// A last line without a line feed.
+	if (result && !parser.completeLineIsAvailableToParse && (parser.line[0] != '\0' || parser.lineStatus == GCODE_LINE_OVERFLOW))
+	{
+		parser.AddCharToLine('\n');
+		parser.ParseLine();
+		result = AddBlock(&parser, sourceLine);
+		summary.sourceLines++;
+	}
+
+	free(buffer);
+	free(memory);
+
+	return result;
+}
+
+/// <summary>
+/// Parses a program held in memory into the columns, appending to any rows already present.
+/// </summary>
+/// <param name="data">The program text.</param>
+/// <param name="length">The length of the program text.</param>
+/// <returns>False if memory runs out or a line is too long (see longLine).</returns>
+bool GCodeColumns::ParseBuffer(const char* data, long length)
+{
+	longLine = 0;
+
+	void* memory = malloc(COLUMNS_ARENA_SIZE);
+
+	if (memory == NULL)
+		return false;
+
+	GCodeArena arena(memory, COLUMNS_ARENA_SIZE);
+	GCodeParser parser;
+	parser.lineArena = &arena;
+	long sourceLine = 1;
+	bool result = true;
+
+	summary.sourceBytes += length;
+
+	for (long i = 0; i < length && result; i++)
+	{
+		if (parser.AddCharToLine(data[i]))
+		{
+			parser.ParseLine();
+			result = AddBlock(&parser, sourceLine);
+			sourceLine++;
+		}
+	}
+
+	summary.sourceLines += sourceLine - 1;
+
+	if (result && !parser.completeLineIsAvailableToParse && (parser.line[0] != '\0' || parser.lineStatus == GCODE_LINE_OVERFLOW))
+	{
+		parser.AddCharToLine('\n');
+		parser.ParseLine();
+		summary.sourceLines++;
+		result = AddBlock(&parser, sourceLine);
+	}
+
+	free(memory);
+
+	return result;
+}
+
+/// <summary>
+/// Determine if a letter is present in a row.
+/// </summary>
+bool GCodeColumns::IsPresent(char letter, long row) const
+{
+	if (letter < 'A' || letter > 'Z' || row < 0 || row >= rowCount || present[letter - 'A'] == NULL)
+		return false;
+
+	return (present[letter - 'A'][row / 8] >> (row % 8)) & 1;
+}
+
+/// <summary>
+/// Gets the comment(s) of a row.
+/// </summary>
+/// <returns>The interned comment or an empty string if the row has none.</returns>
+const char* GCodeColumns::Comment(long row) const
+{
+	if (row < 0 || row >= rowCount)
+		return "";
+
+	return commentPool.Text(commentId[row]);
+}
+
+struct ColumnEntry
+{
+	char name[COLUMN_NAME_SIZE];
+	uint32_t elementSize;
+	uint64_t offset;
+	uint64_t length;
+	const void* data;
+};
+
+/// <summary>
+/// Writes the columns to a single file laid out for memory mapping. See the class remarks for the layout.
+/// </summary>
+/// <param name="path">The file to create.</param>
+/// <returns>False if the file cannot be written.</returns>
+bool GCodeColumns::Dump(const char* path) const
+{
+	ColumnEntry columns[2 * WORD_LETTER_COUNT + 8];
+	uint32_t columnCount = 0;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (value[i] == NULL)
+			continue;
+
+		ColumnEntry* entry = &columns[columnCount++];
+		memset(entry->name, 0, COLUMN_NAME_SIZE);
+		entry->name[0] = 'A' + i;
+		entry->elementSize = sizeof(double);
+		entry->length = rowCount * sizeof(double);
+		entry->data = value[i];
+
+		entry = &columns[columnCount++];
+		memset(entry->name, 0, COLUMN_NAME_SIZE);
+		snprintf(entry->name, COLUMN_NAME_SIZE, "%c.present", 'A' + i);
+		entry->elementSize = 1;
+		entry->length = (rowCount + 7) / 8;
+		entry->data = present[i];
+	}
+
+	const char* names[] = { "g", "m", "line", "comment", "comments", "commentStart", "commentCount", "summary" };
+	const void* data[] = { gCommand, mCommand, lineNumber, commentId, commentPool.Pool(), commentPool.Starts(),
+		commentPool.Counts(), &summary };
+	uint32_t sizes[] = { sizeof(unsigned int), sizeof(unsigned int), sizeof(long), sizeof(int32_t), 1,
+		sizeof(uint32_t), sizeof(uint32_t), sizeof(uint64_t) };
+	uint64_t lengths[] = { rowCount * sizeof(unsigned int), rowCount * sizeof(unsigned int),
+		rowCount * sizeof(long), rowCount * sizeof(int32_t), commentPool.PoolSize(),
+		commentPool.Size() * sizeof(uint32_t), commentPool.Size() * sizeof(uint32_t), sizeof(summary) };
+
+	for (int i = 0; i < 8; i++)
+	{
+		ColumnEntry* entry = &columns[columnCount++];
+		memset(entry->name, 0, COLUMN_NAME_SIZE);
+		strncpy(entry->name, names[i], COLUMN_NAME_SIZE - 1);
+		entry->elementSize = sizes[i];
+		entry->length = lengths[i];
+		entry->data = data[i];
+	}
+
+	uint64_t rows = rowCount;
+	uint64_t offset = 8 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t) +
+		columnCount * (COLUMN_NAME_SIZE + sizeof(uint32_t) + 2 * sizeof(uint64_t));
+
+	for (uint32_t i = 0; i < columnCount; i++)
+	{
+		offset = (offset + 7) & ~(uint64_t)7;
+		columns[i].offset = offset;
+		offset += columns[i].length;
+	}
+
+	FILE* file = fopen(path, "wb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = fwrite("GCODECOL", 1, 8, file) == 8 &&
+		fwrite(&COLUMN_FILE_VERSION, sizeof(uint32_t), 1, file) == 1 &&
+		fwrite(&rows, sizeof(uint64_t), 1, file) == 1 &&
+		fwrite(&columnCount, sizeof(uint32_t), 1, file) == 1;
+
+	for (uint32_t i = 0; i < columnCount && result; i++)
+	{
+		result = fwrite(columns[i].name, 1, COLUMN_NAME_SIZE, file) == (size_t)COLUMN_NAME_SIZE &&
+			fwrite(&columns[i].elementSize, sizeof(uint32_t), 1, file) == 1 &&
+			fwrite(&columns[i].offset, sizeof(uint64_t), 1, file) == 1 &&
+			fwrite(&columns[i].length, sizeof(uint64_t), 1, file) == 1;
+	}
+
+	static const char padding[8] = { 0 };
+
+	for (uint32_t i = 0; i < columnCount && result; i++)
+	{
+		long position = ftell(file);
+
+		if (position < 0 || (uint64_t)position > columns[i].offset)
+			result = false;
+		else if ((uint64_t)position < columns[i].offset)
+			result = fwrite(padding, 1, columns[i].offset - position, file) == columns[i].offset - position;
+
+		if (result && columns[i].length > 0)
+			result = fwrite(columns[i].data, 1, columns[i].length, file) == columns[i].length;
+	}
+
+	if (fclose(file) != 0)
+		result = false;
+
+	return result;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeColumnsView::GCodeColumnsView()
+{
+	mapping = NULL;
+	mappingSize = 0;
+	Unmap();
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeColumnsView::~GCodeColumnsView()
+{
+	Unmap();
+}
+
+/// <summary>
+/// Releases the mapping and clears the columns.
+/// </summary>
+void GCodeColumnsView::Unmap()
+{
+	if (mapping != NULL)
+		munmap(mapping, mappingSize);
+
+	mapping = NULL;
+	mappingSize = 0;
+	rowCount = 0;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		value[i] = NULL;
+		present[i] = NULL;
+	}
+
+	gCommand = NULL;
+	mCommand = NULL;
+	lineNumber = NULL;
+	commentId = NULL;
+	commentPool = NULL;
+	commentPoolSize = 0;
+	commentStart = NULL;
+	commentCount = NULL;
+	distinctComments = 0;
+	summary = NULL;
+}
+
+/// <summary>
+/// Maps a file written by GCodeColumns::Dump.
+/// </summary>
+/// <param name="path">The columns file.</param>
+/// <returns>False if the file cannot be mapped or is not a complete columns file.</returns>
+bool GCodeColumnsView::Map(const char* path)
+{
+	Unmap();
+
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+	void* data = MAP_FAILED;
+
+	if (fstat(fd, &status) == 0 && status.st_size > 0)
+		data = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	// The mapping stays valid after the file is closed, or even deleted.
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	mapping = data;
+	mappingSize = status.st_size;
+
+	const char* file = (const char*)mapping;
+	const uint64_t headerSize = 8 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+	const uint64_t entrySize = COLUMN_NAME_SIZE + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+	uint32_t version;
+	uint64_t rows;
+	uint32_t columnCount;
+
+	if (mappingSize < headerSize || memcmp(file, "GCODECOL", 8) != 0)
+	{
+		Unmap();
+		return false;
+	}
+
+	memcpy(&version, file + 8, sizeof(uint32_t));
+	memcpy(&rows, file + 12, sizeof(uint64_t));
+	memcpy(&columnCount, file + 20, sizeof(uint32_t));
+
+	if (version != COLUMN_FILE_VERSION || headerSize + columnCount * entrySize > mappingSize)
+	{
+		Unmap();
+		return false;
+	}
+
+	rowCount = (long)rows;
+	long countedComments = 0;
+
+	for (uint32_t i = 0; i < columnCount; i++)
+	{
+		const char* entry = file + headerSize + i * entrySize;
+		char name[COLUMN_NAME_SIZE + 1];
+		uint64_t offset;
+		uint64_t length;
+
+		memcpy(name, entry, COLUMN_NAME_SIZE);
+		name[COLUMN_NAME_SIZE] = '\0';
+		memcpy(&offset, entry + COLUMN_NAME_SIZE + sizeof(uint32_t), sizeof(uint64_t));
+		memcpy(&length, entry + COLUMN_NAME_SIZE + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint64_t));
+
+		if (offset > mappingSize || length > mappingSize - offset || offset % 8 != 0)
+		{
+			Unmap();
+			return false;
+		}
+
+		const void* data = file + offset;
+		bool letter = name[0] >= 'A' && name[0] <= 'Z';
+
+		if (letter && name[1] == '\0' && length == rows * sizeof(double))
+			value[name[0] - 'A'] = (const double*)data;
+		else if (letter && strcmp(name + 1, ".present") == 0 && length == (rows + 7) / 8)
+			present[name[0] - 'A'] = (const unsigned char*)data;
+		else if (strcmp(name, "g") == 0 && length == rows * sizeof(unsigned int))
+			gCommand = (const unsigned int*)data;
+		else if (strcmp(name, "m") == 0 && length == rows * sizeof(unsigned int))
+			mCommand = (const unsigned int*)data;
+		else if (strcmp(name, "line") == 0 && length == rows * sizeof(long))
+			lineNumber = (const long*)data;
+		else if (strcmp(name, "comment") == 0 && length == rows * sizeof(int32_t))
+			commentId = (const int32_t*)data;
+		else if (strcmp(name, "comments") == 0)
+		{
+			commentPool = (const char*)data;
+			commentPoolSize = (long)length;
+		}
+		else if (strcmp(name, "commentStart") == 0 && length % sizeof(uint32_t) == 0)
+		{
+			commentStart = (const uint32_t*)data;
+			distinctComments = (long)(length / sizeof(uint32_t));
+		}
+		else if (strcmp(name, "commentCount") == 0 && length % sizeof(uint32_t) == 0)
+		{
+			commentCount = (const uint32_t*)data;
+			countedComments = (long)(length / sizeof(uint32_t));
+		}
+		else if (strcmp(name, "summary") == 0 && length == sizeof(GCodeProgramSummary))
+			summary = (const GCodeProgramSummary*)data;
+	}
+
+	// Letter columns come in pairs. Comment IDs must name a comment and every comment must
+	// start inside the pool, whose last comment is terminated, so Comment never reads past
+	// the mapping.
+	bool valid = gCommand != NULL && mCommand != NULL && lineNumber != NULL && commentId != NULL &&
+		summary != NULL && (commentPoolSize == 0 || commentPool[commentPoolSize - 1] == '\0') &&
+		countedComments == distinctComments;
+
+	for (int i = 0; i < WORD_LETTER_COUNT && valid; i++)
+		valid = (value[i] == NULL) == (present[i] == NULL);
+
+	for (long id = 0; id < distinctComments && valid; id++)
+		valid = commentStart[id] < (uint64_t)commentPoolSize;
+
+	for (long row = 0; row < rowCount && valid; row++)
+		valid = commentId[row] < distinctComments;
+
+	if (!valid)
+	{
+		Unmap();
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Determine if a letter is present in a row.
+/// </summary>
+bool GCodeColumnsView::IsPresent(char letter, long row) const
+{
+	if (letter < 'A' || letter > 'Z' || row < 0 || row >= rowCount || present[letter - 'A'] == NULL)
+		return false;
+
+	return (present[letter - 'A'][row / 8] >> (row % 8)) & 1;
+}
+
+/// <summary>
+/// Gets the comment(s) of a row.
+/// </summary>
+/// <returns>The interned comment or an empty string if the row has none.</returns>
+const char* GCodeColumnsView::Comment(long row) const
+{
+	if (row < 0 || row >= rowCount || commentId[row] < 0)
+		return "";
+
+	return commentPool + commentStart[commentId[row]];
+}
@@ -0,0 +1,140 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeColumns_h
+#define GCodeColumns_h
+
+#include "../../src/GCodeParser.h"
+#include "GCodeCommentPool.h"
+#include <stdio.h>
+#include <stdint.h>
+
+/// <summary>
+/// Summary statistics of a program, kept with its columns.
+/// </summary>
+struct GCodeProgramSummary
+{
+	uint64_t sourceBytes;
+	uint64_t sourceLines;
+	uint64_t blocks;
+	uint64_t words;
+	uint64_t commentedBlocks;
+	uint64_t letterCount[WORD_LETTER_COUNT]; // Blocks with each letter.
+};
+
+/// <summary>
+/// Parses a whole G-Code program straight into columnar arrays for analytics (host only).
+/// </summary>
+/// <remark>
+/// Each parsed block (a line with words or comments, blank lines are skipped) is a row.
+/// The columns are one contiguous array of values per letter, a presence bitmap per letter
+/// (bit row % 8 of byte row / 8), the G and M command keys (GCodeDialect::CommandKey of the
+/// first G and M word or GCODE_COMMAND_EMPTY), the source line number and the ID of the
+/// comment(s) in a GCodeCommentPool (-1 if the block has no comment). Letter columns are only allocated
+/// once the letter is seen. The summary is updated as blocks are added. Lines are parsed
+/// in an arena of COLUMNS_ARENA_SIZE bytes; a longer line fails the parse with its number
+/// in longLine rather than being dropped.
+/// 
+/// Dump writes the columns to a single file laid out for memory mapping:
+///   "GCODECOL" magic, version (uint32), row count (uint64), column count (uint32),
+///   then per column a 16 byte name, element size (uint32), byte offset (uint64) and byte
+///   length (uint64), followed by the column data, each column aligned to 8 bytes.
+/// The "comments" column holds the comment texts, "commentStart" the offset of each ID's
+/// text, "commentCount" its occurrences and "summary" the GCodeProgramSummary.
+/// All values are little endian in host byte order.
+/// </remark>
+class GCodeColumns
+{
+private:
+	long capacity;
+
+	bool Reserve(long rows);
+	bool ReserveLetter(int letter);
+	bool AddBlock(GCodeParser* parser, long lineNumber);
+
+public:
+	long rowCount;
+	long longLine; // Source line too long to parse which failed the last parse, 0 if none.
+	double* value[WORD_LETTER_COUNT];
+	unsigned char* present[WORD_LETTER_COUNT];
+	unsigned int* gCommand;
+	unsigned int* mCommand;
+	long* lineNumber;
+	int32_t* commentId;
+	GCodeCommentPool commentPool;
+	GCodeProgramSummary summary;
+
+	GCodeColumns();
+	~GCodeColumns();
+	void Clear();
+
+	bool ParseFile(const char* path);
+	bool ParseStream(FILE* file);
+	bool ParseBuffer(const char* data, long length);
+
+	bool IsPresent(char letter, long row) const;
+	const char* Comment(long row) const;
+
+	bool Dump(const char* path) const;
+};
+
+/// <summary>
+/// Read only columns of a file written by GCodeColumns::Dump, memory mapped (host only).
+/// </summary>
+/// <remark>
+/// The members point straight into the mapping, nothing is copied or parsed. Map checks the
+/// magic, the version and that every column lies within the file.
+/// </remark>
+class GCodeColumnsView
+{
+private:
+	void* mapping;
+	size_t mappingSize;
+
+public:
+	long rowCount;
+	const double* value[WORD_LETTER_COUNT];
+	const unsigned char* present[WORD_LETTER_COUNT];
+	const unsigned int* gCommand;
+	const unsigned int* mCommand;
+	const long* lineNumber;
+	const int32_t* commentId;
+	const char* commentPool;
+	long commentPoolSize;
+	const uint32_t* commentStart;
+	const uint32_t* commentCount;
+	long distinctComments;
+	const GCodeProgramSummary* summary;
+
+	GCodeColumnsView();
+	~GCodeColumnsView();
+
+	bool Map(const char* path);
+	void Unmap();
+
+	bool IsPresent(char letter, long row) const;
+	const char* Comment(long row) const;
+};
+
+#endif
@@ -0,0 +1,309 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeCommentPool.h"
+#include <stdlib.h>
+#include <string.h>
+
+const uint32_t COMMENT_INITIAL_CAPACITY = 256;
+const size_t COMMENT_INITIAL_TEXT = 16384;
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeCommentPool::GCodeCommentPool()
+{
+	text = NULL;
+	starts = NULL;
+	counts = NULL;
+	hash = NULL;
+	Clear();
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeCommentPool::~GCodeCommentPool()
+{
+	Clear();
+}
+
+/// <summary>
+/// Frees all comments.
+/// </summary>
+void GCodeCommentPool::Clear()
+{
+	free(text);
+	free(starts);
+	free(counts);
+	free(hash);
+
+	text = NULL;
+	textSize = 0;
+	textCapacity = 0;
+	starts = NULL;
+	counts = NULL;
+	size = 0;
+	capacity = 0;
+	hash = NULL;
+	hashMask = 0;
+}
+
+/// <summary>
+/// FNV-1a hash of a span.
+/// </summary>
+static uint32_t HashSpan(const char* comment, size_t length)
+{
+	uint32_t value = 2166136261u;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		value ^= (unsigned char)comment[i];
+		value *= 16777619u;
+	}
+
+	return value;
+}
+
+/// <summary>
+/// Makes room for one more comment of a length.
+/// </summary>
+bool GCodeCommentPool::Grow(size_t length)
+{
+	if (textSize + length + 1 > textCapacity)
+	{
+		size_t newCapacity = textCapacity == 0 ? COMMENT_INITIAL_TEXT : textCapacity;
+
+		while (textSize + length + 1 > newCapacity)
+			newCapacity *= 2;
+
+		if (newCapacity > 0xFFFFFFFFUL)
+			return false;
+
+		char* grown = (char*)realloc(text, newCapacity);
+
+		if (grown == NULL)
+			return false;
+
+		text = grown;
+		textCapacity = newCapacity;
+	}
+
+	if (size == capacity)
+	{
+		uint32_t newCapacity = capacity == 0 ? COMMENT_INITIAL_CAPACITY : capacity * 2;
+		uint32_t* grownStarts = (uint32_t*)realloc(starts, newCapacity * sizeof(uint32_t));
+
+		if (grownStarts == NULL)
+			return false;
+
+		starts = grownStarts;
+
+		uint32_t* grownCounts = (uint32_t*)realloc(counts, newCapacity * sizeof(uint32_t));
+
+		if (grownCounts == NULL)
+			return false;
+
+		counts = grownCounts;
+		capacity = newCapacity;
+	}
+
+	// Keep the hash table at most half full.
+	if ((size + 1) * 2 > hashMask + 1 || hash == NULL)
+	{
+		uint32_t newSize = hash == NULL ? COMMENT_INITIAL_CAPACITY * 2 : (hashMask + 1) * 2;
+		uint32_t* newHash = (uint32_t*)calloc(newSize, sizeof(uint32_t));
+
+		if (newHash == NULL)
+			return false;
+
+		for (uint32_t id = 0; id < size; id++)
+		{
+			uint32_t slot = HashSpan(text + starts[id], Length(id)) & (newSize - 1);
+
+			while (newHash[slot] != 0)
+				slot = (slot + 1) & (newSize - 1);
+
+			newHash[slot] = id + 1;
+		}
+
+		free(hash);
+		hash = newHash;
+		hashMask = newSize - 1;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Gets the ID of a comment, adding it when it is new, and counts an occurrence.
+/// </summary>
+/// <param name="comment">The comment text, which need not be null terminated.</param>
+/// <param name="length">The length of the comment.</param>
+/// <returns>The ID or -1 if out of memory.</returns>
+long GCodeCommentPool::Intern(const char* comment, size_t length)
+{
+	if (!Grow(length))
+		return -1;
+
+	uint32_t slot = HashSpan(comment, length) & hashMask;
+
+	while (hash[slot] != 0)
+	{
+		uint32_t id = hash[slot] - 1;
+
+		if (Length(id) == length && memcmp(text + starts[id], comment, length) == 0)
+		{
+			counts[id]++;
+			return id;
+		}
+
+		slot = (slot + 1) & hashMask;
+	}
+
+	memcpy(text + textSize, comment, length);
+	text[textSize + length] = '\0';
+	starts[size] = textSize;
+	counts[size] = 1;
+	textSize += length + 1;
+	hash[slot] = size + 1;
+
+	return size++;
+}
+
+/// <summary>
+/// Gets the ID of a null terminated comment, adding it when it is new, and counts an occurrence.
+/// </summary>
+long GCodeCommentPool::Intern(const char* comment)
+{
+	return Intern(comment, strlen(comment));
+}
+
+/// <summary>
+/// Gets the ID of a comment without adding or counting it.
+/// </summary>
+/// <returns>The ID or -1 if the comment is not in the pool.</returns>
+long GCodeCommentPool::Find(const char* comment, size_t length) const
+{
+	if (hash == NULL)
+		return -1;
+
+	uint32_t slot = HashSpan(comment, length) & hashMask;
+
+	while (hash[slot] != 0)
+	{
+		uint32_t id = hash[slot] - 1;
+
+		if (Length(id) == length && memcmp(text + starts[id], comment, length) == 0)
+			return id;
+
+		slot = (slot + 1) & hashMask;
+	}
+
+	return -1;
+}
+
+/// <summary>
+/// Gets the text of a comment.
+/// </summary>
+/// <returns>The null terminated text or an empty string for an unknown ID.</returns>
+const char* GCodeCommentPool::Text(long id) const
+{
+	if (id < 0 || id >= (long)size)
+		return "";
+
+	return text + starts[id];
+}
+
+/// <summary>
+/// Gets the length of a comment.
+/// </summary>
+size_t GCodeCommentPool::Length(long id) const
+{
+	if (id < 0 || id >= (long)size)
+		return 0;
+
+	size_t end = id + 1 < (long)size ? starts[id + 1] : textSize;
+
+	return end - starts[id] - 1;
+}
+
+/// <summary>
+/// Gets the number of times a comment was interned.
+/// </summary>
+unsigned long GCodeCommentPool::Count(long id) const
+{
+	if (id < 0 || id >= (long)size)
+		return 0;
+
+	return counts[id];
+}
+
+/// <summary>
+/// Gets the number of distinct comments.
+/// </summary>
+long GCodeCommentPool::Size() const
+{
+	return size;
+}
+
+/// <summary>
+/// Gets the text of all comments, each null terminated, in ID order.
+/// </summary>
+const char* GCodeCommentPool::Pool() const
+{
+	return text;
+}
+
+/// <summary>
+/// Gets the bytes of text in the pool.
+/// </summary>
+size_t GCodeCommentPool::PoolSize() const
+{
+	return textSize;
+}
+
+/// <summary>
+/// Gets the offset in the pool of each comment, indexed by ID.
+/// </summary>
+const uint32_t* GCodeCommentPool::Starts() const
+{
+	return starts;
+}
+
+/// <summary>
+/// Gets the occurrence count of each comment, indexed by ID.
+/// </summary>
+const uint32_t* GCodeCommentPool::Counts() const
+{
+	return counts;
+}
+
+/// <summary>
+/// Gets the bytes allocated by the pool.
+/// </summary>
+size_t GCodeCommentPool::MemoryUsed() const
+{
+	return textCapacity + 2 * capacity * sizeof(uint32_t) + (hash != NULL ? (hashMask + 1) * sizeof(uint32_t) : 0);
+}
@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeCommentPool_h
+#define GCodeCommentPool_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// <summary>
+/// Interned comments with small integer IDs and occurrence counts (host only).
+/// </summary>
+/// <remark>
+/// Slicers repeat a few comments (";TYPE:WALL-OUTER", ";WIPE_START") millions of times, so
+/// retained models keep an ID per block instead of a copy. Intern looks the comment span up
+/// in an open addressing hash table (FNV-1a, linear probing, at most half full) and returns
+/// the ID of the existing text, or copies the text into the pool and gives it the next ID.
+/// IDs count up from 0 in order of first appearance. Every Intern counts an occurrence.
+/// </remark>
+class GCodeCommentPool
+{
+private:
+	char* text;
+	size_t textSize;
+	size_t textCapacity;
+	uint32_t* starts;
+	uint32_t* counts;
+	uint32_t size;
+	uint32_t capacity;
+	uint32_t* hash;
+	uint32_t hashMask;
+
+	bool Grow(size_t length);
+
+public:
+	GCodeCommentPool();
+	~GCodeCommentPool();
+
+	GCodeCommentPool(const GCodeCommentPool&) = delete;
+	GCodeCommentPool& operator=(const GCodeCommentPool&) = delete;
+
+	void Clear();
+
+	long Intern(const char* comment, size_t length);
+	long Intern(const char* comment);
+	long Find(const char* comment, size_t length) const;
+
+	const char* Text(long id) const;
+	size_t Length(long id) const;
+	unsigned long Count(long id) const;
+	long Size() const;
+
+	const char* Pool() const;
+	size_t PoolSize() const;
+	const uint32_t* Starts() const;
+	const uint32_t* Counts() const;
+	size_t MemoryUsed() const;
+};
+
+#endif
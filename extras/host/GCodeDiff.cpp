@@ -0,0 +1,617 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeDiff.h"
+#include "../../src/GCodeArena.h"
+#include <stdlib.h>
+#include <string.h>
+
+const int DIFF_WINDOW = 4; // Blocks per rolling hash window.
+const uint64_t WINDOW_BASE = 0x100000001B3ULL;
+const int READ_BUFFER_SIZE = 65536;
+const size_t HASHES_ARENA_SIZE = 1 << 20;
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeProgramHashes::GCodeProgramHashes()
+{
+	capacity = 0;
+	count = 0;
+	longLine = 0;
+	hash = NULL;
+	lineNumber = NULL;
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeProgramHashes::~GCodeProgramHashes()
+{
+	Clear();
+}
+
+/// <summary>
+/// Frees the hashes.
+/// </summary>
+void GCodeProgramHashes::Clear()
+{
+	free(hash);
+	free(lineNumber);
+	hash = NULL;
+	lineNumber = NULL;
+	capacity = 0;
+	count = 0;
+}
+
+/// <summary>
+/// Hashes the code part of a parsed line (64 bit FNV-1a).
+/// </summary>
+uint64_t GCodeProgramHashes::HashCode(const char* code)
+{
+	uint64_t result = 0xCBF29CE484222325ULL;
+
+	while (*code != '\0')
+	{
+		result ^= (unsigned char)*code++;
+		result *= 0x100000001B3ULL;
+	}
+
+	return result;
+}
+
+/// <summary>
+/// Adds a block.
+/// </summary>
+/// <param name="code">The code part of the parsed line. Empty code is skipped.</param>
+/// <param name="sourceLine">The line number in the source file.</param>
+/// <returns>False if memory runs out.</returns>
+bool GCodeProgramHashes::Add(const char* code, long sourceLine)
+{
+	if (code[0] == '\0')
+		return true;
+
+	if (count == capacity)
+	{
+		long newCapacity = capacity == 0 ? 4096 : capacity * 2;
+		uint64_t* newHash = (uint64_t*)realloc(hash, newCapacity * sizeof(uint64_t));
+
+		if (newHash == NULL)
+			return false;
+
+		hash = newHash;
+
+		long* newLineNumber = (long*)realloc(lineNumber, newCapacity * sizeof(long));
+
+		if (newLineNumber == NULL)
+			return false;
+
+		lineNumber = newLineNumber;
+		capacity = newCapacity;
+	}
+
+	hash[count] = HashCode(code);
+	lineNumber[count] = sourceLine;
+	count++;
+
+	return true;
+}
+
+/// <summary>
+/// Hashes every block of a program file.
+/// </summary>
+/// <returns>False if the file cannot be read, memory runs out or a line is too long (see longLine).</returns>
+bool GCodeProgramHashes::ParseFile(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = ParseStream(file);
+	fclose(file);
+
+	return result;
+}
+
+/// <summary>
+/// Hashes every block of a program read from a stream. Only one line is held in memory at a time.
+/// </summary>
+/// <returns>False if the stream cannot be read, memory runs out or a line is too long (see longLine).</returns>
+bool GCodeProgramHashes::ParseStream(FILE* file)
+{
+	longLine = 0;
+
+	void* memory = malloc(HASHES_ARENA_SIZE);
+
+	if (memory == NULL)
+		return false;
+
+	char buffer[READ_BUFFER_SIZE];
+	GCodeArena arena(memory, HASHES_ARENA_SIZE);
+	GCodeParser parser;
+	parser.lineArena = &arena;
+	long sourceLine = 1;
+	bool result = true;
+	size_t length;
+
+	while (result && (length = fread(buffer, 1, READ_BUFFER_SIZE, file)) > 0)
+	{
+		for (size_t i = 0; i < length && result; i++)
+		{
+			if (parser.AddCharToLine(buffer[i]))
+			{
+				parser.ParseLine();
+				result = AddLine(&parser, sourceLine);
+				sourceLine++;
+			}
+		}
+	}
+
+	if (ferror(file))
+		result = false;
+
+	if (result && !parser.completeLineIsAvailableToParse && (parser.line[0] != '\0' || parser.lineStatus == GCODE_LINE_OVERFLOW))
+	{
+		parser.AddCharToLine('\n');
+		parser.ParseLine();
+		result = AddLine(&parser, sourceLine);
+	}
+
+	free(memory);
+
+	return result;
+}
+
+/// <summary>
+/// Adds the parsed line as a block.
+/// </summary>
+bool GCodeProgramHashes::AddLine(GCodeParser* parser, long sourceLine)
+{
+	// An overflowed line parses as empty code, which must not be taken for a blank line.
+	if (parser->lineStatus == GCODE_LINE_OVERFLOW)
+	{
+		longLine = sourceLine;
+		return false;
+	}
+
+	return Add(parser->line, sourceLine);
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeDiff::GCodeDiff()
+{
+	regions = NULL;
+	regionCapacity = 0;
+	Clear();
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeDiff::~GCodeDiff()
+{
+	free(regions);
+}
+
+/// <summary>
+/// Clears the results of the last comparison.
+/// </summary>
+void GCodeDiff::Clear()
+{
+	regionCount = 0;
+	unchangedBlocks = 0;
+	movedBlocks = 0;
+	insertedBlocks = 0;
+	deletedBlocks = 0;
+}
+
+/// <summary>
+/// Appends a region, merging it with the previous region when they are contiguous.
+/// </summary>
+bool GCodeDiff::AddRegion(GCodeDiffType type, long oldBlock, long newBlock, long count)
+{
+	switch (type)
+	{
+	case GCODE_DIFF_UNCHANGED: unchangedBlocks += count; break;
+	case GCODE_DIFF_MOVED: movedBlocks += count; break;
+	case GCODE_DIFF_INSERTED: insertedBlocks += count; break;
+	case GCODE_DIFF_DELETED: deletedBlocks += count; break;
+	}
+
+	if (regionCount > 0)
+	{
+		GCodeDiffRegion* last = &regions[regionCount - 1];
+
+		if (last->type == type &&
+			(oldBlock < 0 || last->oldBlock + last->count == oldBlock) &&
+			(newBlock < 0 || last->newBlock + last->count == newBlock))
+		{
+			last->count += count;
+			return true;
+		}
+	}
+
+	if (regionCount == regionCapacity)
+	{
+		long newCapacity = regionCapacity == 0 ? 256 : regionCapacity * 2;
+		GCodeDiffRegion* grown = (GCodeDiffRegion*)realloc(regions, newCapacity * sizeof(GCodeDiffRegion));
+
+		if (grown == NULL)
+			return false;
+
+		regions = grown;
+		regionCapacity = newCapacity;
+	}
+
+	GCodeDiffRegion* region = &regions[regionCount++];
+	region->type = type;
+	region->oldBlock = oldBlock;
+	region->newBlock = newBlock;
+	region->count = count;
+
+	return true;
+}
+
+/// <summary>
+/// Hash of DIFF_WINDOW consecutive block hashes.
+/// </summary>
+static uint64_t WindowHash(const uint64_t* hash)
+{
+	uint64_t result = 0;
+
+	for (int i = 0; i < DIFF_WINDOW; i++)
+		result = result * WINDOW_BASE + hash[i];
+
+	return result;
+}
+
+/// <summary>
+/// A matched run of blocks.
+/// </summary>
+struct MatchedRun
+{
+	long oldBlock;
+	long newBlock;
+	long count;
+	long weight;      // Heaviest increasing chain ending with this run.
+	long previous;    // Previous run in that chain or -1.
+	bool inOrder;
+};
+
+/// <summary>
+/// Compares the programs. The results replace those of any previous comparison.
+/// </summary>
+/// <param name="oldProgram">The original program.</param>
+/// <param name="newProgram">The changed program.</param>
+/// <returns>False if memory runs out.</returns>
+bool GCodeDiff::Compare(const GCodeProgramHashes* oldProgram, const GCodeProgramHashes* newProgram)
+{
+	Clear();
+
+	long oldCount = oldProgram->count;
+	long newCount = newProgram->count;
+	const uint64_t* oldHash = oldProgram->hash;
+	const uint64_t* newHash = newProgram->hash;
+
+	long* matchOld = (long*)malloc((newCount + 1) * sizeof(long));
+	unsigned char* oldMatched = (unsigned char*)calloc(oldCount + 1, 1);
+
+	if (matchOld == NULL || oldMatched == NULL)
+	{
+		free(matchOld);
+		free(oldMatched);
+		return false;
+	}
+
+	for (long i = 0; i < newCount; i++)
+		matchOld[i] = -1;
+
+	// Common prefix and suffix.
+	long prefix = 0;
+
+	while (prefix < oldCount && prefix < newCount && oldHash[prefix] == newHash[prefix])
+	{
+		matchOld[prefix] = prefix;
+		prefix++;
+	}
+
+	long suffix = 0;
+
+	while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+		oldHash[oldCount - 1 - suffix] == newHash[newCount - 1 - suffix])
+	{
+		matchOld[newCount - 1 - suffix] = oldCount - 1 - suffix;
+		suffix++;
+	}
+
+	long oldEnd = oldCount - suffix;
+	long newEnd = newCount - suffix;
+	bool result = true;
+
+	// Index the windows of the old middle in an open addressing table (first occurrence wins).
+	long windows = oldEnd - prefix - DIFF_WINDOW + 1;
+	long tableSize = 0;
+	long* table = NULL;
+
+	if (windows > 0 && newEnd - prefix >= DIFF_WINDOW)
+	{
+		tableSize = 1;
+
+		while (tableSize < windows * 2)
+			tableSize *= 2;
+
+		table = (long*)malloc(tableSize * sizeof(long));
+
+		if (table == NULL)
+			result = false;
+		else
+		{
+			for (long i = 0; i < tableSize; i++)
+				table[i] = -1;
+
+			for (long j = prefix; j < prefix + windows; j++)
+			{
+				uint64_t windowHash = WindowHash(&oldHash[j]);
+				long slot = (long)((windowHash * 0x9E3779B97F4A7C15ULL) >> 20) & (tableSize - 1);
+				bool duplicate = false;
+
+				while (table[slot] >= 0)
+				{
+					if (WindowHash(&oldHash[table[slot]]) == windowHash)
+					{
+						duplicate = true;
+						break;
+					}
+
+					slot = (slot + 1) & (tableSize - 1);
+				}
+
+				if (!duplicate)
+					table[slot] = j;
+			}
+		}
+	}
+
+	// Walk the new middle once, extending every window found in the old program.
+	long i = prefix;
+
+	while (table != NULL && i + DIFF_WINDOW <= newEnd)
+	{
+		uint64_t windowHash = WindowHash(&newHash[i]);
+		long slot = (long)((windowHash * 0x9E3779B97F4A7C15ULL) >> 20) & (tableSize - 1);
+		long j = -1;
+
+		while (table[slot] >= 0)
+		{
+			if (memcmp(&oldHash[table[slot]], &newHash[i], DIFF_WINDOW * sizeof(uint64_t)) == 0)
+			{
+				j = table[slot];
+				break;
+			}
+
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (j < 0)
+		{
+			i++;
+			continue;
+		}
+
+		long back = 0;
+
+		while (i - back - 1 >= prefix && j - back - 1 >= prefix && matchOld[i - back - 1] < 0 &&
+			oldHash[j - back - 1] == newHash[i - back - 1])
+			back++;
+
+		long length = DIFF_WINDOW;
+
+		while (i + length < newEnd && j + length < oldEnd && oldHash[j + length] == newHash[i + length])
+			length++;
+
+		for (long k = -back; k < length; k++)
+			matchOld[i + k] = j + k;
+
+		i += length;
+	}
+
+	free(table);
+
+	// Group the matched blocks into runs.
+	MatchedRun* runs = NULL;
+	long runCount = 0;
+	long runCapacity = 0;
+
+	for (i = 0; i < newCount && result; )
+	{
+		if (matchOld[i] < 0)
+		{
+			i++;
+			continue;
+		}
+
+		long length = 1;
+
+		while (i + length < newCount && matchOld[i + length] == matchOld[i] + length)
+			length++;
+
+		if (runCount == runCapacity)
+		{
+			runCapacity = runCapacity == 0 ? 256 : runCapacity * 2;
+			MatchedRun* grown = (MatchedRun*)realloc(runs, runCapacity * sizeof(MatchedRun));
+
+			if (grown == NULL)
+			{
+				result = false;
+				break;
+			}
+
+			runs = grown;
+		}
+
+		MatchedRun* run = &runs[runCount++];
+		run->oldBlock = matchOld[i];
+		run->newBlock = i;
+		run->count = length;
+		run->inOrder = false;
+
+		i += length;
+	}
+
+	// Heaviest increasing chain of old positions using a Fenwick tree of prefix maximums.
+	// Runs are entered at their end and looked up at their start, so only a run ending
+	// before another starts can come before it (runs may overlap in the old program).
+	long* treeWeight = result ? (long*)calloc(oldCount + 1, sizeof(long)) : NULL;
+	long* treeRun = result ? (long*)malloc((oldCount + 1) * sizeof(long)) : NULL;
+
+	if (result && (treeWeight == NULL || treeRun == NULL))
+		result = false;
+
+	if (result)
+	{
+		for (long k = 0; k <= oldCount; k++)
+			treeRun[k] = -1;
+
+		long bestRun = -1;
+		long bestWeight = 0;
+
+		for (long r = 0; r < runCount; r++)
+		{
+			long weight = 0;
+			long previous = -1;
+
+			for (long k = runs[r].oldBlock; k > 0; k -= k & -k)
+			{
+				if (treeWeight[k] > weight)
+				{
+					weight = treeWeight[k];
+					previous = treeRun[k];
+				}
+			}
+
+			runs[r].weight = weight + runs[r].count;
+			runs[r].previous = previous;
+
+			for (long k = runs[r].oldBlock + runs[r].count; k <= oldCount; k += k & -k)
+			{
+				if (runs[r].weight > treeWeight[k])
+				{
+					treeWeight[k] = runs[r].weight;
+					treeRun[k] = r;
+				}
+			}
+
+			if (runs[r].weight > bestWeight)
+			{
+				bestWeight = runs[r].weight;
+				bestRun = r;
+			}
+		}
+
+		for (long r = bestRun; r >= 0; r = runs[r].previous)
+			runs[r].inOrder = true;
+	}
+
+	free(treeWeight);
+	free(treeRun);
+
+	// Regions in new program order.
+	long r = 0;
+
+	for (i = 0; i < newCount && result; )
+	{
+		if (r < runCount && runs[r].newBlock == i)
+		{
+			result = AddRegion(runs[r].inOrder ? GCODE_DIFF_UNCHANGED : GCODE_DIFF_MOVED,
+				runs[r].oldBlock, runs[r].newBlock, runs[r].count);
+
+			for (long k = 0; k < runs[r].count; k++)
+				oldMatched[runs[r].oldBlock + k] = 1;
+
+			i += runs[r].count;
+			r++;
+		}
+		else
+		{
+			long next = r < runCount ? runs[r].newBlock : newCount;
+			result = AddRegion(GCODE_DIFF_INSERTED, -1, i, next - i);
+			i = next;
+		}
+	}
+
+	// Deleted regions in old program order.
+	for (long j = 0; j < oldCount && result; j++)
+	{
+		if (!oldMatched[j])
+			result = AddRegion(GCODE_DIFF_DELETED, j, -1, 1);
+	}
+
+	free(runs);
+	free(matchOld);
+	free(oldMatched);
+
+	return result;
+}
+
+/// <summary>
+/// Prints the regions with source line numbers.
+/// </summary>
+/// <param name="file">The output stream.</param>
+/// <param name="oldProgram">The original program.</param>
+/// <param name="newProgram">The changed program.</param>
+/// <param name="includeUnchanged">True to also list the unchanged regions.</param>
+/// <remarks>
+/// Each region is printed on a line starting with = (unchanged), ~ (moved), + (inserted)
+/// or - (deleted) followed by the old and new source line ranges.
+/// </remarks>
+void GCodeDiff::Print(FILE* file, const GCodeProgramHashes* oldProgram, const GCodeProgramHashes* newProgram, bool includeUnchanged) const
+{
+	static const char symbol[] = { '=', '~', '+', '-' };
+
+	for (long r = 0; r < regionCount; r++)
+	{
+		const GCodeDiffRegion* region = &regions[r];
+
+		if (region->type == GCODE_DIFF_UNCHANGED && !includeUnchanged)
+			continue;
+
+		fputc(symbol[region->type], file);
+
+		if (region->oldBlock >= 0)
+			fprintf(file, " old %ld-%ld", oldProgram->lineNumber[region->oldBlock],
+				oldProgram->lineNumber[region->oldBlock + region->count - 1]);
+
+		if (region->newBlock >= 0)
+			fprintf(file, " new %ld-%ld", newProgram->lineNumber[region->newBlock],
+				newProgram->lineNumber[region->newBlock + region->count - 1]);
+
+		fprintf(file, " (%ld blocks)\n", region->count);
+	}
+
+	fprintf(file, "%ld unchanged, %ld moved, %ld inserted, %ld deleted blocks\n",
+		unchangedBlocks, movedBlocks, insertedBlocks, deletedBlocks);
+}
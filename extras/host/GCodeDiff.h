@@ -0,0 +1,121 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeDiff_h
+#define GCodeDiff_h
+
+#include "../../src/GCodeParser.h"
+#include <stdio.h>
+#include <stdint.h>
+
+/// <summary>
+/// The normalized code hashes of a program, one per block (host only).
+/// </summary>
+/// <remark>
+/// Only the code part of each line (GCodeParser::line after ParseLine, with spaces and
+/// comments removed) is hashed. Blank and comment only lines are skipped so whitespace and
+/// comment changes do not show up as differences. The text itself is not kept, so memory
+/// is 12 bytes per block no matter how long the lines are. A line too long to parse fails
+/// ParseStream with its number in longLine rather than being hashed as blank.
+/// </remark>
+class GCodeProgramHashes
+{
+private:
+	long capacity;
+
+	bool AddLine(GCodeParser* parser, long sourceLine);
+
+public:
+	long count;
+	long longLine; // Source line too long to parse which failed the last parse, 0 if none.
+	uint64_t* hash;
+	long* lineNumber;
+
+	GCodeProgramHashes();
+	~GCodeProgramHashes();
+	void Clear();
+
+	bool Add(const char* code, long sourceLine);
+	bool ParseFile(const char* path);
+	bool ParseStream(FILE* file);
+
+	static uint64_t HashCode(const char* code);
+};
+
+enum GCodeDiffType
+{
+	GCODE_DIFF_UNCHANGED = 0, // Same blocks in the same order.
+	GCODE_DIFF_MOVED,         // Same blocks found elsewhere in the old program.
+	GCODE_DIFF_INSERTED,      // Blocks only in the new program.
+	GCODE_DIFF_DELETED        // Blocks only in the old program.
+};
+
+/// <summary>
+/// A run of blocks with the same difference type.
+/// </summary>
+struct GCodeDiffRegion
+{
+	GCodeDiffType type;
+	long oldBlock; // First block in the old program, -1 for inserted regions.
+	long newBlock; // First block in the new program, -1 for deleted regions.
+	long count;
+};
+
+/// <summary>
+/// Compares two programs at block granularity (host only).
+/// </summary>
+/// <remark>
+/// Common leading and trailing blocks are matched first. The remaining old blocks are
+/// indexed by a rolling hash of DIFF_WINDOW consecutive block hashes, then the new blocks
+/// are walked once and every window found in the old program is extended forward and back
+/// as far as the blocks match. Matched runs that keep their relative order (the heaviest
+/// increasing run of old positions) are unchanged, the others are moved. The whole
+/// comparison is near linear in the number of blocks.
+/// 
+/// Regions are listed in new program order followed by the deleted regions in old program order.
+/// </remark>
+class GCodeDiff
+{
+private:
+	long regionCapacity;
+
+	bool AddRegion(GCodeDiffType type, long oldBlock, long newBlock, long count);
+
+public:
+	GCodeDiffRegion* regions;
+	long regionCount;
+	long unchangedBlocks;
+	long movedBlocks;
+	long insertedBlocks;
+	long deletedBlocks;
+
+	GCodeDiff();
+	~GCodeDiff();
+	void Clear();
+
+	bool Compare(const GCodeProgramHashes* oldProgram, const GCodeProgramHashes* newProgram);
+	void Print(FILE* file, const GCodeProgramHashes* oldProgram, const GCodeProgramHashes* newProgram, bool includeUnchanged) const;
+};
+
+#endif
@@ -0,0 +1,495 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeLayerIndex.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+const size_t LAYER_READ_SIZE = 1 << 20;
+const long INDEX_INITIAL_CAPACITY = 64;
+
+/// <summary>
+/// Determine if a comment marks a new layer.
+/// </summary>
+/// <param name="comment">The semicolon comment.</param>
+/// <param name="number">Receives the layer number, -1 when the comment has none.</param>
+static bool LayerComment(const char* comment, long* number)
+{
+	*number = -1;
+
+	// Cura.
+	if (strncmp(comment, ";LAYER:", 7) == 0)
+	{
+		if (GCodeParser::ParseInteger(comment + 7, number) == 0)
+			*number = -1;
+
+		return true;
+	}
+
+	// PrusaSlicer, OrcaSlicer and Bambu Studio.
+	if (strncmp(comment, ";LAYER_CHANGE", 13) == 0)
+		return true;
+
+	// Simplify3D.
+	if (strncmp(comment, "; layer ", 8) == 0 && comment[8] >= '0' && comment[8] <= '9')
+		return GCodeParser::ParseInteger(comment + 8, number) > 0;
+
+	return false;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeLayerIndex::GCodeLayerIndex()
+{
+	layers = NULL;
+	toolSegments = NULL;
+	Clear();
+
+	// Slicer thumbnails are thousands of comment lines which cannot hold layer comments.
+	parser.skipThumbnails = true;
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeLayerIndex::~GCodeLayerIndex()
+{
+	Clear();
+}
+
+/// <summary>
+/// Frees the index and starts a new one.
+/// </summary>
+void GCodeLayerIndex::Clear()
+{
+	free(layers);
+	free(toolSegments);
+
+	parser.Initialize();
+	motion.Reset();
+	layers = NULL;
+	layerCount = 0;
+	layerCapacity = 0;
+	toolSegments = NULL;
+	toolSegmentCount = 0;
+	toolSegmentCapacity = 0;
+	sourceBytes = 0;
+	sourceLines = 0;
+	position = 0;
+	lineOffset = 0;
+	lineNumber = 1;
+	layerComments = false;
+	extrusionSeen = false;
+	zChangePending = false;
+	zChangeOffset = 0;
+	zChangeLine = 0;
+	layerZKnown = false;
+	GCodeMotion::EmptyBounds(&pendingMoves);
+}
+
+/// <summary>
+/// Closes the last entry of a kind and starts a new one.
+/// </summary>
+/// <returns>The new entry or NULL if out of memory.</returns>
+GCodeIndexEntry* GCodeLayerIndex::StartEntry(GCodeIndexEntry** entries, long* count, long* capacity, uint64_t offset,
+	long line, long number, const GCodeModalState* checkpoint)
+{
+	if (*count == *capacity)
+	{
+		long newCapacity = *capacity == 0 ? INDEX_INITIAL_CAPACITY : *capacity * 2;
+		GCodeIndexEntry* grown = (GCodeIndexEntry*)realloc(*entries, newCapacity * sizeof(GCodeIndexEntry));
+
+		if (grown == NULL)
+			return NULL;
+
+		*entries = grown;
+		*capacity = newCapacity;
+	}
+
+	if (*count > 0)
+	{
+		GCodeIndexEntry* previous = &(*entries)[*count - 1];
+		previous->length = offset - previous->offset;
+		previous->lines = line - previous->line;
+	}
+
+	GCodeIndexEntry* entry = &(*entries)[(*count)++];
+	entry->offset = offset;
+	entry->length = 0;
+	entry->line = line;
+	entry->lines = 0;
+	entry->number = number;
+	entry->z = checkpoint->position[2];
+	entry->state = *checkpoint;
+	GCodeMotion::EmptyBounds(&entry->bounds);
+
+	return entry;
+}
+
+/// <summary>
+/// Adds a parsed line to the index.
+/// </summary>
+/// <param name="parser">The parser after ParseLine.</param>
+/// <param name="offset">Byte offset of the line in the program.</param>
+/// <param name="line">Source line number.</param>
+/// <returns>False if out of memory.</returns>
+bool GCodeLayerIndex::AddBlock(GCodeParser* parser, uint64_t offset, long line)
+{
+	GCodeModalState before = motion.state;
+	GCodeMove move;
+	bool moved = motion.Apply(parser, &move);
+
+	if (motion.state.tool != before.tool &&
+		StartEntry(&toolSegments, &toolSegmentCount, &toolSegmentCapacity, offset, line, motion.state.tool, &before) == NULL)
+		return false;
+
+	const char* semicolon = parser->comments[0] != '\0' ? strchr(parser->comments, ';') : NULL;
+	long number;
+
+	if (semicolon != NULL && LayerComment(semicolon, &number))
+	{
+		if (!layerComments)
+		{
+			// Layers found from Z so far were the start G-Code.
+			layerComments = true;
+			layerCount = 0;
+			zChangePending = false;
+		}
+
+		if (StartEntry(&layers, &layerCount, &layerCapacity, offset, line, number >= 0 ? number : layerCount,
+			&before) == NULL)
+			return false;
+
+		layerZKnown = false;
+	}
+
+	if (!moved)
+		return true;
+
+	GCodeBounds bounds;
+	GCodeMotion::MoveBounds(&move, &bounds);
+
+	if (toolSegmentCount > 0)
+		GCodeMotion::MergeBounds(&toolSegments[toolSegmentCount - 1].bounds, &bounds);
+
+	bool extruding = move.to[3] > move.from[3];
+
+	if (extruding)
+		extrusionSeen = true;
+
+	bool working = move.motion != 0 && (move.words & (GCODE_LETTER('X') | GCODE_LETTER('Y'))) &&
+		(extruding || !extrusionSeen);
+
+	if (layerComments)
+	{
+		if (layerCount > 0)
+		{
+			GCodeIndexEntry* layer = &layers[layerCount - 1];
+			GCodeMotion::MergeBounds(&layer->bounds, &bounds);
+
+			if (working && !layerZKnown)
+			{
+				layer->z = move.to[2];
+				layerZKnown = true;
+			}
+		}
+
+		return true;
+	}
+
+	if (move.to[2] != move.from[2] && !zChangePending)
+	{
+		zChangePending = true;
+		zChangeOffset = offset;
+		zChangeLine = line;
+		zChangeState = before;
+	}
+
+	if (zChangePending)
+		GCodeMotion::MergeBounds(&pendingMoves, &bounds);
+	else if (layerCount > 0)
+		GCodeMotion::MergeBounds(&layers[layerCount - 1].bounds, &bounds);
+
+	if (!working)
+		return true;
+
+	if (layerCount == 0 || move.to[2] != layers[layerCount - 1].z)
+	{
+		GCodeIndexEntry* layer = zChangePending ?
+			StartEntry(&layers, &layerCount, &layerCapacity, zChangeOffset, zChangeLine, layerCount, &zChangeState) :
+			StartEntry(&layers, &layerCount, &layerCapacity, offset, line, layerCount, &before);
+
+		if (layer == NULL)
+			return false;
+
+		layer->z = move.to[2];
+		layerZKnown = true;
+
+		if (!zChangePending)
+			layer->bounds = bounds;
+	}
+
+	if (zChangePending)
+		GCodeMotion::MergeBounds(&layers[layerCount - 1].bounds, &pendingMoves);
+
+	zChangePending = false;
+	GCodeMotion::EmptyBounds(&pendingMoves);
+
+	return true;
+}
+
+/// <summary>
+/// Adds program bytes to the index, parsing each line as it is completed.
+/// </summary>
+/// <param name="bytes">The next bytes of the program, in any size of chunk.</param>
+/// <returns>False if out of memory.</returns>
+bool GCodeLayerIndex::Add(const char* bytes, size_t length)
+{
+	while (length > 0)
+	{
+		int chunk = length > 0x40000000 ? 0x40000000 : (int)length;
+		int taken = parser.AddCharsToLine(bytes, chunk);
+
+		bytes += taken;
+		length -= taken;
+		position += taken;
+
+		if (parser.completeLineIsAvailableToParse)
+		{
+			parser.ParseLine();
+
+			if (!AddBlock(&parser, lineOffset, lineNumber))
+				return false;
+
+			lineNumber++;
+			lineOffset = position;
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Closes the last layer and tool segment after the bytes passed to Add.
+/// </summary>
+/// <returns>False if out of memory.</returns>
+bool GCodeLayerIndex::Finish()
+{
+	long lines = lineNumber - 1;
+
+	// A last line without a line feed.
+	if (position > lineOffset)
+	{
+		lines++;
+
+		if (!parser.completeLineIsAvailableToParse && parser.line[0] != '\0')
+		{
+			parser.AddCharToLine('\n');
+			parser.ParseLine();
+
+			if (!AddBlock(&parser, lineOffset, lineNumber))
+				return false;
+		}
+	}
+
+	Finish(position, lines);
+
+	return true;
+}
+
+/// <summary>
+/// Closes the last layer and tool segment after the lines passed to AddBlock.
+/// </summary>
+/// <param name="sourceBytes">The length of the program.</param>
+/// <param name="sourceLines">The number of lines in the program.</param>
+void GCodeLayerIndex::Finish(uint64_t sourceBytes, long sourceLines)
+{
+	this->sourceBytes = sourceBytes;
+	this->sourceLines = sourceLines;
+
+	if (zChangePending && layerCount > 0)
+		GCodeMotion::MergeBounds(&layers[layerCount - 1].bounds, &pendingMoves);
+
+	zChangePending = false;
+	GCodeMotion::EmptyBounds(&pendingMoves);
+
+	if (layerCount > 0)
+	{
+		layers[layerCount - 1].length = sourceBytes - layers[layerCount - 1].offset;
+		layers[layerCount - 1].lines = sourceLines + 1 - layers[layerCount - 1].line;
+	}
+
+	if (toolSegmentCount > 0)
+	{
+		toolSegments[toolSegmentCount - 1].length = sourceBytes - toolSegments[toolSegmentCount - 1].offset;
+		toolSegments[toolSegmentCount - 1].lines = sourceLines + 1 - toolSegments[toolSegmentCount - 1].line;
+	}
+}
+
+/// <summary>
+/// Indexes a program held in memory, replacing any index held.
+/// </summary>
+/// <returns>False if out of memory.</returns>
+bool GCodeLayerIndex::BuildBuffer(const char* data, size_t length)
+{
+	Clear();
+
+	return Add(data, length) && Finish();
+}
+
+/// <summary>
+/// Indexes a program file, replacing any index held.
+/// </summary>
+/// <remark>
+/// The file is read in chunks, so programs of any size are indexed in constant memory
+/// besides the index itself.
+/// </remark>
+/// <returns>False if the file cannot be read or memory runs out.</returns>
+bool GCodeLayerIndex::BuildFile(const char* path)
+{
+	Clear();
+
+	FILE* file = fopen(path, "rb");
+	char* buffer = (char*)malloc(LAYER_READ_SIZE);
+	bool result = file != NULL && buffer != NULL;
+	size_t count;
+
+	while (result && (count = fread(buffer, 1, LAYER_READ_SIZE, file)) > 0)
+		result = Add(buffer, count);
+
+	if (result && ferror(file))
+		result = false;
+
+	if (file != NULL)
+		fclose(file);
+
+	free(buffer);
+
+	return result && Finish();
+}
+
+/// <summary>
+/// Gets the layer holding a byte offset.
+/// </summary>
+/// <returns>The layer or -1 if the offset is before the first layer or past the end.</returns>
+long GCodeLayerIndex::LayerAt(uint64_t offset) const
+{
+	if (layerCount == 0 || offset < layers[0].offset || offset >= sourceBytes)
+		return -1;
+
+	long low = 0;
+	long high = layerCount - 1;
+
+	while (low < high)
+	{
+		long middle = (low + high + 1) / 2;
+
+		if (layers[middle].offset <= offset)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+/// <summary>
+/// Positions a stream of the indexed program at the start of a layer.
+/// </summary>
+/// <param name="file">The program, opened for reading.</param>
+/// <param name="layer">The index of the layer in layers.</param>
+/// <param name="state">Receives the modal state to parse the layer in.</param>
+/// <returns>False if there is no such layer or the stream cannot seek.</returns>
+bool GCodeLayerIndex::SeekLayer(FILE* file, long layer, GCodeModalState* state) const
+{
+	if (layer < 0 || layer >= layerCount || fseeko(file, (off_t)layers[layer].offset, SEEK_SET) != 0)
+		return false;
+
+	*state = layers[layer].state;
+
+	return true;
+}
+
+struct LayerWork
+{
+	const GCodeLayerIndex* index;
+	const char* data;
+	GCodeLayerTask task;
+	void* context;
+	long next;
+};
+
+static void* LayerWorker(void* argument)
+{
+	LayerWork* work = (LayerWork*)argument;
+
+	while (true)
+	{
+		long layer = __atomic_fetch_add(&work->next, 1L, __ATOMIC_RELAXED);
+
+		if (layer >= work->index->layerCount)
+			break;
+
+		const GCodeIndexEntry* entry = &work->index->layers[layer];
+		work->task(entry, work->data + entry->offset, work->context);
+	}
+
+	return NULL;
+}
+
+/// <summary>
+/// Runs a task on each layer of a program held in memory on several threads.
+/// </summary>
+/// <param name="data">The indexed program.</param>
+/// <param name="length">The length of the program.</param>
+/// <param name="threads">The number of threads, including the calling thread.</param>
+/// <param name="task">Called once per layer with the layer and its text (layer->length bytes).
+/// Calls run at the same time, in no particular order.</param>
+/// <param name="context">Passed to the task.</param>
+/// <returns>False if the program is not the one indexed.</returns>
+bool GCodeLayerIndex::RunLayers(const char* data, size_t length, int threads, GCodeLayerTask task, void* context) const
+{
+	if (length != sourceBytes)
+		return false;
+
+	LayerWork work = { this, data, task, context, 0 };
+	pthread_t* workers = threads > 1 ? (pthread_t*)malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+	int started = 0;
+
+	// Threads that cannot be started leave their layers to the others.
+	while (workers != NULL && started < threads - 1 && pthread_create(&workers[started], NULL, LayerWorker, &work) == 0)
+		started++;
+
+	LayerWorker(&work);
+
+	for (int i = 0; i < started; i++)
+		pthread_join(workers[i], NULL);
+
+	free(workers);
+
+	return true;
+}
@@ -0,0 +1,119 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeLayerIndex_h
+#define GCodeLayerIndex_h
+
+#include "GCodeMotion.h"
+#include <stdio.h>
+#include <stdint.h>
+
+/// <summary>
+/// A layer or tool segment of a program.
+/// </summary>
+struct GCodeIndexEntry
+{
+	uint64_t offset;           // Byte offset of the first line.
+	uint64_t length;           // Bytes up to the next entry of the same kind or the end.
+	long line;                 // Source line number of the first line.
+	long lines;
+	long number;               // Layer number or tool number.
+	double z;                  // Z of the layer's first working move, Z at the start for tool segments.
+	GCodeBounds bounds;        // Of the moves in the entry.
+	GCodeModalState state;     // Modal state before the first line.
+};
+
+typedef void (*GCodeLayerTask)(const GCodeIndexEntry* layer, const char* text, void* context);
+
+/// <summary>
+/// Index of the layers and tool segments of a program, built while it is parsed (host only).
+/// </summary>
+/// <remark>
+/// Blocks are passed in order, either as bytes to Add (i.e. chunks as they are read) or as
+/// lines the caller has already parsed to AddBlock, and Finish closes the last entries
+/// (with the source length and line count when AddBlock was used).
+///
+/// Layers start at slicer layer comments (";LAYER:n", ";LAYER_CHANGE" or "; layer n").
+/// Until the first is seen layers are found from Z: a working move (extruding once E has
+/// been seen, otherwise any G1, G2 or G3 in X or Y) at a new Z starts a layer at the first Z
+/// change since the last working move, so Z hops stay in their layer. Layers found from Z
+/// are dropped when a layer comment turns up, leaving the start G-Code outside the layers.
+/// A tool segment starts at each tool change.
+///
+/// Each entry keeps its modal state checkpoint (see GCodeMotion) and the bounding box of its
+/// moves, so a layer can be parsed on its own: SeekLayer positions a stream at the layer and
+/// RunLayers hands layers of a program in memory to worker threads.
+/// </remark>
+class GCodeLayerIndex
+{
+private:
+	GCodeParser parser;
+	GCodeMotion motion;
+	long layerCapacity;
+	long toolSegmentCapacity;
+	uint64_t position;         // Bytes passed to Add.
+	uint64_t lineOffset;       // Offset of the line being collected by Add.
+	long lineNumber;
+	bool layerComments;        // Layer comments were seen, Z is no longer used.
+	bool extrusionSeen;
+	bool zChangePending;       // Z changed since the last working move.
+	uint64_t zChangeOffset;
+	long zChangeLine;
+	GCodeModalState zChangeState;
+
+	bool layerZKnown;          // The last layer has had a working move.
+	GCodeBounds pendingMoves;  // Moves since the pending Z change.
+
+	GCodeIndexEntry* StartEntry(GCodeIndexEntry** entries, long* count, long* capacity, uint64_t offset, long line,
+		long number, const GCodeModalState* checkpoint);
+
+public:
+	GCodeIndexEntry* layers;
+	long layerCount;
+	GCodeIndexEntry* toolSegments;
+	long toolSegmentCount;
+	uint64_t sourceBytes;
+	long sourceLines;
+
+	GCodeLayerIndex();
+	~GCodeLayerIndex();
+
+	GCodeLayerIndex(const GCodeLayerIndex&) = delete;
+	GCodeLayerIndex& operator=(const GCodeLayerIndex&) = delete;
+
+	void Clear();
+	bool Add(const char* bytes, size_t length);
+	bool AddBlock(GCodeParser* parser, uint64_t offset, long line);
+	bool Finish();
+	void Finish(uint64_t sourceBytes, long sourceLines);
+
+	bool BuildBuffer(const char* data, size_t length);
+	bool BuildFile(const char* path);
+
+	long LayerAt(uint64_t offset) const;
+	bool SeekLayer(FILE* file, long layer, GCodeModalState* state) const;
+	bool RunLayers(const char* data, size_t length, int threads, GCodeLayerTask task, void* context) const;
+};
+
+#endif
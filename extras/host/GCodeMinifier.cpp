@@ -0,0 +1,836 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "GCodeMinifier.h"
+#include "../../src/GCodeArena.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char MINIFY_AXES[] = "XYZABCUVWE";
+const int MINIFY_E = 9;
+const int MINIFY_READ_SIZE = 1 << 16;
+const int MINIFY_ARENA_SIZE = 1 << 16;
+const int MINIFY_OUTPUT_SIZE = MINIFY_ARENA_SIZE + 2 * MAX_LINE_SIZE;
+
+// Parenthesis comments LinuxCNC (and some other controllers) act on, followed by ',' or ')'.
+static const char* const ACTIVE_COMMENTS[] = { "MSG", "PRINT", "DEBUG", "LOGOPEN", "LOGAPPEND", "LOGCLOSE", "PROBEOPEN", "PROBECLOSE" };
+
+/// <summary>
+/// Gets the index of an axis letter in MINIFY_AXES, -1 if it is not an axis.
+/// </summary>
+static int AxisIndex(char letter)
+{
+	const char* axis = strchr(MINIFY_AXES, letter);
+
+	return letter != '\0' && axis != NULL ? (int)(axis - MINIFY_AXES) : -1;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeMinifier::GCodeMinifier()
+{
+	memset(decimals, -1, sizeof(decimals));
+	modalMotion = false;
+	activeComments = true;
+	confirmed = -1;
+	longLine = 0;
+	linesIn = 0;
+	linesOut = 0;
+	bytesIn = 0;
+	bytesOut = 0;
+	wordCount = 0;
+	blockDelete = false;
+	checksum = false;
+
+	Reset();
+}
+
+/// <summary>
+/// Forgets the modal state, i.e. after the controller rejected a block. The counters are kept.
+/// </summary>
+void GCodeMinifier::Reset()
+{
+	motion = -1;
+	plane = -1;
+	units = -1;
+	distance = -1;
+	feedMode = 94;
+	extrusion = -1;
+	feed = 0;
+	feedKnown = false;
+	motionSet = -1;
+	planeSet = -1;
+	unitsSet = -1;
+	distanceSet = -1;
+	feedModeSet = -1;
+	extrusionSet = -1;
+	feedSet = -1;
+
+	for (int i = 0; i < MINIFY_AXIS_COUNT; i++)
+	{
+		position[i] = 0;
+		positionKnown[i] = false;
+		carry[i] = 0;
+		positionSet[i] = -1;
+	}
+}
+
+/// <summary>
+/// Sets the decimal places values of some letters are rounded to.
+/// </summary>
+/// <param name="letters">The letters, i.e. "XYZIJK".</param>
+/// <param name="places">The machine's resolution in decimal places, -1 to keep the values as written.</param>
+void GCodeMinifier::SetDecimals(const char* letters, int places)
+{
+	for (; *letters != '\0'; letters++)
+	{
+		char letter = toupper(*letters);
+
+		if (letter >= 'A' && letter <= 'Z')
+			decimals[letter - 'A'] = places < MAX_FIXED_DECIMALS ? places : MAX_FIXED_DECIMALS;
+	}
+}
+
+/// <summary>
+/// Gets the bytes removed so far, line feeds included.
+/// </summary>
+long GCodeMinifier::BytesSaved() const
+{
+	return bytesIn - bytesOut;
+}
+
+/// <summary>
+/// Writes a number with the fewest characters that have the same value.
+/// </summary>
+/// <param name="text">The number, an optional sign, digits and an optional fraction.</param>
+/// <param name="length">The length of the number, 0 for a word without a value.</param>
+/// <param name="output">Receives the number and a null.</param>
+/// <param name="size">The size of output.</param>
+/// <returns>The length written, -1 if the text is not a number or does not fit.</returns>
+/// <remarks>A '+' and leading and trailing zeros are dropped, 0.50 is written .5 and -0 is 0.</remarks>
+int GCodeMinifier::NormalizeNumber(const char* text, int length, char* output, int size)
+{
+	int pointer = 0;
+	bool negative = false;
+
+	if (pointer < length && (text[pointer] == '+' || text[pointer] == '-'))
+		negative = text[pointer++] == '-';
+
+	int integerStart = pointer;
+
+	while (pointer < length && isdigit((unsigned char)text[pointer]))
+		pointer++;
+
+	int integerEnd = pointer;
+	int fractionStart = pointer;
+	int fractionEnd = pointer;
+
+	if (pointer < length && text[pointer] == '.')
+	{
+		fractionStart = ++pointer;
+
+		while (pointer < length && isdigit((unsigned char)text[pointer]))
+			pointer++;
+
+		fractionEnd = pointer;
+	}
+
+	if (pointer != length || (length > 0 && integerStart == integerEnd && fractionStart == fractionEnd))
+		return -1;
+
+	while (integerStart < integerEnd && text[integerStart] == '0')
+		integerStart++;
+
+	while (fractionEnd > fractionStart && text[fractionEnd - 1] == '0')
+		fractionEnd--;
+
+	if (length > 0 && integerStart == integerEnd && fractionStart == fractionEnd)
+	{
+		text = "0";
+		integerStart = 0;
+		integerEnd = 1;
+		negative = false;
+	}
+
+	int integerDigits = integerEnd - integerStart;
+	int fractionDigits = fractionEnd - fractionStart;
+	int needed = (negative ? 1 : 0) + integerDigits + (fractionDigits > 0 ? fractionDigits + 1 : 0);
+
+	if (needed >= size)
+		return -1;
+
+	pointer = 0;
+
+	if (negative)
+		output[pointer++] = '-';
+
+	memcpy(&output[pointer], &text[integerStart], integerDigits);
+	pointer += integerDigits;
+
+	if (fractionDigits > 0)
+	{
+		output[pointer++] = '.';
+		memcpy(&output[pointer], &text[fractionStart], fractionDigits);
+		pointer += fractionDigits;
+	}
+
+	output[pointer] = '\0';
+
+	return pointer;
+}
+
+/// <summary>
+/// Tells whether a comment is acted on by the controller or host and must be kept.
+/// </summary>
+/// <param name="comment">The comment with its '(' or ';'.</param>
+/// <param name="length">The length of the comment.</param>
+/// <remarks>
+/// Active comments are LinuxCNC's (MSG,...), (PRINT,...), (DEBUG,...), (LOG...) and (PROBE...)
+/// and host commands such as OctoPrint's ;@pause.
+/// </remarks>
+bool GCodeMinifier::IsActiveComment(const char* comment, int length)
+{
+	if (length >= 2 && comment[0] == ';')
+		return comment[1] == '@';
+
+	if (length < 2 || comment[0] != '(')
+		return false;
+
+	int start = 1;
+
+	while (start < length && comment[start] == ' ')
+		start++;
+
+	for (size_t i = 0; i < sizeof(ACTIVE_COMMENTS) / sizeof(ACTIVE_COMMENTS[0]); i++)
+	{
+		const char* keyword = ACTIVE_COMMENTS[i];
+		int keywordLength = strlen(keyword);
+
+		if (start + keywordLength < length && strncasecmp(&comment[start], keyword, keywordLength) == 0 &&
+			(comment[start + keywordLength] == ',' || comment[start + keywordLength] == ')'))
+			return true;
+	}
+
+	return false;
+}
+
+/// <summary>
+/// Splits the code of a block into words with their numbers normalized.
+/// </summary>
+/// <returns>False if the code is not all words (i.e. a Grbl $ command or M117) or has too many of them.</returns>
+bool GCodeMinifier::Split(const char* code)
+{
+	wordCount = 0;
+	blockDelete = false;
+	checksum = false;
+
+	if (*code == '/')
+	{
+		blockDelete = true;
+		code++;
+	}
+
+	while (*code != '\0')
+	{
+		// A checksum is worked out again for the block written.
+		if (*code == '*')
+		{
+			checksum = true;
+			break;
+		}
+
+		if (!isalpha((unsigned char)*code) || wordCount == MINIFY_MAX_WORDS)
+			return false;
+
+		Word* word = &words[wordCount++];
+		word->letter = *code++;
+		word->keep = true;
+		word->value = 0;
+
+		const char* number = code;
+
+		while (*code == '+' || *code == '-' || *code == '.' || isdigit((unsigned char)*code))
+			code++;
+
+		word->length = NormalizeNumber(number, (int)(code - number), word->text, sizeof(word->text));
+
+		if (word->length < 0)
+			return false;
+
+		if (word->length > 0)
+			GCodeParser::ParseNumber(word->text, &word->value);
+
+		// The rest of a message or file name (i.e. M117) is text, not words.
+		if (wordCount == 1 && toupper(word->letter) == 'M' && word->length > 0 &&
+			(word->value == 23 || word->value == 28 || word->value == 32 || word->value == 117 ||
+			word->value == 118 || word->value == 928))
+			return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Tells whether the effect of every word of the block split is tracked.
+/// </summary>
+bool GCodeMinifier::Tracked() const
+{
+	if (blockDelete)
+		return false;
+
+	bool motionWord = false;
+	bool setPosition = false;
+	bool otherCommand = false;
+	bool axisWord = false;
+
+	for (int i = 0; i < wordCount; i++)
+	{
+		const Word* word = &words[i];
+		char letter = toupper(word->letter);
+		long code = (long)word->value;
+
+		if (word->length == 0 || letter == 'T')
+			return false;
+
+		if ((letter == 'G' || letter == 'M') && word->value != (double)code)
+			return false;
+
+		if (letter == 'G')
+		{
+			if (code >= 0 && code <= 3)
+				motionWord = true;
+			else if (code == 92)
+				setPosition = true;
+			else if (code == 4)
+				otherCommand = true;
+			else if (code != 17 && code != 18 && code != 19 && code != 20 && code != 21 &&
+				code != 90 && code != 91 && code != 93 && code != 94)
+				return false;
+		}
+		else if (letter == 'M')
+		{
+			if (code == 2 || code == 30 || code == 6 || code == 206 || code == 428)
+				return false;
+
+			otherCommand = true;
+		}
+		else if (letter == 'F' || AxisIndex(letter) >= 0)
+			axisWord = true;
+	}
+
+	// Axis and F words are positions and feed rates only in a move or G92, elsewhere they are
+	// arguments (G4 X10, M92 X80, M203 X500).
+	if (otherCommand && axisWord)
+		return false;
+
+	return !(motionWord && setPosition);
+}
+
+/// <summary>
+/// Determine if the controller has accepted a block, so state it set can be relied on.
+/// </summary>
+/// <param name="block">The block (linesIn - 1 when it was minified) or -1 for state held from the start.</param>
+bool GCodeMinifier::Confirmed(long block) const
+{
+	return confirmed < 0 || block < confirmed;
+}
+
+/// <summary>
+/// Rounds the value of a word to the decimal places of its letter.
+/// </summary>
+/// <param name="value">The value to round, which may include the rounding carried from earlier moves.</param>
+void GCodeMinifier::Round(Word* word, double value)
+{
+	int places = decimals[toupper(word->letter) - 'A'];
+
+	if (places < 0)
+		return;
+
+	char text[MAX_NUMBER_SIZE];
+	int length = GCodeWriter::FormatNumber(text, sizeof(text), value, places);
+
+	// Too large to round, kept as written.
+	if (length == 0)
+		return;
+
+	word->length = NormalizeNumber(text, length, word->text, sizeof(word->text));
+	GCodeParser::ParseNumber(word->text, &word->value);
+}
+
+/// <summary>
+/// Rounds the words of a tracked block, drops those which change nothing and updates the modal state.
+/// </summary>
+void GCodeMinifier::Decide()
+{
+	long block = linesIn - 1;
+	int blockMotion = -1;
+	int repeatedMotion = -1;
+	bool setPosition = false;
+
+	// Modal words apply to the rest of the block, whatever their order.
+	for (int i = 0; i < wordCount; i++)
+	{
+		Word* word = &words[i];
+		char letter = toupper(word->letter);
+		int code = (int)word->value;
+		int* state = NULL;
+		long* set = NULL;
+
+		if (letter == 'G')
+		{
+			if (code <= 3)
+			{
+				blockMotion = code;
+				state = &motion;
+				set = &motionSet;
+
+				if (motion == code && Confirmed(motionSet))
+					repeatedMotion = i;
+			}
+			else if (code >= 17 && code <= 19)
+			{
+				state = &plane;
+				set = &planeSet;
+			}
+			else if (code == 20 || code == 21)
+			{
+				state = &units;
+				set = &unitsSet;
+			}
+			else if (code == 90 || code == 91)
+			{
+				state = &distance;
+				set = &distanceSet;
+			}
+			else if (code == 93 || code == 94)
+			{
+				state = &feedMode;
+				set = &feedModeSet;
+			}
+			else if (code == 92)
+				setPosition = true;
+		}
+		else if (letter == 'M' && (code == 82 || code == 83))
+		{
+			state = &extrusion;
+			set = &extrusionSet;
+		}
+
+		if (state == NULL)
+			continue;
+
+		// Sent again while the block which set it may still be rejected.
+		if (*state == code)
+		{
+			if (Confirmed(*set))
+				word->keep = false;
+
+			continue;
+		}
+
+		if (state == &units)
+		{
+			// Positions and feed rates known in the other units are not in these.
+			for (int axis = 0; axis < MINIFY_AXIS_COUNT; axis++)
+				positionKnown[axis] = false;
+
+			feedKnown = false;
+		}
+
+		// G90 and G91 set the extruder as well on Marlin but not on Klipper.
+		if (state == &distance)
+			extrusion = -1;
+
+		*state = code;
+		*set = block;
+	}
+
+	int effectiveMotion = blockMotion >= 0 ? blockMotion : (Confirmed(motionSet) ? motion : -1);
+	bool straight = effectiveMotion == 0 || effectiveMotion == 1;
+	bool axisWords = false;
+
+	for (int i = 0; i < wordCount; i++)
+	{
+		Word* word = &words[i];
+		char letter = toupper(word->letter);
+		int axis = AxisIndex(letter);
+
+		if (letter == 'G' || letter == 'M' || letter == 'N')
+			continue;
+
+		if (letter == 'F')
+		{
+			Round(word, word->value);
+
+			if (feedMode == 94 && feedKnown && feed == word->value)
+			{
+				if (Confirmed(feedModeSet) && Confirmed(feedSet))
+					word->keep = false;
+
+				continue;
+			}
+
+			feed = word->value;
+			feedKnown = feedMode == 94;
+			feedSet = block;
+			continue;
+		}
+
+		if (axis < 0)
+		{
+			Round(word, word->value);
+			continue;
+		}
+
+		axisWords = true;
+
+		if (setPosition)
+		{
+			position[axis] = word->value;
+			positionKnown[axis] = true;
+			positionSet[axis] = block;
+			carry[axis] = 0;
+			continue;
+		}
+
+		int mode = axis == MINIFY_E ? extrusion : distance;
+		bool modeConfirmed = Confirmed(axis == MINIFY_E ? extrusionSet : distanceSet);
+
+		if (mode == 91 || mode == 83)
+		{
+			double target = word->value + carry[axis];
+			Round(word, target);
+			carry[axis] = target - word->value;
+
+			if (word->value == 0)
+			{
+				if (straight && modeConfirmed)
+					word->keep = false;
+
+				continue;
+			}
+
+			position[axis] += word->value;
+			positionSet[axis] = block;
+		}
+		else if (mode == 90 || mode == 82)
+		{
+			Round(word, word->value);
+
+			if (positionKnown[axis] && position[axis] == word->value)
+			{
+				if (straight && modeConfirmed && Confirmed(positionSet[axis]))
+					word->keep = false;
+
+				continue;
+			}
+
+			position[axis] = word->value;
+			positionKnown[axis] = true;
+			positionSet[axis] = block;
+		}
+		else
+			positionKnown[axis] = false;
+	}
+
+	// A G92 without axis words zeroes them all on some controllers and is an error on others.
+	if (setPosition && !axisWords)
+	{
+		for (int axis = 0; axis < MINIFY_AXIS_COUNT; axis++)
+			positionKnown[axis] = false;
+	}
+
+	// Without modal motion a repeated G word is only dropped with the rest of the block.
+	if (repeatedMotion >= 0 && !modalMotion)
+	{
+		for (int i = 0; i < wordCount; i++)
+		{
+			if (words[i].keep)
+			{
+				words[repeatedMotion].keep = true;
+				break;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Writes the words kept and the active comments.
+/// </summary>
+/// <param name="code">Code to write as it is instead of the words, NULL for the words.</param>
+/// <param name="comments">The comments of the block.</param>
+/// <returns>The length written, 0 if there is nothing to write or -1 if it does not fit.</returns>
+int GCodeMinifier::Compose(const char* code, const char* comments, char* output, int size) const
+{
+	int pointer = 0;
+
+	if (code != NULL)
+	{
+		pointer = strlen(code);
+
+		if (pointer >= size)
+			return -1;
+
+		memcpy(output, code, pointer);
+	}
+	else
+	{
+		if (blockDelete)
+			output[pointer++] = '/';
+
+		for (int i = 0; i < wordCount; i++)
+		{
+			const Word* word = &words[i];
+
+			if (!word->keep)
+				continue;
+
+			if (pointer + 1 + word->length >= size)
+				return -1;
+
+			output[pointer++] = word->letter;
+			memcpy(&output[pointer], word->text, word->length);
+			pointer += word->length;
+		}
+
+		if (pointer == 1 && blockDelete)
+			pointer = 0;
+	}
+
+	const char* comment = comments;
+
+	while (activeComments && *comment != '\0')
+	{
+		int length;
+
+		if (*comment == '(')
+		{
+			const char* close = strchr(comment, ')');
+			length = close != NULL ? (int)(close - comment) + 1 : strlen(comment);
+		}
+		else if (*comment == ';')
+			length = strlen(comment);
+		else
+		{
+			comment++;
+			continue;
+		}
+
+		if (IsActiveComment(comment, length))
+		{
+			if (pointer + length >= size)
+				return -1;
+
+			memcpy(&output[pointer], comment, length);
+			pointer += length;
+		}
+
+		comment += length;
+	}
+
+	if (code == NULL && checksum && pointer > 0)
+	{
+		int sum = 0;
+
+		for (int i = 0; i < pointer; i++)
+			sum ^= (unsigned char)output[i];
+
+		int length = snprintf(&output[pointer], size - pointer, "*%d", sum);
+
+		if (length >= size - pointer)
+			return -1;
+
+		pointer += length;
+	}
+
+	output[pointer] = '\0';
+
+	return pointer;
+}
+
+/// <summary>
+/// Minifies a parsed block.
+/// </summary>
+/// <param name="parser">The parser after ParseLine.</param>
+/// <param name="sourceLength">The bytes the line took in the source, its line feed included, for the counters.</param>
+/// <param name="output">Receives the block without a line feed.</param>
+/// <param name="size">The size of output.</param>
+/// <returns>The length written, 0 if the block can be left out or -1 if it does not fit or the
+/// parser discarded the line (GCODE_LINE_OVERFLOW).</returns>
+int GCodeMinifier::Minify(GCodeParser* parser, int sourceLength, char* output, int size)
+{
+	linesIn++;
+	bytesIn += sourceLength;
+
+	// An overflowed line parses as an empty block, which must not be taken for one.
+	if (parser->lineStatus == GCODE_LINE_OVERFLOW)
+	{
+		Reset();
+		return -1;
+	}
+
+	bool split = Split(parser->line);
+	bool tracked = split && Tracked();
+
+	if (tracked)
+		Decide();
+
+	int length = Compose(split ? NULL : parser->line, parser->comments, output, size);
+
+	if (!tracked)
+		Reset();
+
+	if (length > 0)
+	{
+		linesOut++;
+		bytesOut += length + 1;
+	}
+
+	return length;
+}
+
+/// <summary>
+/// Minifies the line completed in a parser and writes it.
+/// </summary>
+/// <returns>False if the output cannot be written, the line was too long or does not fit.</returns>
+bool GCodeMinifier::MinifyLine(GCodeParser* parser, int sourceLength, long lineNumber, char* output, FILE* out)
+{
+	parser->ParseLine();
+	int count = Minify(parser, sourceLength, output, MINIFY_OUTPUT_SIZE - 1);
+
+	if (count < 0)
+	{
+		if (parser->lineStatus == GCODE_LINE_OVERFLOW)
+			longLine = lineNumber;
+
+		return false;
+	}
+
+	if (count == 0)
+		return true;
+
+	output[count++] = '\n';
+
+	return fwrite(output, 1, count, out) == (size_t)count;
+}
+
+/// <summary>
+/// Minifies a program read from a stream.
+/// </summary>
+/// <remark>
+/// Lines longer than MAX_LINE_SIZE are parsed in an arena of MINIFY_ARENA_SIZE bytes. A line
+/// longer than that stops the stream with its line number in longLine rather than being
+/// dropped.
+/// </remark>
+/// <param name="in">The program.</param>
+/// <param name="out">Receives the minified program.</param>
+/// <returns>False if the input cannot be read, the output written, a line is too long or a block does not fit in a line.</returns>
+bool GCodeMinifier::MinifyStream(FILE* in, FILE* out)
+{
+	char* buffer = (char*)malloc(MINIFY_READ_SIZE);
+	char* output = (char*)malloc(MINIFY_OUTPUT_SIZE);
+	char* memory = (char*)malloc(MINIFY_ARENA_SIZE);
+
+	longLine = 0;
+
+	if (buffer == NULL || output == NULL || memory == NULL)
+	{
+		free(buffer);
+		free(output);
+		free(memory);
+		return false;
+	}
+
+	GCodeArena arena(memory, MINIFY_ARENA_SIZE);
+	GCodeParser parser;
+	parser.lineArena = &arena;
+
+	bool result = true;
+	long lineNumber = 1;
+	int source = 0;
+	size_t length;
+
+	while (result && (length = fread(buffer, 1, MINIFY_READ_SIZE, in)) > 0)
+	{
+		size_t pointer = 0;
+
+		while (result && pointer < length)
+		{
+			int taken = parser.AddCharsToLine(&buffer[pointer], (int)(length - pointer));
+			pointer += taken;
+			source += taken;
+
+			if (!parser.completeLineIsAvailableToParse)
+				continue;
+
+			result = MinifyLine(&parser, source, lineNumber++, output, out);
+			source = 0;
+		}
+	}
+
+	// A last line without a line feed.
+	if (result && source > 0)
+	{
+		parser.AddCharToLine('\n');
+		result = MinifyLine(&parser, source, lineNumber, output, out);
+	}
+
+	free(buffer);
+	free(output);
+	free(memory);
+
+	return result && !ferror(in);
+}
+
+/// <summary>
+/// Minifies a program file.
+/// </summary>
+/// <param name="inPath">The program to minify.</param>
+/// <param name="outPath">The file to create.</param>
+/// <returns>False if a file cannot be read or written or a block does not fit in a line.</returns>
+bool GCodeMinifier::MinifyFile(const char* inPath, const char* outPath)
+{
+	FILE* in = fopen(inPath, "rb");
+
+	if (in == NULL)
+		return false;
+
+	FILE* out = fopen(outPath, "wb");
+
+	if (out == NULL)
+	{
+		fclose(in);
+		return false;
+	}
+
+	bool success = MinifyStream(in, out);
+
+	if (fclose(out) != 0)
+		success = false;
+
+	fclose(in);
+
+	return success;
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GCodeMinifier_h
+#define GCodeMinifier_h
+
+#include "../../src/GCodeParser.h"
+#include "../../src/GCodeWriter.h"
+#include <stdio.h>
+
+const int MINIFY_MAX_WORDS = 64;    // Words in a block, blocks with more are sent as they are.
+const int MINIFY_AXIS_COUNT = 10;   // X, Y, Z, A, B, C, U, V, W and E.
+
+/// <summary>
+/// Rewrites blocks with the fewest characters that make the controller do the same thing (host only).
+/// </summary>
+/// <remark>
+/// Works on the code and comments ParseLine splits a line into. Spaces and comments are
+/// dropped, except active comments (see IsActiveComment), and numbers are written without
+/// a sign, leading or trailing zeros they do not need (G01 is G1, X0.500 is X.5). When
+/// decimals are set for a letter its values are also rounded to that many places, the
+/// machine's resolution. Rounded relative moves carry the rounding to the next move so
+/// the position does not drift.
+///
+/// The modal state is tracked from the blocks minified and starts unknown, so the first
+/// word of each kind is always kept. A motion (G0 to G3), plane, units, distance, feed
+/// rate mode or M82/M83 word the controller already has is dropped, as is an F it
+/// already has, an axis word of a G0 or G1 that does not move the axis and a whole block
+/// left with nothing to do. A block with a word whose effect is not tracked (any other G,
+/// M2, M30, M6, M206, M428, T, a bare or block deleted word) is only reformatted and
+/// forgets the state, as is a G4 or M code with axis or F words, which are arguments there
+/// (M92 X80). G92 sets the positions. Arcs keep their axis words. G90 and G91 leave the
+/// extrusion mode unknown since controllers differ on whether they change it.
+///
+/// The state assumes every block sent is carried out: call Reset when the controller
+/// rejects one. When blocks are sent before the earlier ones are acknowledged, set
+/// confirmed to the linesIn count after the last block acknowledged; a word is then only
+/// dropped when the block which set the state it repeats has been acknowledged, so a
+/// rejected block never leaves a block sent after it without a word it needed. Every
+/// move keeps its G word unless modalMotion is set, for controllers which keep the motion
+/// mode between blocks (Grbl, LinuxCNC); Marlin and RepRapFirmware reject a move without one.
+/// A line the parser discarded as too long is never taken for an empty block.
+///
+///   GCodeMinifier minifier;
+///   minifier.SetDecimals("XYZIJKR", 3);
+///   minifier.MinifyFile("part.gcode", "part-min.gcode");
+///   printf("%ld bytes saved\n", minifier.BytesSaved());
+/// </remark>
+class GCodeMinifier
+{
+private:
+	struct Word
+	{
+		char letter;              // As written, for text arguments such as M117's.
+		bool keep;
+		int length;
+		double value;
+		char text[MAX_NUMBER_SIZE];
+	};
+
+	Word words[MINIFY_MAX_WORDS];
+	int wordCount;
+	bool blockDelete;
+	bool checksum;
+
+	int motion;                       // 0 to 3, -1 unknown.
+	int plane;                        // 17 to 19, -1 unknown.
+	int units;                        // 20 or 21, -1 unknown.
+	int distance;                     // 90 or 91, -1 unknown.
+	int feedMode;                     // 93 or 94.
+	int extrusion;                    // 82 or 83, -1 unknown.
+	double feed;
+	bool feedKnown;
+	double position[MINIFY_AXIS_COUNT];
+	bool positionKnown[MINIFY_AXIS_COUNT];
+	double carry[MINIFY_AXIS_COUNT];  // Rounding not yet sent of relative moves.
+
+	// The block (linesIn - 1) which set each state, -1 when it holds from the start.
+	long motionSet;
+	long planeSet;
+	long unitsSet;
+	long distanceSet;
+	long feedModeSet;
+	long extrusionSet;
+	long feedSet;
+	long positionSet[MINIFY_AXIS_COUNT];
+
+	bool Split(const char* code);
+	bool Tracked() const;
+	bool Confirmed(long block) const;
+	void Round(Word* word, double value);
+	void Decide();
+	int Compose(const char* code, const char* comments, char* output, int size) const;
+	bool MinifyLine(GCodeParser* parser, int sourceLength, long lineNumber, char* output, FILE* out);
+
+public:
+	signed char decimals[WORD_LETTER_COUNT]; // Places to round values to per letter, -1 to keep them (default -1).
+	bool modalMotion;         // The controller keeps the motion mode between blocks (default false).
+	bool activeComments;      // Keep active comments (default true).
+	long confirmed;           // Blocks, counted by linesIn, the controller has accepted, -1 for all (default).
+	long linesIn;
+	long linesOut;
+	long bytesIn;
+	long bytesOut;
+	long longLine;            // Source line too long to parse which stopped MinifyStream, 0 if none.
+
+	GCodeMinifier();
+
+	void Reset();
+	void SetDecimals(const char* letters, int places);
+	long BytesSaved() const;
+
+	int Minify(GCodeParser* parser, int sourceLength, char* output, int size);
+	bool MinifyStream(FILE* in, FILE* out);
+	bool MinifyFile(const char* inPath, const char* outPath);
+
+	static bool IsActiveComment(const char* comment, int length);
+	static int NormalizeNumber(const char* text, int length, char* output, int size);
+};
+
+#endif
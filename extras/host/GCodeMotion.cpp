@@ -0,0 +1,315 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeMotion.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+const unsigned long MOTION_LETTERS = GCODE_LETTER('X') | GCODE_LETTER('Y') | GCODE_LETTER('Z') | GCODE_LETTER('E') |
+	GCODE_LETTER('F') | GCODE_LETTER('I') | GCODE_LETTER('J') | GCODE_LETTER('R') | GCODE_LETTER('T');
+const unsigned long MOTION_AXES = GCODE_LETTER('X') | GCODE_LETTER('Y') | GCODE_LETTER('Z') | GCODE_LETTER('E');
+const double MOTION_PI = 3.14159265358979323846;
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeMotion::GCodeMotion()
+{
+	Reset();
+}
+
+/// <summary>
+/// Goes back to the state at the start of a program.
+/// </summary>
+void GCodeMotion::Reset()
+{
+	InitialState(&state);
+	toolChangeSeen = false;
+}
+
+/// <summary>
+/// Gets the state at the start of a program.
+/// </summary>
+void GCodeMotion::InitialState(GCodeModalState* state)
+{
+	memset(state, 0, sizeof(*state));
+	state->plane = 17;
+	state->workOffset = 54;
+	state->absolute = true;
+	state->absoluteExtrusion = true;
+	state->tool = -1;
+	state->selectedTool = -1;
+}
+
+/// <summary>
+/// Applies a parsed line to the state.
+/// </summary>
+/// <param name="parser">The parser after ParseLine.</param>
+/// <param name="move">Receives the move, and the letters on the block even when it does not move.</param>
+/// <returns>True if the block moves.</returns>
+bool GCodeMotion::Apply(GCodeParser* parser, GCodeMove* move)
+{
+	const char* code = parser->line;
+	bool setPosition = false;
+	bool home = false;
+	bool nonMotion = false;
+	bool toolChange = false;
+
+	// Scan the G and M words for modal changes.
+	for (int pointer = 0; code[pointer] != '\0'; pointer++)
+	{
+		char letter = code[pointer];
+
+		if (letter != 'G' && letter != 'M')
+			continue;
+
+		long value;
+		int count = GCodeParser::ParseInteger(&code[pointer + 1], &value);
+
+		if (count == 0)
+			continue;
+
+		if (code[pointer + 1 + count] == '.')
+		{
+			// G28.1, G92.1 and similar.
+			if (letter == 'G')
+				nonMotion = true;
+
+			continue;
+		}
+
+		if (letter == 'M')
+		{
+			switch (value)
+			{
+			case 6: toolChange = true; break;
+			case 82: state.absoluteExtrusion = true; break;
+			case 83: state.absoluteExtrusion = false; break;
+			}
+
+			continue;
+		}
+
+		switch (value)
+		{
+		case 0: case 1: case 2: case 3: state.motion = (unsigned char)value; break;
+		case 17: case 18: case 19: state.plane = (unsigned char)value; break;
+		case 20: state.inches = true; break;
+		case 21: state.inches = false; break;
+		case 54: case 55: case 56: case 57: case 58: case 59: state.workOffset = (unsigned char)value; break;
+		case 90: state.absolute = true; break;
+		case 91: state.absolute = false; break;
+		case 92: setPosition = true; break;
+		case 28: home = true; break;
+		case 4: case 10: case 30: case 53: nonMotion = true; break;
+		}
+	}
+
+	GCodeWords words;
+	unsigned long found = parser->GetWords(MOTION_LETTERS, &words);
+	move->words = found;
+
+	if (found & GCODE_LETTER('F'))
+		state.feedRate = words.value['F' - 'A'];
+
+	if (found & GCODE_LETTER('T'))
+	{
+		state.selectedTool = (long)words.value['T' - 'A'];
+
+		if (!toolChangeSeen && !toolChange)
+			state.tool = state.selectedTool;
+	}
+
+	if (toolChange)
+	{
+		toolChangeSeen = true;
+		state.tool = state.selectedTool;
+	}
+
+	if (nonMotion || (!(found & MOTION_AXES) && !home))
+		return false;
+
+	const char letters[4] = { 'X', 'Y', 'Z', 'E' };
+	memcpy(move->from, state.position, sizeof(move->from));
+
+	for (int a = 0; a < 4; a++)
+	{
+		bool present = (found & GCODE_LETTER(letters[a])) != 0;
+		double value = words.value[letters[a] - 'A'];
+
+		if (home)
+		{
+			// G28 without axes homes them all.
+			if (a < 3 && (present || !(found & MOTION_AXES)))
+				state.position[a] = 0.0;
+		}
+		else if (!present)
+			continue;
+		else if (setPosition || (state.absolute && (a < 3 || state.absoluteExtrusion)))
+			state.position[a] = value;
+		else
+			state.position[a] += value;
+	}
+
+	// G92 declares the position without moving.
+	if (setPosition)
+		return false;
+
+	memcpy(move->to, state.position, sizeof(move->to));
+	move->motion = home ? 0 : state.motion;
+	move->radius = 0.0;
+	move->sweep = 0.0;
+
+	if (move->motion < 2)
+		return true;
+
+	double x = move->to[0] - move->from[0];
+	double y = move->to[1] - move->from[1];
+
+	if (found & (GCODE_LETTER('I') | GCODE_LETTER('J')))
+	{
+		move->center[0] = move->from[0] + words.value['I' - 'A'];
+		move->center[1] = move->from[1] + words.value['J' - 'A'];
+	}
+	else if ((found & GCODE_LETTER('R')) && (x != 0.0 || y != 0.0))
+	{
+		// The center is on the perpendicular bisector of the chord, to the right of it for
+		// clockwise arcs of less than 180 degrees (positive R).
+		double r = words.value['R' - 'A'];
+		double squared = 4.0 * r * r - x * x - y * y;
+		double h = -sqrt(squared > 0.0 ? squared : 0.0) / sqrt(x * x + y * y);
+
+		if (move->motion == 3)
+			h = -h;
+
+		if (r < 0.0)
+			h = -h;
+
+		move->center[0] = move->from[0] + 0.5 * (x - y * h);
+		move->center[1] = move->from[1] + 0.5 * (y + x * h);
+	}
+	else
+	{
+		// Without a center the arc is taken as a line.
+		move->motion = 1;
+		return true;
+	}
+
+	double startX = move->from[0] - move->center[0];
+	double startY = move->from[1] - move->center[1];
+	double endX = move->to[0] - move->center[0];
+	double endY = move->to[1] - move->center[1];
+	double sweep = atan2(startX * endY - startY * endX, startX * endX + startY * endY);
+
+	move->radius = sqrt(startX * startX + startY * startY);
+
+	// Ending where it starts is a full circle.
+	if (move->motion == 2 && sweep >= -1e-9)
+		sweep -= 2.0 * MOTION_PI;
+	else if (move->motion == 3 && sweep <= 1e-9)
+		sweep += 2.0 * MOTION_PI;
+
+	move->sweep = sweep;
+
+	return true;
+}
+
+/// <summary>
+/// Makes a box empty.
+/// </summary>
+void GCodeMotion::EmptyBounds(GCodeBounds* bounds)
+{
+	for (int a = 0; a < 3; a++)
+	{
+		bounds->min[a] = DBL_MAX;
+		bounds->max[a] = -DBL_MAX;
+	}
+}
+
+/// <summary>
+/// Grows a box to hold another.
+/// </summary>
+void GCodeMotion::MergeBounds(GCodeBounds* bounds, const GCodeBounds* other)
+{
+	for (int a = 0; a < 3; a++)
+	{
+		if (other->min[a] < bounds->min[a])
+			bounds->min[a] = other->min[a];
+
+		if (other->max[a] > bounds->max[a])
+			bounds->max[a] = other->max[a];
+	}
+}
+
+/// <summary>
+/// Determine if two boxes overlap, touching counts.
+/// </summary>
+bool GCodeMotion::Overlap(const GCodeBounds* a, const GCodeBounds* b)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (a->min[i] > b->max[i] || b->min[i] > a->max[i])
+			return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Gets the box of a move.
+/// </summary>
+/// <remark>
+/// An arc's box holds its ends and each axis extreme (0, 90, 180 and 270 degrees) the arc
+/// passes through.
+/// </remark>
+void GCodeMotion::MoveBounds(const GCodeMove* move, GCodeBounds* bounds)
+{
+	for (int a = 0; a < 3; a++)
+	{
+		bounds->min[a] = move->from[a] < move->to[a] ? move->from[a] : move->to[a];
+		bounds->max[a] = move->from[a] > move->to[a] ? move->from[a] : move->to[a];
+	}
+
+	if (move->radius <= 0.0)
+		return;
+
+	double start = atan2(move->from[1] - move->center[1], move->from[0] - move->center[0]);
+	double low = move->sweep < 0.0 ? start + move->sweep : start;
+	double high = move->sweep < 0.0 ? start : start + move->sweep;
+
+	// The extremes are at multiples of 90 degrees, the first one after the lower angle.
+	for (double angle = ceil(low / (MOTION_PI / 2)) * (MOTION_PI / 2); angle <= high; angle += MOTION_PI / 2)
+	{
+		int quadrant = ((int)floor(angle / (MOTION_PI / 2) + 0.5) % 4 + 4) % 4;
+
+		switch (quadrant)
+		{
+		case 0: bounds->max[0] = move->center[0] + move->radius; break;
+		case 1: bounds->max[1] = move->center[1] + move->radius; break;
+		case 2: bounds->min[0] = move->center[0] - move->radius; break;
+		case 3: bounds->min[1] = move->center[1] - move->radius; break;
+		}
+	}
+}
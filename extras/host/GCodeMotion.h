@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeMotion_h
+#define GCodeMotion_h
+
+#include "../../src/GCodeParser.h"
+
+/// <summary>
+/// The modal state a block runs in, enough to start parsing part way through a program.
+/// </summary>
+struct GCodeModalState
+{
+	double position[4];        // X, Y, Z and E in program units.
+	double feedRate;
+	unsigned char motion;      // Last motion command: 0, 1, 2 or 3.
+	unsigned char plane;       // 17, 18 or 19.
+	unsigned char workOffset;  // 54 to 59.
+	bool absolute;             // G90 (true) or G91.
+	bool absoluteExtrusion;    // M82 (true) or M83.
+	bool inches;               // G20 (true) or G21.
+	long tool;                 // Tool in use, -1 before the first tool change.
+	long selectedTool;         // Last T word, -1 before the first.
+};
+
+/// <summary>
+/// An axis aligned box. Empty when min is greater than max.
+/// </summary>
+struct GCodeBounds
+{
+	double min[3];
+	double max[3];
+};
+
+/// <summary>
+/// A move resolved against the modal state.
+/// </summary>
+struct GCodeMove
+{
+	double from[4];            // X, Y, Z and E before the block.
+	double to[4];              // X, Y, Z and E after the block.
+	double center[2];          // XY center of an arc.
+	double radius;             // Radius of an arc, 0 for a line.
+	double sweep;              // Angle of an arc in radians, positive counterclockwise.
+	unsigned char motion;      // 0 to 3, homing moves are 0.
+	unsigned long words;       // Letters on the block (GCODE_LETTER) of X, Y, Z, E, F, I, J, R and T.
+};
+
+/// <summary>
+/// Follows the modal state of a program block by block and resolves its moves (host only).
+/// </summary>
+/// <remark>
+/// Apply reads the G and M words of a parsed line (G0 to G3, G17 to G19, G20, G21, G54 to
+/// G59, G90, G91, G92, M82, M83 and M6) and the X, Y, Z, E, F and T words, updates state and
+/// resolves the move of the block if it has one. R arcs are resolved to their center.
+/// A tool change is taken at M6 with the selected tool, or at a T word while the program
+/// has not used M6 (printers change tools with T alone).
+///
+/// Limitations: arcs are assumed to be in the G17 (XY) plane, G28 is taken to move to 0,
+/// G10, G30, G53 and G4 blocks do not move and the position is assumed to start at 0,0,0.
+/// </remark>
+class GCodeMotion
+{
+public:
+	GCodeModalState state;
+	bool toolChangeSeen;       // M6 was seen.
+
+	GCodeMotion();
+	void Reset();
+
+	bool Apply(GCodeParser* parser, GCodeMove* move);
+
+	static void InitialState(GCodeModalState* state);
+	static void EmptyBounds(GCodeBounds* bounds);
+	static void MergeBounds(GCodeBounds* bounds, const GCodeBounds* other);
+	static bool Overlap(const GCodeBounds* a, const GCodeBounds* b);
+	static void MoveBounds(const GCodeMove* move, GCodeBounds* bounds);
+};
+
+#endif
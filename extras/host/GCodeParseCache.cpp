@@ -0,0 +1,327 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeParseCache.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+const int CACHE_PATH_SIZE = 4096;
+const char CACHE_LOCK_NAME[] = "lock";
+const char CACHE_TEMPORARY_PREFIX[] = "tmp.";
+const long CACHE_TEMPORARY_AGE = 3600; // Seconds before a temporary file is taken as abandoned.
+
+/// <summary>
+/// Class constructor. Creates the directory if needed.
+/// </summary>
+/// <param name="directory">The cache directory, which may be shared by several processes.</param>
+/// <param name="maxBytes">Size limit of the directory, 0 for no limit.</param>
+GCodeParseCache::GCodeParseCache(const char* directory, uint64_t maxBytes)
+{
+	this->directory = strdup(directory);
+	this->maxBytes = maxBytes;
+	hits = 0;
+	misses = 0;
+
+	mkdir(directory, 0777);
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeParseCache::~GCodeParseCache()
+{
+	free(directory);
+}
+
+/// <summary>
+/// Gets the key of some source bytes: their 64 bit FNV-1a hash and length in hex.
+/// </summary>
+/// <param name="key">Receives the key, CACHE_KEY_SIZE characters.</param>
+void GCodeParseCache::Key(const char* data, long length, char* key)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+
+	for (long i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 0x100000001B3ULL;
+	}
+
+	snprintf(key, CACHE_KEY_SIZE, "%016llx-%lx", (unsigned long long)hash, (unsigned long)length);
+}
+
+/// <summary>
+/// Gets the path of the entry for a key.
+/// </summary>
+bool GCodeParseCache::EntryPath(const char* key, char* path, int size) const
+{
+	return snprintf(path, size, "%s/%s", directory, key) < size;
+}
+
+/// <summary>
+/// Parses the source bytes and adds them to the cache.
+/// </summary>
+/// <returns>False if the source cannot be parsed or the entry written.</returns>
+bool GCodeParseCache::Store(const char* key, const char* data, long length)
+{
+	GCodeColumns columns;
+
+	if (!columns.ParseBuffer(data, length))
+		return false;
+
+	char temporary[CACHE_PATH_SIZE];
+	char path[CACHE_PATH_SIZE];
+
+	if (snprintf(temporary, sizeof(temporary), "%s/%sXXXXXX", directory, CACHE_TEMPORARY_PREFIX) >= (int)sizeof(temporary) ||
+		!EntryPath(key, path, sizeof(path)))
+		return false;
+
+	int fd = mkstemp(temporary);
+
+	if (fd < 0)
+		return false;
+
+	// mkstemp creates the file for its owner only, entries are shared with other users.
+	fchmod(fd, 0644);
+	close(fd);
+
+	// Another process storing the same program at the same time renames an identical file.
+	if (!columns.Dump(temporary) || rename(temporary, path) != 0)
+	{
+		unlink(temporary);
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Gets the parsed form of a program file, parsing and storing it on a miss.
+/// </summary>
+/// <param name="path">The G-Code file.</param>
+/// <param name="view">Receives the mapped columns.</param>
+/// <returns>False if the file cannot be read or parsed, or the entry cannot be mapped.</returns>
+bool GCodeParseCache::Open(const char* path, GCodeColumnsView* view)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+
+	if (fstat(fd, &status) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	if (status.st_size == 0)
+	{
+		close(fd);
+		return OpenBuffer("", 0, view);
+	}
+
+	void* data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	bool result = OpenBuffer((const char*)data, status.st_size, view);
+	munmap(data, status.st_size);
+
+	return result;
+}
+
+/// <summary>
+/// Gets the parsed form of a program held in memory, parsing and storing it on a miss.
+/// </summary>
+/// <param name="data">The program text.</param>
+/// <param name="length">The length of the program text.</param>
+/// <param name="view">Receives the mapped columns.</param>
+/// <returns>False if the program cannot be parsed or the entry cannot be mapped.</returns>
+bool GCodeParseCache::OpenBuffer(const char* data, long length, GCodeColumnsView* view)
+{
+	char key[CACHE_KEY_SIZE];
+	char path[CACHE_PATH_SIZE];
+
+	Key(data, length, key);
+
+	if (!EntryPath(key, path, sizeof(path)))
+		return false;
+
+	if (view->Map(path) && view->summary->sourceBytes == (uint64_t)length)
+	{
+		// Touching the entry moves it to the end of the LRU order.
+		utimensat(AT_FDCWD, path, NULL, 0);
+		hits++;
+
+		return true;
+	}
+
+	misses++;
+
+	if (!Store(key, data, length) || !view->Map(path))
+		return false;
+
+	// Evicting after mapping keeps the view even when the entry itself is evicted.
+	Evict();
+
+	return true;
+}
+
+struct CacheEntry
+{
+	char name[CACHE_KEY_SIZE];
+	uint64_t size;
+	struct timespec used;
+};
+
+static int CompareUsed(const void* a, const void* b)
+{
+	const struct timespec* first = &((const CacheEntry*)a)->used;
+	const struct timespec* second = &((const CacheEntry*)b)->used;
+
+	if (first->tv_sec != second->tv_sec)
+		return first->tv_sec < second->tv_sec ? -1 : 1;
+
+	if (first->tv_nsec != second->tv_nsec)
+		return first->tv_nsec < second->tv_nsec ? -1 : 1;
+
+	return 0;
+}
+
+/// <summary>
+/// Deletes the least recently used entries until the directory fits in maxBytes.
+/// </summary>
+/// <remark>
+/// Runs under an exclusive lock so processes evicting at the same time do not delete more
+/// than needed. Temporary files abandoned by a process that died while storing are deleted.
+/// </remark>
+/// <returns>False if the directory cannot be locked or read.</returns>
+bool GCodeParseCache::Evict()
+{
+	if (maxBytes == 0)
+		return true;
+
+	char path[CACHE_PATH_SIZE];
+
+	if (snprintf(path, sizeof(path), "%s/%s", directory, CACHE_LOCK_NAME) >= (int)sizeof(path))
+		return false;
+
+	int lock = open(path, O_RDWR | O_CREAT, 0666);
+
+	if (lock < 0)
+		return false;
+
+	while (flock(lock, LOCK_EX) != 0)
+	{
+		if (errno != EINTR)
+		{
+			close(lock);
+			return false;
+		}
+	}
+
+	DIR* folder = opendir(directory);
+	CacheEntry* entries = NULL;
+	long count = 0;
+	long capacity = 0;
+	uint64_t total = 0;
+	bool result = folder != NULL;
+	struct dirent* item;
+	time_t now = time(NULL);
+
+	while (result && (item = readdir(folder)) != NULL)
+	{
+		struct stat status;
+
+		if (item->d_name[0] == '.' || strcmp(item->d_name, CACHE_LOCK_NAME) == 0 ||
+			snprintf(path, sizeof(path), "%s/%s", directory, item->d_name) >= (int)sizeof(path) ||
+			stat(path, &status) != 0 || !S_ISREG(status.st_mode))
+			continue;
+
+		if (strncmp(item->d_name, CACHE_TEMPORARY_PREFIX, strlen(CACHE_TEMPORARY_PREFIX)) == 0)
+		{
+			if (now - status.st_mtime > CACHE_TEMPORARY_AGE)
+				unlink(path);
+
+			continue;
+		}
+
+		if (strlen(item->d_name) >= (size_t)CACHE_KEY_SIZE)
+			continue;
+
+		if (count == capacity)
+		{
+			long newCapacity = capacity == 0 ? 256 : capacity * 2;
+			CacheEntry* grown = (CacheEntry*)realloc(entries, newCapacity * sizeof(CacheEntry));
+
+			if (grown == NULL)
+			{
+				result = false;
+				break;
+			}
+
+			entries = grown;
+			capacity = newCapacity;
+		}
+
+		strcpy(entries[count].name, item->d_name);
+		entries[count].size = status.st_size;
+		entries[count].used = status.st_mtim;
+		total += status.st_size;
+		count++;
+	}
+
+	if (folder != NULL)
+		closedir(folder);
+
+	if (result && total > maxBytes)
+	{
+		qsort(entries, count, sizeof(CacheEntry), CompareUsed);
+
+		for (long i = 0; i < count && total > maxBytes; i++)
+		{
+			if (EntryPath(entries[i].name, path, sizeof(path)) && unlink(path) == 0)
+				total -= entries[i].size;
+		}
+	}
+
+	free(entries);
+	flock(lock, LOCK_UN);
+	close(lock);
+
+	return result;
+}
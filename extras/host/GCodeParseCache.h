@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeParseCache_h
+#define GCodeParseCache_h
+
+#include "GCodeColumns.h"
+#include <stdint.h>
+
+const int CACHE_KEY_SIZE = 40; // Hex hash, '-', hex length and null.
+
+/// <summary>
+/// Content addressed directory of parsed programs (host only).
+/// </summary>
+/// <remark>
+/// Entries are GCodeColumns dumps named by a 64 bit FNV-1a hash and the length of the source
+/// bytes, so the same program is parsed once whatever its name or who sends it. A hit is
+/// memory mapped into a GCodeColumnsView without running ParseLine.
+///
+/// Several processes can share a directory. Entries are written to a temporary file and
+/// renamed into place, so a reader sees a complete entry or none. A hit sets the entry's
+/// modification time, which is the LRU order. After a store, eviction runs under an exclusive
+/// flock on the directory's lock file and deletes the least recently used entries until the
+/// directory fits in maxBytes; views already mapped stay valid after their file is deleted.
+/// </remark>
+class GCodeParseCache
+{
+private:
+	char* directory;
+
+	bool EntryPath(const char* key, char* path, int size) const;
+	bool Store(const char* key, const char* data, long length);
+
+public:
+	uint64_t maxBytes;  // Size limit of the directory, 0 for no limit.
+	long hits;
+	long misses;
+
+	GCodeParseCache(const char* directory, uint64_t maxBytes);
+	~GCodeParseCache();
+
+	bool Open(const char* path, GCodeColumnsView* view);
+	bool OpenBuffer(const char* data, long length, GCodeColumnsView* view);
+	bool Evict();
+
+	static void Key(const char* data, long length, char* key);
+};
+
+#endif
@@ -0,0 +1,289 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeProgram.h"
+#include "../../src/GCodeArena.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t PROGRAM_REGION_ALIGNMENT = 4096;
+const size_t PROGRAM_ARENA_SIZE = 1 << 20;
+
+/// <summary>
+/// Rounds a size up to the region alignment.
+/// </summary>
+static size_t AlignRegion(size_t size)
+{
+	return (size + PROGRAM_REGION_ALIGNMENT - 1) & ~(PROGRAM_REGION_ALIGNMENT - 1);
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeProgram::GCodeProgram()
+{
+	reservation = NULL;
+	reservationSize = 0;
+	longLine = 0;
+	Free();
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeProgram::~GCodeProgram()
+{
+	Free();
+}
+
+/// <summary>
+/// Releases the program in one step.
+/// </summary>
+void GCodeProgram::Free()
+{
+	if (reservation != NULL)
+		munmap(reservation, reservationSize);
+
+	reservation = NULL;
+	reservationSize = 0;
+	maxBlocks = 0;
+	blocks = NULL;
+	words = NULL;
+	blockCount = 0;
+	wordCount = 0;
+	comments.Clear();
+}
+
+/// <summary>
+/// Reserves address space for the worst case program of a source length.
+/// </summary>
+/// <remark>
+/// A block needs a character and a line feed, so there are at most (n + 1) / 2 blocks; every
+/// word starts with a letter, so there are at most n words.
+/// </remark>
+bool GCodeProgram::Reserve(uint64_t sourceBytes)
+{
+	Free();
+
+	if (sourceBytes >= 0xFFFFFFF0ULL)
+		return false;
+
+	maxBlocks = sourceBytes / 2 + 2;
+
+	size_t headerBytes = AlignRegion(maxBlocks * sizeof(GCodeBlockHeader));
+	size_t wordBytes = AlignRegion((sourceBytes + 1) * sizeof(double));
+
+	reservationSize = headerBytes + wordBytes;
+
+	// Pages are only backed by memory once written, and read as zero until then.
+	void* memory = mmap(NULL, reservationSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	if (memory == MAP_FAILED)
+	{
+		reservationSize = 0;
+		return false;
+	}
+
+	reservation = (char*)memory;
+	blocks = (GCodeBlockHeader*)reservation;
+	words = (double*)(reservation + headerBytes);
+
+	return true;
+}
+
+/// <summary>
+/// Adds the parsed line as a block.
+/// </summary>
+bool GCodeProgram::AddBlock(GCodeParser* parser, long sourceLine)
+{
+	// An overflowed line parses as an empty block, which must not be taken for a blank line.
+	if (parser->lineStatus == GCODE_LINE_OVERFLOW)
+	{
+		longLine = sourceLine;
+		return false;
+	}
+
+	if (parser->line[0] == '\0' && parser->comments[0] == '\0')
+		return true;
+
+	if ((uint64_t)blockCount >= maxBlocks)
+		return false;
+
+	GCodeWords found;
+	GCodeBlockHeader* block = &blocks[blockCount];
+	long comment = parser->comments[0] != '\0' ? comments.Intern(parser->comments) : (long)PROGRAM_NO_COMMENT;
+
+	if (comment < 0)
+		return false;
+
+	block->present = parser->GetWords(GCODE_ALL_LETTERS, &found);
+	block->words = wordCount;
+	block->comment = (uint32_t)comment;
+	block->lineNumber = sourceLine;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (block->present & (1UL << i))
+			words[wordCount++] = found.value[i];
+	}
+
+	blockCount++;
+
+	return true;
+}
+
+/// <summary>
+/// Parses a program held in memory, replacing any program held.
+/// </summary>
+/// <param name="data">The program text.</param>
+/// <param name="length">The length of the program text.</param>
+/// <returns>False if the address space cannot be reserved or a line is too long (see longLine).</returns>
+bool GCodeProgram::ParseBuffer(const char* data, size_t length)
+{
+	longLine = 0;
+
+	void* memory = malloc(PROGRAM_ARENA_SIZE);
+
+	if (memory == NULL || !Reserve(length))
+	{
+		free(memory);
+		return false;
+	}
+
+	GCodeArena arena(memory, PROGRAM_ARENA_SIZE);
+	GCodeParser parser;
+	parser.lineArena = &arena;
+	long sourceLine = 1;
+	bool result = true;
+
+	for (size_t i = 0; i < length && result; i++)
+	{
+		if (parser.AddCharToLine(data[i]))
+		{
+			parser.ParseLine();
+			result = AddBlock(&parser, sourceLine);
+			sourceLine++;
+		}
+	}
+
+	if (result && !parser.completeLineIsAvailableToParse && (parser.line[0] != '\0' || parser.lineStatus == GCODE_LINE_OVERFLOW))
+	{
+		parser.AddCharToLine('\n');
+		parser.ParseLine();
+		result = AddBlock(&parser, sourceLine);
+	}
+
+	free(memory);
+
+	if (!result)
+		Free();
+
+	return result;
+}
+
+/// <summary>
+/// Parses a program file, replacing any program held.
+/// </summary>
+/// <param name="path">The G-Code file.</param>
+/// <returns>False if the file cannot be read, the address space cannot be reserved or a line is too long.</returns>
+bool GCodeProgram::ParseFile(const char* path)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+	bool result = fstat(fd, &status) == 0;
+
+	if (result && status.st_size == 0)
+		result = ParseBuffer("", 0);
+	else if (result)
+	{
+		void* data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data == MAP_FAILED)
+			result = false;
+		else
+		{
+			madvise(data, status.st_size, MADV_SEQUENTIAL);
+			result = ParseBuffer((const char*)data, status.st_size);
+			munmap(data, status.st_size);
+		}
+	}
+
+	close(fd);
+
+	return result;
+}
+
+/// <summary>
+/// Determine if a block has a word.
+/// </summary>
+bool GCodeProgram::HasWord(long block, char letter) const
+{
+	if (letter < 'A' || letter > 'Z' || block < 0 || block >= blockCount)
+		return false;
+
+	return (blocks[block].present & GCODE_LETTER(letter)) != 0;
+}
+
+/// <summary>
+/// Gets the value of a word on a block.
+/// </summary>
+/// <returns>The value or 0.0 if the block does not have the word.</returns>
+double GCodeProgram::GetWordValue(long block, char letter) const
+{
+	if (!HasWord(block, letter))
+		return 0.0;
+
+	const GCodeBlockHeader* header = &blocks[block];
+
+	// The values are in letter order, so the index is the number of letters before this one.
+	return words[header->words + __builtin_popcount(header->present & (GCODE_LETTER(letter) - 1))];
+}
+
+/// <summary>
+/// Gets the comment(s) of a block.
+/// </summary>
+/// <returns>The interned comment or an empty string if the block has none.</returns>
+const char* GCodeProgram::Comment(long block) const
+{
+	if (block < 0 || block >= blockCount || blocks[block].comment == PROGRAM_NO_COMMENT)
+		return "";
+
+	return comments.Text(blocks[block].comment);
+}
+
+/// <summary>
+/// Gets the bytes in use by the headers, the word table and the comment pool.
+/// </summary>
+size_t GCodeProgram::MemoryUsed() const
+{
+	return blockCount * sizeof(GCodeBlockHeader) + wordCount * sizeof(double) + comments.MemoryUsed();
+}
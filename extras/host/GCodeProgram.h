@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeProgram_h
+#define GCodeProgram_h
+
+#include "../../src/GCodeParser.h"
+#include "GCodeCommentPool.h"
+#include <stddef.h>
+#include <stdint.h>
+
+const uint32_t PROGRAM_NO_COMMENT = 0xFFFFFFFF; // Comment ID of a block without comments.
+
+/// <summary>
+/// The fixed size header of a block in a GCodeProgram.
+/// </summary>
+struct GCodeBlockHeader
+{
+	uint32_t present;     // Letter mask (GCODE_LETTER) of the words on the block.
+	uint32_t words;       // Index in the word table of the block's first value.
+	uint32_t comment;     // ID of the comment(s) in the comment pool or PROGRAM_NO_COMMENT.
+	uint32_t lineNumber;  // Source line number.
+};
+
+/// <summary>
+/// A whole parsed program held in one contiguous reservation (host only).
+/// </summary>
+/// <remark>
+/// The reservation is sized from the source length before parsing starts: one mmap of address
+/// space big enough for the worst case of both regions, of which only the pages written are
+/// backed by memory. It holds, in order:
+///   block headers     16 bytes per block (lines with words or comments, blank lines are skipped),
+///   the word table    the values of each block's words in letter order, one double per word.
+/// Comments are interned in a GCodeCommentPool, so each distinct comment is kept once and
+/// blocks hold its ID. Nothing is allocated per block and Free releases the reservation
+/// with a single munmap. Lines longer than MAX_LINE_SIZE are parsed in an arena of
+/// PROGRAM_ARENA_SIZE bytes; a line longer than that fails the parse with its number in
+/// longLine rather than being dropped.
+/// Iterating blocks walks the headers and the word table forwards in step.
+///
+///   for (long i = 0; i &lt; program.blockCount; i++)
+///     if (program.HasWord(i, 'X'))
+///       x = program.GetWordValue(i, 'X');
+/// </remark>
+class GCodeProgram
+{
+private:
+	char* reservation;
+	size_t reservationSize;
+	uint64_t maxBlocks;
+
+	bool Reserve(uint64_t sourceBytes);
+	bool AddBlock(GCodeParser* parser, long sourceLine);
+
+public:
+	GCodeBlockHeader* blocks;
+	double* words;
+	GCodeCommentPool comments;
+	long blockCount;
+	long wordCount;
+	long longLine;        // Source line too long to parse which failed the last parse, 0 if none.
+
+	GCodeProgram();
+	~GCodeProgram();
+
+	GCodeProgram(const GCodeProgram&) = delete;
+	GCodeProgram& operator=(const GCodeProgram&) = delete;
+
+	bool ParseFile(const char* path);
+	bool ParseBuffer(const char* data, size_t length);
+	void Free();
+
+	bool HasWord(long block, char letter) const;
+	double GetWordValue(long block, char letter) const;
+	const char* Comment(long block) const;
+	size_t MemoryUsed() const;
+};
+
+#endif
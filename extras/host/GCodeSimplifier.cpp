@@ -0,0 +1,433 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeSimplifier.h"
+#include "../../src/GCodeWriter.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int SIMPLIFY_READ_SIZE = 65536;
+const int SIMPLIFY_MIN_WINDOW = 3;
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeSimplifier::GCodeSimplifier()
+{
+	window = NULL;
+	keep = NULL;
+	stack = NULL;
+	count = 0;
+	out = NULL;
+	result = true;
+	tolerance = 0.01;
+	extrusionTolerance = 0.05;
+	windowSize = 256;
+	precision = 5;
+	blocksIn = 0;
+	blocksOut = 0;
+	movesRemoved = 0;
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeSimplifier::~GCodeSimplifier()
+{
+	free(window);
+	free(keep);
+	free(stack);
+}
+
+/// <summary>
+/// Starts a program.
+/// </summary>
+/// <param name="out">Receives the simplified program.</param>
+/// <returns>False if out of memory.</returns>
+bool GCodeSimplifier::Begin(FILE* out)
+{
+	if (windowSize < SIMPLIFY_MIN_WINDOW)
+		windowSize = SIMPLIFY_MIN_WINDOW;
+
+	free(window);
+	free(keep);
+	free(stack);
+
+	window = (Point*)malloc(windowSize * sizeof(Point));
+	keep = (bool*)malloc(windowSize * sizeof(bool));
+	stack = (int*)malloc(2 * windowSize * sizeof(int));
+
+	this->out = out;
+	motion.Reset();
+	memset(emitted, 0, sizeof(emitted));
+	count = 0;
+	blocksIn = 0;
+	blocksOut = 0;
+	movesRemoved = 0;
+	result = window != NULL && keep != NULL && stack != NULL;
+
+	return result;
+}
+
+/// <summary>
+/// Determine if a parsed line is a G1 move that may be merged, before it is applied.
+/// </summary>
+bool GCodeSimplifier::Mergeable(GCodeParser* parser) const
+{
+	if (parser->comments[0] != '\0')
+		return false;
+
+	const char* code = parser->line;
+	bool command = false;
+	bool axis = false;
+
+	for (int pointer = 0; code[pointer] != '\0';)
+	{
+		char letter = code[pointer];
+		double value;
+		int count = GCodeParser::ParseNumber(&code[pointer + 1], &value);
+
+		if (count == 0 || strchr("GXYZEF", letter) == NULL)
+			return false;
+
+		switch (letter)
+		{
+		case 'G':
+			if (value != 1.0 || command)
+				return false;
+
+			command = true;
+			break;
+
+		case 'F':
+			// A new feed rate is a modal change.
+			if (value != motion.state.feedRate)
+				return false;
+
+			break;
+
+		case 'X':
+		case 'Y':
+			axis = true;
+			break;
+		}
+
+		pointer += 1 + count;
+	}
+
+	return axis && (command || motion.state.motion == 1);
+}
+
+/// <summary>
+/// Marks the points of the window that are kept (Douglas-Peucker).
+/// </summary>
+void GCodeSimplifier::Simplify()
+{
+	for (int i = 0; i < count; i++)
+		keep[i] = false;
+
+	keep[0] = true;
+	keep[count - 1] = true;
+
+	int depth = 0;
+	stack[depth++] = 0;
+	stack[depth++] = count - 1;
+
+	while (depth > 0)
+	{
+		int last = stack[--depth];
+		int first = stack[--depth];
+		const double* a = window[first].position;
+		const double* b = window[last].position;
+		double chord[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		double length = chord[0] * chord[0] + chord[1] * chord[1] + chord[2] * chord[2];
+		double farthest = 0.0;
+		int index = -1;
+
+		for (int i = first + 1; i < last; i++)
+		{
+			const double* p = window[i].position;
+			double offset[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+			double t = length > 0.0 ? (offset[0] * chord[0] + offset[1] * chord[1] + offset[2] * chord[2]) / length : 0.0;
+
+			t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+
+			double distance = 0.0;
+
+			for (int k = 0; k < 3; k++)
+				distance += (offset[k] - t * chord[k]) * (offset[k] - t * chord[k]);
+
+			if (distance > farthest)
+			{
+				farthest = distance;
+				index = i;
+			}
+		}
+
+		if (index >= 0 && farthest > tolerance * tolerance)
+		{
+			keep[index] = true;
+			stack[depth++] = first;
+			stack[depth++] = index;
+			stack[depth++] = index;
+			stack[depth++] = last;
+		}
+	}
+}
+
+/// <summary>
+/// Rounds a value to decimal places, so relative moves add up to what was written.
+/// </summary>
+static double RoundValue(double value, int decimals)
+{
+	if (decimals < 0)
+		return value;
+
+	double scale = pow(10.0, decimals);
+
+	return round(value * scale) / scale;
+}
+
+/// <summary>
+/// Writes a merged G1 move to a point.
+/// </summary>
+bool GCodeSimplifier::WriteMove(const double* to)
+{
+	GCodeWriter writer(line, sizeof(line));
+	writer.precision = precision;
+	writer.Begin();
+	writer.AddCommand('G', 1, -1);
+
+	const char letters[4] = { 'X', 'Y', 'Z', 'E' };
+
+	for (int a = 0; a < 4; a++)
+	{
+		// X and Y are always written, Z and E when they change.
+		if (a >= 2 && to[a] == emitted[a])
+			continue;
+
+		bool absolute = motion.state.absolute && (a < 3 || motion.state.absoluteExtrusion);
+		double value = RoundValue(absolute ? to[a] : to[a] - emitted[a], precision);
+
+		writer.AddWord(letters[a], value);
+		emitted[a] = absolute ? value : emitted[a] + value;
+	}
+
+	writer.End();
+	blocksOut++;
+
+	return fwrite(writer.Text(), 1, writer.Length(), out) == (size_t)writer.Length();
+}
+
+/// <summary>
+/// Simplifies the window and writes the points kept, leaving the last point as the start
+/// of the next window.
+/// </summary>
+bool GCodeSimplifier::Flush()
+{
+	if (count < 2)
+		return result;
+
+	Simplify();
+
+	for (int i = 1; i < count && result; i++)
+	{
+		if (keep[i])
+			result = WriteMove(window[i].position);
+		else
+			movesRemoved++;
+	}
+
+	window[0] = window[count - 1];
+	count = 1;
+
+	return result;
+}
+
+/// <summary>
+/// Adds a parsed line.
+/// </summary>
+/// <param name="parser">The parser after ParseLine.</param>
+/// <returns>False if the output cannot be written.</returns>
+bool GCodeSimplifier::AddBlock(GCodeParser* parser)
+{
+	if (!result)
+		return false;
+
+	if (parser->line[0] == '\0' && parser->comments[0] == '\0')
+		return true;
+
+	blocksIn++;
+
+	bool mergeable = Mergeable(parser);
+
+	// The run is written in the modal state it was collected in.
+	if (!mergeable)
+	{
+		Flush();
+		count = 0;
+	}
+
+	GCodeMove move;
+	bool moved = motion.Apply(parser, &move);
+
+	if (mergeable && moved)
+	{
+		double x = move.to[0] - move.from[0];
+		double y = move.to[1] - move.from[1];
+		double z = move.to[2] - move.from[2];
+		double length = sqrt(x * x + y * y + z * z);
+		double e = move.to[3] - move.from[3];
+		double moveRate = length > 0.0 ? e / length : 0.0;
+
+		if (length > 0.0)
+		{
+			// Extruding and travel moves, or different extrusion rates, are separate runs.
+			if (count > 1 && ((e != 0.0) != extruding || fabs(moveRate - rate) > extrusionTolerance * fabs(rate)))
+				Flush();
+
+			if (count == 0)
+			{
+				memcpy(window[0].position, move.from, sizeof(window[0].position));
+				count = 1;
+			}
+
+			if (count == 1)
+			{
+				extruding = e != 0.0;
+				rate = moveRate;
+			}
+
+			memcpy(window[count++].position, move.to, sizeof(window[0].position));
+
+			if (count == windowSize)
+				Flush();
+
+			return result;
+		}
+
+		Flush();
+		count = 0;
+	}
+
+	GCodeWriter writer(line, sizeof(line));
+	writer.precision = GCODE_SHORTEST;
+	writer.Begin();
+	writer.AddBlock(parser);
+	writer.End();
+	blocksOut++;
+
+	memcpy(emitted, motion.state.position, sizeof(emitted));
+	result = fwrite(writer.Text(), 1, writer.Length(), out) == (size_t)writer.Length();
+
+	return result;
+}
+
+/// <summary>
+/// Writes the rest of the last run.
+/// </summary>
+/// <returns>False if the output could not be written.</returns>
+bool GCodeSimplifier::End()
+{
+	Flush();
+	count = 0;
+
+	return result && !ferror(out);
+}
+
+/// <summary>
+/// Simplifies a program read from a stream.
+/// </summary>
+/// <param name="in">The program to simplify.</param>
+/// <param name="out">Receives the simplified program.</param>
+/// <returns>False if a stream cannot be read or written.</returns>
+bool GCodeSimplifier::SimplifyStream(FILE* in, FILE* out)
+{
+	char* buffer = (char*)malloc(SIMPLIFY_READ_SIZE);
+
+	if (buffer == NULL || !Begin(out))
+	{
+		free(buffer);
+		return false;
+	}
+
+	GCodeParser parser;
+	size_t length;
+
+	while (result && (length = fread(buffer, 1, SIMPLIFY_READ_SIZE, in)) > 0)
+	{
+		for (size_t n = 0; n < length && result; n++)
+		{
+			if (parser.AddCharToLine(buffer[n]))
+			{
+				parser.ParseLine();
+				AddBlock(&parser);
+			}
+		}
+	}
+
+	// A last line without a line feed.
+	if (result && !parser.completeLineIsAvailableToParse && parser.line[0] != '\0')
+	{
+		parser.AddCharToLine('\n');
+		parser.ParseLine();
+		AddBlock(&parser);
+	}
+
+	free(buffer);
+
+	return End() && !ferror(in);
+}
+
+/// <summary>
+/// Simplifies a program file.
+/// </summary>
+/// <param name="inPath">The program to simplify.</param>
+/// <param name="outPath">The file to create.</param>
+/// <returns>False if a file cannot be read or written.</returns>
+bool GCodeSimplifier::SimplifyFile(const char* inPath, const char* outPath)
+{
+	FILE* in = fopen(inPath, "rb");
+
+	if (in == NULL)
+		return false;
+
+	FILE* out = fopen(outPath, "wb");
+
+	if (out == NULL)
+	{
+		fclose(in);
+		return false;
+	}
+
+	bool success = SimplifyStream(in, out);
+
+	if (fclose(out) != 0)
+		success = false;
+
+	fclose(in);
+
+	return success;
+}
@@ -0,0 +1,102 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeSimplifier_h
+#define GCodeSimplifier_h
+
+#include "GCodeMotion.h"
+#include <stdio.h>
+
+const int SIMPLIFY_LINE_SIZE = 256; // Output line buffer.
+
+/// <summary>
+/// Merges runs of short G1 moves that stay within a chord tolerance of fewer, longer moves
+/// and re-emits the program through a GCodeWriter (host only).
+/// </summary>
+/// <remark>
+/// A block can be merged when it is a G1 move in X and Y (Z and E optional) with no other
+/// words, no comments and the feed rate of the run. Consecutive mergeable blocks collect in
+/// a window of at most windowSize points which is simplified with Douglas-Peucker: a point
+/// is dropped when it is within tolerance of the chord that replaces it, the run's ends are
+/// always kept. Extruding and travel moves are never merged with each other and an
+/// extruding run is broken where the extrusion per unit of length changes by more than
+/// extrusionTolerance, so each merged move carries the E of the moves it replaces in
+/// proportion to its length. E is written as positions or amounts, as the program uses.
+///
+/// Any other block (a modal change, a comment, a tool change, an arc or a G0) ends the run
+/// and is written unchanged (reformatted by GCodeWriter::AddBlock). Blank lines are dropped.
+///
+///   GCodeSimplifier simplifier;
+///   simplifier.tolerance = 0.02;
+///   simplifier.SimplifyFile("part.gcode", "part-simple.gcode");
+/// </remark>
+class GCodeSimplifier
+{
+private:
+	struct Point
+	{
+		double position[4];
+	};
+
+	GCodeMotion motion;
+	Point* window;
+	bool* keep;
+	int* stack;
+	int count;
+	bool extruding;
+	double rate;               // E per unit of length of the run.
+	double emitted[4];         // Position after the last line written.
+	FILE* out;
+	char line[SIMPLIFY_LINE_SIZE];
+	bool result;
+
+	bool Mergeable(GCodeParser* parser) const;
+	void Simplify();
+	bool WriteMove(const double* to);
+	bool Flush();
+
+public:
+	double tolerance;          // Largest distance of a dropped point from its chord (default 0.01).
+	double extrusionTolerance; // Largest relative change of E per length in a run (default 0.05).
+	int windowSize;            // Points simplified at a time (default 256).
+	int precision;             // Decimal places of merged moves (default 5).
+	long blocksIn;
+	long blocksOut;
+	long movesRemoved;
+
+	GCodeSimplifier();
+	~GCodeSimplifier();
+
+	GCodeSimplifier(const GCodeSimplifier&) = delete;
+	GCodeSimplifier& operator=(const GCodeSimplifier&) = delete;
+
+	bool Begin(FILE* out);
+	bool AddBlock(GCodeParser* parser);
+	bool End();
+
+	bool SimplifyStream(FILE* in, FILE* out);
+	bool SimplifyFile(const char* inPath, const char* outPath);
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeSimulator.h"
+#include "GCodeStreamer.h"
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const int SIMULATOR_READ_SIZE = 4096; // Characters read from the host at a time.
+const double SIMULATOR_IDLE_WAIT = 0.1; // Seconds to wait for input when nothing is due.
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeControllerSimulator::GCodeControllerSimulator()
+{
+	replyHead = 0;
+	replyCount = 0;
+
+	rxBufferSize = GRBL_RX_BUFFER_SIZE;
+	processingDelay = 0;
+	responseDelay = 0;
+	dialect = NULL;
+	stop = false;
+
+	linesProcessed = 0;
+	errors = 0;
+	overflows = 0;
+	mostBuffered = 0;
+}
+
+/// <summary>
+/// Sends the replies which are due.
+/// </summary>
+/// <returns>False if the host has gone.</returns>
+bool GCodeControllerSimulator::SendReplies(int fd, double now)
+{
+	while (replyCount > 0 && replyTime[replyHead] <= now)
+	{
+		const char* text = replyError[replyHead] ? "error:20\r\n" : "ok\r\n";
+
+		if (write(fd, text, strlen(text)) < 0 && errno != EINTR)
+			return false;
+
+		replyHead = (replyHead + 1) % SIMULATOR_MAX_REPLIES;
+		replyCount--;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Simulates the controller until the host closes the connection or stop is set.
+/// </summary>
+/// <param name="fd">The controller side of the connection, i.e. a pseudo-terminal master.</param>
+/// <returns>False on a read or write error.</returns>
+bool GCodeControllerSimulator::Run(int fd)
+{
+	GCodeParser parser = GCodeParser(dialect);
+	char rx[SIMULATOR_READ_SIZE];
+	int buffered = 0;
+	double busyUntil = 0;
+
+	while (!stop)
+	{
+		double now = GCodeStreamer::Now();
+		char* lineEnd = (char*)memchr(rx, '\n', buffered);
+
+		// Take the next line from the receive buffer when the last one is done.
+		if (lineEnd != NULL && now >= busyUntil && replyCount < SIMULATOR_MAX_REPLIES)
+		{
+			int length = lineEnd - rx + 1;
+
+			for (int i = 0; i < length; i++)
+				parser.AddCharToLine(rx[i]);
+
+			parser.ParseLine();
+
+			bool error = dialect != NULL && parser.Validate() != GCODE_VALID;
+
+			memmove(rx, rx + length, buffered - length);
+			buffered -= length;
+
+			busyUntil = now + processingDelay / 1e6;
+
+			int tail = (replyHead + replyCount) % SIMULATOR_MAX_REPLIES;
+			replyTime[tail] = busyUntil + responseDelay / 1e6;
+			replyError[tail] = error;
+			replyCount++;
+
+			linesProcessed++;
+
+			if (error)
+				errors++;
+
+			continue;
+		}
+
+		if (!SendReplies(fd, now))
+			return false;
+
+		// Sleep until input arrives or the next reply or line is due.
+		double next = now + SIMULATOR_IDLE_WAIT;
+
+		if (replyCount > 0 && replyTime[replyHead] < next)
+			next = replyTime[replyHead];
+
+		if (lineEnd != NULL && busyUntil < next)
+			next = busyUntil;
+
+		double wait = next > now ? next - now : 0;
+		struct timespec timeout;
+		timeout.tv_sec = (time_t)wait;
+		timeout.tv_nsec = (long)((wait - timeout.tv_sec) * 1e9);
+
+		struct pollfd waitFor;
+		waitFor.fd = fd;
+		waitFor.events = POLLIN;
+		waitFor.revents = 0;
+
+		int ready = ppoll(&waitFor, 1, &timeout, NULL);
+
+		if (ready < 0 && errno != EINTR)
+			return false;
+
+		if (ready <= 0)
+			continue;
+
+		// A line longer than the whole read buffer can never be taken, drop it.
+		if (buffered == SIMULATOR_READ_SIZE)
+		{
+			overflows += buffered;
+			buffered = 0;
+		}
+
+		ssize_t count = read(fd, rx + buffered, SIMULATOR_READ_SIZE - buffered);
+
+		// A pseudo-terminal master reads EIO once the host closes its side.
+		if (count == 0 || (count < 0 && errno == EIO))
+			break;
+
+		if (count < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+
+			return false;
+		}
+
+		int before = buffered;
+		buffered += count;
+
+		if (buffered > rxBufferSize)
+			overflows += buffered - (before > rxBufferSize ? before : rxBufferSize);
+
+		if (buffered > mostBuffered)
+			mostBuffered = buffered;
+	}
+
+	return true;
+}
@@ -0,0 +1,71 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeSimulator_h
+#define GCodeSimulator_h
+
+#include "../../src/GCodeParser.h"
+
+const int SIMULATOR_MAX_REPLIES = 256; // Replies which can wait for their response delay.
+
+/// <summary>
+/// A stand-in for a controller running GCodeParser, for testing streaming hosts without hardware (Linux host only).
+/// </summary>
+/// <remark>
+/// Run reads G-Code from a file descriptor, normally the master side of a pseudo-terminal,
+/// into a receive buffer of rxBufferSize characters. Lines are taken from the buffer one at
+/// a time with AddCharToLine and ParseLine, each keeping the controller busy for
+/// processingDelay microseconds. When a line is processed it is answered with ok, or with
+/// error:20 when a dialect is set and rejects the line. The answer is sent responseDelay
+/// microseconds later, which models USB serial latency. Characters received while the
+/// buffer is full are counted as overflows: a real controller would lose them.
+/// </remark>
+class GCodeControllerSimulator
+{
+private:
+	double replyTime[SIMULATOR_MAX_REPLIES];
+	bool replyError[SIMULATOR_MAX_REPLIES];
+	int replyHead;
+	int replyCount;
+
+	bool SendReplies(int fd, double now);
+
+public:
+	int rxBufferSize;       // Receive buffer size (default GRBL_RX_BUFFER_SIZE, 128).
+	long processingDelay;   // Microseconds each line keeps the controller busy.
+	long responseDelay;     // Microseconds before a reply reaches the host.
+	const GCodeDialect* dialect;
+	volatile bool stop;     // Set from another thread to end Run.
+
+	long linesProcessed;
+	long errors;
+	long overflows;         // Characters which did not fit in the receive buffer.
+	int mostBuffered;       // The most characters waiting in the receive buffer.
+
+	GCodeControllerSimulator();
+
+	bool Run(int fd);
+};
+
+#endif
@@ -0,0 +1,596 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeSpatialIndex.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const double SPATIAL_ARC_PIECE = 3.14159265358979323846 / 8;
+const long SPATIAL_INITIAL_CAPACITY = 4096;
+const long SPATIAL_CHUNK = 65536;      // Segments or cells taken by a build thread at a time.
+const size_t SPATIAL_READ_SIZE = 1 << 20;
+
+/// <summary>
+/// Rounds a value down to a float.
+/// </summary>
+static float FloatBelow(double value)
+{
+	float result = (float)value;
+
+	return result > value ? nextafterf(result, -HUGE_VALF) : result;
+}
+
+/// <summary>
+/// Rounds a value up to a float.
+/// </summary>
+static float FloatAbove(double value)
+{
+	float result = (float)value;
+
+	return result < value ? nextafterf(result, HUGE_VALF) : result;
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeSpatialIndex::GCodeSpatialIndex()
+{
+	segments = NULL;
+	cellStart = NULL;
+	cellSegments = NULL;
+	Clear();
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeSpatialIndex::~GCodeSpatialIndex()
+{
+	Clear();
+}
+
+/// <summary>
+/// Frees the index and starts a new one.
+/// </summary>
+void GCodeSpatialIndex::Clear()
+{
+	free(segments);
+	free(cellStart);
+	free(cellSegments);
+
+	parser.Initialize();
+	motion.Reset();
+	segments = NULL;
+	segmentCount = 0;
+	segmentCapacity = 0;
+	lineNumber = 1;
+	cellStart = NULL;
+	cellSegments = NULL;
+	columns = 0;
+	rows = 0;
+	cellSize = 0.0;
+	origin[0] = origin[1] = 0.0;
+	GCodeMotion::EmptyBounds(&bounds);
+}
+
+/// <summary>
+/// Adds the box of a straight segment.
+/// </summary>
+bool GCodeSpatialIndex::AddSegment(const double* from, const double* to, long block)
+{
+	if (segmentCount == segmentCapacity)
+	{
+		long newCapacity = segmentCapacity == 0 ? SPATIAL_INITIAL_CAPACITY : segmentCapacity * 2;
+		GCodeSegment* grown = (GCodeSegment*)realloc(segments, newCapacity * sizeof(GCodeSegment));
+
+		if (grown == NULL)
+			return false;
+
+		segments = grown;
+		segmentCapacity = newCapacity;
+	}
+
+	GCodeSegment* segment = &segments[segmentCount++];
+	segment->block = (uint32_t)block;
+
+	for (int a = 0; a < 3; a++)
+	{
+		double low = from[a] < to[a] ? from[a] : to[a];
+		double high = from[a] > to[a] ? from[a] : to[a];
+
+		segment->min[a] = FloatBelow(low);
+		segment->max[a] = FloatAbove(high);
+
+		if (low < bounds.min[a])
+			bounds.min[a] = low;
+
+		if (high > bounds.max[a])
+			bounds.max[a] = high;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Adds a move resolved by GCodeMotion.
+/// </summary>
+/// <param name="move">The move.</param>
+/// <param name="block">Its block ID.</param>
+/// <returns>False if out of memory.</returns>
+bool GCodeSpatialIndex::AddMove(const GCodeMove* move, long block)
+{
+	if (move->radius <= 0.0)
+		return AddSegment(move->from, move->to, block);
+
+	// Break the arc at multiples of the piece angle, which include the axis extremes.
+	double start = atan2(move->from[1] - move->center[1], move->from[0] - move->center[0]);
+	double end = start + move->sweep;
+	double direction = move->sweep < 0.0 ? -1.0 : 1.0;
+	double angle = direction > 0.0 ? floor(start / SPATIAL_ARC_PIECE) * SPATIAL_ARC_PIECE :
+		ceil(start / SPATIAL_ARC_PIECE) * SPATIAL_ARC_PIECE;
+	double from[3] = { move->from[0], move->from[1], move->from[2] };
+
+	while (true)
+	{
+		angle += direction * SPATIAL_ARC_PIECE;
+
+		// The last piece ends at the programmed end point.
+		if ((end - angle) * direction <= 1e-12)
+			return AddSegment(from, move->to, block);
+
+		double to[3];
+		to[0] = move->center[0] + move->radius * cos(angle);
+		to[1] = move->center[1] + move->radius * sin(angle);
+		to[2] = move->from[2] + (move->to[2] - move->from[2]) * (angle - start) / move->sweep;
+
+		if (!AddSegment(from, to, block))
+			return false;
+
+		memcpy(from, to, sizeof(from));
+	}
+}
+
+/// <summary>
+/// Adds the move of a parsed line.
+/// </summary>
+/// <param name="parser">The parser after ParseLine.</param>
+/// <param name="block">The block ID reported by Query.</param>
+/// <returns>False if out of memory.</returns>
+bool GCodeSpatialIndex::AddBlock(GCodeParser* parser, long block)
+{
+	GCodeMove move;
+
+	if (!motion.Apply(parser, &move))
+		return true;
+
+	return AddMove(&move, block);
+}
+
+/// <summary>
+/// Adds program bytes, parsing each line as it is completed. Block IDs are line numbers.
+/// </summary>
+/// <returns>False if out of memory.</returns>
+bool GCodeSpatialIndex::Add(const char* bytes, size_t length)
+{
+	while (length > 0)
+	{
+		int chunk = length > 0x40000000 ? 0x40000000 : (int)length;
+		int taken = parser.AddCharsToLine(bytes, chunk);
+
+		bytes += taken;
+		length -= taken;
+
+		if (parser.completeLineIsAvailableToParse)
+		{
+			parser.ParseLine();
+
+			if (!AddBlock(&parser, lineNumber))
+				return false;
+
+			lineNumber++;
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Adds a program held in memory. Block IDs are line numbers.
+/// </summary>
+/// <returns>False if out of memory.</returns>
+bool GCodeSpatialIndex::ParseBuffer(const char* data, size_t length)
+{
+	return Add(data, length);
+}
+
+/// <summary>
+/// Adds a program file, read in chunks. Block IDs are line numbers.
+/// </summary>
+/// <returns>False if the file cannot be read or memory runs out.</returns>
+bool GCodeSpatialIndex::ParseFile(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	char* buffer = (char*)malloc(SPATIAL_READ_SIZE);
+	bool result = file != NULL && buffer != NULL;
+	size_t count;
+
+	while (result && (count = fread(buffer, 1, SPATIAL_READ_SIZE, file)) > 0)
+		result = Add(buffer, count);
+
+	if (result && ferror(file))
+		result = false;
+
+	if (file != NULL)
+		fclose(file);
+
+	free(buffer);
+
+	return result;
+}
+
+/// <summary>
+/// Gets the cells under a box, clamped to the grid.
+/// </summary>
+/// <param name="first">Receives the first column and row.</param>
+/// <param name="last">Receives the last column and row.</param>
+void GCodeSpatialIndex::CellRange(const float* min, const float* max, long* first, long* last) const
+{
+	const long limit[2] = { columns - 1, rows - 1 };
+
+	for (int a = 0; a < 2; a++)
+	{
+		double low = floor((min[a] - origin[a]) / cellSize);
+		double high = floor((max[a] - origin[a]) / cellSize);
+
+		first[a] = low < 0.0 ? 0 : low > limit[a] ? limit[a] : (long)low;
+		last[a] = high < 0.0 ? 0 : high > limit[a] ? limit[a] : (long)high;
+	}
+}
+
+enum SpatialPhase
+{
+	SPATIAL_COUNT,
+	SPATIAL_FILL,
+	SPATIAL_SORT
+};
+
+struct SpatialBuild
+{
+	GCodeSpatialIndex* index;
+	SpatialPhase phase;
+	uint32_t* cursor;
+	long next;
+
+	static void* Worker(void* argument);
+	void Run(int threads, SpatialPhase phase);
+};
+
+/// <summary>
+/// Takes chunks of segments (or cells) until none are left.
+/// </summary>
+void* SpatialBuild::Worker(void* argument)
+{
+	SpatialBuild* build = (SpatialBuild*)argument;
+	GCodeSpatialIndex* index = build->index;
+	long cells = index->columns * index->rows;
+	long total = build->phase == SPATIAL_SORT ? cells : index->segmentCount;
+
+	while (true)
+	{
+		long begin = __atomic_fetch_add(&build->next, SPATIAL_CHUNK, __ATOMIC_RELAXED);
+
+		if (begin >= total)
+			break;
+
+		long end = begin + SPATIAL_CHUNK < total ? begin + SPATIAL_CHUNK : total;
+
+		for (long i = begin; i < end; i++)
+		{
+			if (build->phase == SPATIAL_SORT)
+			{
+				// Insertion sort, cells hold a few segments and mostly in order already.
+				uint32_t* list = index->cellSegments + index->cellStart[i];
+				long count = index->cellStart[i + 1] - index->cellStart[i];
+
+				for (long j = 1; j < count; j++)
+				{
+					uint32_t value = list[j];
+					long k = j;
+
+					for (; k > 0 && list[k - 1] > value; k--)
+						list[k] = list[k - 1];
+
+					list[k] = value;
+				}
+
+				continue;
+			}
+
+			long first[2];
+			long last[2];
+			index->CellRange(index->segments[i].min, index->segments[i].max, first, last);
+
+			for (long row = first[1]; row <= last[1]; row++)
+			{
+				for (long column = first[0]; column <= last[0]; column++)
+				{
+					long cell = row * index->columns + column;
+
+					if (build->phase == SPATIAL_COUNT)
+						__atomic_fetch_add(&index->cellStart[cell + 1], 1U, __ATOMIC_RELAXED);
+					else
+						index->cellSegments[__atomic_fetch_add(&build->cursor[cell], 1U, __ATOMIC_RELAXED)] = (uint32_t)i;
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/// <summary>
+/// Runs a phase on the calling thread and up to threads - 1 more.
+/// </summary>
+void SpatialBuild::Run(int threads, SpatialPhase phase)
+{
+	this->phase = phase;
+	next = 0;
+
+	pthread_t* workers = threads > 1 ? (pthread_t*)malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+	int started = 0;
+
+	// Threads that cannot be started leave their chunks to the others.
+	while (workers != NULL && started < threads - 1 && pthread_create(&workers[started], NULL, Worker, this) == 0)
+		started++;
+
+	Worker(this);
+
+	for (int i = 0; i < started; i++)
+		pthread_join(workers[i], NULL);
+
+	free(workers);
+}
+
+/// <summary>
+/// Sorts the segments added so far into the grid.
+/// </summary>
+/// <param name="threads">The number of threads, including the calling thread.</param>
+/// <returns>False if out of memory or there are more than 2^32 cell entries.</returns>
+bool GCodeSpatialIndex::Build(int threads)
+{
+	free(cellStart);
+	free(cellSegments);
+	cellStart = NULL;
+	cellSegments = NULL;
+	columns = rows = 0;
+
+	// A last line added without a line feed.
+	if (parser.line[0] != '\0' && !parser.completeLineIsAvailableToParse && !Add("\n", 1))
+		return false;
+
+	long target = segmentCount / 2 > 1 ? segmentCount / 2 : 1;
+	double width = segmentCount > 0 ? bounds.max[0] - bounds.min[0] : 0.0;
+	double height = segmentCount > 0 ? bounds.max[1] - bounds.min[1] : 0.0;
+	double extent = 0.0;
+
+	for (long i = 0; i < segmentCount; i++)
+	{
+		double x = segments[i].max[0] - segments[i].min[0];
+		double y = segments[i].max[1] - segments[i].min[1];
+		extent += x > y ? x : y;
+	}
+
+	// About two segments per cell, but not smaller than the average segment.
+	cellSize = sqrt(width * height / target);
+
+	if (segmentCount > 0 && cellSize < extent / segmentCount)
+		cellSize = extent / segmentCount;
+
+	if (cellSize <= 0.0)
+		cellSize = width > height ? width : height > 0.0 ? height : 1.0;
+
+	while (true)
+	{
+		columns = (long)(width / cellSize) + 1;
+		rows = (long)(height / cellSize) + 1;
+
+		if ((double)columns * rows <= 4.0 * target + 16)
+			break;
+
+		cellSize *= 1.5;
+	}
+
+	origin[0] = segmentCount > 0 ? bounds.min[0] : 0.0;
+	origin[1] = segmentCount > 0 ? bounds.min[1] : 0.0;
+
+	long cells = columns * rows;
+	cellStart = (uint32_t*)calloc(cells + 1, sizeof(uint32_t));
+
+	SpatialBuild build;
+	build.index = this;
+	build.cursor = NULL;
+
+	if (cellStart == NULL)
+		return false;
+
+	build.Run(threads, SPATIAL_COUNT);
+
+	uint64_t total = 0;
+
+	for (long cell = 0; cell < cells; cell++)
+	{
+		total += cellStart[cell + 1];
+		cellStart[cell + 1] = (uint32_t)total;
+	}
+
+	build.cursor = (uint32_t*)malloc(cells * sizeof(uint32_t));
+	cellSegments = (uint32_t*)malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+
+	if (total > 0xFFFFFFFFULL || build.cursor == NULL || cellSegments == NULL)
+	{
+		free(build.cursor);
+		free(cellStart);
+		free(cellSegments);
+		cellStart = NULL;
+		cellSegments = NULL;
+		columns = rows = 0;
+
+		return false;
+	}
+
+	memcpy(build.cursor, cellStart, cells * sizeof(uint32_t));
+	build.Run(threads, SPATIAL_FILL);
+	build.Run(threads, SPATIAL_SORT);
+	free(build.cursor);
+
+	return true;
+}
+
+/// <summary>
+/// Determine if Build has sorted the segments into the grid.
+/// </summary>
+bool GCodeSpatialIndex::IsBuilt() const
+{
+	return cellStart != NULL;
+}
+
+static int CompareBlocks(const void* a, const void* b)
+{
+	long first = *(const long*)a;
+	long second = *(const long*)b;
+
+	return first < second ? -1 : first > second ? 1 : 0;
+}
+
+/// <summary>
+/// Sorts block IDs and removes repeats.
+/// </summary>
+/// <returns>The number of distinct IDs.</returns>
+static long UniqueBlocks(long* blocks, long count)
+{
+	if (count == 0)
+		return 0;
+
+	qsort(blocks, count, sizeof(long), CompareBlocks);
+
+	long unique = 1;
+
+	for (long i = 1; i < count; i++)
+	{
+		if (blocks[i] != blocks[unique - 1])
+			blocks[unique++] = blocks[i];
+	}
+
+	return unique;
+}
+
+/// <summary>
+/// Finds the blocks with a segment whose box overlaps a region.
+/// </summary>
+/// <param name="region">The region, touching counts.</param>
+/// <param name="blocks">Receives the block IDs in ascending order.</param>
+/// <param name="capacity">The size of blocks.</param>
+/// <returns>The number of blocks, or -1 if there are more than capacity or the index is not built.</returns>
+long GCodeSpatialIndex::Query(const GCodeBounds* region, long* blocks, long capacity) const
+{
+	if (cellStart == NULL)
+		return -1;
+
+	float min[3];
+	float max[3];
+
+	for (int a = 0; a < 3; a++)
+	{
+		min[a] = FloatBelow(region->min[a]);
+		max[a] = FloatAbove(region->max[a]);
+	}
+
+	long first[2];
+	long last[2];
+	long count = 0;
+	bool sorted = true;
+
+	CellRange(min, max, first, last);
+
+	for (long row = first[1]; row <= last[1]; row++)
+	{
+		for (long column = first[0]; column <= last[0]; column++)
+		{
+			long cell = row * columns + column;
+
+			for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; i++)
+			{
+				const GCodeSegment* segment = &segments[cellSegments[i]];
+
+				if (segment->min[0] > max[0] || segment->max[0] < min[0] || segment->min[1] > max[1] ||
+					segment->max[1] < min[1] || segment->min[2] > max[2] || segment->max[2] < min[2])
+					continue;
+
+				// Report the segment only from the cell holding the low corner of the overlap.
+				float corner[2] = { segment->min[0] > min[0] ? segment->min[0] : min[0],
+					segment->min[1] > min[1] ? segment->min[1] : min[1] };
+				long home[2];
+				long unused[2];
+				CellRange(corner, corner, home, unused);
+
+				if (home[0] != column || home[1] != row)
+					continue;
+
+				if (count > 0 && blocks[count - 1] == (long)segment->block)
+					continue;
+
+				if (count == capacity)
+				{
+					count = UniqueBlocks(blocks, count);
+
+					if (count == capacity)
+						return -1;
+				}
+
+				if (count > 0 && blocks[count - 1] > (long)segment->block)
+					sorted = false;
+
+				blocks[count++] = segment->block;
+			}
+		}
+	}
+
+	return sorted ? count : UniqueBlocks(blocks, count);
+}
+
+/// <summary>
+/// Gets the bytes allocated for the segments and the grid.
+/// </summary>
+size_t GCodeSpatialIndex::MemoryUsed() const
+{
+	size_t used = segmentCapacity * sizeof(GCodeSegment);
+
+	if (cellStart != NULL)
+		used += (columns * rows + 1) * sizeof(uint32_t) + cellStart[columns * rows] * sizeof(uint32_t);
+
+	return used;
+}
@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeSpatialIndex_h
+#define GCodeSpatialIndex_h
+
+#include "GCodeMotion.h"
+#include <stdint.h>
+
+/// <summary>
+/// The box of a line or a piece of an arc, rounded outwards to float.
+/// </summary>
+struct GCodeSegment
+{
+	float min[3];
+	float max[3];
+	uint32_t block;            // Block ID, the source line number when the index parsed the program.
+};
+
+/// <summary>
+/// Uniform grid over the segment boxes of a toolpath, for finding the blocks that move
+/// through a region (host only).
+/// </summary>
+/// <remark>
+/// Moves are added as they are parsed (Add, ParseFile, ParseBuffer, or AddBlock for lines the
+/// caller has already parsed), each as one or more segments. Arcs are expanded into pieces
+/// of at most 22.5 degrees that never cross an axis extreme, so each piece's box is the box
+/// of its ends and a large arc does not cover cells it does not pass through.
+///
+/// Build sorts the segments into an XY grid sized from the number of segments and the extent
+/// of the toolpath (about two segments per cell), in compressed rows: cellStart[c] to
+/// cellStart[c + 1] are the positions in cellSegments of the segments overlapping cell c,
+/// in segment order. Counting and filling run on several threads over chunks of segments.
+///
+/// Query visits the cells under a region, tests each segment's box in 3D and reports a
+/// segment only from the first cell the overlap falls in, so no marks are needed and
+/// queries can run on several threads at once.
+/// </remark>
+class GCodeSpatialIndex
+{
+private:
+	GCodeParser parser;
+	GCodeMotion motion;
+	long segmentCapacity;
+	long lineNumber;
+	double origin[2];
+	double cellSize;
+	long columns;
+	long rows;
+	uint32_t* cellStart;
+	uint32_t* cellSegments;
+
+	bool AddSegment(const double* from, const double* to, long block);
+	void CellRange(const float* min, const float* max, long* first, long* last) const;
+
+	friend struct SpatialBuild;
+
+public:
+	GCodeSegment* segments;
+	long segmentCount;
+	GCodeBounds bounds;        // Of all segments.
+
+	GCodeSpatialIndex();
+	~GCodeSpatialIndex();
+
+	GCodeSpatialIndex(const GCodeSpatialIndex&) = delete;
+	GCodeSpatialIndex& operator=(const GCodeSpatialIndex&) = delete;
+
+	void Clear();
+	bool AddMove(const GCodeMove* move, long block);
+	bool AddBlock(GCodeParser* parser, long block);
+	bool Add(const char* bytes, size_t length);
+	bool ParseBuffer(const char* data, size_t length);
+	bool ParseFile(const char* path);
+
+	bool Build(int threads);
+	bool IsBuilt() const;
+	long Query(const GCodeBounds* region, long* blocks, long capacity) const;
+	size_t MemoryUsed() const;
+};
+
+#endif
@@ -0,0 +1,451 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeStreamer.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+/// <param name="fd">An open file descriptor connected to the controller. It is not closed.</param>
+GCodeStreamer::GCodeStreamer(int fd)
+{
+	this->fd = fd;
+	pendingLength = NULL;
+	pendingLine = NULL;
+	pendingBlock = NULL;
+	pendingHead = 0;
+	pendingCount = 0;
+	pendingCapacity = 0;
+	inFlight = 0;
+	responseLength = 0;
+	alarm = false;
+
+	rxBufferSize = GRBL_RX_BUFFER_SIZE;
+	waitForOk = false;
+	minify = false;
+	minifier.confirmed = 0;
+	dialect = NULL;
+	timeout = 10000;
+	log = stderr;
+
+	memset(&statistics, 0, sizeof(statistics));
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeStreamer::~GCodeStreamer()
+{
+	free(pendingLength);
+	free(pendingLine);
+	free(pendingBlock);
+}
+
+/// <summary>
+/// Writes all of the text, retrying partial writes.
+/// </summary>
+bool GCodeStreamer::WriteAll(const char* text, int length)
+{
+	while (length > 0)
+	{
+		ssize_t written = write(fd, text, length);
+
+		if (written < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+
+			return false;
+		}
+
+		text += written;
+		length -= written;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Handles a complete response line from the controller.
+/// </summary>
+void GCodeStreamer::HandleResponse(const char* text)
+{
+	bool acknowledge = strncmp(text, "ok", 2) == 0;
+	bool error = strncmp(text, "error", 5) == 0;
+
+	if (strncmp(text, "ALARM", 5) == 0)
+	{
+		alarm = true;
+
+		if (log != NULL)
+			fprintf(log, "%s\n", text);
+
+		return;
+	}
+
+	if (!acknowledge && !error)
+	{
+		// Welcome banners, [MSG:...] and status reports.
+		if (log != NULL)
+			fprintf(log, "%s\n", text);
+
+		return;
+	}
+
+	long sourceLine = 0;
+
+	if (pendingCount > 0)
+	{
+		inFlight -= pendingLength[pendingHead];
+		sourceLine = pendingLine[pendingHead];
+		minifier.confirmed = pendingBlock[pendingHead];
+		pendingHead = (pendingHead + 1) % pendingCapacity;
+		pendingCount--;
+	}
+
+	if (error)
+	{
+		statistics.errors++;
+
+		// The rejected block did not change the controller's state.
+		minifier.Reset();
+
+		if (log != NULL)
+			fprintf(log, "line %ld: %s\n", sourceLine, text);
+	}
+}
+
+/// <summary>
+/// Reads and handles the responses available.
+/// </summary>
+/// <param name="timeout">Milliseconds to wait for the first byte, 0 to only take what has already arrived.</param>
+/// <returns>False if nothing arrived in time or the connection was closed.</returns>
+bool GCodeStreamer::ReadResponses(int timeout)
+{
+	struct pollfd waitFor;
+	waitFor.fd = fd;
+	waitFor.events = POLLIN;
+	waitFor.revents = 0;
+
+	if (poll(&waitFor, 1, timeout) <= 0)
+		return false;
+
+	char bytes[256];
+	ssize_t count = read(fd, bytes, sizeof(bytes));
+
+	if (count <= 0)
+		return false;
+
+	for (ssize_t i = 0; i < count; i++)
+	{
+		char c = bytes[i];
+
+		if (c == '\n')
+		{
+			response[responseLength] = '\0';
+
+			if (responseLength > 0)
+				HandleResponse(response);
+
+			responseLength = 0;
+		}
+		else if (c != '\r' && responseLength < MAX_LINE_SIZE)
+			response[responseLength++] = c;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Sends a line when there is room for it in the controller's receive buffer.
+/// </summary>
+/// <param name="line">The line without a line feed.</param>
+/// <param name="sourceLine">The line number reported with errors.</param>
+/// <returns>False if the line could not be sent (too long, no response in time, ALARM or a write error).</returns>
+/// <remarks>Blank lines, lines left empty by minifying and lines the dialect rejects are not sent.</remarks>
+bool GCodeStreamer::SendLine(const char* line, long sourceLine)
+{
+	char text[MAX_LINE_SIZE + 2];
+	int length = strlen(line);
+
+	while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+		length--;
+
+	if (length > MAX_LINE_SIZE)
+	{
+		if (log != NULL)
+			fprintf(log, "line %ld: longer than %d characters\n", sourceLine, MAX_LINE_SIZE);
+
+		return false;
+	}
+
+	memcpy(text, line, length);
+	text[length] = '\0';
+
+	parser.dialect = dialect;
+	parser.ParseLine(text);
+
+	if (parser.line[0] == '\0' && !minify)
+	{
+		statistics.bytesSaved += length + 1;
+		return true;
+	}
+
+	int position;
+
+	if (dialect != NULL && parser.line[0] != '\0' && parser.Validate(&position) != GCODE_VALID)
+	{
+		statistics.invalid++;
+
+		if (log != NULL)
+			fprintf(log, "line %ld: not valid for %s at %d: %s\n", sourceLine, dialect->name, position, parser.line);
+
+		return true;
+	}
+
+	// Take any responses which have already arrived, so the minifier knows the lines acknowledged.
+	while (ReadResponses(0))
+		;
+
+	char output[MAX_LINE_SIZE + 2];
+	int minified = minify ? minifier.Minify(&parser, length + 1, output, MAX_LINE_SIZE + 1) : -1;
+
+	if (minified == 0)
+	{
+		statistics.bytesSaved += length + 1;
+		return true;
+	}
+
+	if (minified > 0)
+	{
+		statistics.bytesSaved += length - minified;
+		length = minified;
+	}
+	else
+		memcpy(output, text, length);
+
+	output[length++] = '\n';
+
+	if (length > rxBufferSize)
+	{
+		if (log != NULL)
+			fprintf(log, "line %ld: does not fit in the %d character receive buffer\n", sourceLine, rxBufferSize);
+
+		return false;
+	}
+
+	if (pendingCapacity < rxBufferSize)
+	{
+		int* lengths = (int*)malloc(rxBufferSize * sizeof(int));
+		long* lines = (long*)malloc(rxBufferSize * sizeof(long));
+		long* blocks = (long*)malloc(rxBufferSize * sizeof(long));
+
+		if (lengths == NULL || lines == NULL || blocks == NULL)
+		{
+			free(lengths);
+			free(lines);
+			free(blocks);
+			return false;
+		}
+
+		for (int i = 0; i < pendingCount; i++)
+		{
+			lengths[i] = pendingLength[(pendingHead + i) % pendingCapacity];
+			lines[i] = pendingLine[(pendingHead + i) % pendingCapacity];
+			blocks[i] = pendingBlock[(pendingHead + i) % pendingCapacity];
+		}
+
+		free(pendingLength);
+		free(pendingLine);
+		free(pendingBlock);
+		pendingLength = lengths;
+		pendingLine = lines;
+		pendingBlock = blocks;
+		pendingHead = 0;
+		pendingCapacity = rxBufferSize;
+	}
+
+	// Wait until the line fits.
+	while (!alarm && pendingCount > 0 && (waitForOk || inFlight + length > rxBufferSize))
+	{
+		if (!ReadResponses(timeout))
+		{
+			if (log != NULL)
+				fprintf(log, "line %ld: no response in %d ms\n", sourceLine, timeout);
+
+			return false;
+		}
+	}
+
+	if (alarm || !WriteAll(output, length))
+		return false;
+
+	pendingLength[(pendingHead + pendingCount) % pendingCapacity] = length;
+	pendingLine[(pendingHead + pendingCount) % pendingCapacity] = sourceLine;
+	pendingBlock[(pendingHead + pendingCount) % pendingCapacity] = minifier.linesIn;
+	pendingCount++;
+	inFlight += length;
+
+	statistics.linesSent++;
+	statistics.bytesSent += length;
+
+	return true;
+}
+
+/// <summary>
+/// Waits until every line sent has been acknowledged.
+/// </summary>
+/// <returns>False if a response did not arrive in time or the controller raised an ALARM.</returns>
+bool GCodeStreamer::WaitForAll()
+{
+	while (!alarm && pendingCount > 0)
+	{
+		if (!ReadResponses(timeout))
+			return false;
+	}
+
+	return !alarm;
+}
+
+/// <summary>
+/// Streams a G-Code file.
+/// </summary>
+/// <param name="path">The file.</param>
+/// <returns>False if the file could not be read or the stream stopped. Error responses do not stop the stream.</returns>
+bool GCodeStreamer::StreamFile(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = StreamStream(file);
+	fclose(file);
+
+	return result;
+}
+
+/// <summary>
+/// Streams G-Code from an open stream.
+/// </summary>
+/// <param name="file">The stream, i.e. stdin.</param>
+/// <returns>False if the stream stopped. Error responses do not stop the stream.</returns>
+bool GCodeStreamer::StreamStream(FILE* file)
+{
+	double start = Now();
+	char* line = NULL;
+	size_t size = 0;
+	long sourceLine = 0;
+	bool result = true;
+
+	while (result && getline(&line, &size, file) >= 0)
+		result = SendLine(line, ++sourceLine);
+
+	free(line);
+
+	if (result)
+		result = WaitForAll();
+
+	statistics.seconds = Now() - start;
+
+	return result;
+}
+
+/// <summary>
+/// Puts a serial port in raw mode at the baud rate given.
+/// </summary>
+/// <param name="fd">The serial port. Pipes and sockets are left as they are.</param>
+/// <param name="baud">The baud rate, i.e. 115200.</param>
+/// <returns>False if the baud rate is not supported or the port could not be set.</returns>
+bool GCodeStreamer::ConfigureSerial(int fd, int baud)
+{
+	if (!isatty(fd))
+		return true;
+
+	struct termios settings;
+
+	if (tcgetattr(fd, &settings) != 0)
+		return false;
+
+	cfmakeraw(&settings);
+	settings.c_cflag |= CLOCAL | CREAD;
+	settings.c_cc[VMIN] = 1;
+	settings.c_cc[VTIME] = 0;
+
+	speed_t speed;
+
+	switch (baud)
+	{
+	case 9600: speed = B9600; break;
+	case 19200: speed = B19200; break;
+	case 38400: speed = B38400; break;
+	case 57600: speed = B57600; break;
+	case 115200: speed = B115200; break;
+	case 230400: speed = B230400; break;
+	case 460800: speed = B460800; break;
+	case 921600: speed = B921600; break;
+	default: return false;
+	}
+
+	cfsetispeed(&settings, speed);
+	cfsetospeed(&settings, speed);
+
+	return tcsetattr(fd, TCSANOW, &settings) == 0;
+}
+
+/// <summary>
+/// Finds one of the library's dialects by name (not case sensitive).
+/// </summary>
+/// <returns>The dialect or NULL if there is none with that name.</returns>
+const GCodeDialect* GCodeStreamer::DialectByName(const char* name)
+{
+	const GCodeDialect* dialects[] = { &GCodeDialectMarlin, &GCodeDialectGrbl, &GCodeDialectLinuxCNC, &GCodeDialectFanuc };
+
+	for (unsigned int i = 0; i < sizeof(dialects) / sizeof(dialects[0]); i++)
+	{
+		if (strcasecmp(name, dialects[i]->name) == 0)
+			return dialects[i];
+	}
+
+	return NULL;
+}
+
+/// <summary>
+/// Gets a monotonic time in seconds.
+/// </summary>
+double GCodeStreamer::Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
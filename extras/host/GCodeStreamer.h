@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeStreamer_h
+#define GCodeStreamer_h
+
+#include "../../src/GCodeParser.h"
+#include "../../src/GCodeDialect.h"
+#include "GCodeMinifier.h"
+#include <stdio.h>
+
+const int GRBL_RX_BUFFER_SIZE = 128; // Serial receive buffer of a stock Grbl controller.
+
+/// <summary>
+/// Counters kept while streaming.
+/// </summary>
+struct GCodeStreamStatistics
+{
+	long linesSent;
+	long bytesSent;
+	long bytesSaved;   // Bytes removed by minifying, blank lines included.
+	long errors;       // error: responses.
+	long invalid;      // Lines rejected by the dialect before sending.
+	double seconds;
+};
+
+/// <summary>
+/// Streams G-Code to a controller over a file descriptor with character counting flow control (Linux host only).
+/// </summary>
+/// <remark>
+/// Instead of sending a line and waiting for its ok, the streamer keeps track of how many
+/// characters sent are still in the controller's receive buffer (the length of each line
+/// not yet acknowledged) and sends the next line as soon as it fits, as Grbl's stream.py
+/// does. The buffer stays full so short segments are not limited by the round trip time.
+/// Each line is parsed first and, when minify is set, sent through a GCodeMinifier which
+/// drops spaces, comments and words the controller's modal state makes redundant. A word
+/// is only dropped when the line which set the state it repeats has been acknowledged, so
+/// a line rejected with error: never leaves the lines sent after it without words they
+/// needed, and the error resets the minifier's state. When a dialect is set lines it
+/// rejects are reported and not sent.
+///
+/// The file descriptor can be a serial port (see ConfigureSerial), a pseudo-terminal or a
+/// socket. A response of ok or error: acknowledges the oldest line; ALARM stops the stream.
+/// </remark>
+class GCodeStreamer
+{
+private:
+	int fd;
+	int* pendingLength;
+	long* pendingLine;
+	long* pendingBlock;     // Minifier blocks (linesIn) up to each line, for its confirmed.
+	int pendingHead;
+	int pendingCount;
+	int pendingCapacity;
+	int inFlight;
+	char response[MAX_LINE_SIZE + 2];
+	int responseLength;
+	bool alarm;
+	GCodeParser parser;
+
+	bool ReadResponses(int timeout);
+	void HandleResponse(const char* text);
+	bool WriteAll(const char* text, int length);
+
+public:
+	int rxBufferSize;       // Controller receive buffer size (default GRBL_RX_BUFFER_SIZE).
+	bool waitForOk;         // Send one line at a time and wait for its ok instead (default false).
+	bool minify;            // Send each line through the minifier (default false).
+	GCodeMinifier minifier; // Set its decimals and modalMotion for the controller.
+	const GCodeDialect* dialect; // Validate lines before sending (default NULL).
+	int timeout;            // Milliseconds to wait for a response before giving up.
+	FILE* log;              // Where errors and other controller messages are written (default stderr).
+	GCodeStreamStatistics statistics;
+
+	GCodeStreamer(int fd);
+	~GCodeStreamer();
+
+	bool SendLine(const char* line, long sourceLine);
+	bool WaitForAll();
+	bool StreamFile(const char* path);
+	bool StreamStream(FILE* file);
+
+	static bool ConfigureSerial(int fd, int baud);
+	static const GCodeDialect* DialectByName(const char* name);
+	static double Now();
+};
+
+#endif
@@ -0,0 +1,636 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeTransform.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int TRANSFORM_BATCH_SIZE = 1024;
+const int READ_BUFFER_SIZE = 65536;
+
+// Block flags.
+const unsigned char BLOCK_PASS_THROUGH = 0x01; // Emit unchanged.
+const unsigned char BLOCK_MOVE = 0x02;         // Has axis words.
+const unsigned char BLOCK_ARC = 0x04;          // Has I, J, K or R words.
+const unsigned char BLOCK_INCREMENTAL = 0x08;  // Axis words are deltas.
+const unsigned char BLOCK_HOME = 0x10;         // G28, the homed axes go back to 0.
+
+/// <summary>
+/// The identity transform.
+/// </summary>
+GCodeAffine GCodeAffine::Identity()
+{
+	GCodeAffine result;
+
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+			result.m[row][column] = (row == column) ? 1.0 : 0.0;
+
+		result.t[row] = 0.0;
+	}
+
+	return result;
+}
+
+/// <summary>
+/// A translation (work offset).
+/// </summary>
+GCodeAffine GCodeAffine::Translation(double x, double y, double z)
+{
+	GCodeAffine result = Identity();
+	result.t[0] = x;
+	result.t[1] = y;
+	result.t[2] = z;
+
+	return result;
+}
+
+/// <summary>
+/// A scaling about the origin.
+/// </summary>
+GCodeAffine GCodeAffine::Scaling(double x, double y, double z)
+{
+	GCodeAffine result = Identity();
+	result.m[0][0] = x;
+	result.m[1][1] = y;
+	result.m[2][2] = z;
+
+	return result;
+}
+
+/// <summary>
+/// A counterclockwise rotation about the Z axis through the origin.
+/// </summary>
+GCodeAffine GCodeAffine::Rotation(double degrees)
+{
+	double radians = degrees * M_PI / 180.0;
+	GCodeAffine result = Identity();
+	result.m[0][0] = cos(radians);
+	result.m[0][1] = -sin(radians);
+	result.m[1][0] = sin(radians);
+	result.m[1][1] = cos(radians);
+
+	return result;
+}
+
+/// <summary>
+/// A counterclockwise rotation about the Z axis through the center provided.
+/// </summary>
+GCodeAffine GCodeAffine::Rotation(double degrees, double centerX, double centerY)
+{
+	return Translation(-centerX, -centerY, 0).Then(Rotation(degrees)).Then(Translation(centerX, centerY, 0));
+}
+
+/// <summary>
+/// Mirrors X (X becomes -X).
+/// </summary>
+GCodeAffine GCodeAffine::MirrorX()
+{
+	return Scaling(-1, 1, 1);
+}
+
+/// <summary>
+/// Mirrors Y (Y becomes -Y).
+/// </summary>
+GCodeAffine GCodeAffine::MirrorY()
+{
+	return Scaling(1, -1, 1);
+}
+
+/// <summary>
+/// Combines this transform with the next one.
+/// </summary>
+/// <returns>A transform applying this transform first and then next.</returns>
+GCodeAffine GCodeAffine::Then(const GCodeAffine& next) const
+{
+	GCodeAffine result;
+
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			result.m[row][column] = 0.0;
+
+			for (int k = 0; k < 3; k++)
+				result.m[row][column] += next.m[row][k] * m[k][column];
+		}
+
+		result.t[row] = next.t[row];
+
+		for (int k = 0; k < 3; k++)
+			result.t[row] += next.m[row][k] * t[k];
+	}
+
+	return result;
+}
+
+/// <summary>
+/// The determinant of the XY part of the transform. Negative when the XY plane is mirrored.
+/// </summary>
+double GCodeAffine::XYDeterminant() const
+{
+	return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+}
+
+/// <summary>
+/// A batch of blocks in structure of arrays form.
+/// </summary>
+struct GCodeTransform::Batch
+{
+	char code[TRANSFORM_BATCH_SIZE][MAX_LINE_SIZE + 2]; // Code, a null, then the comments.
+	int commentsAt[TRANSFORM_BATCH_SIZE];
+	unsigned char flags[TRANSFORM_BATCH_SIZE];
+	unsigned long words[TRANSFORM_BATCH_SIZE];          // GCODE_LETTER mask of the words present.
+
+	// Source values: the point after the block (w = 1, w = 0 without one) and the arc offset.
+	double x[TRANSFORM_BATCH_SIZE], y[TRANSFORM_BATCH_SIZE], z[TRANSFORM_BATCH_SIZE], w[TRANSFORM_BATCH_SIZE];
+	double i[TRANSFORM_BATCH_SIZE], j[TRANSFORM_BATCH_SIZE], k[TRANSFORM_BATCH_SIZE];
+	double r[TRANSFORM_BATCH_SIZE];
+
+	// Transformed values.
+	double tx[TRANSFORM_BATCH_SIZE], ty[TRANSFORM_BATCH_SIZE], tz[TRANSFORM_BATCH_SIZE];
+	double ti[TRANSFORM_BATCH_SIZE], tj[TRANSFORM_BATCH_SIZE], tk[TRANSFORM_BATCH_SIZE];
+
+	GCodeParser parser;
+};
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+/// <param name="affine">The transform to apply.</param>
+GCodeTransform::GCodeTransform(const GCodeAffine& affine)
+{
+	this->affine = affine;
+	batch = new Batch;
+	precision = 4;
+	blocksTransformed = 0;
+	longLine = 0;
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeTransform::~GCodeTransform()
+{
+	delete batch;
+}
+
+/// <summary>
+/// Resolves a block against the modal state into source points, deltas and arc offsets.
+/// </summary>
+void GCodeTransform::ResolveBlock(int index)
+{
+	const char* code = batch->code[index];
+	unsigned char flags = 0;
+	bool setPosition = false;
+	bool home = false;
+
+	// Scan the G words for modal changes and blocks which are passed through.
+	for (int pointer = 0; code[pointer] != '\0'; pointer++)
+	{
+		if (code[pointer] != 'G')
+			continue;
+
+		long value;
+		int count = GCodeParser::ParseInteger(&code[pointer + 1], &value);
+
+		if (count == 0)
+			continue;
+
+		if (code[pointer + 1 + count] == '.')
+		{
+			// G28.1, G92.1 and similar.
+			if (value == 28 || value == 30 || value == 92)
+				flags |= BLOCK_PASS_THROUGH;
+
+			continue;
+		}
+
+		switch (value)
+		{
+		case 90: absolute = true; break;
+		case 91: absolute = false; break;
+		case 92: setPosition = true; break;
+		case 28: home = true; flags |= BLOCK_PASS_THROUGH; break;
+		case 10: case 30: case 53: flags |= BLOCK_PASS_THROUGH; break;
+		}
+	}
+
+	GCodeWords words;
+	strcpy(batch->parser.line, code);
+	unsigned long found = batch->parser.GetWords(GCodeParser::LetterMask("XYZIJKR"), &words);
+
+	batch->words[index] = found;
+	batch->w[index] = 0.0;
+	batch->x[index] = batch->y[index] = batch->z[index] = 0.0;
+	batch->i[index] = words.value['I' - 'A'];
+	batch->j[index] = words.value['J' - 'A'];
+	batch->k[index] = words.value['K' - 'A'];
+	batch->r[index] = words.value['R' - 'A'];
+
+	double* axis[3] = { &batch->x[index], &batch->y[index], &batch->z[index] };
+	const char letters[3] = { 'X', 'Y', 'Z' };
+
+	const unsigned long axes = GCODE_LETTER('X') | GCODE_LETTER('Y') | GCODE_LETTER('Z');
+
+	// G28 passes through but the axes it homes, all without axis words, are at 0 again.
+	if (home)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			if ((found & GCODE_LETTER(letters[a])) || !(found & axes))
+				position[a] = 0.0;
+
+			*axis[a] = position[a];
+		}
+
+		batch->w[index] = 1.0;
+		flags |= BLOCK_HOME;
+	}
+
+	if (flags & BLOCK_PASS_THROUGH)
+	{
+		batch->flags[index] = flags;
+		return;
+	}
+
+	// G92 declares the current position so its values are points even in G91.
+	bool absoluteBlock = absolute || setPosition;
+
+	// Incremental blocks are resolved to points too, so EmitBlock can write the delta from
+	// the position written so far and rounding does not add up.
+	if (found & axes)
+	{
+		flags |= BLOCK_MOVE;
+
+		for (int a = 0; a < 3; a++)
+		{
+			bool present = (found & GCODE_LETTER(letters[a])) != 0;
+			double value = words.value[letters[a] - 'A'];
+
+			if (absoluteBlock && present)
+				position[a] = value;
+			else if (present)
+				position[a] += value;
+
+			*axis[a] = position[a];
+		}
+
+		batch->w[index] = 1.0;
+
+		if (!absoluteBlock)
+			flags |= BLOCK_INCREMENTAL;
+	}
+
+	if (found & (GCODE_LETTER('I') | GCODE_LETTER('J') | GCODE_LETTER('K') | GCODE_LETTER('R')))
+		flags |= BLOCK_ARC;
+
+	batch->flags[index] = flags;
+}
+
+/// <summary>
+/// Transforms the points, deltas and arc offsets of a batch in one pass over the columns.
+/// </summary>
+/// <remarks>
+/// The loops have no branches and work on separate arrays so they are vectorized by the
+/// compiler (SSE2/AVX on x86, NEON on ARM). Points carry w = 1 and pick up the translation,
+/// arc offsets only see the linear part.
+/// </remarks>
+void GCodeTransform::TransformBatch(int count)
+{
+	const double m00 = affine.m[0][0], m01 = affine.m[0][1], m02 = affine.m[0][2], t0 = affine.t[0];
+	const double m10 = affine.m[1][0], m11 = affine.m[1][1], m12 = affine.m[1][2], t1 = affine.t[1];
+	const double m20 = affine.m[2][0], m21 = affine.m[2][1], m22 = affine.m[2][2], t2 = affine.t[2];
+
+	const double* __restrict x = batch->x;
+	const double* __restrict y = batch->y;
+	const double* __restrict z = batch->z;
+	const double* __restrict w = batch->w;
+	double* __restrict tx = batch->tx;
+	double* __restrict ty = batch->ty;
+	double* __restrict tz = batch->tz;
+
+	for (int n = 0; n < count; n++)
+	{
+		tx[n] = m00 * x[n] + m01 * y[n] + m02 * z[n] + t0 * w[n];
+		ty[n] = m10 * x[n] + m11 * y[n] + m12 * z[n] + t1 * w[n];
+		tz[n] = m20 * x[n] + m21 * y[n] + m22 * z[n] + t2 * w[n];
+	}
+
+	const double* __restrict i = batch->i;
+	const double* __restrict j = batch->j;
+	const double* __restrict k = batch->k;
+	double* __restrict ti = batch->ti;
+	double* __restrict tj = batch->tj;
+	double* __restrict tk = batch->tk;
+
+	for (int n = 0; n < count; n++)
+	{
+		ti[n] = m00 * i[n] + m01 * j[n] + m02 * k[n];
+		tj[n] = m10 * i[n] + m11 * j[n] + m12 * k[n];
+		tk[n] = m20 * i[n] + m21 * j[n] + m22 * k[n];
+	}
+}
+
+/// <summary>
+/// Writes a value with the precision provided, dropping trailing zeros.
+/// </summary>
+static void WriteValue(FILE* out, char letter, double value, int precision, bool* first)
+{
+	char text[MAX_NUMBER_SIZE];
+
+	if (GCodeWriter::FormatNumber(text, sizeof(text), value, precision) == 0)
+		return;
+
+	fprintf(out, *first ? "%c%s" : " %c%s", letter, text);
+	*first = false;
+}
+
+/// <summary>
+/// Gets a value as the controller reads it when written with the precision provided.
+/// </summary>
+static double WrittenValue(double value, int precision)
+{
+	char text[MAX_NUMBER_SIZE];
+	double written;
+
+	if (GCodeWriter::FormatNumber(text, sizeof(text), value, precision) == 0 ||
+		GCodeParser::ParseNumber(text, &written) == 0)
+		return value;
+
+	return written;
+}
+
+/// <summary>
+/// Emits a block with its transformed values.
+/// </summary>
+bool GCodeTransform::EmitBlock(int index, FILE* out)
+{
+	const char* code = batch->code[index];
+	const char* comments = &batch->code[index][batch->commentsAt[index]];
+	unsigned char flags = batch->flags[index];
+	unsigned long found = batch->words[index];
+
+	double target[3] = { batch->tx[index], batch->ty[index], batch->tz[index] };
+	const char axisLetters[3] = { 'X', 'Y', 'Z' };
+	bool writeAxis[3] = { false, false, false };
+
+	// The homed axes are where the program's origin is, as at the start.
+	if (flags & BLOCK_HOME)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			if ((found & GCODE_LETTER(axisLetters[a])) || !(found & (GCODE_LETTER('X') | GCODE_LETTER('Y') | GCODE_LETTER('Z'))))
+				emitted[a] = target[a];
+		}
+	}
+
+	if (flags & BLOCK_PASS_THROUGH)
+		flags = 0;
+
+	if (flags & (BLOCK_MOVE | BLOCK_ARC))
+		blocksTransformed++;
+
+	// Decide which axis words to write and what they are. Missing axes are added when the
+	// written position changes. emitted follows the values as written, so the rounding of
+	// one incremental move is made up by the next.
+	if (flags & BLOCK_MOVE)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			if (flags & BLOCK_INCREMENTAL)
+			{
+				double delta = WrittenValue(target[a] - emitted[a], precision);
+				writeAxis[a] = (found & GCODE_LETTER(axisLetters[a])) || delta != 0.0;
+				target[a] = delta;
+
+				if (writeAxis[a])
+					emitted[a] += delta;
+			}
+			else
+			{
+				target[a] = WrittenValue(target[a], precision);
+				writeAxis[a] = (found & GCODE_LETTER(axisLetters[a])) || target[a] != emitted[a];
+
+				if (writeAxis[a])
+					emitted[a] = target[a];
+			}
+		}
+	}
+
+	double arc[3] = { batch->ti[index], batch->tj[index], batch->tk[index] };
+	const char arcLetters[3] = { 'I', 'J', 'K' };
+	bool first = true;
+	bool axesWritten = false;
+	bool arcWritten = false;
+	int pointer = 0;
+
+	while (code[pointer] != '\0')
+	{
+		char letter = code[pointer];
+
+		if (letter < 'A' || letter > 'Z')
+		{
+			// Block delete, checksums and anything else are copied as is.
+			fputc(letter, out);
+			pointer++;
+			continue;
+		}
+
+		double value;
+		int count = GCodeParser::ParseNumber(&code[pointer + 1], &value);
+		int axis = (letter >= 'X' && letter <= 'Z') ? letter - 'X' : -1;
+		int offset = (letter >= 'I' && letter <= 'K') ? letter - 'I' : -1;
+
+		if (axis >= 0 && (flags & BLOCK_MOVE))
+		{
+			if (!axesWritten)
+			{
+				for (int a = 0; a < 3; a++)
+				{
+					if (writeAxis[a])
+						WriteValue(out, axisLetters[a], target[a], precision, &first);
+				}
+
+				axesWritten = true;
+			}
+		}
+		else if (offset >= 0 && (flags & BLOCK_ARC))
+		{
+			if (!arcWritten)
+			{
+				for (int a = 0; a < 3; a++)
+				{
+					if ((found & GCODE_LETTER(arcLetters[a])) || (a < 2 && (found & (GCODE_LETTER('I') | GCODE_LETTER('J')))))
+						WriteValue(out, arcLetters[a], arc[a], precision, &first);
+				}
+
+				arcWritten = true;
+			}
+		}
+		else if (letter == 'R' && (flags & BLOCK_ARC))
+			WriteValue(out, 'R', value * sqrt(fabs(affine.XYDeterminant())), precision, &first);
+		else if (letter == 'G' && swapArcs && count == 1 && (code[pointer + 1] == '2' || code[pointer + 1] == '3'))
+			fprintf(out, first ? "G%c" : " G%c", code[pointer + 1] == '2' ? '3' : '2');
+		else if (letter == 'G' && swapArcs && count == 2 && code[pointer + 1] == '0' && (code[pointer + 2] == '2' || code[pointer + 2] == '3'))
+			fprintf(out, first ? "G0%c" : " G0%c", code[pointer + 2] == '2' ? '3' : '2');
+		else
+			fprintf(out, first ? "%c%.*s" : " %c%.*s", letter, count, &code[pointer + 1]);
+
+		first = false;
+		pointer += 1 + count;
+	}
+
+	if (comments[0] != '\0')
+		fprintf(out, first ? "%s" : " %s", comments);
+
+	return fputc('\n', out) != EOF;
+}
+
+/// <summary>
+/// Transforms a program read from a stream.
+/// </summary>
+/// <param name="in">The program to transform.</param>
+/// <param name="out">Receives the transformed program.</param>
+/// <returns>False if a stream cannot be read or written or a line is too long (see longLine).</returns>
+/// <remarks>The blocks before a line too long are written, nothing after it.</remarks>
+bool GCodeTransform::TransformStream(FILE* in, FILE* out)
+{
+	char* buffer = (char*)malloc(READ_BUFFER_SIZE);
+
+	if (buffer == NULL)
+		return false;
+
+	position[0] = position[1] = position[2] = 0.0;
+	emitted[0] = affine.t[0];
+	emitted[1] = affine.t[1];
+	emitted[2] = affine.t[2];
+	absolute = true;
+	swapArcs = affine.XYDeterminant() < 0;
+
+	GCodeParser parser;
+	int count = 0;
+	long lineNumber = 0;
+	bool result = true;
+	bool endOfInput = false;
+
+	longLine = 0;
+
+	while (result && !endOfInput && longLine == 0)
+	{
+		size_t length = fread(buffer, 1, READ_BUFFER_SIZE, in);
+
+		if (length == 0)
+		{
+			endOfInput = true;
+
+			// A last line without a line feed.
+			if (!parser.completeLineIsAvailableToParse && (parser.line[0] != '\0' || parser.lineStatus == GCODE_LINE_OVERFLOW))
+			{
+				buffer[0] = '\n';
+				length = 1;
+			}
+		}
+
+		for (size_t n = 0; n < length && longLine == 0; n++)
+		{
+			if (!parser.AddCharToLine(buffer[n]))
+				continue;
+
+			lineNumber++;
+
+			// Transforming what is left of it would move the machine somewhere else.
+			if (parser.lineStatus == GCODE_LINE_OVERFLOW)
+			{
+				longLine = lineNumber;
+				break;
+			}
+
+			parser.ParseLine();
+
+			int codeLength = strlen(parser.line);
+			memcpy(batch->code[count], parser.line, codeLength + 1);
+			batch->commentsAt[count] = codeLength + 1;
+			strcpy(&batch->code[count][codeLength + 1], parser.comments);
+
+			ResolveBlock(count);
+			count++;
+
+			if (count == TRANSFORM_BATCH_SIZE)
+			{
+				TransformBatch(count);
+
+				for (int index = 0; index < count && result; index++)
+					result = EmitBlock(index, out);
+
+				count = 0;
+			}
+		}
+	}
+
+	TransformBatch(count);
+
+	for (int index = 0; index < count && result; index++)
+		result = EmitBlock(index, out);
+
+	if (ferror(in) || ferror(out) || longLine != 0)
+		result = false;
+
+	free(buffer);
+
+	return result;
+}
+
+/// <summary>
+/// Transforms a program file.
+/// </summary>
+/// <param name="inPath">The program to transform.</param>
+/// <param name="outPath">The file to create.</param>
+/// <returns>False if a file cannot be read or written.</returns>
+bool GCodeTransform::TransformFile(const char* inPath, const char* outPath)
+{
+	FILE* in = fopen(inPath, "rb");
+
+	if (in == NULL)
+		return false;
+
+	FILE* out = fopen(outPath, "wb");
+
+	if (out == NULL)
+	{
+		fclose(in);
+		return false;
+	}
+
+	bool result = TransformStream(in, out);
+
+	fclose(in);
+
+	if (fclose(out) != 0)
+		result = false;
+
+	return result;
+}
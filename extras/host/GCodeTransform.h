@@ -0,0 +1,104 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeTransform_h
+#define GCodeTransform_h
+
+#include "../../src/GCodeParser.h"
+#include "../../src/GCodeWriter.h"
+#include <stdio.h>
+
+/// <summary>
+/// A 3D affine transform (3x3 linear part and a translation) for GCodeTransform.
+/// </summary>
+/// <remark>
+/// Points map to m * p + t. Build transforms with the static methods and combine them
+/// with Then, i.e. GCodeAffine::Rotation(90).Then(GCodeAffine::Translation(100, 0, 0))
+/// rotates and then translates.
+/// </remark>
+struct GCodeAffine
+{
+	double m[3][3];
+	double t[3];
+
+	static GCodeAffine Identity();
+	static GCodeAffine Translation(double x, double y, double z);
+	static GCodeAffine Scaling(double x, double y, double z);
+	static GCodeAffine Rotation(double degrees);
+	static GCodeAffine Rotation(double degrees, double centerX, double centerY);
+	static GCodeAffine MirrorX();
+	static GCodeAffine MirrorY();
+
+	GCodeAffine Then(const GCodeAffine& next) const;
+	double XYDeterminant() const;
+};
+
+/// <summary>
+/// Applies an affine transform to the axis words and arc centers of a program and
+/// re-emits it (host only).
+/// </summary>
+/// <remark>
+/// Blocks are read in batches of TRANSFORM_BATCH_SIZE. Each batch is resolved sequentially
+/// against the modal state (G90/G91, G2/G3 and the current position, so incremental moves
+/// and blocks with missing axes stay correct), transformed in one pass over structure of
+/// arrays columns that the compiler vectorizes, and then emitted. Axis words that were
+/// not on the line are added when the transform changes that axis (i.e. a rotated X only
+/// move). I and J (and K) arc offsets are transformed by the linear part only and G2/G3
+/// are swapped when the transform mirrors the XY plane. R arcs are scaled by the square
+/// root of the XY determinant. G92 values are points and are transformed like a move.
+/// Incremental moves are written as the delta from the position written so far, so their
+/// rounding does not add up. G10, G28, G30, G53 and G28.1, G30.1 and G92.x blocks pass
+/// through unchanged; after G28 the axes it homes are taken to be at the origin again.
+/// 
+/// Limitations: arcs are assumed to be in the G17 (XY) plane, non-uniform scaling of R
+/// arcs is not supported and the position is assumed to start at 0,0,0.
+/// </remark>
+class GCodeTransform
+{
+private:
+	struct Batch;
+	Batch* batch;
+	double position[3];     // Current source position.
+	double emitted[3];      // Last emitted (transformed) position.
+	bool absolute;
+	bool swapArcs;
+
+	void ResolveBlock(int index);
+	void TransformBatch(int count);
+	bool EmitBlock(int index, FILE* out);
+
+public:
+	GCodeAffine affine;
+	int precision;          // Decimal places emitted for transformed values or GCODE_SHORTEST.
+	long blocksTransformed;
+	long longLine;          // Source line longer than MAX_LINE_SIZE which stopped the transform, 0 if none.
+
+	GCodeTransform(const GCodeAffine& affine);
+	~GCodeTransform();
+
+	bool TransformStream(FILE* in, FILE* out);
+	bool TransformFile(const char* inPath, const char* outPath);
+};
+
+#endif
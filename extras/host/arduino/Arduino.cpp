@@ -0,0 +1,375 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Host main for Arduino sketches.
+//
+// Usage: <sketch> [-d] [-q] [-p | <input>]
+//   -d       Make delay() sleep. By default it returns at once so input is processed at full speed.
+//   -q       Discard the sketch's output.
+//   -p       Create a pseudo-terminal, print its path and use it as the serial port.
+//   <input>  A file or pipe to read the serial input from, stdin when missing or -.
+//
+// The sketch runs until the input ends (or it is interrupted) and the bytes read, the time
+// taken and the throughput are printed on stderr.
+
+#include "Arduino.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+bool delayEnabled = false;
+
+/// <summary>
+/// Class constructor. Reads stdin and writes stdout until main says otherwise.
+/// </summary>
+HardwareSerial::HardwareSerial()
+{
+	head = 0;
+	count = 0;
+	input = 0;
+	output = stdout;
+	endOfInput = false;
+	bytesRead = 0;
+}
+
+/// <summary>
+/// Reads more input, waiting for it when none has arrived.
+/// </summary>
+/// <returns>False at the end of the input.</returns>
+bool HardwareSerial::Fill()
+{
+	if (endOfInput)
+		return false;
+
+	while (true)
+	{
+		ssize_t length = ::read(input, buffer, SERIAL_BUFFER_SIZE);
+
+		if (length > 0)
+		{
+			head = 0;
+			count = length;
+			bytesRead += length;
+
+			return true;
+		}
+
+		if (length < 0 && errno == EAGAIN)
+			continue;
+
+		// End of file, a closed pipe or an interrupt all end the input.
+		endOfInput = true;
+
+		return false;
+	}
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+}
+
+void HardwareSerial::end()
+{
+	flush();
+}
+
+int HardwareSerial::available()
+{
+	if (count == 0)
+		Fill();
+
+	return count;
+}
+
+int HardwareSerial::peek()
+{
+	if (count == 0 && !Fill())
+		return -1;
+
+	return buffer[head];
+}
+
+int HardwareSerial::read()
+{
+	if (count == 0 && !Fill())
+		return -1;
+
+	count--;
+
+	return buffer[head++];
+}
+
+void HardwareSerial::flush()
+{
+	if (output != NULL)
+		fflush(output);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+	if (output != NULL)
+		putc(c, output);
+
+	return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* bytes, size_t length)
+{
+	if (output != NULL)
+		fwrite(bytes, 1, length, output);
+
+	return length;
+}
+
+size_t HardwareSerial::print(const char* text)
+{
+	return write((const uint8_t*)text, strlen(text));
+}
+
+size_t HardwareSerial::print(char c)
+{
+	return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(int value)
+{
+	return print((long)value);
+}
+
+size_t HardwareSerial::print(unsigned int value)
+{
+	return print((unsigned long)value);
+}
+
+size_t HardwareSerial::print(long value)
+{
+	char text[24];
+	snprintf(text, sizeof(text), "%ld", value);
+
+	return print(text);
+}
+
+size_t HardwareSerial::print(unsigned long value)
+{
+	char text[24];
+	snprintf(text, sizeof(text), "%lu", value);
+
+	return print(text);
+}
+
+size_t HardwareSerial::print(double value, int digits)
+{
+	char text[64];
+	snprintf(text, sizeof(text), "%.*f", digits, value);
+
+	return print(text);
+}
+
+size_t HardwareSerial::println()
+{
+	return print("\r\n");
+}
+
+size_t HardwareSerial::println(const char* text)
+{
+	return print(text) + println();
+}
+
+size_t HardwareSerial::println(char c)
+{
+	return print(c) + println();
+}
+
+size_t HardwareSerial::println(int value)
+{
+	return print(value) + println();
+}
+
+size_t HardwareSerial::println(unsigned int value)
+{
+	return print(value) + println();
+}
+
+size_t HardwareSerial::println(long value)
+{
+	return print(value) + println();
+}
+
+size_t HardwareSerial::println(unsigned long value)
+{
+	return print(value) + println();
+}
+
+size_t HardwareSerial::println(double value, int digits)
+{
+	return print(value, digits) + println();
+}
+
+HardwareSerial::operator bool()
+{
+	return true;
+}
+
+static struct timespec started;
+
+/// <summary>
+/// Gets the time since the sketch started in microseconds.
+/// </summary>
+static unsigned long long Elapsed()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - started.tv_sec) * 1000000ULL + (now.tv_nsec - started.tv_nsec) / 1000;
+}
+
+void delay(unsigned long ms)
+{
+	if (delayEnabled)
+		usleep(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	if (delayEnabled)
+		usleep(us);
+}
+
+unsigned long millis()
+{
+	return (unsigned long)(Elapsed() / 1000);
+}
+
+unsigned long micros()
+{
+	return (unsigned long)Elapsed();
+}
+
+static void Interrupt(int signal)
+{
+	// The blocked read returns EINTR and the input ends.
+}
+
+int main(int argc, char* argv[])
+{
+	const char* path = NULL;
+	bool quiet = false;
+	bool pseudoTerminal = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-d") == 0)
+			delayEnabled = true;
+		else if (strcmp(argv[i], "-q") == 0)
+			quiet = true;
+		else if (strcmp(argv[i], "-p") == 0)
+			pseudoTerminal = true;
+		else if (path == NULL && (argv[i][0] != '-' || argv[i][1] == '\0'))
+			path = argv[i];
+		else
+		{
+			fprintf(stderr, "Usage: %s [-d] [-q] [-p | <input>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	int host = -1;
+
+	if (pseudoTerminal)
+	{
+		Serial.input = posix_openpt(O_RDWR | O_NOCTTY);
+
+		if (Serial.input < 0 || grantpt(Serial.input) != 0 || unlockpt(Serial.input) != 0)
+		{
+			fprintf(stderr, "Cannot open a pseudo-terminal\n");
+			return 1;
+		}
+
+		// Holding the other side open keeps reads waiting between senders.
+		host = open(ptsname(Serial.input), O_RDWR | O_NOCTTY);
+
+		// Raw mode, otherwise the terminal echoes the sketch's output back to it as input.
+		struct termios settings;
+
+		if (host >= 0 && tcgetattr(host, &settings) == 0)
+		{
+			cfmakeraw(&settings);
+			tcsetattr(host, TCSANOW, &settings);
+		}
+
+		fprintf(stderr, "%s\n", ptsname(Serial.input));
+
+		Serial.output = fdopen(dup(Serial.input), "w");
+		setvbuf(Serial.output, NULL, _IOLBF, 0);
+	}
+	else if (path != NULL && strcmp(path, "-") != 0)
+	{
+		Serial.input = open(path, O_RDONLY);
+
+		if (Serial.input < 0)
+		{
+			fprintf(stderr, "Cannot open %s\n", path);
+			return 1;
+		}
+	}
+
+	if (quiet)
+		Serial.output = NULL;
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Interrupt;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &started);
+
+	setup();
+
+	unsigned long long loops = 0;
+
+	while (!Serial.endOfInput || Serial.available() > 0)
+	{
+		loop();
+		loops++;
+	}
+
+	Serial.flush();
+
+	double seconds = Elapsed() / 1e6;
+
+	fprintf(stderr, "%llu bytes, %llu loops in %.3f s: %.1f MB/s\n", Serial.bytesRead, loops, seconds,
+		seconds > 0 ? Serial.bytesRead / seconds / 1e6 : 0.0);
+
+	if (host >= 0)
+		close(host);
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+// A minimal stand-in for the Arduino core so sketches using the library can be built and
+// profiled on a Linux host. Only what the examples use is provided. The shim supplies main,
+// which calls the sketch's setup once and loop until the input ends.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+const int SERIAL_BUFFER_SIZE = 65536; // Bytes read from the input at a time.
+
+/// <summary>
+/// Serial port backed by a file, a pipe or a pseudo-terminal (host only).
+/// </summary>
+/// <remark>
+/// available() and peek() block until input arrives when the buffer is empty, so a sketch's
+/// loop() does not spin while a pipe or pseudo-terminal is idle. When the input ends the
+/// shim's main returns after the current loop().
+/// </remark>
+class HardwareSerial
+{
+private:
+	unsigned char buffer[SERIAL_BUFFER_SIZE];
+	int head;
+	int count;
+
+	bool Fill();
+
+public:
+	int input;              // Input file descriptor.
+	FILE* output;           // Where output is written, NULL discards it.
+	bool endOfInput;
+	unsigned long long bytesRead;
+
+	HardwareSerial();
+
+	void begin(unsigned long baud);
+	void end();
+	int available();
+	int peek();
+	int read();
+	void flush();
+
+	size_t write(uint8_t c);
+	size_t write(const uint8_t* bytes, size_t length);
+
+	size_t print(const char* text);
+	size_t print(char c);
+	size_t print(int value);
+	size_t print(unsigned int value);
+	size_t print(long value);
+	size_t print(unsigned long value);
+	size_t print(double value, int digits = 2);
+
+	size_t println();
+	size_t println(const char* text);
+	size_t println(char c);
+	size_t println(int value);
+	size_t println(unsigned int value);
+	size_t println(long value);
+	size_t println(unsigned long value);
+	size_t println(double value, int digits = 2);
+
+	operator bool();
+};
+
+extern HardwareSerial Serial;
+
+extern bool delayEnabled; // delay() sleeps when true, otherwise it returns at once (full speed).
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+
+void setup();
+void loop();
+
+#endif
@@ -0,0 +1,150 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeBatchRunner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int BATCH_TEST_FILES = 6;
+
+struct BatchTestRun
+{
+	GCodeBatchResult results[BATCH_TEST_FILES];
+	int sinkCalls;
+	uint64_t hookBlocks;
+};
+
+static void KeepResult(const GCodeBatchResult* result, void* context)
+{
+	BatchTestRun* run = (BatchTestRun*)context;
+	run->results[result->file] = *result;
+	run->sinkCalls++;
+}
+
+static void CountBlock(GCodeParser* parser, int worker, long file, void* context)
+{
+	if (parser->line[0] != '\0')
+		__atomic_fetch_add(&((BatchTestRun*)context)->hookBlocks, 1, __ATOMIC_RELAXED);
+}
+
+static bool WriteFile(const char* path, const char* text)
+{
+	FILE* file = fopen(path, "wb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = fwrite(text, 1, strlen(text), file) == strlen(text);
+
+	return fclose(file) == 0 && result;
+}
+
+/// <summary>
+/// Runs a batch and keeps the results by file.
+/// </summary>
+static bool RunBatch(GCodeBatchRunner* runner, const char* const* paths, BatchTestRun* run)
+{
+	memset(run, 0, sizeof(*run));
+	runner->blockHook = CountBlock;
+	runner->hookContext = run;
+
+	return runner->Run(paths, BATCH_TEST_FILES, KeepResult, run);
+}
+
+HOST_TEST(BatchRunner_Threads_SameResults)
+{
+	static char paths[BATCH_TEST_FILES][512];
+	const char* list[BATCH_TEST_FILES];
+	const char* names[BATCH_TEST_FILES] = { "a.gcode", "b.gcode", "missing.gcode", "c.gcode", "d.gcode", "e.gcode" };
+
+	for (int i = 0; i < BATCH_TEST_FILES; i++)
+	{
+		snprintf(paths[i], sizeof(paths[i]), "%s", HostTest::TempPath(names[i]));
+		list[i] = paths[i];
+	}
+
+	CHECK(WriteFile(paths[0], "G1 X1 Y2 ; first\nM104 S200\n\n(second)\nG1 X3"));
+	CHECK(WriteFile(paths[1], ""));
+
+	// Large enough to be split into chunks.
+	size_t size = 200000;
+	char* large = (char*)malloc(size);
+	size_t length = 0;
+
+	for (int line = 0; length < size - 64; line++)
+		length += snprintf(&large[length], size - length, line % 10 == 0 ? "; layer %d\n" : "G1 X%d.5 Y%d E0.1\n", line, line);
+
+	CHECK(WriteFile(paths[3], large));
+	CHECK(WriteFile(paths[4], large));
+	CHECK(WriteFile(paths[5], "G1 X1\nG999 X1\nM104 S200\n"));
+
+	GCodeBatchRunner runner;
+	BatchTestRun single;
+	runner.threads = 1;
+	runner.chunkSize = 1 << 30;
+	CHECK(RunBatch(&runner, list, &single));
+
+	CHECK(runner.filesDone == 5 && runner.filesFailed == 1);
+	CHECK(single.sinkCalls == BATCH_TEST_FILES);
+	CHECK(!single.results[2].read);
+	CHECK(single.results[0].read && single.results[0].chunks == 1);
+	CHECK(single.results[0].lines == 5 && single.results[0].blocks == 3);
+	CHECK(single.results[0].words == 7 && single.results[0].commentedBlocks == 2);
+	CHECK(single.results[1].read && single.results[1].lines == 0);
+	CHECK(single.results[3].bytes == length && single.results[3].invalid == 0);
+	CHECK(runner.bytesDone == 2 * length + strlen("G1 X1 Y2 ; first\nM104 S200\n\n(second)\nG1 X3") +
+		strlen("G1 X1\nG999 X1\nM104 S200\n"));
+
+	// More threads and small chunks find the same.
+	BatchTestRun split;
+	runner.threads = 4;
+	runner.chunkSize = 4096;
+	CHECK(RunBatch(&runner, list, &split));
+	CHECK(runner.filesDone == 5 && runner.filesFailed == 1);
+	CHECK(split.results[3].chunks > 1);
+
+	uint64_t blocks = 0;
+
+	for (int i = 0; i < BATCH_TEST_FILES; i++)
+	{
+		CHECK(split.results[i].read == single.results[i].read);
+		CHECK(split.results[i].lines == single.results[i].lines);
+		CHECK(split.results[i].blocks == single.results[i].blocks);
+		CHECK(split.results[i].words == single.results[i].words);
+		CHECK(split.results[i].commentedBlocks == single.results[i].commentedBlocks);
+		blocks += split.results[i].blocks;
+	}
+
+	CHECK(split.hookBlocks == blocks && single.hookBlocks == blocks);
+
+	// A dialect counts the blocks it rejects.
+	BatchTestRun checked;
+	runner.dialect = &GCodeDialectMarlin;
+	CHECK(RunBatch(&runner, list, &checked));
+	CHECK(checked.results[5].invalid == 1 && checked.results[3].invalid == 0);
+
+	free(large);
+}
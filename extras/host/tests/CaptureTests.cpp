@@ -0,0 +1,172 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeCapture.h"
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char* captureChunks[] = { "G1 X1", " Y2 ; first\nG1", " X3\n", "(second)\nM30\n" };
+static const int captureChunkCount = 4;
+
+static uint64_t Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/// <summary>
+/// Records the chunks as they are read from a pipe, the given microseconds apart.
+/// </summary>
+static bool Record(const char* path, uint64_t gap, GCodeCaptureWriter* writer)
+{
+	int fds[2];
+
+	if (pipe(fds) != 0 || !writer->Open(path))
+		return false;
+
+	uint64_t time = Now();
+	bool result = true;
+
+	for (int i = 0; i < captureChunkCount && result; i++)
+	{
+		char buffer[64];
+		int length = (int)strlen(captureChunks[i]);
+
+		result = write(fds[1], captureChunks[i], length) == length
+			&& read(fds[0], buffer, sizeof(buffer)) == length;
+
+		time += gap;
+		result = result && writer->Write(buffer, length, time);
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+
+	return writer->Close() && result;
+}
+
+HOST_TEST(Capture_WriteRead_RoundTrip)
+{
+	GCodeCaptureWriter writer;
+	GCodeCaptureReader reader;
+	const char* path = HostTest::TempPath("round.cap");
+
+	CHECK(Record(path, 1000, &writer));
+	CHECK(writer.chunks == 4);
+	CHECK(writer.bytes == 36);
+	CHECK(writer.sequence.blocks == 4);
+
+	// Every chunk comes back as it was received, with the time since the previous one.
+	CHECK(reader.Open(path));
+	CHECK(reader.startTime > 0);
+
+	const char* data;
+	uint64_t delay;
+
+	for (int i = 0; i < captureChunkCount; i++)
+	{
+		int length = reader.Next(&data, &delay);
+
+		CHECK(length == (int)strlen(captureChunks[i]));
+		CHECK(memcmp(data, captureChunks[i], length) == 0);
+
+		if (i > 0)
+			CHECK(delay == 1000);
+	}
+
+	CHECK(reader.Next(&data, &delay) == 0);
+	CHECK(reader.recordedBlocks == 4);
+	CHECK(reader.recordedHash == writer.sequence.hash);
+	reader.Close();
+
+	// The same blocks in other chunks give the same sequence.
+	GCodeBlockSequence whole;
+	const char program[] = "G1 X1 Y2 ; first\nG1 X3\n(second)\nM30\n";
+
+	whole.Add(program, (int)strlen(program));
+	CHECK(whole.blocks == 4 && whole.hash == writer.sequence.hash);
+
+	whole.Reset();
+	whole.Add(program, 9);
+	CHECK(whole.hash != writer.sequence.hash);
+}
+
+HOST_TEST(Capture_Replay_KeepsTiming)
+{
+	GCodeCaptureWriter writer;
+	GCodeCaptureReader reader;
+	GCodeReplayStatistics statistics;
+	const char* path = HostTest::TempPath("timing.cap");
+
+	CHECK(Record(path, 20000, &writer));
+
+	// Fast replay does not wait, real time replay waits for the recorded gaps.
+	CHECK(reader.Replay(path, false, &statistics));
+	CHECK(statistics.verified);
+	CHECK(statistics.chunks == 4 && statistics.bytes == 36 && statistics.blocks == 4);
+	CHECK(statistics.recordedSeconds >= 0.08 && statistics.recordedSeconds < 0.081);
+	CHECK(statistics.seconds < statistics.recordedSeconds);
+
+	CHECK(reader.Replay(path, true, &statistics));
+	CHECK(statistics.verified);
+	CHECK(statistics.seconds >= 0.08);
+	CHECK(statistics.parseSeconds <= statistics.seconds);
+}
+
+HOST_TEST(Capture_CutShort_IsNotVerified)
+{
+	GCodeCaptureWriter writer;
+	GCodeCaptureReader reader;
+	GCodeReplayStatistics statistics;
+	const char* path = HostTest::TempPath("cut.cap");
+
+	CHECK(Record(path, 1000, &writer));
+
+	// Without the end record (1 + 1 byte varint + 8 byte hash) the chunks replay but are not verified.
+	FILE* file = fopen(path, "rb+");
+	CHECK(file != NULL);
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fclose(file);
+	CHECK(truncate(path, size - 10) == 0);
+
+	CHECK(reader.Replay(path, false, &statistics));
+	CHECK(!statistics.verified);
+	CHECK(statistics.chunks == 4 && statistics.blocks == 4);
+	CHECK(reader.recordedBlocks == -1);
+
+	// A record of an unknown type is damage, not the end of the capture.
+	CHECK(truncate(path, size - 11) == 0);
+	file = fopen(path, "ab");
+	CHECK(file != NULL);
+	fputs("X1234567890", file);
+	fclose(file);
+	CHECK(!reader.Replay(path, false, &statistics));
+
+	CHECK(!reader.Open(HostTest::TempPath("missing.cap")));
+}
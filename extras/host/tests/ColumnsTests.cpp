@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeColumns.h"
+#include "../../../src/GCodeDialect.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char columnsProgram[] =
+	"G1 X1 Y2 ; first\n"
+	"M104 S200\n"
+	"\n"
+	"G1 X3 ; first\n"
+	"(second)\n"
+	"G2.1 X4";
+
+HOST_TEST(Columns_ParseBuffer_ConfirmRows)
+{
+	GCodeColumns columns;
+
+	CHECK(columns.ParseBuffer(columnsProgram, strlen(columnsProgram)));
+
+	// The empty line has no row, the comment only line and the last line without a line feed do.
+	CHECK(columns.rowCount == 5);
+	CHECK(columns.summary.sourceLines == 6);
+	CHECK(columns.summary.blocks == 5);
+	CHECK(columns.summary.commentedBlocks == 3);
+	CHECK(columns.summary.letterCount['X' - 'A'] == 3);
+
+	CHECK(columns.IsPresent('X', 0));
+	CHECK(columns.value['Y' - 'A'][0] == 2.0);
+	CHECK(!columns.IsPresent('X', 1));
+	CHECK(columns.value['S' - 'A'][1] == 200.0);
+	CHECK(columns.value['X' - 'A'][2] == 3.0);
+	CHECK(columns.lineNumber[2] == 4);
+	CHECK(columns.lineNumber[4] == 6);
+
+	CHECK(columns.gCommand[0] == GCodeDialect::CommandKey('G', 1, -1));
+	CHECK(columns.mCommand[0] == GCODE_COMMAND_EMPTY);
+	CHECK(columns.mCommand[1] == GCodeDialect::CommandKey('M', 104, -1));
+	CHECK(columns.gCommand[4] == GCodeDialect::CommandKey('G', 2, 1));
+
+	// Equal comments share an ID.
+	CHECK(columns.commentId[0] == columns.commentId[2]);
+	CHECK(columns.commentId[1] == -1);
+	CHECK(strcmp(columns.Comment(0), "; first") == 0);
+	CHECK(strcmp(columns.Comment(3), "(second)") == 0);
+	CHECK(strcmp(columns.Comment(1), "") == 0);
+}
+
+HOST_TEST(Columns_DumpMap_RoundTrip)
+{
+	GCodeColumns columns;
+	GCodeColumnsView view;
+	const char* path = HostTest::TempPath("columns.bin");
+
+	CHECK(columns.ParseBuffer(columnsProgram, strlen(columnsProgram)));
+	CHECK(columns.Dump(path));
+	CHECK(view.Map(path));
+
+	CHECK(view.rowCount == columns.rowCount);
+	CHECK(view.summary->blocks == 5);
+	CHECK(view.distinctComments == 2);
+	CHECK(view.IsPresent('S', 1));
+	CHECK(!view.IsPresent('S', 0));
+	CHECK(!view.IsPresent('Q', 0));
+	CHECK(view.value['X' - 'A'][4] == 4.0);
+	CHECK(view.mCommand[1] == GCodeDialect::CommandKey('M', 104, -1));
+	CHECK(view.lineNumber[3] == 5);
+	CHECK(strcmp(view.Comment(2), "; first") == 0);
+	CHECK(strcmp(view.Comment(1), "") == 0);
+	CHECK(view.commentCount[view.commentId[0]] == 2);
+
+	view.Unmap();
+	CHECK(!view.Map(HostTest::TempPath("missing.bin")));
+}
+
+HOST_TEST(Columns_LongLine_IsNotDropped)
+{
+	GCodeColumns columns;
+	const size_t size = (1 << 20) + 64;
+	char* text = (char*)malloc(size + 64);
+	int length = sprintf(text, "G1 X1\nG1 X2 (");
+
+	// Longer than MAX_LINE_SIZE, parsed in the arena.
+	memset(&text[length], 'a', 300);
+	strcpy(&text[length + 300], ")\nG1 X3\n");
+	CHECK(columns.ParseBuffer(text, strlen(text)));
+	CHECK(columns.rowCount == 3 && columns.value['X' - 'A'][1] == 2.0);
+	CHECK(strlen(columns.Comment(1)) == 302);
+
+	// Longer than the arena fails the parse, with or without a line feed after it.
+	columns.Clear();
+	memset(&text[length], 'a', size);
+	strcpy(&text[length + size], ")\nG1 X3\n");
+	CHECK(!columns.ParseBuffer(text, strlen(text)));
+	CHECK(columns.longLine == 2);
+
+	columns.Clear();
+	text[length + size] = '\0';
+	FILE* file = fmemopen(text, strlen(text), "rb");
+	CHECK(file != NULL);
+	CHECK(!columns.ParseStream(file));
+	CHECK(columns.longLine == 2);
+	fclose(file);
+
+	CHECK(columns.ParseBuffer("G1\n", 3) && columns.longLine == 0);
+	free(text);
+}
@@ -0,0 +1,194 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeDiff.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool HashProgram(const char* program, GCodeProgramHashes* hashes)
+{
+	FILE* file = fmemopen((void*)program, strlen(program), "rb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = hashes->ParseStream(file);
+	fclose(file);
+
+	return result;
+}
+
+HOST_TEST(Diff_Hashes_IgnoreSpacingAndComments)
+{
+	GCodeProgramHashes hashes;
+
+	CHECK(HashProgram("G1 X1 Y2 ; move\n(only a comment)\n\nG1X1Y2\ng1 x1 y2\n", &hashes));
+
+	// Lines without code are skipped, spacing and comments do not change the hash.
+	CHECK(hashes.count == 3);
+	CHECK(hashes.hash[0] == hashes.hash[1]);
+	CHECK(hashes.hash[0] == GCodeProgramHashes::HashCode("G1X1Y2"));
+	CHECK(hashes.lineNumber[1] == 4);
+	CHECK(hashes.lineNumber[2] == 5);
+}
+
+HOST_TEST(Diff_Hashes_LongLineIsNotDropped)
+{
+	GCodeProgramHashes hashes;
+	const size_t size = (1 << 20) + 64;
+	char* text = (char*)malloc(size + 1024);
+	int length = sprintf(text, "G1 X1\nG1 X2 ");
+
+	// Longer than MAX_LINE_SIZE, parsed in the arena.
+	for (int i = 0; i < 100; i++)
+		length += sprintf(&text[length], "Y%d", i);
+
+	strcpy(&text[length], "\nG1 X3\n");
+	CHECK(HashProgram(text, &hashes));
+	CHECK(hashes.count == 3 && hashes.lineNumber[1] == 2);
+
+	// Longer than the arena fails, with or without a line feed after it.
+	hashes.Clear();
+	memset(&text[length], 'Y', size);
+	strcpy(&text[length + size], "\nG1 X3\n");
+	CHECK(!HashProgram(text, &hashes));
+	CHECK(hashes.longLine == 2);
+
+	hashes.Clear();
+	text[length + size] = '\0';
+	CHECK(!HashProgram(text, &hashes));
+	CHECK(hashes.longLine == 2);
+
+	hashes.Clear();
+	CHECK(HashProgram("G1\n", &hashes) && hashes.longLine == 0);
+	free(text);
+}
+
+HOST_TEST(Diff_Identical_AllUnchanged)
+{
+	GCodeProgramHashes oldProgram;
+	GCodeProgramHashes newProgram;
+	GCodeDiff diff;
+
+	CHECK(HashProgram("G1 X1\nG1 X2\nG1 X3\n", &oldProgram));
+	CHECK(HashProgram("G1 X1 ; same\nG1 X2\nG1 X3", &newProgram));
+	CHECK(diff.Compare(&oldProgram, &newProgram));
+
+	CHECK(diff.regionCount == 1);
+	CHECK(diff.regions[0].type == GCODE_DIFF_UNCHANGED);
+	CHECK(diff.regions[0].count == 3);
+	CHECK(diff.unchangedBlocks == 3);
+	CHECK(diff.insertedBlocks + diff.deletedBlocks + diff.movedBlocks == 0);
+}
+
+HOST_TEST(Diff_InsertDelete_ConfirmRegions)
+{
+	GCodeProgramHashes oldProgram;
+	GCodeProgramHashes newProgram;
+	GCodeDiff diff;
+
+	// Regions are matched in windows of four blocks, so the unchanged runs are at least that long.
+	CHECK(HashProgram("G1 X1\nG1 X2\nG1 X3\nG1 X4\nG1 X5\nG1 X6\nG1 X7\nG1 X8\n", &oldProgram));
+	CHECK(HashProgram("G1 X1\nG1 X2\nM3 S1000\nM8\nG1 X3\nG1 X4\nG1 X5\nG1 X6\nG1 X8\n", &newProgram));
+	CHECK(diff.Compare(&oldProgram, &newProgram));
+
+	CHECK(diff.unchangedBlocks == 7);
+	CHECK(diff.insertedBlocks == 2);
+	CHECK(diff.deletedBlocks == 1);
+	CHECK(diff.movedBlocks == 0);
+
+	CHECK(diff.regionCount == 5);
+	CHECK(diff.regions[1].type == GCODE_DIFF_INSERTED);
+	CHECK(diff.regions[1].oldBlock == -1);
+	CHECK(diff.regions[1].newBlock == 2);
+	CHECK(diff.regions[1].count == 2);
+	// Deleted regions follow the others, in old program order.
+	CHECK(diff.regions[4].type == GCODE_DIFF_DELETED);
+	CHECK(diff.regions[4].oldBlock == 6);
+	CHECK(diff.regions[4].newBlock == -1);
+	CHECK(diff.regions[4].count == 1);
+}
+
+HOST_TEST(Diff_MovedBlocks_ClassifiedAsMoved)
+{
+	GCodeProgramHashes oldProgram;
+	GCodeProgramHashes newProgram;
+	GCodeDiff diff;
+
+	// The pocket (X10 to X14) is cut before the profile (X1 to X6) instead of after it.
+	CHECK(HashProgram("G0 Z5\nG1 X1\nG1 X2\nG1 X3\nG1 X4\nG1 X5\nG1 X6\n"
+		"G1 X10\nG1 X11\nG1 X12\nG1 X13\nG1 X14\nM30\n", &oldProgram));
+	CHECK(HashProgram("G0 Z5\nG1 X10\nG1 X11\nG1 X12\nG1 X13\nG1 X14\n"
+		"G1 X1\nG1 X2\nG1 X3\nG1 X4\nG1 X5\nG1 X6\nM30\n", &newProgram));
+	CHECK(diff.Compare(&oldProgram, &newProgram));
+
+	// The longer run stays in order, the shorter one moved.
+	CHECK(diff.insertedBlocks == 0);
+	CHECK(diff.deletedBlocks == 0);
+	CHECK(diff.movedBlocks == 5);
+	CHECK(diff.unchangedBlocks == 8);
+
+	bool movedFound = false;
+
+	for (long i = 0; i < diff.regionCount; i++)
+	{
+		if (diff.regions[i].type == GCODE_DIFF_MOVED)
+		{
+			movedFound = true;
+			CHECK(diff.regions[i].count == 5);
+			CHECK(oldProgram.hash[diff.regions[i].oldBlock] == newProgram.hash[diff.regions[i].newBlock]);
+		}
+	}
+
+	CHECK(movedFound);
+}
+
+HOST_TEST(Diff_OverlappingRuns_OnlyOneUnchanged)
+{
+	GCodeProgramHashes oldProgram;
+	GCodeProgramHashes newProgram;
+	GCodeDiff diff;
+
+	// X5 to X7 are repeated, so both runs of the new program match the old X5 to X7.
+	CHECK(HashProgram("G0 Z5\nG1 X1\nG1 X2\nG1 X3\nG1 X4\nG1 X5\nG1 X6\nG1 X7\nG1 X8\nG1 X9\nM30\n", &oldProgram));
+	CHECK(HashProgram("M3\nG1 X2\nG1 X3\nG1 X4\nG1 X5\nG1 X6\nG1 X7\n"
+		"G1 X5\nG1 X6\nG1 X7\nG1 X8\nG1 X9\nM5\n", &newProgram));
+	CHECK(diff.Compare(&oldProgram, &newProgram));
+
+	// The runs cross in the old program, so they cannot both be in order.
+	CHECK(diff.unchangedBlocks == 6);
+	CHECK(diff.movedBlocks == 5);
+	CHECK(diff.insertedBlocks == 2);
+	CHECK(diff.deletedBlocks == 3);
+
+	for (long i = 0; i < diff.regionCount; i++)
+	{
+		if (diff.regions[i].type == GCODE_DIFF_UNCHANGED)
+			CHECK(diff.regions[i].oldBlock == 2 && diff.regions[i].newBlock == 1 && diff.regions[i].count == 6);
+		else if (diff.regions[i].type == GCODE_DIFF_MOVED)
+			CHECK(diff.regions[i].oldBlock == 5 && diff.regions[i].newBlock == 7 && diff.regions[i].count == 5);
+	}
+}
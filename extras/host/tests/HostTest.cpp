@@ -0,0 +1,125 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// hosttests - Runs the tests of the host modules.
+//
+// Usage: hosttests [name-prefix]
+
+#include "HostTest.h"
+#include <ftw.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static HostTestCase* firstTest = NULL;
+static HostTestCase* lastTest = NULL;
+static int failures = 0;
+static char tempDirectory[PATH_MAX / 2] = "";
+
+/// <summary>
+/// Adds a test to the end of the list run by main.
+/// </summary>
+/// <returns>True, so registration can initialize a static.</returns>
+bool HostTest::Register(HostTestCase* test)
+{
+	if (lastTest == NULL)
+		firstTest = test;
+	else
+		lastTest->next = test;
+
+	lastTest = test;
+
+	return true;
+}
+
+/// <summary>
+/// Reports a failed check. The test goes on so all of its failures are listed.
+/// </summary>
+void HostTest::Fail(const char* file, int line, const char* expression)
+{
+	fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+	failures++;
+}
+
+/// <summary>
+/// Gets a path in a directory created for the run and removed when it ends.
+/// </summary>
+/// <param name="name">The file name.</param>
+/// <returns>The path, valid until the next call.</returns>
+const char* HostTest::TempPath(const char* name)
+{
+	static char path[PATH_MAX];
+
+	if (tempDirectory[0] == '\0')
+	{
+		const char* base = getenv("TMPDIR");
+		snprintf(tempDirectory, sizeof(tempDirectory), "%s/hosttests.XXXXXX", base != NULL ? base : "/tmp");
+
+		if (mkdtemp(tempDirectory) == NULL)
+		{
+			perror("mkdtemp");
+			exit(1);
+		}
+	}
+
+	snprintf(path, sizeof(path), "%s/%s", tempDirectory, name);
+
+	return path;
+}
+
+static int RemoveEntry(const char* path, const struct stat* status, int type, struct FTW* walk)
+{
+	return remove(path);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* prefix = argc > 1 ? argv[1] : "";
+	int run = 0;
+	int failed = 0;
+
+	for (HostTestCase* test = firstTest; test != NULL; test = test->next)
+	{
+		if (strncmp(test->name, prefix, strlen(prefix)) != 0)
+			continue;
+
+		int before = failures;
+		test->function();
+		run++;
+
+		if (failures != before)
+		{
+			fprintf(stderr, "FAILED %s\n", test->name);
+			failed++;
+		}
+	}
+
+	if (tempDirectory[0] != '\0')
+		nftw(tempDirectory, RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+
+	printf("%d tests, %d failed\n", run, failed);
+
+	return failed == 0 ? 0 : 1;
+}
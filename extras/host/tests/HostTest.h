@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef HostTest_h
+#define HostTest_h
+
+/// <summary>
+/// A test registered by HOST_TEST.
+/// </summary>
+struct HostTestCase
+{
+	const char* name;
+	void (*function)();
+	HostTestCase* next;
+};
+
+/// <summary>
+/// Minimal test runner for the host modules, built and run by "make test".
+/// </summary>
+/// <remark>
+/// The library itself is tested by the Visual Studio unit tests. The host modules use POSIX
+/// calls, so their tests run here instead, in the same Arrange, Act, Assert style:
+///
+///   HOST_TEST(Diff_InsertedBlock_ReportsInsert)
+///   {
+///     ...
+///     CHECK(diff.insertedBlocks == 1);
+///   }
+/// </remark>
+class HostTest
+{
+public:
+	static bool Register(HostTestCase* test);
+	static void Fail(const char* file, int line, const char* expression);
+	static const char* TempPath(const char* name);
+};
+
+#define HOST_TEST(name) \
+	static void name(); \
+	static HostTestCase name##Case = { #name, name, 0 }; \
+	static bool name##Registered = HostTest::Register(&name##Case); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) HostTest::Fail(__FILE__, __LINE__, #condition); } while (0)
+
+#endif
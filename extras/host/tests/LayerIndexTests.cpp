@@ -0,0 +1,155 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeLayerIndex.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char commentedProgram[] =
+	"M83\n"
+	"G1 Z5 F3000\n"
+	";LAYER:0\n"
+	"G1 Z0.2\n"
+	"G1 X10 Y0 E1\n"
+	"G1 X10 Y10 E1\n"
+	";LAYER:1\n"
+	"T1\n"
+	"G1 Z0.4\n"
+	"G1 X0 Y10 E1\n";
+
+static const char slicedProgram[] =
+	"G1 Z0.2\n"
+	"G1 X10 E1\n"
+	"G1 Z1\n"
+	"G1 X20\n"
+	"G1 Z0.2\n"
+	"G1 Y10 E2\n"
+	"G1 Z0.4\n"
+	"G1 X0 E3\n";
+
+/// <summary>
+/// Counts the layers a task is called with.
+/// </summary>
+static void CountLayer(const GCodeIndexEntry* layer, const char* text, void* context)
+{
+	// Each layer's text starts at its first line.
+	if (strncmp(text, ";LAYER:", 7) == 0)
+		__atomic_fetch_add((long*)context, layer->number + 1, __ATOMIC_RELAXED);
+}
+
+HOST_TEST(LayerIndex_LayerComments_SplitLayers)
+{
+	GCodeLayerIndex index;
+
+	CHECK(index.BuildBuffer(commentedProgram, strlen(commentedProgram)));
+	CHECK(index.sourceBytes == strlen(commentedProgram));
+	CHECK(index.sourceLines == 10);
+
+	// The start G-Code is outside the layers.
+	CHECK(index.layerCount == 2);
+	CHECK(index.layers[0].number == 0 && index.layers[0].line == 3 && index.layers[0].lines == 4);
+	CHECK(index.layers[0].offset == (uint64_t)(strstr(commentedProgram, ";LAYER:0") - commentedProgram));
+	CHECK(index.layers[1].number == 1 && index.layers[1].line == 7 && index.layers[1].lines == 4);
+	CHECK(index.layers[0].length + index.layers[0].offset == index.layers[1].offset);
+	CHECK(index.layers[1].offset + index.layers[1].length == index.sourceBytes);
+
+	// Layer Z is the Z of the first working move, bounds hold the layer's moves.
+	CHECK(index.layers[0].z == 0.2 && index.layers[1].z == 0.4);
+	CHECK(index.layers[0].bounds.min[0] == 0.0 && index.layers[0].bounds.max[0] == 10.0);
+	CHECK(index.layers[0].bounds.max[1] == 10.0 && index.layers[0].bounds.min[2] == 0.2);
+	CHECK(index.layers[0].bounds.max[2] == 5.0);
+
+	// Checkpoints hold the modal state before the layer.
+	CHECK(!index.layers[0].state.absoluteExtrusion);
+	CHECK(index.layers[0].state.feedRate == 3000.0 && index.layers[0].state.position[2] == 5.0);
+	CHECK(index.layers[1].state.position[0] == 10.0 && index.layers[1].state.position[3] == 2.0);
+	CHECK(index.layers[1].state.tool == -1);
+
+	// T1 starts a tool segment.
+	CHECK(index.toolSegmentCount == 1);
+	CHECK(index.toolSegments[0].number == 1 && index.toolSegments[0].line == 8 && index.toolSegments[0].lines == 3);
+	CHECK(index.toolSegments[0].bounds.min[0] == 0.0 && index.toolSegments[0].bounds.max[0] == 10.0);
+
+	CHECK(index.LayerAt(0) == -1);
+	CHECK(index.LayerAt(index.layers[0].offset) == 0);
+	CHECK(index.LayerAt(index.layers[1].offset - 1) == 0);
+	CHECK(index.LayerAt(index.sourceBytes - 1) == 1);
+	CHECK(index.LayerAt(index.sourceBytes) == -1);
+}
+
+HOST_TEST(LayerIndex_ZChanges_KeepHopsInLayer)
+{
+	GCodeLayerIndex index;
+
+	CHECK(index.BuildBuffer(slicedProgram, strlen(slicedProgram)));
+
+	// The hop to Z1 and back is a travel within the first layer.
+	CHECK(index.layerCount == 2);
+	CHECK(index.layers[0].line == 1 && index.layers[0].z == 0.2);
+	CHECK(index.layers[0].bounds.max[2] == 1.0 && index.layers[0].bounds.max[0] == 20.0);
+	CHECK(index.layers[1].line == 7 && index.layers[1].z == 0.4 && index.layers[1].lines == 2);
+	CHECK(index.layers[1].state.position[0] == 20.0 && index.layers[1].state.position[1] == 10.0);
+}
+
+HOST_TEST(LayerIndex_Chunks_MatchBuffer)
+{
+	GCodeLayerIndex whole;
+	GCodeLayerIndex chunked;
+
+	CHECK(whole.BuildBuffer(commentedProgram, strlen(commentedProgram) - 1));
+
+	// A byte at a time, without the last line feed.
+	for (size_t i = 0; i < strlen(commentedProgram) - 1; i++)
+		CHECK(chunked.Add(&commentedProgram[i], 1));
+
+	CHECK(chunked.Finish());
+	CHECK(chunked.sourceLines == whole.sourceLines && chunked.sourceLines == 10);
+	CHECK(chunked.layerCount == whole.layerCount);
+	CHECK(chunked.layers[1].offset == whole.layers[1].offset);
+	CHECK(chunked.layers[1].bounds.min[0] == 0.0 && whole.layers[1].bounds.min[0] == 0.0);
+	CHECK(chunked.toolSegmentCount == 1);
+}
+
+HOST_TEST(LayerIndex_SeekLayer_ResumesParsing)
+{
+	GCodeLayerIndex index;
+	GCodeModalState state;
+	char line[32];
+
+	CHECK(index.BuildBuffer(commentedProgram, strlen(commentedProgram)));
+
+	FILE* file = fmemopen((void*)commentedProgram, strlen(commentedProgram), "rb");
+	CHECK(file != NULL);
+	CHECK(index.SeekLayer(file, 1, &state));
+	CHECK(fgets(line, sizeof(line), file) != NULL && strcmp(line, ";LAYER:1\n") == 0);
+	CHECK(state.position[1] == 10.0 && !state.absoluteExtrusion);
+	CHECK(!index.SeekLayer(file, 2, &state));
+	fclose(file);
+
+	long sum = 0;
+	CHECK(index.RunLayers(commentedProgram, strlen(commentedProgram), 4, CountLayer, &sum));
+	CHECK(sum == 3);
+	CHECK(!index.RunLayers(commentedProgram, strlen(commentedProgram) - 1, 4, CountLayer, &sum));
+}
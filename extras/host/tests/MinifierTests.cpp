@@ -0,0 +1,202 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeMinifier.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// <summary>
+/// Minifies a program held in memory.
+/// </summary>
+/// <returns>The minified program, to be freed, or NULL if MinifyStream fails.</returns>
+static char* Minify(GCodeMinifier* minifier, const char* program)
+{
+	FILE* in = fmemopen((void*)program, strlen(program), "rb");
+	char* text = NULL;
+	size_t size = 0;
+	FILE* out = open_memstream(&text, &size);
+
+	if (in == NULL || out == NULL)
+		return NULL;
+
+	bool result = minifier->MinifyStream(in, out);
+	fclose(in);
+	fclose(out);
+
+	if (!result)
+	{
+		free(text);
+		return NULL;
+	}
+
+	return text;
+}
+
+/// <summary>
+/// Determine if a program minifies to the text expected for a controller with modal motion.
+/// </summary>
+static bool MinifiesTo(const char* program, const char* expected)
+{
+	GCodeMinifier minifier;
+	minifier.modalMotion = true;
+	char* text = Minify(&minifier, program);
+	bool result = text != NULL && strcmp(text, expected) == 0;
+
+	if (!result)
+		fprintf(stderr, "minified to:\n%s", text != NULL ? text : "(failed)\n");
+
+	free(text);
+
+	return result;
+}
+
+HOST_TEST(Minifier_Moves_DropsRedundantWords)
+{
+	CHECK(MinifiesTo(
+		"G21 G90 ; metric\n"
+		"G01 X0.500 Y1.0 F1500\n"
+		"G01 X0.500 Y2.0 F1500\n"
+		"G1 X0.5 Y2\n"
+		"(MSG,Cut done)\n"
+		"G0 Z5.000\n",
+		"G21G90\n"
+		"G1X.5Y1F1500\n"
+		"Y2\n"
+		"(MSG,Cut done)\n"
+		"G0Z5\n"));
+}
+
+HOST_TEST(Minifier_Rounding_CarriesRelativeMoves)
+{
+	GCodeMinifier minifier;
+	minifier.modalMotion = true;
+	minifier.SetDecimals("XY", 1);
+	char* text = Minify(&minifier, "G91\nG1 X0.04\nG1 X0.04\nG1 X0.04\nG1 X0.04\n");
+
+	// 0.16 in total: moves rounding to 0 are dropped and their rounding carried to the next.
+	CHECK(text != NULL && strcmp(text, "G91\nG1\nX.1\nX.1\n") == 0);
+
+	free(text);
+}
+
+HOST_TEST(Minifier_MCodeAxisWords_AreArguments)
+{
+	// Steps per unit and feed rate limits are not positions.
+	CHECK(MinifiesTo(
+		"G90\n"
+		"G1 X80 Y80\n"
+		"M92 X80 Y80\n",
+		"G90\n"
+		"G1X80Y80\n"
+		"M92X80Y80\n"));
+
+	// The limit does not move the machine, so the move to the same number is kept.
+	CHECK(MinifiesTo(
+		"G90\n"
+		"G1 X0\n"
+		"M203 X500\n"
+		"G1 X500\n",
+		"G90\n"
+		"G1X0\n"
+		"M203X500\n"
+		"G1X500\n"));
+}
+
+HOST_TEST(Minifier_DwellAxisWord_IsKept)
+{
+	CHECK(MinifiesTo(
+		"G90\n"
+		"G1 X10\n"
+		"G4 X10\n"
+		"G4 P500\n",
+		"G90\n"
+		"G1X10\n"
+		"G4X10\n"
+		"G4P500\n"));
+}
+
+HOST_TEST(Minifier_DistanceMode_LeavesExtrusionUnknown)
+{
+	// Klipper keeps M83 after G90, Marlin does not, so M82 is always sent.
+	CHECK(MinifiesTo(
+		"M83\n"
+		"G90\n"
+		"M82\n"
+		"M82\n"
+		"G91\n"
+		"M83\n",
+		"M83\n"
+		"G90\n"
+		"M82\n"
+		"G91\n"
+		"M83\n"));
+}
+
+HOST_TEST(Minifier_Default_KeepsMotionWords)
+{
+	GCodeMinifier minifier;
+	char* text = Minify(&minifier, "G90\nG1 X1 F1500\nG1 X2 F1500\nG1 X2\n");
+
+	// Marlin rejects a move without a G word.
+	CHECK(text != NULL && strcmp(text, "G90\nG1X1F1500\nG1X2\n") == 0);
+	free(text);
+}
+
+HOST_TEST(Minifier_LongLine_IsNotDropped)
+{
+	char program[4096];
+	char comment[301];
+	memset(comment, 'a', 300);
+	comment[300] = '\0';
+
+	// Lines longer than MAX_LINE_SIZE are parsed in the arena.
+	snprintf(program, sizeof(program), "G90\nG1 X1 Y1\nG1 X2 (%s)\nG1 X3", comment);
+	CHECK(MinifiesTo(program, "G90\nG1X1Y1\nX2\nX3\n"));
+
+	snprintf(program, sizeof(program), "G1 X1 ;%s", comment);
+	CHECK(MinifiesTo(program, "G1X1\n"));
+
+	// A line too long even for the arena stops the stream with its line number.
+	const int size = (1 << 16) + 64;
+	char* huge = (char*)malloc(size + 64);
+	int length = sprintf(huge, "G90\nG1 X1 Y1\nG1 X2 (");
+	memset(&huge[length], 'a', size);
+	strcpy(&huge[length + size], ")\nG1 X3\n");
+
+	GCodeMinifier minifier;
+	CHECK(Minify(&minifier, huge) == NULL);
+	CHECK(minifier.longLine == 3);
+
+	// And without a line feed after it.
+	huge[length + size + 1] = '\0';
+	CHECK(Minify(&minifier, huge) == NULL);
+	CHECK(minifier.longLine == 3);
+	free(huge);
+
+	char* text = Minify(&minifier, "G1 X1\n");
+	CHECK(text != NULL && minifier.longLine == 0);
+	free(text);
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeParseCache.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool WriteFile(const char* path, const char* text)
+{
+	FILE* file = fopen(path, "wb");
+
+	if (file == NULL)
+		return false;
+
+	bool result = fwrite(text, 1, strlen(text), file) == strlen(text);
+
+	return fclose(file) == 0 && result;
+}
+
+/// <summary>
+/// Determine if the cache holds an entry for some source bytes.
+/// </summary>
+static bool HasEntry(const char* directory, const char* text)
+{
+	char key[CACHE_KEY_SIZE];
+	char path[1024];
+	struct stat status;
+
+	GCodeParseCache::Key(text, strlen(text), key);
+	snprintf(path, sizeof(path), "%s/%s", directory, key);
+
+	return stat(path, &status) == 0;
+}
+
+HOST_TEST(ParseCache_Rename_Hits)
+{
+	char directory[512];
+	char first[512];
+	char renamed[512];
+	snprintf(directory, sizeof(directory), "%s", HostTest::TempPath("cache-rename"));
+	snprintf(first, sizeof(first), "%s", HostTest::TempPath("part.gcode"));
+	snprintf(renamed, sizeof(renamed), "%s", HostTest::TempPath("part-copy.gcode"));
+
+	GCodeParseCache cache(directory, 0);
+	GCodeColumnsView view;
+
+	CHECK(WriteFile(first, "G1 X1 Y2 ; first\nM104 S200\nG1 X3\n"));
+	CHECK(cache.Open(first, &view));
+	CHECK(cache.misses == 1 && cache.hits == 0);
+	CHECK(view.rowCount == 3);
+	view.Unmap();
+
+	// Content addressed: the same bytes under another name are not parsed again.
+	CHECK(rename(first, renamed) == 0);
+	CHECK(cache.Open(renamed, &view));
+	CHECK(cache.misses == 1 && cache.hits == 1);
+	CHECK(view.rowCount == 3);
+	CHECK(view.value['S' - 'A'][1] == 200.0);
+	CHECK(strcmp(view.Comment(0), "; first") == 0);
+	view.Unmap();
+
+	// A change of one byte is a different program.
+	CHECK(WriteFile(renamed, "G1 X1 Y2 ; first\nM104 S201\nG1 X3\n"));
+	CHECK(cache.Open(renamed, &view));
+	CHECK(cache.misses == 2);
+	CHECK(view.value['S' - 'A'][1] == 201.0);
+	view.Unmap();
+
+	CHECK(!cache.Open(HostTest::TempPath("missing.gcode"), &view));
+}
+
+HOST_TEST(ParseCache_Evict_LeastRecentlyUsed)
+{
+	char directory[512];
+	snprintf(directory, sizeof(directory), "%s", HostTest::TempPath("cache-evict"));
+
+	const char* programs[3] = { "G1 X1\n", "G1 X2\n", "G1 X3\n" };
+	GCodeColumnsView view;
+
+	// Find the size of an entry, then allow two.
+	char key[CACHE_KEY_SIZE];
+	char path[1024];
+	struct stat status;
+
+	{
+		GCodeParseCache sizing(HostTest::TempPath("cache-size"), 0);
+		CHECK(sizing.OpenBuffer(programs[0], strlen(programs[0]), &view));
+		view.Unmap();
+
+		GCodeParseCache::Key(programs[0], strlen(programs[0]), key);
+		snprintf(path, sizeof(path), "%s/%s", HostTest::TempPath("cache-size"), key);
+		CHECK(stat(path, &status) == 0);
+	}
+
+	GCodeParseCache cache(directory, 2 * status.st_size + status.st_size / 2);
+
+	CHECK(cache.OpenBuffer(programs[0], strlen(programs[0]), &view));
+	view.Unmap();
+	usleep(10000);
+	CHECK(cache.OpenBuffer(programs[1], strlen(programs[1]), &view));
+	view.Unmap();
+	usleep(10000);
+
+	// The hit makes the first program the most recently used.
+	CHECK(cache.OpenBuffer(programs[0], strlen(programs[0]), &view));
+	view.Unmap();
+	usleep(10000);
+	CHECK(cache.hits == 1);
+
+	CHECK(cache.OpenBuffer(programs[2], strlen(programs[2]), &view));
+	CHECK(view.value['X' - 'A'][0] == 3.0);
+	view.Unmap();
+
+	CHECK(HasEntry(directory, programs[0]));
+	CHECK(!HasEntry(directory, programs[1]));
+	CHECK(HasEntry(directory, programs[2]));
+}
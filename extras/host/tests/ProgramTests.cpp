@@ -0,0 +1,187 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeProgram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char programText[] =
+	"G21 G90 ; start\n"
+	"\n"
+	"G1 X1.5 Y-2 F1500 ;TYPE:WALL\n"
+	"(note)\n"
+	"M104 S200\n"
+	"G1 X3 ;TYPE:WALL\n"
+	"G2 X4 Y5 I1 J-1";
+
+HOST_TEST(Program_Blocks_IterateWords)
+{
+	GCodeProgram program;
+
+	CHECK(program.ParseBuffer(programText, strlen(programText)));
+
+	// The blank line is skipped, the comment only line and the last line without a line feed are not.
+	CHECK(program.blockCount == 6);
+	CHECK(program.blocks[0].lineNumber == 1 && program.blocks[1].lineNumber == 3);
+	CHECK(program.blocks[5].lineNumber == 7);
+	CHECK(program.wordCount == 1 + 4 + 0 + 2 + 2 + 5);
+
+	CHECK(program.HasWord(1, 'X') && program.HasWord(1, 'F') && !program.HasWord(1, 'Z'));
+	CHECK(program.GetWordValue(1, 'X') == 1.5 && program.GetWordValue(1, 'Y') == -2.0);
+	CHECK(program.GetWordValue(1, 'F') == 1500.0 && program.GetWordValue(1, 'G') == 1.0);
+	CHECK(program.GetWordValue(1, 'Z') == 0.0);
+	CHECK(program.blocks[2].present == 0);
+	CHECK(program.GetWordValue(3, 'S') == 200.0);
+	CHECK(program.GetWordValue(5, 'J') == -1.0 && program.GetWordValue(5, 'G') == 2.0);
+	CHECK(!program.HasWord(6, 'G') && !program.HasWord(-1, 'G') && !program.HasWord(0, '1'));
+
+	// Walking the headers and the word table in step gives the values in letter order.
+	const double* value = program.words;
+
+	for (long i = 0; i < program.blockCount; i++)
+	{
+		CHECK(value == &program.words[program.blocks[i].words]);
+
+		for (char letter = 'A'; letter <= 'Z'; letter++)
+		{
+			if (program.HasWord(i, letter))
+				CHECK(*value++ == program.GetWordValue(i, letter));
+		}
+	}
+
+	CHECK(value == &program.words[program.wordCount]);
+	CHECK(program.words[0] == 21.0 && program.words[1] == 1500.0 && program.words[2] == 1.0);
+}
+
+HOST_TEST(Program_Comments_Interned)
+{
+	GCodeProgram program;
+
+	CHECK(program.ParseBuffer(programText, strlen(programText)));
+
+	CHECK(strcmp(program.Comment(0), "; start") == 0);
+	CHECK(strcmp(program.Comment(2), "(note)") == 0);
+	CHECK(strcmp(program.Comment(3), "") == 0 && program.blocks[3].comment == PROGRAM_NO_COMMENT);
+	CHECK(strcmp(program.Comment(6), "") == 0);
+
+	// A repeated comment is kept once.
+	CHECK(strcmp(program.Comment(4), ";TYPE:WALL") == 0);
+	CHECK(program.blocks[1].comment == program.blocks[4].comment);
+	CHECK(program.comments.Size() == 3);
+	CHECK(program.comments.Count(program.blocks[1].comment) == 2);
+}
+
+HOST_TEST(Program_Reservation_HoldsWorstCase)
+{
+	GCodeProgram program;
+
+	// The most blocks a length can hold: one character and a line feed each.
+	const long lines = 100000;
+	char* text = (char*)malloc(2 * lines + 1);
+
+	for (long i = 0; i < lines; i++)
+		memcpy(&text[2 * i], "X\n", 2);
+
+	CHECK(program.ParseBuffer(text, 2 * lines));
+	CHECK(program.blockCount == lines);
+
+	// The most words: a letter and a digit each, 26 to a line.
+	long length = 0;
+
+	while (length + 53 <= 2 * lines)
+	{
+		for (char letter = 'A'; letter <= 'Z'; letter++)
+		{
+			text[length++] = letter;
+			text[length++] = '1';
+		}
+
+		text[length++] = '\n';
+	}
+
+	CHECK(program.ParseBuffer(text, length));
+	CHECK(program.blockCount == length / 53 && program.wordCount == 26 * program.blockCount);
+	CHECK(program.GetWordValue(program.blockCount - 1, 'Z') == 1.0);
+
+	// A reparse replaces the program.
+	CHECK(program.ParseBuffer("G1 X2\n", 6));
+	CHECK(program.blockCount == 1 && program.GetWordValue(0, 'X') == 2.0);
+	CHECK(program.MemoryUsed() >= sizeof(GCodeBlockHeader) + 2 * sizeof(double));
+
+	CHECK(program.ParseBuffer("", 0));
+	CHECK(program.blockCount == 0);
+	free(text);
+}
+
+HOST_TEST(Program_Free_ReleasesEverything)
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s", HostTest::TempPath("program.gcode"));
+
+	FILE* file = fopen(path, "wb");
+	CHECK(file != NULL && fwrite(programText, 1, strlen(programText), file) == strlen(programText));
+	CHECK(file != NULL && fclose(file) == 0);
+
+	GCodeProgram program;
+	CHECK(program.ParseFile(path));
+	CHECK(program.blockCount == 6 && strcmp(program.Comment(1), ";TYPE:WALL") == 0);
+
+	program.Free();
+	CHECK(program.blockCount == 0 && program.wordCount == 0);
+	CHECK(program.blocks == NULL && program.words == NULL);
+	CHECK(program.comments.Size() == 0 && program.MemoryUsed() == 0);
+	CHECK(!program.HasWord(0, 'X') && strcmp(program.Comment(0), "") == 0);
+
+	CHECK(!program.ParseFile(HostTest::TempPath("missing.gcode")));
+}
+
+HOST_TEST(Program_LongLine_IsNotDropped)
+{
+	GCodeProgram program;
+	const size_t size = (1 << 20) + 64;
+	char* text = (char*)malloc(size + 64);
+	int length = sprintf(text, "G1 X1\nG1 X2 (");
+
+	// Longer than MAX_LINE_SIZE, parsed in the arena.
+	memset(&text[length], 'a', 300);
+	strcpy(&text[length + 300], ")\nG1 X3\n");
+	CHECK(program.ParseBuffer(text, strlen(text)));
+	CHECK(program.blockCount == 3 && program.GetWordValue(1, 'X') == 2.0);
+	CHECK(strlen(program.Comment(1)) == 302);
+
+	// Longer than the arena fails the parse, with or without a line feed after it.
+	memset(&text[length], 'a', size);
+	strcpy(&text[length + size], ")\nG1 X3\n");
+	CHECK(!program.ParseBuffer(text, strlen(text)));
+	CHECK(program.longLine == 2 && program.blockCount == 0);
+
+	text[length + size] = '\0';
+	CHECK(!program.ParseBuffer(text, strlen(text)));
+	CHECK(program.longLine == 2);
+
+	CHECK(program.ParseBuffer("G1\n", 3) && program.longLine == 0);
+	free(text);
+}
@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeSimplifier.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// <summary>
+/// Simplifies a program held in memory.
+/// </summary>
+/// <returns>The simplified program, to be freed, or NULL if SimplifyStream fails.</returns>
+static char* Simplify(GCodeSimplifier* simplifier, const char* program)
+{
+	FILE* in = fmemopen((void*)program, strlen(program), "rb");
+	char* text = NULL;
+	size_t size = 0;
+	FILE* out = open_memstream(&text, &size);
+
+	if (in == NULL || out == NULL)
+		return NULL;
+
+	bool result = simplifier->SimplifyStream(in, out);
+	fclose(in);
+	fclose(out);
+
+	if (!result)
+	{
+		free(text);
+		return NULL;
+	}
+
+	return text;
+}
+
+HOST_TEST(Simplifier_ColinearMoves_Merged)
+{
+	GCodeSimplifier simplifier;
+
+	// X3 is 0.005 off the line and dropped, X5 is 0.05 off and kept.
+	char* text = Simplify(&simplifier,
+		"G90 G1 F1000\n"
+		"G1 X1 Y0\n"
+		"G1 X2 Y0\n"
+		"G1 X3 Y0.005\n"
+		"\n"
+		"G1 X4 Y0\n"
+		"G1 X5 Y0.05\n"
+		"G1 X6 Y0");
+
+	CHECK(text != NULL && strcmp(text,
+		"G90 G1 F1000\n"
+		"G1 X4 Y0\n"
+		"G1 X5 Y0.05\n"
+		"G1 X6 Y0\n") == 0);
+	CHECK(simplifier.blocksIn == 7 && simplifier.blocksOut == 4 && simplifier.movesRemoved == 3);
+	free(text);
+
+	// A larger tolerance drops X5 too.
+	simplifier.tolerance = 0.1;
+	text = Simplify(&simplifier, "G1 X1 Y0\nG1 X5 Y0.05\nG1 X6 Y0\n");
+	CHECK(text != NULL && strcmp(text, "G1 X6 Y0\n") == 0);
+	free(text);
+}
+
+HOST_TEST(Simplifier_Extrusion_KeptAndSeparate)
+{
+	GCodeSimplifier simplifier;
+
+	// Travel is not merged with extrusion and a change of extrusion rate breaks the run.
+	char* text = Simplify(&simplifier,
+		"G90 M82 G1 F1000\n"
+		"G1 X1 Y0 E1\n"
+		"G1 X2 Y0 E2\n"
+		"G1 X3 Y0 E3\n"
+		"G1 X4 Y0\n"
+		"G1 X5 Y0\n"
+		"G1 X6 Y0 E4\n"
+		"G1 X7 Y0 E5.5\n");
+
+	CHECK(text != NULL && strcmp(text,
+		"G90 M82 G1 F1000\n"
+		"G1 X3 Y0 E3\n"
+		"G1 X5 Y0\n"
+		"G1 X6 Y0 E4\n"
+		"G1 X7 Y0 E5.5\n") == 0);
+	free(text);
+
+	// Relative moves and extrusion add up to the moves replaced.
+	text = Simplify(&simplifier,
+		"G91 M83 G1 F1000\n"
+		"G1 X1 Y0 E0.5\n"
+		"G1 X1 Y0 E0.5\n"
+		"G1 X1 Y0 E0.5\n");
+
+	CHECK(text != NULL && strcmp(text,
+		"G91 M83 G1 F1000\n"
+		"G1 X3 Y0 E1.5\n") == 0);
+	free(text);
+}
+
+HOST_TEST(Simplifier_OtherBlocks_EndRun)
+{
+	GCodeSimplifier simplifier;
+
+	// A new feed rate, a comment and a G0 are written as they are and are not merged.
+	char* text = Simplify(&simplifier,
+		"G1 F1000\n"
+		"G1 X1 Y0\n"
+		"G1 X2 Y0 F2000\n"
+		"G1 X3 Y0 ; perimeter\n"
+		"G1 X4 Y0\n"
+		"G0 X5 Y0\n"
+		"G1 X6 Y0\n"
+		"G1 X7 Y0\n");
+
+	CHECK(text != NULL && strcmp(text,
+		"G1 F1000\n"
+		"G1 X1 Y0\n"
+		"G1 X2 Y0 F2000\n"
+		"G1 X3 Y0 ; perimeter\n"
+		"G1 X4 Y0\n"
+		"G0 X5 Y0\n"
+		"G1 X7 Y0\n") == 0);
+	CHECK(simplifier.movesRemoved == 1);
+	free(text);
+}
@@ -0,0 +1,286 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeMotion.h"
+#include "../GCodeSpatialIndex.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// <summary>
+/// Parses a line and applies it to the motion state.
+/// </summary>
+static bool Apply(GCodeMotion* motion, const char* text, GCodeMove* move)
+{
+	GCodeParser parser;
+	char line[MAX_LINE_SIZE];
+
+	snprintf(line, sizeof(line), "%s", text);
+	parser.ParseLine(line);
+
+	return motion->Apply(&parser, move);
+}
+
+static bool Near(double a, double b)
+{
+	return fabs(a - b) < 1e-9;
+}
+
+HOST_TEST(Motion_ModalState_ResolvesMoves)
+{
+	GCodeMotion motion;
+	GCodeMove move;
+
+	CHECK(Apply(&motion, "G1 X10 Y5 F1200", &move));
+	CHECK(move.from[0] == 0.0 && move.to[0] == 10.0 && move.to[1] == 5.0);
+	CHECK(move.motion == 1 && motion.state.feedRate == 1200.0);
+
+	// A block with no axis words keeps the motion mode but does not move.
+	CHECK(!Apply(&motion, "G0 F600", &move));
+	CHECK(motion.state.motion == 0 && motion.state.feedRate == 600.0);
+	CHECK((move.words & GCODE_LETTER('F')) != 0);
+	CHECK(Apply(&motion, "Z2", &move));
+	CHECK(move.motion == 0 && move.to[2] == 2.0 && move.to[0] == 10.0);
+
+	// Relative moves and relative extrusion.
+	CHECK(!Apply(&motion, "G91 M83", &move));
+	CHECK(!motion.state.absolute && !motion.state.absoluteExtrusion);
+	CHECK(Apply(&motion, "G1 X-4 E1.5", &move));
+	CHECK(move.to[0] == 6.0 && move.to[1] == 5.0 && move.to[3] == 1.5);
+	CHECK(Apply(&motion, "E1.5", &move));
+	CHECK(move.to[3] == 3.0);
+
+	// G92 sets the position without moving, even in G91.
+	CHECK(!Apply(&motion, "G92 X0 E0", &move));
+	CHECK(motion.state.position[0] == 0.0 && motion.state.position[1] == 5.0 && motion.state.position[3] == 0.0);
+
+	// G28 moves the axes named, or all of them, to 0.
+	CHECK(Apply(&motion, "G28 Z", &move));
+	CHECK(move.motion == 0 && move.to[2] == 0.0 && move.to[1] == 5.0);
+	CHECK(Apply(&motion, "G28", &move));
+	CHECK(move.to[0] == 0.0 && move.to[1] == 0.0 && move.to[2] == 0.0);
+
+	// Blocks which do not move.
+	CHECK(!Apply(&motion, "G4 P100", &move));
+	CHECK(!Apply(&motion, "G10 L2 P1 X5", &move));
+	CHECK(motion.state.position[0] == 0.0);
+
+	CHECK(!Apply(&motion, "G90 G20 G18 G55", &move));
+	CHECK(motion.state.absolute && motion.state.inches && motion.state.plane == 18 && motion.state.workOffset == 55);
+
+	motion.Reset();
+	CHECK(motion.state.absolute && !motion.state.inches && motion.state.position[0] == 0.0);
+}
+
+HOST_TEST(Motion_ToolChange_AtM6OrT)
+{
+	GCodeMotion motion;
+	GCodeMove move;
+
+	// Printers change tools with T alone.
+	CHECK(!Apply(&motion, "T1", &move));
+	CHECK(motion.state.tool == 1 && motion.state.selectedTool == 1);
+
+	// Once M6 is used, T only selects the next tool.
+	CHECK(!Apply(&motion, "T2 M6", &move));
+	CHECK(motion.state.tool == 2 && motion.toolChangeSeen);
+	CHECK(!Apply(&motion, "T3", &move));
+	CHECK(motion.state.tool == 2 && motion.state.selectedTool == 3);
+	CHECK(!Apply(&motion, "M6", &move));
+	CHECK(motion.state.tool == 3);
+}
+
+HOST_TEST(Motion_Arcs_ResolveCenterAndSweep)
+{
+	GCodeMotion motion;
+	GCodeMove move;
+	GCodeBounds bounds;
+
+	// A counterclockwise half circle from (10, 0) to (-10, 0) around the origin.
+	CHECK(Apply(&motion, "G0 X10", &move));
+	CHECK(Apply(&motion, "G3 X-10 Y0 I-10 J0", &move));
+	CHECK(move.motion == 3 && move.center[0] == 0.0 && move.center[1] == 0.0);
+	CHECK(Near(move.radius, 10.0) && Near(move.sweep, M_PI));
+
+	// It passes through (0, 10) but not (0, -10).
+	GCodeMotion::MoveBounds(&move, &bounds);
+	CHECK(Near(bounds.max[1], 10.0) && Near(bounds.min[1], 0.0));
+	CHECK(Near(bounds.min[0], -10.0) && Near(bounds.max[0], 10.0));
+
+	// The same end point clockwise with R: a short arc below the chord's right.
+	CHECK(Apply(&motion, "G2 X0 Y10 R10", &move));
+	CHECK(Near(move.center[0], 0.0) && Near(move.center[1], 0.0));
+	CHECK(Near(move.sweep, -M_PI / 2));
+
+	// Negative R takes the long way round.
+	CHECK(Apply(&motion, "G2 X10 Y0 R-10", &move));
+	CHECK(Near(move.center[0], 10.0) && Near(move.center[1], 10.0));
+	CHECK(Near(move.sweep, -3 * M_PI / 2));
+
+	// Ending where it starts is a full circle.
+	CHECK(Apply(&motion, "G2 X10 Y0 I-5", &move));
+	CHECK(Near(move.radius, 5.0) && Near(move.sweep, -2 * M_PI));
+	GCodeMotion::MoveBounds(&move, &bounds);
+	CHECK(Near(bounds.min[0], 0.0) && Near(bounds.max[1], 5.0) && Near(bounds.min[1], -5.0));
+
+	// Without a center the arc is a line.
+	CHECK(Apply(&motion, "G2 X20", &move));
+	CHECK(move.motion == 1 && move.radius == 0.0);
+}
+
+HOST_TEST(Motion_Bounds_MergeAndOverlap)
+{
+	GCodeBounds a;
+	GCodeBounds b = { { 2, 2, 0 }, { 3, 3, 1 } };
+	GCodeBounds c = { { 3, 0, 1 }, { 4, 1, 2 } };
+
+	GCodeMotion::EmptyBounds(&a);
+	CHECK(!GCodeMotion::Overlap(&a, &b));
+
+	GCodeMotion::MergeBounds(&a, &b);
+	CHECK(a.min[0] == 2.0 && a.max[2] == 1.0);
+
+	// Touching counts.
+	CHECK(!GCodeMotion::Overlap(&b, &c));
+	c.min[1] = 2.0;
+	c.max[1] = 2.0;
+	CHECK(GCodeMotion::Overlap(&b, &c));
+}
+
+static const char regionProgram[] =
+	"G0 X0 Y0 Z0.2\n"
+	"G1 X10 Y0\n"
+	"G1 X10 Y10\n"
+	"G0 Z5\n"
+	"G0 X50 Y50\n"
+	"G1 Z0.2\n"
+	"G2 X50 Y50 I10 J0\n"
+	"G1 X100 Y100\n";
+
+HOST_TEST(SpatialIndex_Query_FindsBlocksInRegion)
+{
+	GCodeSpatialIndex index;
+	long blocks[16];
+
+	CHECK(index.ParseBuffer(regionProgram, strlen(regionProgram)));
+	CHECK(index.Query(&index.bounds, blocks, 16) == -1);
+	CHECK(index.Build(2) && index.IsBuilt());
+	CHECK(index.bounds.min[0] == 0.0 && index.bounds.max[0] == 100.0 && index.bounds.max[2] == 5.0);
+
+	// Along the first side.
+	GCodeBounds region = { { 4, -1, 0 }, { 6, 1, 1 } };
+	CHECK(index.Query(&region, blocks, 16) == 1 && blocks[0] == 2);
+
+	// Touching the corner at (10, 0) finds both sides.
+	GCodeBounds corner = { { 10, 0, 0.2 }, { 10, 0, 0.2 } };
+	CHECK(index.Query(&corner, blocks, 16) == 2 && blocks[0] == 2 && blocks[1] == 3);
+
+	// The full circle around (60, 50) passes through (60, 40), the hole in its middle is empty.
+	GCodeBounds circle = { { 59, 39, 0 }, { 61, 41, 1 } };
+	CHECK(index.Query(&circle, blocks, 16) == 1 && blocks[0] == 7);
+
+	GCodeBounds hole = { { 58, 42, 0 }, { 62, 46, 1 } };
+	CHECK(index.Query(&hole, blocks, 16) == 0);
+
+	// Above the part only the travel at Z5 is found.
+	GCodeBounds above = { { 20, 20, 4 }, { 30, 30, 6 } };
+	CHECK(index.Query(&above, blocks, 16) == 1 && blocks[0] == 5);
+
+	// Everything, in line order, and too little room.
+	CHECK(index.Query(&index.bounds, blocks, 16) == 8);
+
+	for (long i = 0; i < 8; i++)
+		CHECK(blocks[i] == i + 1);
+
+	CHECK(index.Query(&index.bounds, blocks, 3) == -1);
+}
+
+HOST_TEST(SpatialIndex_Grid_MatchesBruteForce)
+{
+	GCodeSpatialIndex index;
+	char line[64];
+	GCodeParser parser;
+
+	// A random walk of lines and arcs.
+	srand(1);
+
+	for (long block = 1; block <= 2000; block++)
+	{
+		if (block % 7 == 0)
+			snprintf(line, sizeof(line), "G2 X%d Y%d I%d J%d", rand() % 200, rand() % 200, rand() % 11 - 5, rand() % 11 - 5);
+		else
+			snprintf(line, sizeof(line), "G1 X%d Y%d Z%d", rand() % 200, rand() % 200, rand() % 3);
+
+		parser.ParseLine(line);
+		CHECK(index.AddBlock(&parser, block));
+	}
+
+	CHECK(index.Build(4));
+
+	long* blocks = (long*)malloc(2000 * sizeof(long));
+	bool* expected = (bool*)malloc(2001 * sizeof(bool));
+
+	for (int query = 0; query < 50; query++)
+	{
+		GCodeBounds region;
+		region.min[0] = rand() % 200;
+		region.min[1] = rand() % 200;
+		region.min[2] = rand() % 3;
+		region.max[0] = region.min[0] + rand() % 30;
+		region.max[1] = region.min[1] + rand() % 30;
+		region.max[2] = region.min[2];
+
+		memset(expected, 0, 2001 * sizeof(bool));
+		long expectedCount = 0;
+
+		for (long s = 0; s < index.segmentCount; s++)
+		{
+			const GCodeSegment* segment = &index.segments[s];
+			GCodeBounds box;
+
+			for (int a = 0; a < 3; a++)
+			{
+				box.min[a] = segment->min[a];
+				box.max[a] = segment->max[a];
+			}
+
+			if (GCodeMotion::Overlap(&box, &region) && !expected[segment->block])
+			{
+				expected[segment->block] = true;
+				expectedCount++;
+			}
+		}
+
+		long count = index.Query(&region, blocks, 2000);
+		CHECK(count == expectedCount);
+
+		for (long i = 0; i < count; i++)
+			CHECK(expected[blocks[i]] && (i == 0 || blocks[i] > blocks[i - 1]));
+	}
+
+	free(blocks);
+	free(expected);
+}
@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeStreamer.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/// <summary>
+/// Reads what the streamer has written to the controller's end.
+/// </summary>
+static bool Received(int fd, const char* expected)
+{
+	char text[512];
+	ssize_t count = recv(fd, text, sizeof(text) - 1, MSG_DONTWAIT);
+
+	if (count < 0)
+		count = 0;
+
+	text[count] = '\0';
+
+	if (strcmp(text, expected) != 0)
+	{
+		fprintf(stderr, "received:\n%s", text);
+		return false;
+	}
+
+	return true;
+}
+
+static void Respond(int fd, const char* text)
+{
+	CHECK(write(fd, text, strlen(text)) == (ssize_t)strlen(text));
+}
+
+HOST_TEST(Streamer_Minify_IsOptIn)
+{
+	int fds[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+	GCodeStreamer streamer(fds[0]);
+	streamer.log = NULL;
+
+	CHECK(streamer.SendLine("G1 X1 F100 ; first", 1));
+	CHECK(streamer.SendLine("(comment only)", 2));
+	CHECK(Received(fds[1], "G1 X1 F100 ; first\n"));
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+HOST_TEST(Streamer_Minify_KeepsWordsOfLinesInFlight)
+{
+	int fds[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+	GCodeStreamer streamer(fds[0]);
+	streamer.log = NULL;
+	streamer.minify = true;
+	streamer.minifier.modalMotion = true;
+
+	// Any of these may still be rejected, so the later lines repeat what they set.
+	CHECK(streamer.SendLine("G90", 1));
+	CHECK(streamer.SendLine("G1 X1 F100", 2));
+	CHECK(streamer.SendLine("G1 X2 F100", 3));
+	CHECK(streamer.SendLine("G90 G1 X2 F100", 4));
+	CHECK(Received(fds[1], "G90\nG1X1F100\nG1X2F100\nG90G1X2F100\n"));
+
+	// Once they are acknowledged their state is relied on.
+	Respond(fds[1], "ok\nok\nok\nok\n");
+	CHECK(streamer.SendLine("G90 G1 X2 F100", 5));
+	CHECK(streamer.SendLine("G1 X3 F100", 6));
+	CHECK(Received(fds[1], "X3\n"));
+	CHECK(streamer.statistics.linesSent == 5);
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+HOST_TEST(Streamer_Error_ResetsMinifier)
+{
+	int fds[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+	GCodeStreamer streamer(fds[0]);
+	streamer.log = NULL;
+	streamer.minify = true;
+
+	CHECK(streamer.SendLine("G91", 1));
+	CHECK(streamer.SendLine("G1 X1", 2));
+	CHECK(Received(fds[1], "G91\nG1X1\n"));
+
+	// G91 was rejected, the modal state is unknown again.
+	Respond(fds[1], "error:20\nok\n");
+	CHECK(streamer.SendLine("G91", 3));
+	CHECK(streamer.SendLine("G1 X1", 4));
+	CHECK(Received(fds[1], "G91\nG1X1\n"));
+	CHECK(streamer.statistics.errors == 1);
+
+	close(fds[0]);
+	close(fds[1]);
+}
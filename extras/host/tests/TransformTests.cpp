@@ -0,0 +1,226 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostTest.h"
+#include "../GCodeTransform.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// <summary>
+/// Transforms a program held in memory.
+/// </summary>
+/// <returns>The transformed program, to be freed, or NULL if TransformStream fails.</returns>
+static char* Transform(GCodeTransform* transform, const char* program)
+{
+	FILE* in = fmemopen((void*)program, strlen(program), "rb");
+	char* text = NULL;
+	size_t size = 0;
+	FILE* out = open_memstream(&text, &size);
+
+	if (in == NULL || out == NULL)
+		return NULL;
+
+	bool result = transform->TransformStream(in, out);
+	fclose(in);
+	fclose(out);
+
+	if (!result)
+	{
+		free(text);
+		return NULL;
+	}
+
+	return text;
+}
+
+static const char transformProgram[] =
+	"G21 G90\n"
+	"G0 X10 Y0 ; start\n"
+	"G1 X20 F300\n"
+	"G2 X30 Y10 I5 J5\n"
+	"G91\n"
+	"G1 X1 Y1\n"
+	"G90\n"
+	"G28\n"
+	"G1 Z1";
+
+HOST_TEST(Transform_Translation_MovesPointsOnly)
+{
+	GCodeTransform transform(GCodeAffine::Translation(5, 2, 0));
+	char* text = Transform(&transform, transformProgram);
+
+	// Incremental moves, arc offsets and G28 are unchanged, the last line gets a line feed.
+	CHECK(text != NULL && strcmp(text,
+		"G21 G90\n"
+		"G0 X15 Y2 ; start\n"
+		"G1 X25 F300\n"
+		"G2 X35 Y12 I5 J5\n"
+		"G91\n"
+		"G1 X1 Y1\n"
+		"G90\n"
+		"G28\n"
+		"G1 Z1\n") == 0);
+
+	free(text);
+}
+
+HOST_TEST(Transform_Mirror_SwapsArcs)
+{
+	GCodeTransform transform(GCodeAffine::MirrorX());
+	char* text = Transform(&transform, transformProgram);
+
+	CHECK(text != NULL && strstr(text, "G3 X-30 Y10 I-5 J5\n") != NULL);
+	CHECK(text != NULL && strstr(text, "G1 X-1 Y1\n") != NULL);
+
+	free(text);
+}
+
+HOST_TEST(Transform_Rotation_AddsMissingAxis)
+{
+	GCodeTransform transform(GCodeAffine::Rotation(90));
+	char* text = Transform(&transform, transformProgram);
+
+	// The X only move becomes a Y move, so X and Y are both written.
+	CHECK(text != NULL && strstr(text, "G1 X0 Y20 F300\n") != NULL);
+	CHECK(text != NULL && strstr(text, "G2 X-10 Y30 I-5 J5\n") != NULL);
+
+	free(text);
+}
+
+HOST_TEST(Transform_Scaling_ScalesRadius)
+{
+	GCodeTransform transform(GCodeAffine::Scaling(2, 2, 1));
+	transform.precision = 2;
+	char* text = Transform(&transform, "G0 X1 Y1\nG1 X2.005 Y2 E5\nG2 X3 Y3 R2\nG92 X0 Y0\n");
+
+	// E is not an axis of the transform. G92 declares a point, so it is transformed too.
+	CHECK(text != NULL && strcmp(text, "G0 X2 Y2\nG1 X4.01 Y4 E5\nG2 X6 Y6 R4\nG92 X0 Y0\n") == 0);
+	CHECK(transform.blocksTransformed == 4);
+
+	free(text);
+}
+
+HOST_TEST(Transform_Shortest_WritesSmallChanges)
+{
+	GCodeTransform transform(GCodeAffine::Rotation(10));
+	transform.precision = GCODE_SHORTEST;
+	char* text = Transform(&transform, "G90\nG1 X10 Y0\nG1 X10 Y3\nG1 X20\n");
+
+	// The X only move changes Y by 1.7, which must not be taken for rounding.
+	CHECK(text != NULL && strstr(text, "G1 X19.17521052724337 Y6.42") != NULL);
+	free(text);
+
+	// Axes the transform leaves alone are not added.
+	transform.affine = GCodeAffine::Translation(0.001, 0, 0);
+	text = Transform(&transform, "G1 X1 Y1\nG1 X2\n");
+	CHECK(text != NULL && strcmp(text, "G1 X1.001 Y1\nG1 X2.001\n") == 0);
+	free(text);
+}
+
+HOST_TEST(Transform_Incremental_CarriesRounding)
+{
+	GCodeTransform transform(GCodeAffine::Rotation(30));
+	transform.precision = 2;
+	char program[16 * 1000 + 8];
+	int length = sprintf(program, "G91\n");
+
+	for (int n = 0; n < 1000; n++)
+		length += sprintf(&program[length], "G1 X0.013\n");
+
+	char* text = Transform(&transform, program);
+	CHECK(text != NULL);
+
+	// The moves written add up to the transformed 13 mm, not to 1000 rounded moves.
+	double sum[2] = { 0.0, 0.0 };
+
+	for (const char* line = text; line != NULL && *line != '\0'; line = strchr(line, '\n') + 1)
+	{
+		const char* x = strchr(line, 'X');
+		const char* y = strchr(line, 'Y');
+		const char* end = strchr(line, '\n');
+
+		if (x != NULL && x < end)
+			sum[0] += atof(x + 1);
+
+		if (y != NULL && y < end)
+			sum[1] += atof(y + 1);
+	}
+
+	CHECK(fabs(sum[0] - 13.0 * cos(M_PI / 6)) < 0.006);
+	CHECK(fabs(sum[1] - 6.5) < 0.006);
+	free(text);
+
+	// G92 declares where the controller is, so the rounding left before it is dropped.
+	transform.affine = GCodeAffine::Identity();
+	text = Transform(&transform, "G91\nG1 X0.004\nG92 X0\nG1 X0.004\nG1 X0.004\n");
+	CHECK(text != NULL && strcmp(text, "G91\nG1 X0\nG92 X0\nG1 X0\nG1 X0.01\n") == 0);
+	free(text);
+}
+
+HOST_TEST(Transform_Home_ResetsPosition)
+{
+	GCodeTransform transform(GCodeAffine::Rotation(90));
+	char* text = Transform(&transform, "G1 X10 Y10\nG28\nG1 X5\nG28 Y0\nG1 Z1\n");
+
+	// After G28 the program is at its origin again, not at X10 Y10.
+	CHECK(text != NULL && strcmp(text, "G1 X-10 Y10\nG28\nG1 X0 Y5\nG28 Y0\nG1 Z1\n") == 0);
+	free(text);
+}
+
+HOST_TEST(Transform_LongLine_ReportsLine)
+{
+	GCodeTransform transform(GCodeAffine::Translation(5, 0, 0));
+	char program[600];
+	int length = sprintf(program, "G1 X1\nG1 X2 ");
+
+	while (length < 400)
+		length += sprintf(&program[length], "(comment) ");
+
+	sprintf(&program[length], "\nG1 X3\n");
+
+	// The blocks before the long line are written, the rest is not transformed.
+	FILE* in = fmemopen(program, strlen(program), "rb");
+	char* text = NULL;
+	size_t size = 0;
+	FILE* out = open_memstream(&text, &size);
+
+	CHECK(!transform.TransformStream(in, out));
+	fclose(in);
+	fclose(out);
+
+	CHECK(transform.longLine == 2);
+	CHECK(text != NULL && strcmp(text, "G1 X6\n") == 0);
+	free(text);
+
+	// Without a line feed at the end.
+	program[length] = '\0';
+	CHECK(Transform(&transform, program) == NULL);
+	CHECK(transform.longLine == 2);
+
+	text = Transform(&transform, "G1 X1\n");
+	CHECK(text != NULL && transform.longLine == 0);
+	free(text);
+}
@@ -0,0 +1,172 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+// gcodebatch - Parses and checks many programs in one process, using every core.
+//
+// Usage: gcodebatch [options] <program.gcode>...
+//        gcodebatch [options] -l <list>
+//   -t n          Worker threads (default the processors online).
+//   -c megabytes  Split files larger than this into chunks (default 4).
+//   -d dialect    Validate blocks against a dialect (Marlin, Grbl, LinuxCNC or Fanuc).
+//   -l list       Read the paths from a file, one per line, - for stdin.
+//
+// Prints a tab separated line per file as it completes (path, bytes, lines, blocks, words,
+// commented blocks, invalid blocks, long lines, chunks) and a summary on stderr. Exit
+// status is 0 when every file was read and no block was invalid, 1 otherwise.
+
+#include "../GCodeBatchRunner.h"
+#include "../GCodeStreamer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void PrintResult(const GCodeBatchResult* result, void* context)
+{
+	uint64_t* invalid = (uint64_t*)context;
+
+	if (!result->read)
+	{
+		printf("%s\tcannot read\n", result->path);
+		return;
+	}
+
+	printf("%s\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%d\n", result->path, (unsigned long long)result->bytes,
+		(unsigned long long)result->lines, (unsigned long long)result->blocks, (unsigned long long)result->words,
+		(unsigned long long)result->commentedBlocks, (unsigned long long)result->invalid,
+		(unsigned long long)result->longLines, result->chunks);
+
+	*invalid += result->invalid;
+}
+
+/// <summary>
+/// Reads a list of paths, one per line.
+/// </summary>
+static bool ReadList(const char* path, char*** list, long* count)
+{
+	FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+
+	if (file == NULL)
+		return false;
+
+	char** paths = NULL;
+	long capacity = 0;
+	char* line = NULL;
+	size_t size = 0;
+	ssize_t length;
+
+	*count = 0;
+
+	while ((length = getline(&line, &size, file)) >= 0)
+	{
+		while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+			line[--length] = '\0';
+
+		if (length == 0)
+			continue;
+
+		if (*count == capacity)
+		{
+			capacity = capacity == 0 ? 1024 : capacity * 2;
+			char** grown = (char**)realloc(paths, capacity * sizeof(char*));
+
+			if (grown == NULL)
+				break;
+
+			paths = grown;
+		}
+
+		paths[(*count)++] = strdup(line);
+	}
+
+	free(line);
+
+	if (file != stdin)
+		fclose(file);
+
+	*list = paths;
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	GCodeBatchRunner runner;
+	const char* list = NULL;
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-')
+	{
+		const char* option = argv[argument];
+		const char* value = argv[argument + 1];
+
+		if (strcmp(option, "-t") == 0)
+			runner.threads = atoi(value);
+		else if (strcmp(option, "-c") == 0)
+			runner.chunkSize = (size_t)(atof(value) * 1024 * 1024);
+		else if (strcmp(option, "-d") == 0 && (runner.dialect = GCodeStreamer::DialectByName(value)) != NULL)
+			;
+		else if (strcmp(option, "-l") == 0)
+			list = value;
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (list == NULL ? argument == argc : argument != argc)
+	{
+		fprintf(stderr, "Usage: %s [-t threads] [-c megabytes] [-d dialect] <program.gcode>...\n", argv[0]);
+		fprintf(stderr, "       %s [-t threads] [-c megabytes] [-d dialect] -l <list>\n", argv[0]);
+		return 2;
+	}
+
+	long count = argc - argument;
+	char** paths = &argv[argument];
+
+	if (list != NULL && !ReadList(list, &paths, &count))
+	{
+		fprintf(stderr, "%s: cannot read %s\n", argv[0], list);
+		return 1;
+	}
+
+	uint64_t invalid = 0;
+
+	if (!runner.Run(paths, count, PrintResult, &invalid))
+	{
+		fprintf(stderr, "%s: cannot start the workers\n", argv[0]);
+		return 1;
+	}
+
+	fflush(stdout);
+	fprintf(stderr, "%ld files, %.1f MB in %.3f s with %d threads: %.1f MB/s, %.0f files/s, %ld tasks stolen",
+		runner.filesDone, runner.bytesDone / 1e6, runner.seconds, runner.threads,
+		runner.seconds > 0 ? runner.bytesDone / 1e6 / runner.seconds : 0.0,
+		runner.seconds > 0 ? runner.filesDone / runner.seconds : 0.0, runner.tasksStolen);
+
+	if (runner.filesFailed > 0)
+		fprintf(stderr, ", %ld cannot be read", runner.filesFailed);
+
+	fprintf(stderr, "\n");
+
+	return runner.filesFailed == 0 && invalid == 0 ? 0 : 1;
+}
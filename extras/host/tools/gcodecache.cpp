@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodecache - Gets programs through the parse cache and prints their summaries.
+//
+// Usage: gcodecache [-d directory] [-m megabytes] <program.gcode>...
+//   -d     Cache directory (default $XDG_CACHE_HOME/gcodeparser or ~/.cache/gcodeparser).
+//   -m     Size limit of the cache directory (default 1024).
+
+#include "../GCodeParseCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+static double Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+	char directory[4096] = "";
+	uint64_t megabytes = 1024;
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-')
+	{
+		if (strcmp(argv[argument], "-d") == 0)
+			snprintf(directory, sizeof(directory), "%s", argv[argument + 1]);
+		else if (strcmp(argv[argument], "-m") == 0)
+			megabytes = strtoull(argv[argument + 1], NULL, 10);
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (argument == argc || argv[argument][0] == '-')
+	{
+		fprintf(stderr, "Usage: %s [-d directory] [-m megabytes] <program.gcode>...\n", argv[0]);
+		return 2;
+	}
+
+	if (directory[0] == '\0')
+	{
+		const char* base = getenv("XDG_CACHE_HOME");
+
+		if (base != NULL && base[0] != '\0')
+			snprintf(directory, sizeof(directory), "%s/gcodeparser", base);
+		else
+		{
+			const char* home = getenv("HOME");
+			snprintf(directory, sizeof(directory), "%s/.cache", home != NULL ? home : ".");
+			mkdir(directory, 0777);
+			strncat(directory, "/gcodeparser", sizeof(directory) - strlen(directory) - 1);
+		}
+	}
+
+	GCodeParseCache cache(directory, megabytes * 1024 * 1024);
+	int result = 0;
+
+	for (; argument < argc; argument++)
+	{
+		GCodeColumnsView view;
+		long hits = cache.hits;
+		double start = Now();
+
+		if (!cache.Open(argv[argument], &view))
+		{
+			fprintf(stderr, "%s: cannot parse %s\n", argv[0], argv[argument]);
+			result = 1;
+			continue;
+		}
+
+		const GCodeProgramSummary* summary = view.summary;
+
+		printf("%s: %s in %.3f ms, %llu bytes, %llu lines, %llu blocks, %llu words, %llu commented\n",
+			argv[argument], cache.hits > hits ? "hit" : "miss", (Now() - start) * 1e3,
+			(unsigned long long)summary->sourceBytes, (unsigned long long)summary->sourceLines,
+			(unsigned long long)summary->blocks, (unsigned long long)summary->words,
+			(unsigned long long)summary->commentedBlocks);
+	}
+
+	return result;
+}
@@ -0,0 +1,165 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodecapture - Records raw input bytes with their timing and replays them through the parser.
+//
+// Usage: gcodecapture record [-b baud] <input> <capture>
+//        gcodecapture replay [-t] <capture>
+//   record  Reads a serial port, pipe, file or stdin (-) until it ends or is interrupted,
+//           writing each read as a timestamped chunk.
+//   -b n    Configure a serial port input to a baud rate.
+//   replay  Feeds the capture to AddCharToLine and ParseLine as fast as possible, reporting
+//           the throughput and whether the same blocks were produced.
+//   -t      Replay with the original timing.
+//
+// Exit status is 0 when the capture was written, or replayed and verified, 1 otherwise.
+
+#include "../GCodeCapture.h"
+#include "../GCodeStreamer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void Interrupt(int signal)
+{
+	// The blocked read returns EINTR and the recording ends.
+}
+
+static int Record(const char* input, const char* path, int baud)
+{
+	int fd = strcmp(input, "-") == 0 ? 0 : open(input, O_RDONLY | O_NOCTTY);
+
+	if (fd < 0)
+	{
+		fprintf(stderr, "Cannot open %s\n", input);
+		return 1;
+	}
+
+	if (baud > 0 && !GCodeStreamer::ConfigureSerial(fd, baud))
+	{
+		fprintf(stderr, "Cannot configure %s\n", input);
+		return 1;
+	}
+
+	GCodeCaptureWriter writer;
+
+	if (!writer.Open(path))
+	{
+		fprintf(stderr, "Cannot create %s\n", path);
+		return 1;
+	}
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Interrupt;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	static char buffer[CAPTURE_MAX_CHUNK];
+	bool result = true;
+
+	while (true)
+	{
+		ssize_t length = read(fd, buffer, sizeof(buffer));
+
+		if (length < 0 && errno == EAGAIN)
+			continue;
+
+		if (length <= 0)
+			break;
+
+		if (!writer.Write(buffer, (int)length))
+		{
+			result = false;
+			break;
+		}
+	}
+
+	if (!writer.Close())
+		result = false;
+
+	fprintf(stderr, "%llu bytes in %ld chunks, %ld blocks\n", (unsigned long long)writer.bytes, writer.chunks,
+		writer.sequence.blocks);
+
+	if (!result)
+		fprintf(stderr, "Cannot write %s\n", path);
+
+	return result ? 0 : 1;
+}
+
+static int Replay(const char* path, bool realTime)
+{
+	GCodeCaptureReader reader;
+	GCodeReplayStatistics statistics;
+
+	if (!reader.Replay(path, realTime, &statistics))
+	{
+		fprintf(stderr, "Cannot read %s\n", path);
+		return 1;
+	}
+
+	printf("%llu bytes in %ld chunks, %ld blocks (recorded over %.3f s)\n", (unsigned long long)statistics.bytes,
+		statistics.chunks, statistics.blocks, statistics.recordedSeconds);
+	printf("replayed in %.3f s, parsing %.3f s: %.1f MB/s, %.0f blocks/s\n", statistics.seconds, statistics.parseSeconds,
+		statistics.parseSeconds > 0 ? statistics.bytes / statistics.parseSeconds / 1e6 : 0.0,
+		statistics.parseSeconds > 0 ? statistics.blocks / statistics.parseSeconds : 0.0);
+
+	if (reader.recordedBlocks < 0)
+		printf("not verified, the capture was cut short\n");
+	else if (statistics.verified)
+		printf("verified, same block sequence as recorded\n");
+	else
+		printf("MISMATCH, %ld blocks were recorded\n", reader.recordedBlocks);
+
+	return statistics.verified ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 4 && strcmp(argv[1], "record") == 0)
+	{
+		if (argc == 6 && strcmp(argv[2], "-b") == 0)
+			return Record(argv[4], argv[5], atoi(argv[3]));
+
+		if (argc == 4)
+			return Record(argv[2], argv[3], 0);
+	}
+	else if (argc >= 3 && strcmp(argv[1], "replay") == 0)
+	{
+		if (argc == 4 && strcmp(argv[2], "-t") == 0)
+			return Replay(argv[3], true);
+
+		if (argc == 3)
+			return Replay(argv[2], false);
+	}
+
+	fprintf(stderr, "Usage: gcodecapture record [-b baud] <input> <capture>\n");
+	fprintf(stderr, "       gcodecapture replay [-t] <capture>\n");
+
+	return 1;
+}
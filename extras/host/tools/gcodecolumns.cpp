@@ -0,0 +1,62 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodecolumns - Parses a G-Code program into columns and dumps them to a file.
+//
+// Usage: gcodecolumns <program.gcode> <columns.bin>
+
+#include "../GCodeColumns.h"
+#include <stdio.h>
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <program.gcode> <columns.bin>\n", argv[0]);
+		return 2;
+	}
+
+	GCodeColumns columns;
+
+	if (!columns.ParseFile(argv[1]))
+	{
+		if (columns.longLine != 0)
+			fprintf(stderr, "%s: %s line %ld is too long to parse\n", argv[0], argv[1], columns.longLine);
+		else
+			fprintf(stderr, "%s: cannot parse %s\n", argv[0], argv[1]);
+
+		return 1;
+	}
+
+	if (!columns.Dump(argv[2]))
+	{
+		fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[2]);
+		return 1;
+	}
+
+	printf("%ld rows, %ld distinct comments in %lu bytes\n", columns.rowCount, columns.commentPool.Size(),
+		(unsigned long)columns.commentPool.PoolSize());
+
+	return 0;
+}
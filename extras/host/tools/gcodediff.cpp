@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodediff - Compares two G-Code programs block by block ignoring whitespace and comments.
+//
+// Usage: gcodediff [-a] <old.gcode> <new.gcode>
+//   -a  Also list unchanged regions.
+//
+// Exit status is 0 when the programs have the same blocks, 1 when they differ and 2 on error.
+
+#include "../GCodeDiff.h"
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+	bool includeUnchanged = false;
+	int first = 1;
+
+	if (argc > 1 && strcmp(argv[1], "-a") == 0)
+	{
+		includeUnchanged = true;
+		first++;
+	}
+
+	if (argc - first != 2)
+	{
+		fprintf(stderr, "Usage: %s [-a] <old.gcode> <new.gcode>\n", argv[0]);
+		return 2;
+	}
+
+	GCodeProgramHashes oldProgram;
+	GCodeProgramHashes newProgram;
+
+	for (int i = 0; i < 2; i++)
+	{
+		GCodeProgramHashes* program = i == 0 ? &oldProgram : &newProgram;
+
+		if (!program->ParseFile(argv[first + i]))
+		{
+			if (program->longLine != 0)
+				fprintf(stderr, "%s: %s line %ld is too long to parse\n", argv[0], argv[first + i], program->longLine);
+			else
+				fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[first + i]);
+
+			return 2;
+		}
+	}
+
+	GCodeDiff diff;
+
+	if (!diff.Compare(&oldProgram, &newProgram))
+	{
+		fprintf(stderr, "%s: out of memory\n", argv[0]);
+		return 2;
+	}
+
+	diff.Print(stdout, &oldProgram, &newProgram, includeUnchanged);
+
+	return (diff.movedBlocks + diff.insertedBlocks + diff.deletedBlocks) == 0 ? 0 : 1;
+}
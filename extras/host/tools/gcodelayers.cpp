@@ -0,0 +1,192 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodelayers - Indexes the layers and tool segments of a program.
+//
+// Usage: gcodelayers [-t threads] [-l layer] <program.gcode>
+//   -t     Parse every layer again on this many threads from its checkpoint (default 1).
+//   -l     Print a layer: its modal state checkpoint and its lines.
+
+#include "../GCodeLayerIndex.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static double Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void PrintEntry(const char* kind, const GCodeIndexEntry* entry)
+{
+	printf("%s %ld: line %ld, %ld lines, offset %llu, %llu bytes, z %g", kind, entry->number, entry->line, entry->lines,
+		(unsigned long long)entry->offset, (unsigned long long)entry->length, entry->z);
+
+	if (entry->bounds.min[0] <= entry->bounds.max[0])
+		printf(", box %g,%g,%g to %g,%g,%g", entry->bounds.min[0], entry->bounds.min[1], entry->bounds.min[2],
+			entry->bounds.max[0], entry->bounds.max[1], entry->bounds.max[2]);
+
+	printf("\n");
+}
+
+static void CountBlocks(const GCodeIndexEntry* layer, const char* text, void* context)
+{
+	GCodeParser parser;
+	long blocks = 0;
+
+	for (uint64_t i = 0; i < layer->length; i++)
+	{
+		if (parser.AddCharToLine(text[i]))
+		{
+			parser.ParseLine();
+
+			if (!parser.NoWords())
+				blocks++;
+		}
+	}
+
+	__atomic_fetch_add((long*)context, blocks, __ATOMIC_RELAXED);
+}
+
+static int PrintLayer(const GCodeLayerIndex* index, const char* path, long layer)
+{
+	FILE* file = fopen(path, "rb");
+	GCodeModalState state;
+
+	if (file == NULL || !index->SeekLayer(file, layer, &state))
+	{
+		fprintf(stderr, "No layer %ld in %s\n", layer, path);
+		return 1;
+	}
+
+	printf("; position X%g Y%g Z%g E%g F%g, G%d G%d G%d G%d %s, tool %ld\n", state.position[0], state.position[1],
+		state.position[2], state.position[3], state.feedRate, state.motion, state.plane, state.inches ? 20 : 21,
+		state.absolute ? 90 : 91, state.absoluteExtrusion ? "M82" : "M83", state.tool);
+
+	char buffer[65536];
+	uint64_t remaining = index->layers[layer].length;
+
+	while (remaining > 0)
+	{
+		size_t count = fread(buffer, 1, remaining < sizeof(buffer) ? remaining : sizeof(buffer), file);
+
+		if (count == 0)
+			break;
+
+		fwrite(buffer, 1, count, stdout);
+		remaining -= count;
+	}
+
+	fclose(file);
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	int threads = 1;
+	long layer = -1;
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-')
+	{
+		if (strcmp(argv[argument], "-t") == 0)
+			threads = atoi(argv[argument + 1]);
+		else if (strcmp(argv[argument], "-l") == 0)
+			layer = atol(argv[argument + 1]);
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (argument != argc - 1 || argv[argument][0] == '-')
+	{
+		fprintf(stderr, "Usage: %s [-t threads] [-l layer] <program.gcode>\n", argv[0]);
+		return 2;
+	}
+
+	const char* path = argv[argument];
+	GCodeLayerIndex* index = new GCodeLayerIndex();
+	double start = Now();
+
+	if (!index->BuildFile(path))
+	{
+		fprintf(stderr, "%s: cannot index %s\n", argv[0], path);
+		return 1;
+	}
+
+	double built = Now() - start;
+
+	if (layer >= 0)
+		return PrintLayer(index, path, layer);
+
+	for (long i = 0; i < index->layerCount; i++)
+		PrintEntry("layer", &index->layers[i]);
+
+	for (long i = 0; i < index->toolSegmentCount; i++)
+		PrintEntry("tool", &index->toolSegments[i]);
+
+	printf("%ld layers, %ld tool segments in %llu bytes, indexed in %.3f s\n", index->layerCount,
+		index->toolSegmentCount, (unsigned long long)index->sourceBytes, built);
+
+	if (index->layerCount == 0 || index->sourceBytes == 0)
+		return 0;
+
+	int fd = open(path, O_RDONLY);
+	void* data = fd >= 0 ? mmap(NULL, index->sourceBytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+
+	if (fd >= 0)
+		close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		fprintf(stderr, "%s: cannot map %s\n", argv[0], path);
+		return 1;
+	}
+
+	long blocks = 0;
+	start = Now();
+
+	if (!index->RunLayers((const char*)data, index->sourceBytes, threads, CountBlocks, &blocks))
+	{
+		fprintf(stderr, "%s: %s changed while it was indexed\n", argv[0], path);
+		return 1;
+	}
+
+	printf("%ld blocks in layers parsed in %.3f s on %d threads\n", blocks, Now() - start, threads);
+
+	munmap(data, index->sourceBytes);
+	delete index;
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+// gcodeminify - Rewrites a program with the fewest bytes that do the same thing.
+//
+// Usage: gcodeminify [options] <in.gcode> <out.gcode>
+//   -p places     Round axis, arc and radius words to the machine resolution (default as written).
+//   -e places     Round E words (default as written).
+//   -f places     Round F words (default as written).
+//   -m            Drop repeated G words of moves, for controllers with modal motion (Grbl, LinuxCNC).
+
+#include "../GCodeMinifier.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+	GCodeMinifier minifier;
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-')
+	{
+		const char* option = argv[argument];
+		const char* value = argv[argument + 1];
+
+		if (strcmp(option, "-m") == 0)
+		{
+			minifier.modalMotion = true;
+			argument++;
+			continue;
+		}
+
+		if (strcmp(option, "-p") == 0)
+			minifier.SetDecimals("XYZABCUVWIJKR", atoi(value));
+		else if (strcmp(option, "-e") == 0)
+			minifier.SetDecimals("E", atoi(value));
+		else if (strcmp(option, "-f") == 0)
+			minifier.SetDecimals("F", atoi(value));
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (argc - argument != 2)
+	{
+		fprintf(stderr, "Usage: %s [-p places] [-e places] [-f places] [-m] <in.gcode> <out.gcode>\n", argv[0]);
+		return 2;
+	}
+
+	if (!minifier.MinifyFile(argv[argument], argv[argument + 1]))
+	{
+		if (minifier.longLine != 0)
+			fprintf(stderr, "%s: %s line %ld is too long to parse\n", argv[0], argv[argument], minifier.longLine);
+		else
+			fprintf(stderr, "%s: cannot minify %s to %s\n", argv[0], argv[argument], argv[argument + 1]);
+
+		return 1;
+	}
+
+	printf("%ld lines, %ld bytes in, %ld lines, %ld bytes out, %ld bytes saved (%.1f%%)\n", minifier.linesIn,
+		minifier.bytesIn, minifier.linesOut, minifier.bytesOut, minifier.BytesSaved(),
+		minifier.bytesIn > 0 ? 100.0 * minifier.BytesSaved() / minifier.bytesIn : 0.0);
+
+	return 0;
+}
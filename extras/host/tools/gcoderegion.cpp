@@ -0,0 +1,130 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcoderegion - Finds the lines of a program that move through a box, i.e. a fixture.
+//
+// Usage: gcoderegion [-t threads] [-n repeats] <program.gcode> <x0> <y0> <z0> <x1> <y1> <z1>
+//   -t     Threads used to build the index (default 1).
+//   -n     Run the query this many times to time it (default 1).
+//
+// Prints the line numbers of the blocks whose moves (arcs expanded) have a box overlapping
+// the region. Exit status is 0 when no block does, 1 when some do and 2 on errors.
+
+#include "../GCodeSpatialIndex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+	int threads = 1;
+	long repeats = 1;
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-' && argv[argument][1] >= 'a')
+	{
+		if (strcmp(argv[argument], "-t") == 0)
+			threads = atoi(argv[argument + 1]);
+		else if (strcmp(argv[argument], "-n") == 0)
+			repeats = atol(argv[argument + 1]);
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (argc - argument != 7 || repeats < 1)
+	{
+		fprintf(stderr, "Usage: %s [-t threads] [-n repeats] <program.gcode> <x0> <y0> <z0> <x1> <y1> <z1>\n", argv[0]);
+		return 2;
+	}
+
+	const char* path = argv[argument];
+	GCodeBounds region;
+
+	for (int a = 0; a < 3; a++)
+	{
+		double first = atof(argv[argument + 1 + a]);
+		double second = atof(argv[argument + 4 + a]);
+
+		region.min[a] = first < second ? first : second;
+		region.max[a] = first > second ? first : second;
+	}
+
+	GCodeSpatialIndex* index = new GCodeSpatialIndex();
+	double start = Now();
+
+	if (!index->ParseFile(path))
+	{
+		fprintf(stderr, "%s: cannot read %s\n", argv[0], path);
+		return 2;
+	}
+
+	double parsed = Now();
+
+	if (!index->Build(threads))
+	{
+		fprintf(stderr, "%s: out of memory\n", argv[0]);
+		return 2;
+	}
+
+	double built = Now();
+	long capacity = 1024;
+	long* blocks = (long*)malloc(capacity * sizeof(long));
+	long count;
+
+	while ((count = index->Query(&region, blocks, capacity)) < 0)
+	{
+		capacity *= 4;
+		blocks = (long*)realloc(blocks, capacity * sizeof(long));
+	}
+
+	double queryStart = Now();
+
+	for (long i = 0; i < repeats; i++)
+		count = index->Query(&region, blocks, capacity);
+
+	double queried = Now();
+
+	for (long i = 0; i < count; i++)
+		printf("%ld\n", blocks[i]);
+
+	fprintf(stderr, "%ld segments, %.1f MB, parsed in %.3f s, built in %.3f s on %d threads, query %.1f us, %ld blocks\n",
+		index->segmentCount, index->MemoryUsed() / 1e6, parsed - start, built - parsed, threads,
+		(queried - queryStart) / repeats * 1e6, count);
+
+	free(blocks);
+	delete index;
+
+	return count > 0 ? 1 : 0;
+}
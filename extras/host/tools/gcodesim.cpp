@@ -0,0 +1,107 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodesim - Simulates a controller running GCodeParser on a pseudo-terminal.
+//
+// Usage: gcodesim [-b size] [-p us] [-l us] [-d dialect]
+//   -b n   Receive buffer size (default 128).
+//   -p n   Microseconds to process each line.
+//   -l n   Microseconds before each reply reaches the host.
+//   -d     Answer error:20 for lines not valid for a dialect (Marlin, Grbl, LinuxCNC or Fanuc).
+//
+// Prints the pseudo-terminal to connect a sender to and runs until interrupted.
+
+#include "../GCodeSimulator.h"
+#include "../GCodeStreamer.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static GCodeControllerSimulator simulator;
+
+static void Stop(int signal)
+{
+	simulator.stop = true;
+}
+
+int main(int argc, char* argv[])
+{
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-')
+	{
+		const char* option = argv[argument];
+		const char* value = argv[argument + 1];
+
+		if (strcmp(option, "-b") == 0)
+			simulator.rxBufferSize = atoi(value);
+		else if (strcmp(option, "-p") == 0)
+			simulator.processingDelay = atol(value);
+		else if (strcmp(option, "-l") == 0)
+			simulator.responseDelay = atol(value);
+		else if (strcmp(option, "-d") == 0 && (simulator.dialect = GCodeStreamer::DialectByName(value)) != NULL)
+			;
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (argument != argc)
+	{
+		fprintf(stderr, "Usage: gcodesim [-b size] [-p us] [-l us] [-d dialect]\n");
+		return 1;
+	}
+
+	int controller = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (controller < 0 || grantpt(controller) != 0 || unlockpt(controller) != 0)
+	{
+		fprintf(stderr, "Cannot open a pseudo-terminal\n");
+		return 1;
+	}
+
+	// Holding the host side open keeps the pseudo-terminal up between senders.
+	int host = open(ptsname(controller), O_RDWR | O_NOCTTY);
+	GCodeStreamer::ConfigureSerial(host, 115200);
+
+	printf("%s\n", ptsname(controller));
+	fflush(stdout);
+
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+
+	bool result = simulator.Run(controller);
+
+	fprintf(stderr, "%ld lines processed, %ld errors, most buffered %d of %d, %ld characters overflowed\n",
+		simulator.linesProcessed, simulator.errors, simulator.mostBuffered, simulator.rxBufferSize, simulator.overflows);
+
+	close(host);
+	close(controller);
+
+	return result ? 0 : 1;
+}
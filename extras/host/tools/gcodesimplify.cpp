@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodesimplify - Merges runs of short G1 moves within a chord tolerance.
+//
+// Usage: gcodesimplify [options] <in.gcode> <out.gcode>
+//   -t mm         Chord tolerance (default 0.01).
+//   -e ratio      Largest relative change of extrusion per length in a run (default 0.05).
+//   -w points     Points simplified at a time (default 256).
+//   -p places     Decimal places of merged moves (default 5).
+
+#include "../GCodeSimplifier.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+	GCodeSimplifier simplifier;
+	int argument = 1;
+
+	while (argument + 1 < argc && argv[argument][0] == '-')
+	{
+		const char* option = argv[argument];
+		const char* value = argv[argument + 1];
+
+		if (strcmp(option, "-t") == 0)
+			simplifier.tolerance = atof(value);
+		else if (strcmp(option, "-e") == 0)
+			simplifier.extrusionTolerance = atof(value);
+		else if (strcmp(option, "-w") == 0)
+			simplifier.windowSize = atoi(value);
+		else if (strcmp(option, "-p") == 0)
+			simplifier.precision = atoi(value);
+		else
+			break;
+
+		argument += 2;
+	}
+
+	if (argc - argument != 2)
+	{
+		fprintf(stderr, "Usage: %s [-t mm] [-e ratio] [-w points] [-p places] <in.gcode> <out.gcode>\n", argv[0]);
+		return 2;
+	}
+
+	if (!simplifier.SimplifyFile(argv[argument], argv[argument + 1]))
+	{
+		fprintf(stderr, "%s: cannot simplify %s to %s\n", argv[0], argv[argument], argv[argument + 1]);
+		return 1;
+	}
+
+	printf("%ld blocks in, %ld blocks out, %ld moves merged away (%.1f%% fewer blocks)\n", simplifier.blocksIn,
+		simplifier.blocksOut, simplifier.movesRemoved,
+		simplifier.blocksIn > 0 ? 100.0 * (simplifier.blocksIn - simplifier.blocksOut) / simplifier.blocksIn : 0.0);
+
+	return 0;
+}
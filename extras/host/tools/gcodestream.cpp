@@ -0,0 +1,183 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodestream - Streams a G-Code program to a controller with character counting flow control.
+//
+// Usage: gcodestream [options] <device> <program.gcode>
+//        gcodestream [options] -s <processing us>[,<response us>] <program.gcode>
+//   -s     Stream to a built in simulated controller over a pseudo-terminal.
+//   -b n   Controller receive buffer size (default 128).
+//   -r n   Serial baud rate (default 115200).
+//   -d     Validate lines against a dialect (Marlin, Grbl, LinuxCNC or Fanuc) before sending.
+//   -m     Minify lines before sending them.
+//   -p n   Round axis and arc words to n decimal places when minifying (default as written).
+//   -w     Send one line and wait for its ok, for comparison.
+//
+// Exit status is 0 when every line was sent and acknowledged without error, 1 otherwise.
+
+#include "../GCodeStreamer.h"
+#include "../GCodeSimulator.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct SimulatorThread
+{
+	GCodeControllerSimulator simulator;
+	int fd;
+};
+
+static void* RunSimulator(void* argument)
+{
+	SimulatorThread* thread = (SimulatorThread*)argument;
+	thread->simulator.Run(thread->fd);
+
+	return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+	int rxBufferSize = GRBL_RX_BUFFER_SIZE;
+	int baud = 115200;
+	const GCodeDialect* dialect = NULL;
+	bool minify = false;
+	int places = -1;
+	bool wait = false;
+	bool simulate = false;
+	long processingDelay = 0;
+	long responseDelay = 0;
+	int argument = 1;
+
+	while (argument < argc && argv[argument][0] == '-')
+	{
+		const char* option = argv[argument];
+		const char* value = argument + 1 < argc ? argv[argument + 1] : NULL;
+
+		if (strcmp(option, "-m") == 0)
+			minify = true;
+		else if (strcmp(option, "-w") == 0)
+			wait = true;
+		else if (value != NULL && strcmp(option, "-b") == 0)
+			rxBufferSize = atoi(value);
+		else if (value != NULL && strcmp(option, "-r") == 0)
+			baud = atoi(value);
+		else if (value != NULL && strcmp(option, "-p") == 0)
+			places = atoi(value);
+		else if (value != NULL && strcmp(option, "-d") == 0 && (dialect = GCodeStreamer::DialectByName(value)) != NULL)
+			;
+		else if (value != NULL && strcmp(option, "-s") == 0)
+		{
+			simulate = true;
+
+			if (sscanf(value, "%ld,%ld", &processingDelay, &responseDelay) < 1)
+				break;
+		}
+		else
+			break;
+
+		argument += (strcmp(option, "-m") == 0 || strcmp(option, "-w") == 0) ? 1 : 2;
+	}
+
+	if (argc - argument != (simulate ? 1 : 2))
+	{
+		fprintf(stderr, "Usage: gcodestream [-b size] [-r baud] [-d dialect] [-m] [-p places] [-w] <device> <program.gcode>\n");
+		fprintf(stderr, "       gcodestream [-b size] [-d dialect] [-m] [-p places] [-w] -s <processing us>[,<response us>] <program.gcode>\n");
+		return 1;
+	}
+
+	SimulatorThread controller;
+	GCodeControllerSimulator& simulator = controller.simulator;
+	pthread_t simulatorThread;
+	int fd;
+
+	if (simulate)
+	{
+		controller.fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+		if (controller.fd < 0 || grantpt(controller.fd) != 0 || unlockpt(controller.fd) != 0)
+		{
+			fprintf(stderr, "Cannot open a pseudo-terminal\n");
+			return 1;
+		}
+
+		fd = open(ptsname(controller.fd), O_RDWR | O_NOCTTY);
+	}
+	else
+		fd = open(argv[argument++], O_RDWR | O_NOCTTY);
+
+	if (fd < 0 || !GCodeStreamer::ConfigureSerial(fd, baud))
+	{
+		fprintf(stderr, "Cannot open %s\n", simulate ? "the pseudo-terminal" : argv[argument - 1]);
+		return 1;
+	}
+
+	if (simulate)
+	{
+		simulator.rxBufferSize = rxBufferSize;
+		simulator.processingDelay = processingDelay;
+		simulator.responseDelay = responseDelay;
+		simulator.dialect = dialect;
+		pthread_create(&simulatorThread, NULL, RunSimulator, &controller);
+	}
+
+	GCodeStreamer streamer(fd);
+	streamer.rxBufferSize = rxBufferSize;
+	streamer.waitForOk = wait;
+	streamer.minify = minify;
+	streamer.dialect = dialect;
+	streamer.minifier.SetDecimals("XYZABCUVWIJKR", places);
+
+	// Marlin carries out one command per line, each move needs its G word.
+	streamer.minifier.modalMotion = dialect != &GCodeDialectMarlin;
+
+	bool streamed = streamer.StreamFile(argv[argument]);
+
+	close(fd);
+
+	if (simulate)
+	{
+		simulator.stop = true;
+		pthread_join(simulatorThread, NULL);
+		close(controller.fd);
+	}
+
+	const GCodeStreamStatistics& statistics = streamer.statistics;
+
+	printf("%ld lines, %ld bytes sent (%ld saved) in %.3f s: %.0f lines/s, %.0f bytes/s\n",
+		statistics.linesSent, statistics.bytesSent, statistics.bytesSaved, statistics.seconds,
+		statistics.seconds > 0 ? statistics.linesSent / statistics.seconds : 0.0,
+		statistics.seconds > 0 ? statistics.bytesSent / statistics.seconds : 0.0);
+
+	if (statistics.errors + statistics.invalid > 0)
+		printf("%ld error responses, %ld lines not valid for the dialect\n", statistics.errors, statistics.invalid);
+
+	if (simulate)
+		printf("simulator: %ld lines processed, most buffered %d of %d, %ld characters overflowed\n",
+			simulator.linesProcessed, simulator.mostBuffered, simulator.rxBufferSize, simulator.overflows);
+
+	return streamed && statistics.errors == 0 && statistics.invalid == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// gcodetransform - Translates, scales, rotates and mirrors a G-Code program.
+//
+// Usage: gcodetransform [options] <in.gcode> <out.gcode>
+//   -t x,y,z      Translate.
+//   -s x,y,z      Scale about the origin.
+//   -r degrees    Rotate counterclockwise about the Z axis.
+//   -mx, -my      Mirror X or Y.
+//   -p places     Decimal places written (default 4).
+// Options are applied in the order given.
+
+#include "../GCodeTransform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+	GCodeAffine affine = GCodeAffine::Identity();
+	int precision = 4;
+	int argument = 1;
+
+	while (argument < argc && argv[argument][0] == '-')
+	{
+		const char* option = argv[argument];
+		const char* value = argument + 1 < argc ? argv[argument + 1] : NULL;
+		double x, y, z;
+
+		if (strcmp(option, "-mx") == 0)
+			affine = affine.Then(GCodeAffine::MirrorX());
+		else if (strcmp(option, "-my") == 0)
+			affine = affine.Then(GCodeAffine::MirrorY());
+		else if (value != NULL && strcmp(option, "-t") == 0 && sscanf(value, "%lf,%lf,%lf", &x, &y, &z) == 3)
+			affine = affine.Then(GCodeAffine::Translation(x, y, z));
+		else if (value != NULL && strcmp(option, "-s") == 0 && sscanf(value, "%lf,%lf,%lf", &x, &y, &z) == 3)
+			affine = affine.Then(GCodeAffine::Scaling(x, y, z));
+		else if (value != NULL && strcmp(option, "-r") == 0)
+			affine = affine.Then(GCodeAffine::Rotation(atof(value)));
+		else if (value != NULL && strcmp(option, "-p") == 0)
+			precision = atoi(value);
+		else
+			break;
+
+		argument += (strcmp(option, "-mx") == 0 || strcmp(option, "-my") == 0) ? 1 : 2;
+	}
+
+	if (argc - argument != 2)
+	{
+		fprintf(stderr, "Usage: %s [-t x,y,z] [-s x,y,z] [-r degrees] [-mx] [-my] [-p places] <in.gcode> <out.gcode>\n", argv[0]);
+		return 2;
+	}
+
+	GCodeTransform transform(affine);
+	transform.precision = precision;
+
+	if (!transform.TransformFile(argv[argument], argv[argument + 1]))
+	{
+		if (transform.longLine != 0)
+			fprintf(stderr, "%s: %s line %ld is longer than %d characters\n", argv[0], argv[argument], transform.longLine, MAX_LINE_SIZE);
+		else
+			fprintf(stderr, "%s: cannot transform %s\n", argv[0], argv[argument]);
+
+		return 1;
+	}
+
+	return 0;
+}
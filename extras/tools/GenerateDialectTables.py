@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+"""
+Generates src/GCodeDialectTables.cpp, the G-Code dialect command tables.
+
+Each dialect's commands are placed in a perfect hash table (hash and displace)
+so GCodeDialect::FindCommand is two multiplies and one compare with no probing.
+The hash functions here must match HashCommandKey and HashCommandBucket in
+src/GCodeDialect.cpp.
+
+Usage: python3 extras/tools/GenerateDialectTables.py > src/GCodeDialectTables.cpp
+"""
+
+import sys
+
+EMPTY_KEY = 0xFFFF
+
+# Modal groups. Must match the GCODE_GROUP_* constants in src/GCodeDialect.h.
+NON_MODAL = 0
+MOTION = 1
+PLANE = 2
+DISTANCE = 3
+ARC_DISTANCE = 4
+FEED_RATE_MODE = 5
+UNITS = 6
+CUTTER_COMPENSATION = 7
+TOOL_LENGTH = 8
+RETURN_MODE = 10
+COORDINATE_SYSTEM = 12
+PATH_CONTROL = 13
+SPINDLE_SPEED_MODE = 14
+LATHE_DIAMETER = 15
+STOPPING = 20
+SPINDLE = 23
+
+# Command flags. Must match the GCODE_COMMAND_* constants in src/GCodeDialect.h.
+TEXT = 0x01
+
+# Dialect flags. Must match the GCODE_DIALECT_* constants in src/GCodeDialect.h.
+BARE_WORDS = 0x01
+
+AXES = "XYZABCUVW"
+ALL = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+
+
+def command_key(letter, code, subcode=None):
+    key = (0x8000 if letter == "M" else 0) | (code << 4)
+    if subcode is not None:
+        key |= subcode + 1
+    return key
+
+
+def parse_command(text):
+    letter = text[0]
+    if "." in text:
+        code, subcode = text[1:].split(".")
+        return letter, int(code), int(subcode)
+    return letter, int(text[1:]), None
+
+
+def mask(letters):
+    value = 0
+    for letter in letters:
+        value |= 1 << (ord(letter) - ord("A"))
+    return value
+
+
+def hash_key(key, seed, bits):
+    h = ((key ^ seed) * 2654435761) & 0xFFFFFFFF
+    return h >> (32 - bits)
+
+
+def hash_bucket(key, bits):
+    h = (key * 2246822507) & 0xFFFFFFFF
+    return h >> (32 - bits)
+
+
+def build_perfect_hash(keys):
+    """Returns (table bits, bucket bits, displacements, slots) with slots holding key indices."""
+    table_bits = max(1, (len(keys) - 1).bit_length())
+    while True:
+        bucket_bits = max(1, table_bits - 2)
+        buckets = [[] for _ in range(1 << bucket_bits)]
+        for index, key in enumerate(keys):
+            buckets[hash_bucket(key, bucket_bits)].append(index)
+
+        slots = [None] * (1 << table_bits)
+        displacements = [0] * (1 << bucket_bits)
+        order = sorted(range(len(buckets)), key=lambda b: -len(buckets[b]))
+        placed = True
+
+        for bucket in order:
+            members = buckets[bucket]
+            if not members:
+                continue
+            for seed in range(0x10000):
+                positions = [hash_key(keys[i], seed, table_bits) for i in members]
+                if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+                    for i, p in zip(members, positions):
+                        slots[p] = i
+                    displacements[bucket] = seed
+                    break
+            else:
+                placed = False
+                break
+
+        if placed:
+            return table_bits, bucket_bits, displacements, slots
+        table_bits += 1
+
+
+class Dialect:
+    def __init__(self, name, letters, general_words, flags):
+        self.name = name
+        self.letters = letters
+        self.general_words = general_words
+        self.flags = flags
+        self.commands = {}
+
+    def add(self, names, group, allowed="", flags=0):
+        for name in names.split():
+            letter, code, subcode = parse_command(name)
+            key = command_key(letter, code, subcode)
+            assert key not in self.commands, name
+            self.commands[key] = (name, group, flags, mask(allowed))
+
+
+def rs274_common(dialect):
+    dialect.add("G0 G1", MOTION, AXES)
+    dialect.add("G2 G3", MOTION, AXES + "IJKRP")
+    dialect.add("G4", NON_MODAL, "P")
+    dialect.add("G17 G18 G19", PLANE)
+    dialect.add("G20 G21", UNITS)
+    dialect.add("G28 G30", NON_MODAL, AXES)
+    dialect.add("G28.1 G30.1", NON_MODAL)
+    dialect.add("G38.2 G38.3 G38.4 G38.5", MOTION, AXES)
+    dialect.add("G40", CUTTER_COMPENSATION)
+    dialect.add("G49", TOOL_LENGTH)
+    dialect.add("G53", NON_MODAL)
+    dialect.add("G54 G55 G56 G57 G58 G59", COORDINATE_SYSTEM)
+    dialect.add("G61", PATH_CONTROL)
+    dialect.add("G80", MOTION)
+    dialect.add("G90 G91", DISTANCE)
+    dialect.add("G92", NON_MODAL, AXES)
+    dialect.add("G93 G94", FEED_RATE_MODE)
+    dialect.add("M0 M1 M2 M30", STOPPING)
+    dialect.add("M3 M4", SPINDLE)
+    dialect.add("M5", SPINDLE)
+    # Mist and flood coolant may be turned on together so coolant is not group checked.
+    dialect.add("M7 M8 M9", NON_MODAL)
+
+
+def grbl():
+    dialect = Dialect("Grbl", "FGHIJKLMNPRSTXYZ", "NFST", 0)
+    rs274_common(dialect)
+    dialect.add("G10", NON_MODAL, "LPR" + "XYZ")
+    dialect.add("G43.1", TOOL_LENGTH, "Z")
+    dialect.add("G91.1", ARC_DISTANCE)
+    dialect.add("G92.1", NON_MODAL)
+    dialect.add("M56", NON_MODAL, "P")
+    return dialect
+
+
+def linuxcnc():
+    dialect = Dialect("LinuxCNC", "ABCDEFGHIJKLMNPQRSTUVWXYZ", "NFST", 0)
+    rs274_common(dialect)
+    dialect.add("G5", MOTION, "XYIJPQ")
+    dialect.add("G5.1", MOTION, "XYIJ")
+    dialect.add("G5.2", MOTION, "XYPL")
+    dialect.add("G5.3", MOTION)
+    dialect.add("G7 G8", LATHE_DIAMETER)
+    dialect.add("G10", NON_MODAL, "LPRIJKQ" + AXES)
+    dialect.add("G17.1 G18.1 G19.1", PLANE)
+    dialect.add("G33", MOTION, AXES + "K")
+    dialect.add("G33.1", MOTION, "XYZK")
+    dialect.add("G41 G42", CUTTER_COMPENSATION, "D")
+    dialect.add("G41.1 G42.1", CUTTER_COMPENSATION, "DL")
+    dialect.add("G43 G43.2", TOOL_LENGTH, "H")
+    dialect.add("G43.1", TOOL_LENGTH, AXES)
+    dialect.add("G52", NON_MODAL, AXES)
+    dialect.add("G59.1 G59.2 G59.3", COORDINATE_SYSTEM)
+    dialect.add("G61.1", PATH_CONTROL)
+    dialect.add("G64", PATH_CONTROL, "PQ")
+    dialect.add("G73 G74 G81 G82 G83 G84 G85 G86 G87 G88 G89", MOTION, AXES + "RLPQIJK")
+    dialect.add("G76", MOTION, "PZIJRKQHEL")
+    dialect.add("G90.1 G91.1", ARC_DISTANCE)
+    dialect.add("G92.1 G92.2 G92.3", NON_MODAL)
+    dialect.add("G95", FEED_RATE_MODE)
+    dialect.add("G96", SPINDLE_SPEED_MODE, "D")
+    dialect.add("G97", SPINDLE_SPEED_MODE)
+    dialect.add("G98 G99", RETURN_MODE)
+    dialect.add("M6", NON_MODAL)
+    dialect.add("M19", SPINDLE, "RQP")
+    dialect.add("M48 M49", NON_MODAL)
+    dialect.add("M50 M51 M52 M53", NON_MODAL, "P")
+    dialect.add("M60", STOPPING)
+    dialect.add("M61", NON_MODAL, "Q")
+    dialect.add("M62 M63 M64 M65", NON_MODAL, "P")
+    dialect.add("M66", NON_MODAL, "PELQ")
+    dialect.add("M67 M68", NON_MODAL, "EQ")
+    dialect.add("M70 M71 M72 M73", NON_MODAL)
+    dialect.add(" ".join("M%d" % code for code in range(100, 200)), NON_MODAL, "PQ")
+    return dialect
+
+
+def fanuc():
+    dialect = Dialect("Fanuc", "ABCDEFGHIJKLMNOPQRSTUVWXYZ", "NFSTO", 0)
+    dialect.add("G0 G1", MOTION, AXES)
+    dialect.add("G2 G3", MOTION, AXES + "IJKR")
+    dialect.add("G4", NON_MODAL, "PXU")
+    dialect.add("G9", NON_MODAL)
+    dialect.add("G10", NON_MODAL, "LPRQ" + AXES)
+    dialect.add("G11", NON_MODAL)
+    dialect.add("G15 G16", NON_MODAL)
+    dialect.add("G17 G18 G19", PLANE)
+    dialect.add("G20 G21", UNITS)
+    dialect.add("G22 G23", NON_MODAL, AXES + "IJK")
+    dialect.add("G27 G28 G29 G30", NON_MODAL, AXES + "P")
+    dialect.add("G31", NON_MODAL, AXES)
+    dialect.add("G33", MOTION, AXES + "FQ")
+    dialect.add("G40", CUTTER_COMPENSATION)
+    dialect.add("G41 G42", CUTTER_COMPENSATION, "D")
+    dialect.add("G43 G44", TOOL_LENGTH, "HZ")
+    dialect.add("G49", TOOL_LENGTH)
+    dialect.add("G50 G51", NON_MODAL, AXES + "IJKPR")
+    dialect.add("G50.1 G51.1", NON_MODAL, AXES)
+    dialect.add("G52 G53", NON_MODAL, AXES)
+    dialect.add("G54 G55 G56 G57 G58 G59", COORDINATE_SYSTEM)
+    dialect.add("G54.1", COORDINATE_SYSTEM, "P")
+    dialect.add("G61 G62 G63 G64", PATH_CONTROL)
+    dialect.add("G65 G66", NON_MODAL, ALL)
+    dialect.add("G67", NON_MODAL)
+    dialect.add("G68", NON_MODAL, AXES + "R")
+    dialect.add("G69", NON_MODAL)
+    dialect.add("G73 G74 G76 G81 G82 G83 G84 G85 G86 G87 G88 G89", MOTION, AXES + "RPQLK")
+    dialect.add("G80", MOTION)
+    dialect.add("G90 G91", DISTANCE)
+    dialect.add("G92", NON_MODAL, AXES)
+    dialect.add("G94 G95", FEED_RATE_MODE)
+    dialect.add("G96 G97", SPINDLE_SPEED_MODE)
+    dialect.add("G98 G99", RETURN_MODE)
+    dialect.add("M0 M1 M2 M30", STOPPING)
+    dialect.add("M3 M4 M5 M19", SPINDLE)
+    dialect.add("M6", NON_MODAL)
+    dialect.add("M7 M8 M9", NON_MODAL)
+    dialect.add("M29", NON_MODAL)
+    dialect.add("M98", NON_MODAL, "PL")
+    dialect.add("M99", NON_MODAL, "P")
+    dialect.add("M198", NON_MODAL, "PL")
+    return dialect
+
+
+def marlin():
+    dialect = Dialect("Marlin", ALL, "N", BARE_WORDS)
+    dialect.add("G0 G1", NON_MODAL, AXES + "EFS")
+    dialect.add("G2 G3", NON_MODAL, AXES + "EFIJRPS")
+    dialect.add("G4", NON_MODAL, "PS")
+    dialect.add("G5", NON_MODAL, "XYEFIJPQS")
+    dialect.add("G6", NON_MODAL, "XYZEIRS")
+    dialect.add("G10 G11", NON_MODAL, "S")
+    dialect.add("G12", NON_MODAL, "PRSTXYZ")
+    dialect.add("G17 G18 G19", NON_MODAL)
+    dialect.add("G20 G21", NON_MODAL)
+    dialect.add("G28", NON_MODAL, AXES + "LOR")
+    dialect.add("G38.2 G38.3 G38.4 G38.5", NON_MODAL, AXES + "F")
+    dialect.add("G53", NON_MODAL)
+    dialect.add("G54 G55 G56 G57 G58 G59 G59.1 G59.2 G59.3", NON_MODAL)
+    dialect.add("G80", NON_MODAL)
+    dialect.add("G90 G91", NON_MODAL)
+    dialect.add("G92", NON_MODAL, AXES + "E")
+    dialect.add("M0 M1", NON_MODAL, "PS")
+    dialect.add("M3 M4", NON_MODAL, "SOI")
+    dialect.add("M5 M7 M8 M9 M10 M11", NON_MODAL)
+    dialect.add("M104 M109", NON_MODAL, "BFISTD")
+    dialect.add("M140 M190", NON_MODAL, "ISR")
+    dialect.add("M106", NON_MODAL, "IPST")
+    dialect.add("M107", NON_MODAL, "P")
+    # Commands whose rest of line is a message or file name.
+    dialect.add("M23 M28 M30 M32 M33 M117 M118 M928", NON_MODAL, "", TEXT)
+    # Remaining commands accept command specific parameter letters which are not tabulated.
+    others = ("G26 G27 G29 G30 G31 G32 G33 G34 G35 G42 G60 G61 G76 G425 "
+              "M16 M17 M18 M20 M21 M22 M24 M25 M26 M27 M29 M31 M34 M42 M43 M48 "
+              "M73 M75 M76 M77 M78 M80 M81 M82 M83 M84 M85 M86 M87 M92 M100 M102 "
+              "M105 M108 M110 M111 M112 M113 M114 M115 M119 M120 M121 M122 M123 M125 "
+              "M126 M127 M128 M129 M141 M143 M145 M149 M150 M154 M155 M163 M164 M165 M166 "
+              "M191 M192 M193 M200 M201 M203 M204 M205 M206 M207 M208 M209 M211 M217 "
+              "M218 M220 M221 M226 M240 M250 M255 M256 M260 M261 M280 M281 M282 M290 "
+              "M300 M301 M302 M303 M304 M305 M306 M350 M351 M355 M360 M361 M362 M363 "
+              "M364 M380 M381 M400 M401 M402 M403 M404 M405 M406 M407 M410 M412 M413 "
+              "M420 M421 M422 M423 M425 M428 M430 M486 M493 M500 M501 M502 M503 M504 "
+              "M510 M511 M512 M524 M540 M569 M575 M592 M593 M600 M603 M605 M665 M666 "
+              "M672 M701 M702 M710 M808 M851 M852 M860 M861 M862 M863 M864 M865 M866 "
+              "M867 M868 M869 M871 M876 M900 M906 M907 M908 M909 M910 M911 M912 M913 "
+              "M914 M915 M916 M917 M918 M919 M951 M993 M994 M995 M997 M999")
+    dialect.add(others, NON_MODAL, ALL)
+    return dialect
+
+
+FLAGS = {0: "0", TEXT: "GCODE_COMMAND_TEXT"}
+DIALECT_FLAGS = {0: "0", BARE_WORDS: "GCODE_DIALECT_BARE_WORDS"}
+
+HEADER = """/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Generated by extras/tools/GenerateDialectTables.py. Do not edit by hand.
+
+#include "GCodeDialect.h"
+"""
+
+
+def emit(dialect, out):
+    keys = sorted(dialect.commands)
+    table_bits, bucket_bits, displacements, slots = build_perfect_hash(keys)
+    ident = dialect.name
+
+    out.write("\n// %s: %d commands in %d slots.\n" % (ident, len(keys), len(slots)))
+    out.write("static const unsigned int %sDisplacements[%d] GCODE_PROGMEM = {" % (ident, len(displacements)))
+    for i, d in enumerate(displacements):
+        out.write(("\n\t" if i % 12 == 0 else " ") + "%d," % d)
+    out.write("\n};\n\n")
+
+    out.write("static const GCodeCommand %sCommands[%d] GCODE_PROGMEM = {\n" % (ident, len(slots)))
+    for slot in slots:
+        if slot is None:
+            out.write("\t{ 0x%04X, 0, 0, 0x%07XUL },\n" % (EMPTY_KEY, 0))
+        else:
+            key = keys[slot]
+            name, group, flags, allowed = dialect.commands[key]
+            out.write("\t{ 0x%04X, %d, %s, 0x%07XUL }, // %s\n" % (key, group, FLAGS[flags], allowed, name))
+    out.write("};\n\n")
+
+    out.write("const GCodeDialect GCodeDialect%s = {\n" % ident)
+    out.write("\t\"%s\",\n" % dialect.name)
+    out.write("\t0x%07XUL, // %s\n" % (mask(dialect.letters), dialect.letters))
+    out.write("\t0x%07XUL, // %s\n" % (mask(dialect.general_words), dialect.general_words))
+    out.write("\t%s,\n" % DIALECT_FLAGS[dialect.flags])
+    out.write("\t%d,\n" % table_bits)
+    out.write("\t%d,\n" % bucket_bits)
+    out.write("\t%sCommands,\n" % ident)
+    out.write("\t%sDisplacements\n" % ident)
+    out.write("};\n")
+
+
+def main():
+    out = sys.stdout
+    out.write(HEADER)
+    for dialect in (marlin(), grbl(), linuxcnc(), fanuc()):
+        emit(dialect, out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeArena.h"
+
+// Alignment of every allocation, enough for the doubles and pointers stored in arenas.
+const size_t ARENA_ALIGNMENT = sizeof(double) > sizeof(void*) ? sizeof(double) : sizeof(void*);
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+/// <param name="memory">The memory to allocate from, owned by the caller.</param>
+/// <param name="size">The size of the memory in bytes.</param>
+GCodeArena::GCodeArena(void* memory, size_t size)
+{
+	this->memory = (char*)memory;
+	this->size = memory != NULL ? size : 0;
+	used = 0;
+}
+
+/// <summary>
+/// Allocates bytes from the arena.
+/// </summary>
+/// <param name="bytes">The number of bytes.</param>
+/// <returns>The aligned bytes or NULL if the arena does not have room.</returns>
+void* GCodeArena::Allocate(size_t bytes)
+{
+	size_t start = (used + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+	if (start > size || bytes > size - start)
+		return NULL;
+
+	used = start + bytes;
+
+	return memory + start;
+}
+
+/// <summary>
+/// Allocates all the bytes left in the arena.
+/// </summary>
+/// <param name="bytes">Receives the number of bytes allocated.</param>
+/// <returns>The aligned bytes or NULL if the arena is full.</returns>
+void* GCodeArena::AllocateRest(size_t* bytes)
+{
+	size_t start = (used + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+	if (start >= size)
+	{
+		*bytes = 0;
+		return NULL;
+	}
+
+	*bytes = size - start;
+	used = size;
+
+	return memory + start;
+}
+
+/// <summary>
+/// Gets a mark to release allocations made after it.
+/// </summary>
+size_t GCodeArena::Mark() const
+{
+	return used;
+}
+
+/// <summary>
+/// Frees everything allocated after a mark.
+/// </summary>
+/// <param name="mark">A value returned by Mark.</param>
+void GCodeArena::Release(size_t mark)
+{
+	if (mark < used)
+		used = mark;
+}
+
+/// <summary>
+/// Frees everything allocated.
+/// </summary>
+void GCodeArena::Reset()
+{
+	used = 0;
+}
+
+/// <summary>
+/// Gets the size of the arena in bytes.
+/// </summary>
+size_t GCodeArena::Size() const
+{
+	return size;
+}
+
+/// <summary>
+/// Gets the bytes allocated, including alignment padding.
+/// </summary>
+size_t GCodeArena::Used() const
+{
+	return used;
+}
+
+/// <summary>
+/// Gets the bytes left, before alignment.
+/// </summary>
+size_t GCodeArena::Available() const
+{
+	return size - used;
+}
@@ -0,0 +1,64 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeArena_h
+#define GCodeArena_h
+
+#include <stddef.h>
+
+/// <summary>
+/// A bump allocator over caller provided memory.
+/// </summary>
+/// <remark>
+/// Allocate hands out the next aligned bytes of the memory and never calls malloc, so many
+/// small objects cost one pointer increment each and are all freed at once by Reset (or
+/// back to a Mark by Release). The memory can be a static array on the Arduino or one large
+/// block on a host.
+///
+///   static char memory[2048];
+///   GCodeArena arena(memory, sizeof(memory));
+///   GCode.lineArena = &amp;arena;
+/// </remark>
+class GCodeArena
+{
+private:
+	char* memory;
+	size_t size;
+	size_t used;
+
+public:
+	GCodeArena(void* memory, size_t size);
+
+	void* Allocate(size_t bytes);
+	void* AllocateRest(size_t* bytes);
+	size_t Mark() const;
+	void Release(size_t mark);
+	void Reset();
+
+	size_t Size() const;
+	size_t Used() const;
+	size_t Available() const;
+};
+
+#endif
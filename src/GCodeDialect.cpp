@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeDialect.h"
+#include <string.h>
+
+/// <summary>
+/// Builds the command table key for a G or M code.
+/// </summary>
+/// <param name="letter">G or M.</param>
+/// <param name="code">The command number (0 to 2047).</param>
+/// <param name="subcode">The digit after the decimal point (i.e. 2 for G38.2) or -1 if none.</param>
+/// <returns>The key or GCODE_COMMAND_EMPTY if the command cannot be represented.</returns>
+unsigned int GCodeDialect::CommandKey(char letter, long code, int subcode)
+{
+	if ((letter != 'G' && letter != 'M') || code < 0 || code > 2047 || subcode < -1 || subcode > 9)
+		return GCODE_COMMAND_EMPTY;
+
+	return (letter == 'M' ? 0x8000 : 0) | ((unsigned int)code << 4) | (unsigned int)(subcode + 1);
+}
+
+/// <summary>
+/// Hashes a command key to a slot. Must match hash_key in GenerateDialectTables.py.
+/// </summary>
+static unsigned int HashCommandKey(unsigned int key, unsigned int seed, unsigned char bits)
+{
+	unsigned long h = ((unsigned long)(key ^ seed) * 2654435761UL) & 0xFFFFFFFFUL;
+
+	return (unsigned int)(h >> (32 - bits));
+}
+
+/// <summary>
+/// Hashes a command key to a displacement bucket. Must match hash_bucket in GenerateDialectTables.py.
+/// </summary>
+static unsigned int HashCommandBucket(unsigned int key, unsigned char bits)
+{
+	unsigned long h = ((unsigned long)key * 2246822507UL) & 0xFFFFFFFFUL;
+
+	return (unsigned int)(h >> (32 - bits));
+}
+
+/// <summary>
+/// Looks up a command.
+/// </summary>
+/// <param name="letter">G or M.</param>
+/// <param name="code">The command number.</param>
+/// <param name="subcode">The digit after the decimal point or -1 if none.</param>
+/// <param name="command">Receives the command if found. May be NULL.</param>
+/// <returns>True if the dialect supports the command.</returns>
+bool GCodeDialect::FindCommand(char letter, long code, int subcode, GCodeCommand* command) const
+{
+	unsigned int key = CommandKey(letter, code, subcode);
+
+	if (key == GCODE_COMMAND_EMPTY)
+		return false;
+
+	const unsigned int* displacement = &displacements[HashCommandBucket(key, bucketBits)];
+	GCodeCommand slot;
+
+#if defined(__AVR__)
+	unsigned int seed = pgm_read_word(displacement);
+	memcpy_P(&slot, &commands[HashCommandKey(key, seed, tableBits)], sizeof(GCodeCommand));
+#else
+	unsigned int seed = *displacement;
+	slot = commands[HashCommandKey(key, seed, tableBits)];
+#endif
+
+	if (slot.key != key)
+		return false;
+
+	if (command != NULL)
+		*command = slot;
+
+	return true;
+}
+
+/// <summary>
+/// Determine if the dialect supports a command.
+/// </summary>
+/// <param name="letter">G or M.</param>
+/// <param name="code">The command number.</param>
+/// <param name="subcode">The digit after the decimal point or -1 if none.</param>
+/// <returns>True if the dialect supports the command.</returns>
+bool GCodeDialect::IsCommand(char letter, long code, int subcode) const
+{
+	return FindCommand(letter, code, subcode, NULL);
+}
+
+/// <summary>
+/// Validates a parsed line (comments and whitespace removed) against the dialect.
+/// </summary>
+/// <param name="line">The code block, normally GCodeParser::line after ParseLine.</param>
+/// <param name="errorPosition">Receives the position of the offending character. May be NULL.</param>
+/// <returns>GCODE_VALID or the first problem found.</returns>
+/// <remarks>
+/// The line is walked once. Every letter must be in the dialect, every word must have a
+/// number (unless the dialect allows bare words), every G and M code must be in the
+/// command table and no two commands may share a modal group. When the line has commands
+/// every word must be allowed by one of them or be a general word. Lines without commands
+/// (modal moves such as X10 Y20) only have their letters checked. A checksum (*nn) ends
+/// the block and a text command (i.e. M117) ends validation.
+/// </remarks>
+GCodeValidation GCodeDialect::Validate(const char* line, int* errorPosition) const
+{
+	int pointer = 0;
+	unsigned long wordsFound = 0;
+	unsigned long wordsAllowed = generalWords;
+	unsigned long groupsFound = 0;
+	bool commandFound = false;
+	GCodeValidation result = GCODE_VALID;
+
+	// Block delete and program begin/end.
+	if (line[0] == '/')
+		pointer++;
+	else if (line[0] == '%')
+		line = "";
+
+	while (line[pointer] != '\0' && line[pointer] != '*')
+	{
+		char letter = line[pointer];
+
+		if (letter < 'A' || letter > 'Z' || !(letters & GCODE_LETTER(letter)))
+		{
+			result = GCODE_INVALID_LETTER;
+			break;
+		}
+
+		int letterPosition = pointer;
+		pointer++;
+
+		if (letter == 'G' || letter == 'M')
+		{
+			long code;
+			int count = GCodeParser::ParseInteger(&line[pointer], &code);
+
+			if (count == 0 || line[pointer] == '-' || line[pointer] == '+')
+			{
+				pointer = letterPosition;
+				result = GCODE_INVALID_NUMBER;
+				break;
+			}
+
+			pointer += count;
+
+			int subcode = -1;
+
+			if (line[pointer] == '.')
+			{
+				pointer++;
+
+				if (line[pointer] >= '0' && line[pointer] <= '9')
+				{
+					subcode = line[pointer] - '0';
+					pointer++;
+				}
+			}
+
+			GCodeCommand command;
+
+			if (!FindCommand(letter, code, subcode, &command))
+			{
+				pointer = letterPosition;
+				result = GCODE_UNKNOWN_COMMAND;
+				break;
+			}
+
+			if (command.modalGroup != GCODE_GROUP_NON_MODAL)
+			{
+				unsigned long group = 1UL << command.modalGroup;
+
+				if (groupsFound & group)
+				{
+					pointer = letterPosition;
+					result = GCODE_MODAL_GROUP_CONFLICT;
+					break;
+				}
+
+				groupsFound |= group;
+			}
+
+			commandFound = true;
+			wordsAllowed |= command.allowedWords;
+
+			if (command.flags & GCODE_COMMAND_TEXT)
+				break;
+
+			continue;
+		}
+
+		double value;
+		int count = GCodeParser::ParseNumber(&line[pointer], &value);
+
+		if (count == 0 && !(flags & GCODE_DIALECT_BARE_WORDS))
+		{
+			pointer = letterPosition;
+			result = GCODE_INVALID_NUMBER;
+			break;
+		}
+
+		pointer += count;
+		wordsFound |= GCODE_LETTER(letter);
+	}
+
+	if (result == GCODE_VALID && commandFound && (wordsFound & ~wordsAllowed))
+	{
+		// Find the first word not allowed to report its position.
+		result = GCODE_WORD_NOT_ALLOWED;
+
+		for (pointer = 0; line[pointer] != '\0'; pointer++)
+		{
+			char letter = line[pointer];
+
+			if (letter >= 'A' && letter <= 'Z' && letter != 'G' && letter != 'M' && !(wordsAllowed & GCODE_LETTER(letter)))
+				break;
+		}
+	}
+
+	if (errorPosition != NULL)
+		*errorPosition = (result == GCODE_VALID) ? -1 : pointer;
+
+	return result;
+}
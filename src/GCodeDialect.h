@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeDialect_h
+#define GCodeDialect_h
+
+#include "GCodeParser.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define GCODE_PROGMEM PROGMEM
+#else
+#define GCODE_PROGMEM
+#endif
+
+const unsigned int GCODE_COMMAND_EMPTY = 0xFFFF; // Unused command table slot.
+
+// Command flags.
+const unsigned char GCODE_COMMAND_TEXT = 0x01; // The rest of the line is a message or file name (i.e. M117).
+
+// Dialect flags.
+const unsigned char GCODE_DIALECT_BARE_WORDS = 0x01; // Words may omit their value (i.e. Marlin G28 X).
+
+// Modal groups. G groups follow RS274/NGC numbering, M groups are offset by 16.
+const unsigned char GCODE_GROUP_NON_MODAL = 0;
+const unsigned char GCODE_GROUP_MOTION = 1;
+const unsigned char GCODE_GROUP_PLANE = 2;
+const unsigned char GCODE_GROUP_DISTANCE = 3;
+const unsigned char GCODE_GROUP_ARC_DISTANCE = 4;
+const unsigned char GCODE_GROUP_FEED_RATE_MODE = 5;
+const unsigned char GCODE_GROUP_UNITS = 6;
+const unsigned char GCODE_GROUP_CUTTER_COMPENSATION = 7;
+const unsigned char GCODE_GROUP_TOOL_LENGTH = 8;
+const unsigned char GCODE_GROUP_RETURN_MODE = 10;
+const unsigned char GCODE_GROUP_COORDINATE_SYSTEM = 12;
+const unsigned char GCODE_GROUP_PATH_CONTROL = 13;
+const unsigned char GCODE_GROUP_SPINDLE_SPEED_MODE = 14;
+const unsigned char GCODE_GROUP_LATHE_DIAMETER = 15;
+const unsigned char GCODE_GROUP_STOPPING = 20;
+const unsigned char GCODE_GROUP_SPINDLE = 23;
+
+/// <summary>
+/// A G or M command supported by a dialect.
+/// </summary>
+/// <remark>
+/// The key is built by GCodeDialect::CommandKey: bit 15 is set for M codes, bits 4 to 14
+/// hold the code and bits 0 to 3 hold the subcode plus one (zero for no subcode).
+/// </remark>
+struct GCodeCommand
+{
+	unsigned int key;
+	unsigned char modalGroup;
+	unsigned char flags;
+	unsigned long allowedWords; // GCODE_LETTER mask of the words the command accepts.
+};
+
+/// <summary>
+/// A G-Code dialect. The letters, commands, modal groups and words allowed per command
+/// for a family of controllers.
+/// </summary>
+/// <remark>
+/// Commands are stored in a perfect hash table generated ahead of time by
+/// extras/tools/GenerateDialectTables.py, so looking up a command costs two multiplies
+/// and a single compare. On the AVR the tables are kept in program memory.
+/// 
+/// Predefined dialects are GCodeDialectMarlin, GCodeDialectGrbl, GCodeDialectLinuxCNC
+/// and GCodeDialectFanuc. Select one with GCodeParser(const GCodeDialect* dialect).
+/// </remark>
+struct GCodeDialect
+{
+	const char* name;
+	unsigned long letters;      // GCODE_LETTER mask of valid word letters.
+	unsigned long generalWords; // Words allowed on any line (i.e. N, F, S, T).
+	unsigned char flags;
+	unsigned char tableBits;    // The command table holds 2^tableBits slots.
+	unsigned char bucketBits;   // The displacement table holds 2^bucketBits entries.
+	const GCodeCommand* commands;
+	const unsigned int* displacements;
+
+	static unsigned int CommandKey(char letter, long code, int subcode);
+
+	bool FindCommand(char letter, long code, int subcode, GCodeCommand* command) const;
+	bool IsCommand(char letter, long code, int subcode) const;
+	GCodeValidation Validate(const char* line, int* errorPosition) const;
+};
+
+extern const GCodeDialect GCodeDialectMarlin;
+extern const GCodeDialect GCodeDialectGrbl;
+extern const GCodeDialect GCodeDialectLinuxCNC;
+extern const GCodeDialect GCodeDialectFanuc;
+
+#endif
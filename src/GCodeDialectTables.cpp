@@ -0,0 +1,1081 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Generated by extras/tools/GenerateDialectTables.py. Do not edit by hand.
+
+#include "GCodeDialect.h"
+
+// Marlin: 257 commands in 512 slots.
+static const unsigned int MarlinDisplacements[128] GCODE_PROGMEM = {
+	0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	2, 0, 0, 0, 1, 0, 2, 0, 0, 0, 2, 0,
+	2, 6, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1,
+	0, 0, 4, 0, 0, 0, 0, 0, 0, 4, 0, 0,
+	0, 4, 5, 0, 0, 1, 0, 0, 3, 0, 0, 1,
+	0, 1, 1, 1, 1, 2, 1, 0, 0, 0, 0, 2,
+	4, 2, 3, 6, 1, 0, 0, 2, 0, 0, 1, 0,
+	1, 1, 0, 0, 0, 2, 0, 2, 4, 1, 0, 4,
+	2, 1, 3, 0, 2, 0, 0, 4, 0, 2, 6, 0,
+	3, 0, 0, 4, 5, 0, 2, 0, 0, 0, 12, 3,
+	0, 9, 3, 0, 0, 0, 0, 0,
+};
+
+static const GCodeCommand MarlinCommands[512] GCODE_PROGMEM = {
+	{ 0x0000, 0, 0, 0x3F40037UL }, // G0
+	{ 0x97C0, 0, 0, 0x3FFFFFFUL }, // M380
+	{ 0x8300, 0, 0, 0x3FFFFFFUL }, // M48
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB540, 0, 0, 0x3FFFFFFUL }, // M852
+	{ 0x8150, 0, 0, 0x3FFFFFFUL }, // M21
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8960, 0, 0, 0x3FFFFFFUL }, // M150
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x88D0, 0, 0, 0x3FFFFFFUL }, // M141
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8D00, 0, 0, 0x3FFFFFFUL }, // M208
+	{ 0x87B0, 0, 0, 0x3FFFFFFUL }, // M123
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8720, 0, 0, 0x3FFFFFFUL }, // M114
+	{ 0x9AC0, 0, 0, 0x3FFFFFFUL }, // M428
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8570, 0, 0, 0x3FFFFFFUL }, // M87
+	{ 0x9E60, 0, 0, 0x3FFFFFFUL }, // M486
+	{ 0x9910, 0, 0, 0x3FFFFFFUL }, // M401
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8760, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M118
+	{ 0x8210, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M33
+	{ 0xBE10, 0, 0, 0x3FFFFFFUL }, // M993
+	{ 0x8180, 0, 0, 0x3FFFFFFUL }, // M24
+	{ 0x0220, 0, 0, 0x3FFFFFFUL }, // G34
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x92E0, 0, 0, 0x3FFFFFFUL }, // M302
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0500, 0, 0, 0x0000000UL }, // G80
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0350, 0, 0, 0x0000000UL }, // G53
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xBE70, 0, 0, 0x3FFFFFFUL }, // M999
+	{ 0xB6C0, 0, 0, 0x3FFFFFFUL }, // M876
+	{ 0x0110, 0, 0, 0x0000000UL }, // G17
+	{ 0x8DD0, 0, 0, 0x3FFFFFFUL }, // M221
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9690, 0, 0, 0x3FFFFFFUL }, // M361
+	{ 0x00A0, 0, 0, 0x0040000UL }, // G10
+	{ 0xB530, 0, 0, 0x3FFFFFFUL }, // M851
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8950, 0, 0, 0x3FFFFFFUL }, // M149
+	{ 0x03B0, 0, 0, 0x0000000UL }, // G59
+	{ 0x88C0, 0, 0, 0x0060100UL }, // M140
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x87A0, 0, 0, 0x3FFFFFFUL }, // M122
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8680, 0, 0, 0x00C012AUL }, // M104
+	{ 0x04C0, 0, 0, 0x3FFFFFFUL }, // G76
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03A0, 0, 0, 0x0000000UL }, // G58
+	{ 0x9900, 0, 0, 0x3FFFFFFUL }, // M400
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8A40, 0, 0, 0x3FFFFFFUL }, // M164
+	{ 0xA1C0, 0, 0, 0x3FFFFFFUL }, // M540
+	{ 0x8200, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M32
+	{ 0x0040, 0, 0, 0x0048000UL }, // G4
+	{ 0x8170, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M23
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8BE0, 0, 0, 0x0060100UL }, // M190
+	{ 0xB900, 0, 0, 0x3FFFFFFUL }, // M912
+	{ 0x8510, 0, 0, 0x3FFFFFFUL }, // M81
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8190, 0, 0, 0x3FFFFFFUL }, // M25
+	{ 0x92D0, 0, 0, 0x3FFFFFFUL }, // M301
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB8F0, 0, 0, 0x3FFFFFFUL }, // M911
+	{ 0x8A50, 0, 0, 0x3FFFFFFUL }, // M165
+	{ 0x9000, 0, 0, 0x3FFFFFFUL }, // M256
+	{ 0x86D0, 0, 0, 0x00C012AUL }, // M109
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB620, 0, 0, 0x3FFFFFFUL }, // M866
+	{ 0x8DC0, 0, 0, 0x3FFFFFFUL }, // M220
+	{ 0x8D30, 0, 0, 0x3FFFFFFUL }, // M211
+	{ 0xAC60, 0, 0, 0x3FFFFFFUL }, // M710
+	{ 0x8F00, 0, 0, 0x3FFFFFFUL }, // M240
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8C10, 0, 0, 0x3FFFFFFUL }, // M193
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0380, 0, 0, 0x0000000UL }, // G56
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8A60, 0, 0, 0x3FFFFFFUL }, // M166
+	{ 0x0264, 0, 0, 0x3F00027UL }, // G38.3
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x80A0, 0, 0, 0x0000000UL }, // M10
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x1A90, 0, 0, 0x3FFFFFFUL }, // G425
+	{ 0x8790, 0, 0, 0x3FFFFFFUL }, // M121
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8700, 0, 0, 0x3FFFFFFUL }, // M112
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8D90, 0, 0, 0x3FFFFFFUL }, // M217
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8550, 0, 0, 0x3FFFFFFUL }, // M85
+	{ 0x9050, 0, 0, 0x3FFFFFFUL }, // M261
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8690, 0, 0, 0x3FFFFFFUL }, // M105
+	{ 0x97D0, 0, 0, 0x3FFFFFFUL }, // M381
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x99A0, 0, 0, 0x3FFFFFFUL }, // M410
+	{ 0x03B3, 0, 0, 0x0000000UL }, // G59.2
+	{ 0xB840, 0, 0, 0x3FFFFFFUL }, // M900
+	{ 0x81F0, 0, 0, 0x3FFFFFFUL }, // M31
+	{ 0x8CF0, 0, 0, 0x3FFFFFFUL }, // M207
+	{ 0x8160, 0, 0, 0x3FFFFFFUL }, // M22
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8040, 0, 0, 0x0044100UL }, // M4
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0050, 0, 0, 0x1858330UL }, // G5
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x92C0, 0, 0, 0x3FFFFFFUL }, // M300
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xBA00, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M928
+	{ 0x91A0, 0, 0, 0x3FFFFFFUL }, // M282
+	{ 0xB970, 0, 0, 0x3FFFFFFUL }, // M919
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB8E0, 0, 0, 0x3FFFFFFUL }, // M910
+	{ 0x8FF0, 0, 0, 0x3FFFFFFUL }, // M255
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x02A0, 0, 0, 0x3FFFFFFUL }, // G42
+	{ 0x0210, 0, 0, 0x3FFFFFFUL }, // G33
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x99D0, 0, 0, 0x3FFFFFFUL }, // M413
+	{ 0xB610, 0, 0, 0x3FFFFFFUL }, // M865
+	{ 0x8770, 0, 0, 0x3FFFFFFUL }, // M119
+	{ 0x0060, 0, 0, 0x3860110UL }, // G6
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01A0, 0, 0, 0x3FFFFFFUL }, // G26
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0370, 0, 0, 0x0000000UL }, // G55
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x95E0, 0, 0, 0x3FFFFFFUL }, // M350
+	{ 0x8CB0, 0, 0, 0x3FFFFFFUL }, // M203
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8810, 0, 0, 0x3FFFFFFUL }, // M129
+	{ 0x9310, 0, 0, 0x3FFFFFFUL }, // M305
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x86F0, 0, 0, 0x3FFFFFFUL }, // M111
+	{ 0x03B4, 0, 0, 0x0000000UL }, // G59.3
+	{ 0x9F50, 0, 0, 0x3FFFFFFUL }, // M501
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB930, 0, 0, 0x3FFFFFFUL }, // M915
+	{ 0x8540, 0, 0, 0x3FFFFFFUL }, // M84
+	{ 0x84B0, 0, 0, 0x3FFFFFFUL }, // M75
+	{ 0x8710, 0, 0, 0x3FFFFFFUL }, // M113
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01D0, 0, 0, 0x3FFFFFFUL }, // G29
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x96A0, 0, 0, 0x3FFFFFFUL }, // M362
+	{ 0xB5D0, 0, 0, 0x3FFFFFFUL }, // M861
+	{ 0x81E0, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M30
+	{ 0x8CE0, 0, 0, 0x3FFFFFFUL }, // M206
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8030, 0, 0, 0x0044100UL }, // M3
+	{ 0x9F60, 0, 0, 0x3FFFFFFUL }, // M502
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9220, 0, 0, 0x3FFFFFFUL }, // M290
+	{ 0x82B0, 0, 0, 0x3FFFFFFUL }, // M43
+	{ 0x9190, 0, 0, 0x3FFFFFFUL }, // M281
+	{ 0xB960, 0, 0, 0x3FFFFFFUL }, // M918
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB8D0, 0, 0, 0x3FFFFFFUL }, // M909
+	{ 0x9F40, 0, 0, 0x3FFFFFFUL }, // M500
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x86B0, 0, 0, 0x0008000UL }, // M107
+	{ 0x0200, 0, 0, 0x3FFFFFFUL }, // G32
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03D0, 0, 0, 0x3FFFFFFUL }, // G61
+	{ 0x8500, 0, 0, 0x3FFFFFFUL }, // M80
+	{ 0xB600, 0, 0, 0x3FFFFFFUL }, // M864
+	{ 0x8D10, 0, 0, 0x3FFFFFFUL }, // M209
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8C80, 0, 0, 0x3FFFFFFUL }, // M200
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xBB70, 0, 0, 0x3FFFFFFUL }, // M951
+	{ 0x9950, 0, 0, 0x3FFFFFFUL }, // M405
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x81A0, 0, 0, 0x3FFFFFFUL }, // M26
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x89B0, 0, 0, 0x3FFFFFFUL }, // M155
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xBE50, 0, 0, 0x3FFFFFFUL }, // M997
+	{ 0x8800, 0, 0, 0x3FFFFFFUL }, // M128
+	{ 0x8CC0, 0, 0, 0x3FFFFFFUL }, // M204
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x86E0, 0, 0, 0x3FFFFFFUL }, // M110
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x85C0, 0, 0, 0x3FFFFFFUL }, // M92
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8530, 0, 0, 0x3FFFFFFUL }, // M83
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xABE0, 0, 0, 0x3FFFFFFUL }, // M702
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB650, 0, 0, 0x3FFFFFFUL }, // M869
+	{ 0x84C0, 0, 0, 0x3FFFFFFUL }, // M76
+	{ 0x81D0, 0, 0, 0x3FFFFFFUL }, // M29
+	{ 0x8CD0, 0, 0, 0x3FFFFFFUL }, // M205
+	{ 0x8140, 0, 0, 0x3FFFFFFUL }, // M20
+	{ 0x80B0, 0, 0, 0x0000000UL }, // M11
+	{ 0x0150, 0, 0, 0x0000000UL }, // G21
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x00C0, 0, 0, 0x38E8000UL }, // G12
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA5B0, 0, 0, 0x3FFFFFFUL }, // M603
+	{ 0xB950, 0, 0, 0x3FFFFFFUL }, // M917
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB8C0, 0, 0, 0x3FFFFFFUL }, // M908
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA5D0, 0, 0, 0x3FFFFFFUL }, // M605
+	{ 0x01F0, 0, 0, 0x3FFFFFFUL }, // G31
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8E20, 0, 0, 0x3FFFFFFUL }, // M226
+	{ 0x9920, 0, 0, 0x3FFFFFFUL }, // M402
+	{ 0xB5F0, 0, 0, 0x3FFFFFFUL }, // M863
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9F80, 0, 0, 0x3FFFFFFUL }, // M504
+	{ 0x8220, 0, 0, 0x3FFFFFFUL }, // M34
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8A30, 0, 0, 0x3FFFFFFUL }, // M163
+	{ 0x89A0, 0, 0, 0x3FFFFFFUL }, // M154
+	{ 0x8070, 0, 0, 0x0000000UL }, // M7
+	{ 0xB630, 0, 0, 0x3FFFFFFUL }, // M867
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9A70, 0, 0, 0x3FFFFFFUL }, // M423
+	{ 0x8640, 0, 0, 0x3FFFFFFUL }, // M100
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8520, 0, 0, 0x3FFFFFFUL }, // M82
+	{ 0x8490, 0, 0, 0x3FFFFFFUL }, // M73
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9A90, 0, 0, 0x3FFFFFFUL }, // M425
+	{ 0xABD0, 0, 0, 0x3FFFFFFUL }, // M701
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9970, 0, 0, 0x3FFFFFFUL }, // M407
+	{ 0x0120, 0, 0, 0x0000000UL }, // G18
+	{ 0x9680, 0, 0, 0x3FFFFFFUL }, // M360
+	{ 0x81C0, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M28
+	{ 0x0263, 0, 0, 0x3F00027UL }, // G38.2
+	{ 0xA990, 0, 0, 0x3FFFFFFUL }, // M665
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8560, 0, 0, 0x3FFFFFFUL }, // M86
+	{ 0x8010, 0, 0, 0x0048000UL }, // M1
+	{ 0x84D0, 0, 0, 0x3FFFFFFUL }, // M77
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9320, 0, 0, 0x3FFFFFFUL }, // M306
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA510, 0, 0, 0x3FFFFFFUL }, // M593
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB8B0, 0, 0, 0x3FFFFFFUL }, // M907
+	{ 0xA3F0, 0, 0, 0x3FFFFFFUL }, // M575
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8050, 0, 0, 0x0000000UL }, // M5
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01E0, 0, 0, 0x3FFFFFFUL }, // G30
+	{ 0xB670, 0, 0, 0x3FFFFFFUL }, // M871
+	{ 0x0230, 0, 0, 0x3FFFFFFUL }, // G35
+	{ 0x84E0, 0, 0, 0x3FFFFFFUL }, // M78
+	{ 0x0030, 0, 0, 0x3F68337UL }, // G3
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA000, 0, 0, 0x3FFFFFFUL }, // M512
+	{ 0x9F70, 0, 0, 0x3FFFFFFUL }, // M503
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB280, 0, 0, 0x3FFFFFFUL }, // M808
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8BF0, 0, 0, 0x3FFFFFFUL }, // M191
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xAA00, 0, 0, 0x3FFFFFFUL }, // M672
+	{ 0x87E0, 0, 0, 0x3FFFFFFUL }, // M126
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x86C0, 0, 0, 0x3FFFFFFUL }, // M108
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9A60, 0, 0, 0x3FFFFFFUL }, // M422
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9940, 0, 0, 0x3FFFFFFUL }, // M404
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA580, 0, 0, 0x3FFFFFFUL }, // M600
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9960, 0, 0, 0x3FFFFFFUL }, // M406
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x81B0, 0, 0, 0x3FFFFFFUL }, // M27
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB940, 0, 0, 0x3FFFFFFUL }, // M916
+	{ 0x8090, 0, 0, 0x0000000UL }, // M9
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05C0, 0, 0, 0x3F00017UL }, // G92
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03B2, 0, 0, 0x0000000UL }, // G59.1
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA500, 0, 0, 0x3FFFFFFUL }, // M592
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9040, 0, 0, 0x3FFFFFFUL }, // M260
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0266, 0, 0, 0x3F00027UL }, // G38.5
+	{ 0x9180, 0, 0, 0x3FFFFFFUL }, // M280
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0140, 0, 0, 0x0000000UL }, // G20
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x00B0, 0, 0, 0x0040000UL }, // G11
+	{ 0x0020, 0, 0, 0x3F68337UL }, // G2
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9FF0, 0, 0, 0x3FFFFFFUL }, // M511
+	{ 0x96C0, 0, 0, 0x3FFFFFFUL }, // M364
+	{ 0x9630, 0, 0, 0x3FFFFFFUL }, // M355
+	{ 0x9ED0, 0, 0, 0x3FFFFFFUL }, // M493
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x88F0, 0, 0, 0x3FFFFFFUL }, // M143
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x87D0, 0, 0, 0x3FFFFFFUL }, // M125
+	{ 0xA0C0, 0, 0, 0x3FFFFFFUL }, // M524
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9AE0, 0, 0, 0x3FFFFFFUL }, // M430
+	{ 0x8910, 0, 0, 0x3FFFFFFUL }, // M145
+	{ 0x9A50, 0, 0, 0x3FFFFFFUL }, // M421
+	{ 0x99C0, 0, 0, 0x3FFFFFFUL }, // M412
+	{ 0x87F0, 0, 0, 0x3FFFFFFUL }, // M127
+	{ 0x9930, 0, 0, 0x3FFFFFFUL }, // M403
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB910, 0, 0, 0x3FFFFFFUL }, // M913
+	{ 0x8780, 0, 0, 0x3FFFFFFUL }, // M120
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xBE30, 0, 0, 0x3FFFFFFUL }, // M995
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8110, 0, 0, 0x3FFFFFFUL }, // M17
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8080, 0, 0, 0x0000000UL }, // M8
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x95F0, 0, 0, 0x3FFFFFFUL }, // M351
+	{ 0x0265, 0, 0, 0x3F00027UL }, // G38.4
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05B0, 0, 0, 0x0000000UL }, // G91
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xB920, 0, 0, 0x3FFFFFFUL }, // M914
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8FA0, 0, 0, 0x3FFFFFFUL }, // M250
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01C0, 0, 0, 0x3F24807UL }, // G28
+	{ 0x0130, 0, 0, 0x0000000UL }, // G19
+	{ 0x0390, 0, 0, 0x0000000UL }, // G57
+	{ 0xB5C0, 0, 0, 0x3FFFFFFUL }, // M860
+	{ 0x0010, 0, 0, 0x3F40037UL }, // G1
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9FE0, 0, 0, 0x3FFFFFFUL }, // M510
+	{ 0x96B0, 0, 0, 0x3FFFFFFUL }, // M363
+	{ 0xB5E0, 0, 0, 0x3FFFFFFUL }, // M862
+	{ 0x8C00, 0, 0, 0x3FFFFFFUL }, // M192
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x82A0, 0, 0, 0x3FFFFFFUL }, // M42
+	{ 0x8DA0, 0, 0, 0x3FFFFFFUL }, // M218
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8730, 0, 0, 0x3FFFFFFUL }, // M115
+	{ 0x86A0, 0, 0, 0x00C8100UL }, // M106
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9A40, 0, 0, 0x3FFFFFFUL }, // M420
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03C0, 0, 0, 0x3FFFFFFUL }, // G60
+	{ 0x8750, 0, GCODE_COMMAND_TEXT, 0x0000000UL }, // M117
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA390, 0, 0, 0x3FFFFFFUL }, // M569
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x9300, 0, 0, 0x3FFFFFFUL }, // M304
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xBE20, 0, 0, 0x3FFFFFFUL }, // M994
+	{ 0x8C90, 0, 0, 0x3FFFFFFUL }, // M201
+	{ 0x8100, 0, 0, 0x3FFFFFFUL }, // M16
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x92F0, 0, 0, 0x3FFFFFFUL }, // M303
+	{ 0x8120, 0, 0, 0x3FFFFFFUL }, // M18
+	{ 0x05A0, 0, 0, 0x0000000UL }, // G90
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8000, 0, 0, 0x0048000UL }, // M0
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xA9A0, 0, 0, 0x3FFFFFFUL }, // M666
+	{ 0x0360, 0, 0, 0x0000000UL }, // G54
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8660, 0, 0, 0x3FFFFFFUL }, // M102
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01B0, 0, 0, 0x3FFFFFFUL }, // G27
+	{ 0xB640, 0, 0, 0x3FFFFFFUL }, // M868
+	{ 0xB8A0, 0, 0, 0x3FFFFFFUL }, // M906
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+};
+
+const GCodeDialect GCodeDialectMarlin = {
+	"Marlin",
+	0x3FFFFFFUL, // ABCDEFGHIJKLMNOPQRSTUVWXYZ
+	0x0002000UL, // N
+	GCODE_DIALECT_BARE_WORDS,
+	9,
+	7,
+	MarlinCommands,
+	MarlinDisplacements
+};
+
+// Grbl: 49 commands in 64 slots.
+static const unsigned int GrblDisplacements[16] GCODE_PROGMEM = {
+	3, 17, 11, 8, 0, 13, 13, 0, 0, 1, 1, 0,
+	21, 11, 1, 22,
+};
+
+static const GCodeCommand GrblCommands[64] GCODE_PROGMEM = {
+	{ 0x0263, 1, 0, 0x3F00007UL }, // G38.2
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0264, 1, 0, 0x3F00007UL }, // G38.3
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05B2, 4, 0, 0x0000000UL }, // G91.1
+	{ 0x0110, 2, 0, 0x0000000UL }, // G17
+	{ 0x8380, 0, 0, 0x0008000UL }, // M56
+	{ 0x8020, 20, 0, 0x0000000UL }, // M2
+	{ 0x01C2, 0, 0, 0x0000000UL }, // G28.1
+	{ 0x01E0, 0, 0, 0x3F00007UL }, // G30
+	{ 0x8050, 23, 0, 0x0000000UL }, // M5
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01E2, 0, 0, 0x0000000UL }, // G30.1
+	{ 0x03B0, 12, 0, 0x0000000UL }, // G59
+	{ 0x0265, 1, 0, 0x3F00007UL }, // G38.4
+	{ 0x8030, 23, 0, 0x0000000UL }, // M3
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8040, 23, 0, 0x0000000UL }, // M4
+	{ 0x0310, 8, 0, 0x0000000UL }, // G49
+	{ 0x8000, 20, 0, 0x0000000UL }, // M0
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0390, 12, 0, 0x0000000UL }, // G57
+	{ 0x0030, 1, 0, 0x3F28707UL }, // G3
+	{ 0x0266, 1, 0, 0x3F00007UL }, // G38.5
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05B0, 3, 0, 0x0000000UL }, // G91
+	{ 0x05C2, 0, 0, 0x0000000UL }, // G92.1
+	{ 0x05E0, 5, 0, 0x0000000UL }, // G94
+	{ 0x0280, 7, 0, 0x0000000UL }, // G40
+	{ 0x03A0, 12, 0, 0x0000000UL }, // G58
+	{ 0x0040, 0, 0, 0x0008000UL }, // G4
+	{ 0x0360, 12, 0, 0x0000000UL }, // G54
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05C0, 0, 0, 0x3F00007UL }, // G92
+	{ 0x0120, 2, 0, 0x0000000UL }, // G18
+	{ 0x8010, 20, 0, 0x0000000UL }, // M1
+	{ 0x8080, 0, 0, 0x0000000UL }, // M8
+	{ 0x05D0, 5, 0, 0x0000000UL }, // G93
+	{ 0x8090, 0, 0, 0x0000000UL }, // M9
+	{ 0x0500, 1, 0, 0x0000000UL }, // G80
+	{ 0x0350, 0, 0, 0x0000000UL }, // G53
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0130, 2, 0, 0x0000000UL }, // G19
+	{ 0x0380, 12, 0, 0x0000000UL }, // G56
+	{ 0x0020, 1, 0, 0x3F28707UL }, // G2
+	{ 0x02B2, 8, 0, 0x2000000UL }, // G43.1
+	{ 0x0140, 6, 0, 0x0000000UL }, // G20
+	{ 0x03D0, 13, 0, 0x0000000UL }, // G61
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0000, 1, 0, 0x3F00007UL }, // G0
+	{ 0x0150, 6, 0, 0x0000000UL }, // G21
+	{ 0x00A0, 0, 0, 0x3828800UL }, // G10
+	{ 0x0370, 12, 0, 0x0000000UL }, // G55
+	{ 0x01C0, 0, 0, 0x3F00007UL }, // G28
+	{ 0x0010, 1, 0, 0x3F00007UL }, // G1
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8070, 0, 0, 0x0000000UL }, // M7
+	{ 0x05A0, 3, 0, 0x0000000UL }, // G90
+	{ 0x81E0, 20, 0, 0x0000000UL }, // M30
+};
+
+const GCodeDialect GCodeDialectGrbl = {
+	"Grbl",
+	0x38EBFE0UL, // FGHIJKLMNPRSTXYZ
+	0x00C2020UL, // NFST
+	0,
+	6,
+	4,
+	GrblCommands,
+	GrblDisplacements
+};
+
+// LinuxCNC: 212 commands in 256 slots.
+static const unsigned int LinuxCNCDisplacements[64] GCODE_PROGMEM = {
+	0, 1, 1, 9, 16, 5, 0, 0, 0, 1, 6, 12,
+	1, 0, 1, 3, 0, 1, 7, 4, 8, 22, 3, 0,
+	1, 0, 0, 23, 72, 1, 0, 0, 21, 14, 1, 0,
+	2, 1, 0, 3, 0, 3, 0, 1, 7, 3, 30, 19,
+	2, 20, 5, 4, 2, 1, 10, 5, 13, 0, 6, 2,
+	28, 3, 73, 79,
+};
+
+static const GCodeCommand LinuxCNCCommands[256] GCODE_PROGMEM = {
+	{ 0x0000, 1, 0, 0x3F00007UL }, // G0
+	{ 0x87C0, 0, 0, 0x0018000UL }, // M124
+	{ 0x8B10, 0, 0, 0x0018000UL }, // M177
+	{ 0x0280, 7, 0, 0x0000000UL }, // G40
+	{ 0x8960, 0, 0, 0x0018000UL }, // M150
+	{ 0x8410, 0, 0, 0x0008000UL }, // M65
+	{ 0x8080, 0, 0, 0x0000000UL }, // M8
+	{ 0x87B0, 0, 0, 0x0018000UL }, // M123
+	{ 0x8350, 0, 0, 0x0008000UL }, // M53
+	{ 0x88F0, 0, 0, 0x0018000UL }, // M143
+	{ 0x03B0, 12, 0, 0x0000000UL }, // G59
+	{ 0x8740, 0, 0, 0x0018000UL }, // M116
+	{ 0x83C0, 20, 0, 0x0000000UL }, // M60
+	{ 0x8B80, 0, 0, 0x0018000UL }, // M184
+	{ 0x0340, 0, 0, 0x3F00007UL }, // G52
+	{ 0x02B3, 8, 0, 0x0000080UL }, // G43.2
+	{ 0x88B0, 0, 0, 0x0018000UL }, // M139
+	{ 0x8060, 0, 0, 0x0000000UL }, // M6
+	{ 0x05C2, 0, 0, 0x0000000UL }, // G92.1
+	{ 0x8A40, 0, 0, 0x0018000UL }, // M164
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0500, 1, 0, 0x0000000UL }, // G80
+	{ 0x0510, 1, 0, 0x3F38F07UL }, // G81
+	{ 0x0266, 1, 0, 0x3F00007UL }, // G38.5
+	{ 0x8AB0, 0, 0, 0x0018000UL }, // M171
+	{ 0x8650, 0, 0, 0x0018000UL }, // M101
+	{ 0x8900, 0, 0, 0x0018000UL }, // M144
+	{ 0x8C40, 0, 0, 0x0018000UL }, // M196
+	{ 0x81E0, 20, 0, 0x0000000UL }, // M30
+	{ 0x01C2, 0, 0, 0x0000000UL }, // G28.1
+	{ 0x05F0, 5, 0, 0x0000000UL }, // G95
+	{ 0x8720, 0, 0, 0x0018000UL }, // M114
+	{ 0x89E0, 0, 0, 0x0018000UL }, // M158
+	{ 0x03B4, 12, 0, 0x0000000UL }, // G59.3
+	{ 0x88D0, 0, 0, 0x0018000UL }, // M141
+	{ 0x8830, 0, 0, 0x0018000UL }, // M131
+	{ 0x0550, 1, 0, 0x3F38F07UL }, // G85
+	{ 0x8050, 23, 0, 0x0000000UL }, // M5
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03A0, 12, 0, 0x0000000UL }, // G58
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8AD0, 0, 0, 0x0018000UL }, // M173
+	{ 0x8320, 0, 0, 0x0008000UL }, // M50
+	{ 0x8C10, 0, 0, 0x0018000UL }, // M193
+	{ 0x02A2, 7, 0, 0x0000808UL }, // G42.1
+	{ 0x8C70, 0, 0, 0x0018000UL }, // M199
+	{ 0x8A60, 0, 0, 0x0018000UL }, // M166
+	{ 0x8AC0, 0, 0, 0x0018000UL }, // M172
+	{ 0x0610, 14, 0, 0x0000000UL }, // G97
+	{ 0x8B70, 0, 0, 0x0018000UL }, // M183
+	{ 0x8880, 0, 0, 0x0018000UL }, // M136
+	{ 0x8A50, 0, 0, 0x0018000UL }, // M165
+	{ 0x86D0, 0, 0, 0x0018000UL }, // M109
+	{ 0x88A0, 0, 0, 0x0018000UL }, // M138
+	{ 0x00A0, 0, 0, 0x3F38F07UL }, // G10
+	{ 0x05C4, 0, 0, 0x0000000UL }, // G92.3
+	{ 0x8400, 0, 0, 0x0008000UL }, // M64
+	{ 0x8660, 0, 0, 0x0018000UL }, // M102
+	{ 0x0132, 2, 0, 0x0000000UL }, // G19.1
+	{ 0x8AF0, 0, 0, 0x0018000UL }, // M175
+	{ 0x0265, 1, 0, 0x3F00007UL }, // G38.4
+	{ 0x8940, 0, 0, 0x0018000UL }, // M148
+	{ 0x0150, 6, 0, 0x0000000UL }, // G21
+	{ 0x8820, 0, 0, 0x0018000UL }, // M130
+	{ 0x8C50, 0, 0, 0x0018000UL }, // M197
+	{ 0x8670, 0, 0, 0x0018000UL }, // M103
+	{ 0x8B20, 0, 0, 0x0018000UL }, // M178
+	{ 0x8AA0, 0, 0, 0x0018000UL }, // M170
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8690, 0, 0, 0x0018000UL }, // M105
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03B3, 12, 0, 0x0000000UL }, // G59.2
+	{ 0x0292, 7, 0, 0x0000808UL }, // G41.1
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8BD0, 0, 0, 0x0018000UL }, // M189
+	{ 0x0053, 1, 0, 0x1808800UL }, // G5.2
+	{ 0x0380, 12, 0, 0x0000000UL }, // G56
+	{ 0x88E0, 0, 0, 0x0018000UL }, // M142
+	{ 0x8B60, 0, 0, 0x0018000UL }, // M182
+	{ 0x8490, 0, 0, 0x0000000UL }, // M73
+	{ 0x8750, 0, 0, 0x0018000UL }, // M117
+	{ 0x0590, 1, 0, 0x3F38F07UL }, // G89
+	{ 0x0210, 1, 0, 0x3F00407UL }, // G33
+	{ 0x8420, 0, 0, 0x0018810UL }, // M66
+	{ 0x8480, 0, 0, 0x0000000UL }, // M72
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8A90, 0, 0, 0x0018000UL }, // M169
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x87E0, 0, 0, 0x0018000UL }, // M126
+	{ 0x89C0, 0, 0, 0x0018000UL }, // M156
+	{ 0x8090, 0, 0, 0x0000000UL }, // M9
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8810, 0, 0, 0x0018000UL }, // M129
+	{ 0x05C0, 0, 0, 0x3F00007UL }, // G92
+	{ 0x04A0, 1, 0, 0x3F38F07UL }, // G74
+	{ 0x86F0, 0, 0, 0x0018000UL }, // M111
+	{ 0x8C60, 0, 0, 0x0018000UL }, // M198
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05B2, 4, 0, 0x0000000UL }, // G91.1
+	{ 0x8300, 0, 0, 0x0000000UL }, // M48
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8BC0, 0, 0, 0x0018000UL }, // M188
+	{ 0x8030, 23, 0, 0x0000000UL }, // M3
+	{ 0x8460, 0, 0, 0x0000000UL }, // M70
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8980, 0, 0, 0x0018000UL }, // M152
+	{ 0x8730, 0, 0, 0x0018000UL }, // M115
+	{ 0x87D0, 0, 0, 0x0018000UL }, // M125
+	{ 0x0580, 1, 0, 0x3F38F07UL }, // G88
+	{ 0x0110, 2, 0, 0x0000000UL }, // G17
+	{ 0x03D0, 13, 0, 0x0000000UL }, // G61
+	{ 0x05A0, 3, 0, 0x0000000UL }, // G90
+	{ 0x8C20, 0, 0, 0x0018000UL }, // M194
+	{ 0x83E0, 0, 0, 0x0008000UL }, // M62
+	{ 0x8A70, 0, 0, 0x0018000UL }, // M167
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x89B0, 0, 0, 0x0018000UL }, // M155
+	{ 0x8890, 0, 0, 0x0018000UL }, // M137
+	{ 0x8800, 0, 0, 0x0018000UL }, // M128
+	{ 0x05B0, 3, 0, 0x0000000UL }, // G91
+	{ 0x86E0, 0, 0, 0x0018000UL }, // M110
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0400, 13, 0, 0x0018000UL }, // G64
+	{ 0x8970, 0, 0, 0x0018000UL }, // M151
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0054, 1, 0, 0x0000000UL }, // G5.3
+	{ 0x0130, 2, 0, 0x0000000UL }, // G19
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01E2, 0, 0, 0x0000000UL }, // G30.1
+	{ 0x8020, 20, 0, 0x0000000UL }, // M2
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0020, 1, 0, 0x3F28707UL }, // G2
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x04C0, 1, 0, 0x2038F90UL }, // G76
+	{ 0x8470, 0, 0, 0x0000000UL }, // M71
+	{ 0x0310, 8, 0, 0x0000000UL }, // G49
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8BA0, 0, 0, 0x0018000UL }, // M186
+	{ 0x0040, 0, 0, 0x0008000UL }, // G4
+	{ 0x0212, 1, 0, 0x3800400UL }, // G33.1
+	{ 0x8BE0, 0, 0, 0x0018000UL }, // M190
+	{ 0x8C30, 0, 0, 0x0018000UL }, // M195
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8A30, 0, 0, 0x0018000UL }, // M163
+	{ 0x8910, 0, 0, 0x0018000UL }, // M145
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x87F0, 0, 0, 0x0018000UL }, // M127
+	{ 0x05A2, 4, 0, 0x0000000UL }, // G90.1
+	{ 0x8640, 0, 0, 0x0018000UL }, // M100
+	{ 0x8430, 0, 0, 0x0010010UL }, // M67
+	{ 0x8B50, 0, 0, 0x0018000UL }, // M181
+	{ 0x0530, 1, 0, 0x3F38F07UL }, // G83
+	{ 0x89A0, 0, 0, 0x0018000UL }, // M154
+	{ 0x0122, 2, 0, 0x0000000UL }, // G18.1
+	{ 0x05E0, 5, 0, 0x0000000UL }, // G94
+	{ 0x0263, 1, 0, 0x3F00007UL }, // G38.2
+	{ 0x0050, 1, 0, 0x1818300UL }, // G5
+	{ 0x8010, 20, 0, 0x0000000UL }, // M1
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05D0, 5, 0, 0x0000000UL }, // G93
+	{ 0x8330, 0, 0, 0x0008000UL }, // M51
+	{ 0x8C00, 0, 0, 0x0018000UL }, // M192
+	{ 0x0390, 12, 0, 0x0000000UL }, // G57
+	{ 0x0560, 1, 0, 0x3F38F07UL }, // G86
+	{ 0x8B40, 0, 0, 0x0018000UL }, // M180
+	{ 0x01E0, 0, 0, 0x3F00007UL }, // G30
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0030, 1, 0, 0x3F28707UL }, // G3
+	{ 0x8AE0, 0, 0, 0x0018000UL }, // M174
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0052, 1, 0, 0x1800300UL }, // G5.1
+	{ 0x8930, 0, 0, 0x0018000UL }, // M147
+	{ 0x8BF0, 0, 0, 0x0018000UL }, // M191
+	{ 0x0112, 2, 0, 0x0000000UL }, // G17.1
+	{ 0x03B2, 12, 0, 0x0000000UL }, // G59.1
+	{ 0x0620, 10, 0, 0x0000000UL }, // G98
+	{ 0x8920, 0, 0, 0x0018000UL }, // M146
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8770, 0, 0, 0x0018000UL }, // M119
+	{ 0x0520, 1, 0, 0x3F38F07UL }, // G82
+	{ 0x83F0, 0, 0, 0x0008000UL }, // M63
+	{ 0x8440, 0, 0, 0x0010010UL }, // M68
+	{ 0x0370, 12, 0, 0x0000000UL }, // G55
+	{ 0x0540, 1, 0, 0x3F38F07UL }, // G84
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8000, 20, 0, 0x0000000UL }, // M0
+	{ 0x8B00, 0, 0, 0x0018000UL }, // M176
+	{ 0x05C3, 0, 0, 0x0000000UL }, // G92.2
+	{ 0x8950, 0, 0, 0x0018000UL }, // M149
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x87A0, 0, 0, 0x0018000UL }, // M122
+	{ 0x8680, 0, 0, 0x0018000UL }, // M104
+	{ 0x8840, 0, 0, 0x0018000UL }, // M132
+	{ 0x0140, 6, 0, 0x0000000UL }, // G20
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8B30, 0, 0, 0x0018000UL }, // M179
+	{ 0x86C0, 0, 0, 0x0018000UL }, // M108
+	{ 0x8A10, 0, 0, 0x0018000UL }, // M161
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8860, 0, 0, 0x0018000UL }, // M134
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x86B0, 0, 0, 0x0018000UL }, // M107
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03D2, 13, 0, 0x0000000UL }, // G61.1
+	{ 0x8760, 0, 0, 0x0018000UL }, // M118
+	{ 0x02B2, 8, 0, 0x3F00007UL }, // G43.1
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8780, 0, 0, 0x0018000UL }, // M120
+	{ 0x0070, 15, 0, 0x0000000UL }, // G7
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0290, 7, 0, 0x0000008UL }, // G41
+	{ 0x8700, 0, 0, 0x0018000UL }, // M112
+	{ 0x0264, 1, 0, 0x3F00007UL }, // G38.3
+	{ 0x8130, 23, 0, 0x0038000UL }, // M19
+	{ 0x8A20, 0, 0, 0x0018000UL }, // M162
+	{ 0x0490, 1, 0, 0x3F38F07UL }, // G73
+	{ 0x8790, 0, 0, 0x0018000UL }, // M121
+	{ 0x8870, 0, 0, 0x0018000UL }, // M135
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01C0, 0, 0, 0x3F00007UL }, // G28
+	{ 0x8990, 0, 0, 0x0018000UL }, // M153
+	{ 0x0010, 1, 0, 0x3F00007UL }, // G1
+	{ 0x8310, 0, 0, 0x0000000UL }, // M49
+	{ 0x8BB0, 0, 0, 0x0018000UL }, // M187
+	{ 0x8A80, 0, 0, 0x0018000UL }, // M168
+	{ 0x8A00, 0, 0, 0x0018000UL }, // M160
+	{ 0x8040, 23, 0, 0x0000000UL }, // M4
+	{ 0x8850, 0, 0, 0x0018000UL }, // M133
+	{ 0x02B0, 8, 0, 0x0000080UL }, // G43
+	{ 0x0570, 1, 0, 0x3F38F07UL }, // G87
+	{ 0x86A0, 0, 0, 0x0018000UL }, // M106
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x02A0, 7, 0, 0x0000008UL }, // G42
+	{ 0x83D0, 0, 0, 0x0010000UL }, // M61
+	{ 0x8340, 0, 0, 0x0008000UL }, // M52
+	{ 0x0350, 0, 0, 0x0000000UL }, // G53
+	{ 0x0600, 14, 0, 0x0000008UL }, // G96
+	{ 0x89D0, 0, 0, 0x0018000UL }, // M157
+	{ 0x8070, 0, 0, 0x0000000UL }, // M7
+	{ 0x0080, 15, 0, 0x0000000UL }, // G8
+	{ 0x0630, 10, 0, 0x0000000UL }, // G99
+	{ 0x8B90, 0, 0, 0x0018000UL }, // M185
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x89F0, 0, 0, 0x0018000UL }, // M159
+	{ 0x88C0, 0, 0, 0x0018000UL }, // M140
+	{ 0x0360, 12, 0, 0x0000000UL }, // G54
+	{ 0x0120, 2, 0, 0x0000000UL }, // G18
+	{ 0x8710, 0, 0, 0x0018000UL }, // M113
+};
+
+const GCodeDialect GCodeDialectLinuxCNC = {
+	"LinuxCNC",
+	0x3FFBFFFUL, // ABCDEFGHIJKLMNPQRSTUVWXYZ
+	0x00C2020UL, // NFST
+	0,
+	8,
+	6,
+	LinuxCNCCommands,
+	LinuxCNCDisplacements
+};
+
+// Fanuc: 89 commands in 128 slots.
+static const unsigned int FanucDisplacements[32] GCODE_PROGMEM = {
+	2, 1, 1, 1, 1, 0, 0, 2, 0, 3, 3, 0,
+	2, 0, 3, 4, 1, 0, 0, 4, 1, 1, 4, 0,
+	3, 0, 7, 1, 6, 0, 0, 1,
+};
+
+static const GCodeCommand FanucCommands[128] GCODE_PROGMEM = {
+	{ 0x0140, 6, 0, 0x0000000UL }, // G20
+	{ 0x81E0, 20, 0, 0x0000000UL }, // M30
+	{ 0x01F0, 0, 0, 0x3F00007UL }, // G31
+	{ 0x0040, 0, 0, 0x0908000UL }, // G4
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0320, 0, 0, 0x3F28707UL }, // G50
+	{ 0x0170, 0, 0, 0x3F00707UL }, // G23
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0620, 10, 0, 0x0000000UL }, // G98
+	{ 0x0590, 1, 0, 0x3F38C07UL }, // G89
+	{ 0x03E0, 13, 0, 0x0000000UL }, // G62
+	{ 0x0490, 1, 0, 0x3F38C07UL }, // G73
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x81D0, 0, 0, 0x0000000UL }, // M29
+	{ 0x8020, 20, 0, 0x0000000UL }, // M2
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x04C0, 1, 0, 0x3F38C07UL }, // G76
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0310, 8, 0, 0x0000000UL }, // G49
+	{ 0x0160, 0, 0, 0x3F00707UL }, // G22
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8050, 23, 0, 0x0000000UL }, // M5
+	{ 0x0580, 1, 0, 0x3F38C07UL }, // G88
+	{ 0x03D0, 13, 0, 0x0000000UL }, // G61
+	{ 0x02B0, 8, 0, 0x2000080UL }, // G43
+	{ 0x0100, 0, 0, 0x0000000UL }, // G16
+	{ 0x0530, 1, 0, 0x3F38C07UL }, // G83
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0000, 1, 0, 0x3F00007UL }, // G0
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0540, 1, 0, 0x3F38C07UL }, // G84
+	{ 0x0390, 12, 0, 0x0000000UL }, // G57
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x01E0, 0, 0, 0x3F08007UL }, // G30
+	{ 0x0030, 1, 0, 0x3F20707UL }, // G3
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0570, 1, 0, 0x3F38C07UL }, // G87
+	{ 0x0450, 0, 0, 0x0000000UL }, // G69
+	{ 0x02A0, 7, 0, 0x0000008UL }, // G42
+	{ 0x0210, 1, 0, 0x3F10027UL }, // G33
+	{ 0x00F0, 0, 0, 0x0000000UL }, // G15
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x00A0, 0, 0, 0x3F38807UL }, // G10
+	{ 0x05C0, 0, 0, 0x3F00007UL }, // G92
+	{ 0x0410, 0, 0, 0x3FFFFFFUL }, // G65
+	{ 0x0550, 1, 0, 0x3F38C07UL }, // G85
+	{ 0x03A0, 12, 0, 0x0000000UL }, // G58
+	{ 0x00B0, 0, 0, 0x0000000UL }, // G11
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x05F0, 5, 0, 0x0000000UL }, // G95
+	{ 0x0440, 0, 0, 0x3F20007UL }, // G68
+	{ 0x8070, 0, 0, 0x0000000UL }, // M7
+	{ 0x0290, 7, 0, 0x0000008UL }, // G41
+	{ 0x0340, 0, 0, 0x3F00007UL }, // G52
+	{ 0x8000, 20, 0, 0x0000000UL }, // M0
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8080, 0, 0, 0x0000000UL }, // M8
+	{ 0x05B0, 3, 0, 0x0000000UL }, // G91
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0400, 13, 0, 0x0000000UL }, // G64
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0130, 2, 0, 0x0000000UL }, // G19
+	{ 0x0150, 6, 0, 0x0000000UL }, // G21
+	{ 0x05E0, 5, 0, 0x0000000UL }, // G94
+	{ 0x8040, 23, 0, 0x0000000UL }, // M4
+	{ 0x0430, 0, 0, 0x0000000UL }, // G67
+	{ 0x0280, 7, 0, 0x0000000UL }, // G40
+	{ 0x0332, 0, 0, 0x3F00007UL }, // G51.1
+	{ 0x0500, 1, 0, 0x0000000UL }, // G80
+	{ 0x0350, 0, 0, 0x3F00007UL }, // G53
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0630, 10, 0, 0x0000000UL }, // G99
+	{ 0x0510, 1, 0, 0x3F38C07UL }, // G81
+	{ 0x0360, 12, 0, 0x0000000UL }, // G54
+	{ 0x01B0, 0, 0, 0x3F08007UL }, // G27
+	{ 0x0120, 2, 0, 0x0000000UL }, // G18
+	{ 0x8130, 23, 0, 0x0000000UL }, // M19
+	{ 0x8010, 20, 0, 0x0000000UL }, // M1
+	{ 0x8030, 23, 0, 0x0000000UL }, // M3
+	{ 0x0420, 0, 0, 0x3FFFFFFUL }, // G66
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0322, 0, 0, 0x3F00007UL }, // G50.1
+	{ 0x8C60, 0, 0, 0x0008800UL }, // M198
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8060, 0, 0, 0x0000000UL }, // M6
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8630, 0, 0, 0x0008000UL }, // M99
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0560, 1, 0, 0x3F38C07UL }, // G86
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x03B0, 12, 0, 0x0000000UL }, // G59
+	{ 0x0380, 12, 0, 0x0000000UL }, // G56
+	{ 0x01D0, 0, 0, 0x3F08007UL }, // G29
+	{ 0x0020, 1, 0, 0x3F20707UL }, // G2
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8620, 0, 0, 0x0008800UL }, // M98
+	{ 0x05A0, 3, 0, 0x0000000UL }, // G90
+	{ 0x03F0, 13, 0, 0x0000000UL }, // G63
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0090, 0, 0, 0x0000000UL }, // G9
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0520, 1, 0, 0x3F38C07UL }, // G82
+	{ 0x0370, 12, 0, 0x0000000UL }, // G55
+	{ 0x01C0, 0, 0, 0x3F08007UL }, // G28
+	{ 0x0010, 1, 0, 0x3F00007UL }, // G1
+	{ 0x0610, 14, 0, 0x0000000UL }, // G97
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0600, 14, 0, 0x0000000UL }, // G96
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x0330, 0, 0, 0x3F28707UL }, // G51
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x02C0, 8, 0, 0x2000080UL }, // G44
+	{ 0x0110, 2, 0, 0x0000000UL }, // G17
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+	{ 0x8090, 0, 0, 0x0000000UL }, // M9
+	{ 0x0362, 12, 0, 0x0008000UL }, // G54.1
+	{ 0x04A0, 1, 0, 0x3F38C07UL }, // G74
+	{ 0xFFFF, 0, 0, 0x0000000UL },
+};
+
+const GCodeDialect GCodeDialectFanuc = {
+	"Fanuc",
+	0x3FFFFFFUL, // ABCDEFGHIJKLMNOPQRSTUVWXYZ
+	0x00C6020UL, // NFSTO
+	0,
+	7,
+	5,
+	FanucCommands,
+	FanucDisplacements
+};
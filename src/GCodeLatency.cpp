@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeLatency.h"
+#include <limits.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const int LATENCY_MAX_EXPONENT = 31; // Values from 2^32 up share the last bucket.
+
+/// <summary>
+/// Adds one to a counter without a lock.
+/// </summary>
+static inline void Increment(unsigned long* counter)
+{
+#if defined(__GNUC__) && !defined(__AVR__)
+	__atomic_fetch_add(counter, 1UL, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+	_InterlockedIncrement((volatile long*)counter);
+#else
+	(*counter)++;
+#endif
+}
+
+/// <summary>
+/// Reads a counter another thread may be incrementing.
+/// </summary>
+static inline unsigned long Load(const unsigned long* counter)
+{
+#if defined(__GNUC__) && !defined(__AVR__)
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#else
+	return *(const volatile unsigned long*)counter;
+#endif
+}
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+GCodeLatencyHistogram::GCodeLatencyHistogram()
+{
+	Reset();
+}
+
+/// <summary>
+/// Counts a value.
+/// </summary>
+/// <param name="value">The latency in clock units.</param>
+void GCodeLatencyHistogram::Record(unsigned long value)
+{
+	Increment(&counts[Bucket(value)]);
+}
+
+/// <summary>
+/// Clears all counts. Not safe while another thread is recording.
+/// </summary>
+void GCodeLatencyHistogram::Reset()
+{
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+		counts[i] = 0;
+}
+
+/// <summary>
+/// Gets the number of values recorded.
+/// </summary>
+unsigned long GCodeLatencyHistogram::Count() const
+{
+	unsigned long total = 0;
+
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+		total += Load(&counts[i]);
+
+	return total;
+}
+
+/// <summary>
+/// Gets a percentile.
+/// </summary>
+/// <param name="percent">The percentile wanted, i.e. 50.0, 99.0 or 99.9.</param>
+/// <returns>The highest value of the bucket holding the percentile or 0 if nothing was recorded.</returns>
+/// <remarks>
+/// The result is never below the true percentile and at most 25% above it. Values recorded
+/// while the percentile is computed may or may not be included.
+/// </remarks>
+unsigned long GCodeLatencyHistogram::Percentile(double percent) const
+{
+	unsigned long total = Count();
+
+	if (total == 0)
+		return 0;
+
+	double wanted = percent / 100.0 * total;
+	unsigned long rank = (unsigned long)wanted;
+
+	if (rank < wanted)
+		rank++;
+
+	if (rank < 1)
+		rank = 1;
+
+	if (rank > total)
+		rank = total;
+
+	unsigned long seen = 0;
+
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+	{
+		seen += Load(&counts[i]);
+
+		if (seen >= rank)
+			return BucketHighest(i);
+	}
+
+	return BucketHighest(LATENCY_BUCKET_COUNT - 1);
+}
+
+/// <summary>
+/// Gets the bucket a value is counted in.
+/// </summary>
+/// <remarks>
+/// Values below 8 have a bucket each. Above that the bucket is four times the power of two
+/// below the value plus the next two bits of the value.
+/// </remarks>
+int GCodeLatencyHistogram::Bucket(unsigned long value)
+{
+	if (value < LATENCY_SUB_BUCKETS)
+		return (int)value;
+
+	int exponent = 0;
+
+	while (exponent < LATENCY_MAX_EXPONENT && (value >> (exponent + 1)) != 0)
+		exponent++;
+
+	if ((value >> exponent) > 1)
+		return LATENCY_BUCKET_COUNT - 1;
+
+	return LATENCY_SUB_BUCKETS * (exponent - 1) + (int)((value >> (exponent - 2)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+/// <summary>
+/// Gets the lowest value counted in a bucket.
+/// </summary>
+unsigned long GCodeLatencyHistogram::BucketLowest(int bucket)
+{
+	if (bucket < LATENCY_SUB_BUCKETS)
+		return bucket;
+
+	int exponent = bucket / LATENCY_SUB_BUCKETS + 1;
+	unsigned long step = LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS;
+
+	return step << (exponent - 2);
+}
+
+/// <summary>
+/// Gets the highest value counted in a bucket.
+/// </summary>
+unsigned long GCodeLatencyHistogram::BucketHighest(int bucket)
+{
+	if (bucket >= LATENCY_BUCKET_COUNT - 1)
+		return ULONG_MAX;
+
+	return BucketLowest(bucket + 1) - 1;
+}
@@ -0,0 +1,67 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeLatency_h
+#define GCodeLatency_h
+
+const int LATENCY_SUB_BUCKETS = 4; // Buckets per power of two, the resolution is 25%.
+const int LATENCY_BUCKET_COUNT = 124; // Covers the full range of an unsigned long.
+
+/// <summary>
+/// A log scale histogram of latencies with percentile queries.
+/// </summary>
+/// <remark>
+/// Values (in the units of the clock, i.e. microseconds from micros()) are counted in buckets
+/// which double in width every LATENCY_SUB_BUCKETS buckets, so values below 8 are exact and
+/// larger values are placed within 25%. Record only increments one counter and takes no lock:
+/// on desktop compilers the increment is atomic so several threads may record while another
+/// reads percentiles. On the AVR a reader in an interrupt should not rely on a consistent
+/// snapshot.
+///
+///   GCodeLatencyHistogram latency;
+///   GCode.clock = micros;
+///   GCode.latency = &amp;latency;
+///   ...
+///   Serial.println(latency.Percentile(99.0));
+/// </remark>
+class GCodeLatencyHistogram
+{
+private:
+	unsigned long counts[LATENCY_BUCKET_COUNT];
+
+public:
+	GCodeLatencyHistogram();
+
+	void Record(unsigned long value);
+	void Reset();
+
+	unsigned long Count() const;
+	unsigned long Percentile(double percent) const;
+
+	static int Bucket(unsigned long value);
+	static unsigned long BucketLowest(int bucket);
+	static unsigned long BucketHighest(int bucket);
+};
+
+#endif
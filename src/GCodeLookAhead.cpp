@@ -0,0 +1,219 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeLookAhead.h"
+#include <stddef.h>
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+/// <param name="blocks">The blocks which make up the ring. They are owned by the caller.</param>
+/// <param name="capacity">The number of blocks, the most that can be looked at ahead.</param>
+GCodeLookAhead::GCodeLookAhead(GCodeParsedBlock* blocks, int capacity)
+{
+	this->blocks = blocks;
+	this->capacity = capacity;
+	head = 0;
+	count = 0;
+	pending = false;
+}
+
+/// <summary>
+/// Moves the line waiting in the parser into the ring.
+/// </summary>
+/// <returns>False if the ring is full, the line is too long or no memory was available, and the line is still waiting.</returns>
+bool GCodeLookAhead::Push()
+{
+	if (parser.lineStatus == GCODE_LINE_OVERFLOW)
+		return false;
+
+	if (parser.line[0] == '\0' && parser.comments[0] == '\0')
+	{
+		pending = false;
+		return true;
+	}
+
+	if (count == capacity)
+		return false;
+
+	int tail = head + count;
+
+	if (tail >= capacity)
+		tail -= capacity;
+
+	if (!parser.GetBlock(&blocks[tail]))
+		return false;
+
+	count++;
+	pending = false;
+
+	return true;
+}
+
+/// <summary>
+/// Adds a character from the input.
+/// </summary>
+/// <param name="c">The character to add.</param>
+/// <returns>False if the ring is full or a line is too long and the character was not taken; add it again after Pop or SkipLine.</returns>
+bool GCodeLookAhead::AddChar(char c)
+{
+	if (pending && !Push())
+		return false;
+
+	if (parser.AddCharToLine(c))
+	{
+		parser.ParseLine();
+		pending = true;
+		Push();
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Adds characters from the input until they run out or the ring is full.
+/// </summary>
+/// <param name="bytes">The characters, i.e. read from a file.</param>
+/// <param name="length">The number of characters.</param>
+/// <returns>The number of characters taken. Fill again from there after Pop or SkipLine.</returns>
+int GCodeLookAhead::Fill(const char* bytes, int length)
+{
+	int pointer = 0;
+
+	while (pointer < length && AddChar(bytes[pointer]))
+		pointer++;
+
+	return pointer;
+}
+
+/// <summary>
+/// Completes a last line which has no line feed at the end of the input.
+/// </summary>
+/// <returns>False if the ring is full or the line is too long; call again after Pop or SkipLine.</returns>
+bool GCodeLookAhead::EndOfInput()
+{
+	if (pending)
+		return Push();
+
+	// An overflowed line has an empty buffer too, but it must not be taken for no line.
+	if (parser.completeLineIsAvailableToParse || (parser.line[0] == '\0' && parser.lineStatus != GCODE_LINE_OVERFLOW))
+		return true;
+
+	return AddChar('\n') && !pending;
+}
+
+/// <summary>
+/// Gets the number of blocks which can be looked at.
+/// </summary>
+int GCodeLookAhead::Available() const
+{
+	return count;
+}
+
+/// <summary>
+/// Gets the number of blocks the ring holds.
+/// </summary>
+int GCodeLookAhead::Capacity() const
+{
+	return capacity;
+}
+
+/// <summary>
+/// Determine if the ring is full and no more input is taken until a block is popped.
+/// </summary>
+bool GCodeLookAhead::IsFull() const
+{
+	return count == capacity;
+}
+
+/// <summary>
+/// Determine if input stopped at a line too long for the parser, which was not queued.
+/// </summary>
+bool GCodeLookAhead::Overflow() const
+{
+	return pending && parser.lineStatus == GCODE_LINE_OVERFLOW;
+}
+
+/// <summary>
+/// Drops the line too long for the parser so input can go on.
+/// </summary>
+void GCodeLookAhead::SkipLine()
+{
+	if (Overflow())
+		pending = false;
+}
+
+/// <summary>
+/// Looks at a block without removing it.
+/// </summary>
+/// <param name="k">0 for the current block, 1 for the next and so on.</param>
+/// <returns>The block or NULL if k is not less than Available().</returns>
+const GCodeParsedBlock* GCodeLookAhead::Peek(int k) const
+{
+	if (k < 0 || k >= count)
+		return NULL;
+
+	int index = head + k;
+
+	if (index >= capacity)
+		index -= capacity;
+
+	return &blocks[index];
+}
+
+/// <summary>
+/// Removes the current block.
+/// </summary>
+/// <param name="block">Receives the block, moved out of the ring.</param>
+/// <returns>False if there are no blocks.</returns>
+bool GCodeLookAhead::Pop(GCodeParsedBlock* block)
+{
+	if (count == 0)
+		return false;
+
+	*block = static_cast<GCodeParsedBlock&&>(blocks[head]);
+
+	head++;
+
+	if (head == capacity)
+		head = 0;
+
+	count--;
+
+	if (pending)
+		Push();
+
+	return true;
+}
+
+/// <summary>
+/// Removes and discards the current block.
+/// </summary>
+/// <returns>False if there are no blocks.</returns>
+bool GCodeLookAhead::Pop()
+{
+	GCodeParsedBlock block;
+
+	return Pop(&block);
+}
@@ -0,0 +1,83 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeLookAhead_h
+#define GCodeLookAhead_h
+
+#include "GCodeParser.h"
+#include "GCodeParsedBlock.h"
+
+/// <summary>
+/// A bounded window of parsed blocks for consumers which need to see ahead of the current block.
+/// </summary>
+/// <remark>
+/// Bytes from a serial port or file are fed with AddChar or Fill. Each complete line is parsed
+/// once and kept as a GCodeParsedBlock in a ring of caller provided blocks. Peek(0) is the
+/// current block and Peek(k) the k-th block after it; Pop moves the current block out.
+/// When the ring is full the last line parsed waits in the parser and AddChar stops taking
+/// bytes until a block is popped, so no line is lost or parsed twice. Lines without code or
+/// comments are skipped. A line too long for the parser (GCODE_LINE_OVERFLOW) is never
+/// queued as an empty block: input stops there as when the ring is full and Overflow
+/// returns true until the caller reports it and calls SkipLine.
+///
+///   GCodeParsedBlock window[8];
+///   GCodeLookAhead lookAhead(window, 8);
+///
+///   while (Serial.available() > 0 && lookAhead.AddChar(Serial.peek()))
+///     Serial.read();
+///
+///   if (lookAhead.Available() > 2 && lookAhead.Peek(2)->HasWord('T'))
+///     ... // pre-heat for the tool change
+/// </remark>
+class GCodeLookAhead
+{
+private:
+	GCodeParsedBlock* blocks;
+	int capacity;
+	int head;
+	int count;
+	bool pending;
+
+	bool Push();
+
+public:
+	GCodeParser parser;     // The parser the blocks are read with, i.e. to set a dialect.
+
+	GCodeLookAhead(GCodeParsedBlock* blocks, int capacity);
+
+	bool AddChar(char c);
+	int Fill(const char* bytes, int length);
+	bool EndOfInput();
+
+	int Available() const;
+	int Capacity() const;
+	bool IsFull() const;
+	bool Overflow() const;
+	void SkipLine();
+	const GCodeParsedBlock* Peek(int k) const;
+	bool Pop(GCodeParsedBlock* block);
+	bool Pop();
+};
+
+#endif
@@ -0,0 +1,255 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeParsedBlock.h"
+#include "GCodeParser.h"
+#include <string.h>
+
+/// <summary>
+/// Class constructor. The block is empty until filled by GCodeParser::GetBlock.
+/// </summary>
+GCodeParsedBlock::GCodeParsedBlock()
+{
+	storage = NULL;
+	present = 0;
+	duplicate = 0;
+	codeLength = 0;
+	commentsLength = 0;
+	lastCommentOffset = 0;
+	wordCount = 0;
+	commentCount = 0;
+	blockDelete = false;
+	beginEnd = false;
+}
+
+/// <summary>
+/// Move constructor. Takes the other block's storage and leaves it empty.
+/// </summary>
+GCodeParsedBlock::GCodeParsedBlock(GCodeParsedBlock&& other)
+{
+	storage = NULL;
+	*this = static_cast<GCodeParsedBlock&&>(other);
+}
+
+/// <summary>
+/// Move assignment. Frees this block's storage, takes the other block's and leaves it empty.
+/// </summary>
+GCodeParsedBlock& GCodeParsedBlock::operator=(GCodeParsedBlock&& other)
+{
+	if (this == &other)
+		return *this;
+
+	Release();
+
+	storage = other.storage;
+	present = other.present;
+	duplicate = other.duplicate;
+	codeLength = other.codeLength;
+	commentsLength = other.commentsLength;
+	lastCommentOffset = other.lastCommentOffset;
+	wordCount = other.wordCount;
+	commentCount = other.commentCount;
+	blockDelete = other.blockDelete;
+	beginEnd = other.beginEnd;
+
+	other.storage = NULL;
+	other.Release();
+
+	return *this;
+}
+
+/// <summary>
+/// Class destructor.
+/// </summary>
+GCodeParsedBlock::~GCodeParsedBlock()
+{
+	Release();
+}
+
+/// <summary>
+/// Frees the storage and empties the block.
+/// </summary>
+void GCodeParsedBlock::Release()
+{
+	delete[] storage;
+
+	storage = NULL;
+	present = 0;
+	duplicate = 0;
+	codeLength = 0;
+	commentsLength = 0;
+	lastCommentOffset = 0;
+	wordCount = 0;
+	commentCount = 0;
+	blockDelete = false;
+	beginEnd = false;
+}
+
+/// <summary>
+/// Gets the word values. They start the storage so they are always aligned.
+/// </summary>
+const double* GCodeParsedBlock::Values() const
+{
+	return (const double*)storage;
+}
+
+/// <summary>
+/// Gets the comment spans, pairs of offset into the comments and length.
+/// </summary>
+const unsigned int* GCodeParsedBlock::Spans() const
+{
+	return (const unsigned int*)(storage + wordCount * sizeof(double));
+}
+
+/// <summary>
+/// Determine if the block holds a line.
+/// </summary>
+/// <returns>True if the block was never filled or has been moved from.</returns>
+bool GCodeParsedBlock::IsEmpty() const
+{
+	return storage == NULL;
+}
+
+/// <summary>
+/// Gets the code part of the line, spaces, tabs and comments removed (as GCodeParser::line).
+/// </summary>
+const char* GCodeParsedBlock::Code() const
+{
+	if (storage == NULL)
+		return "";
+
+	return (const char*)(Spans() + 2 * commentCount);
+}
+
+/// <summary>
+/// Gets all of the comments on the line with their separators (as GCodeParser::comments).
+/// </summary>
+const char* GCodeParsedBlock::Comments() const
+{
+	if (storage == NULL)
+		return "";
+
+	return Code() + codeLength + 1;
+}
+
+/// <summary>
+/// Gets the last comment on the line, the one an active comment is read from (as GCodeParser::lastComment).
+/// </summary>
+const char* GCodeParsedBlock::LastComment() const
+{
+	return Comments() + lastCommentOffset;
+}
+
+/// <summary>
+/// Gets the number of comments on the line.
+/// </summary>
+int GCodeParsedBlock::CommentCount() const
+{
+	return commentCount;
+}
+
+/// <summary>
+/// Gets a comment.
+/// </summary>
+/// <param name="index">The comment, 0 to CommentCount() - 1.</param>
+/// <param name="length">Receives the length of the comment including its separators.</param>
+/// <returns>The start of the comment within Comments(). The comment is not null terminated.</returns>
+const char* GCodeParsedBlock::Comment(int index, int* length) const
+{
+	if (index < 0 || index >= (int)commentCount)
+	{
+		*length = 0;
+		return "";
+	}
+
+	const unsigned int* spans = Spans();
+	*length = spans[2 * index + 1];
+
+	return Comments() + spans[2 * index];
+}
+
+/// <summary>
+/// Determine if the line started with the block delete character '/'.
+/// </summary>
+bool GCodeParsedBlock::BlockDelete() const
+{
+	return blockDelete;
+}
+
+/// <summary>
+/// Determine if the line was a '%' program begin or end marker.
+/// </summary>
+bool GCodeParsedBlock::BeginEnd() const
+{
+	return beginEnd;
+}
+
+/// <summary>
+/// Looks to see if the word exists in the line.
+/// </summary>
+/// <param name="letter">The letter of the word.</param>
+/// <returns>True if the word exists.</returns>
+bool GCodeParsedBlock::HasWord(char letter) const
+{
+	return letter >= 'A' && letter <= 'Z' && (present & GCODE_LETTER(letter));
+}
+
+/// <summary>
+/// Gets the value following the word.
+/// </summary>
+/// <param name="letter">The letter of the word.</param>
+/// <returns>The value of the first occurrence of the word or 0.0 if the word does not exist.</returns>
+/// <remarks>Values are stored in letter order so the index is the count of present letters before this one.</remarks>
+double GCodeParsedBlock::GetWordValue(char letter) const
+{
+	if (!HasWord(letter))
+		return 0.0;
+
+	unsigned long before = present & (GCODE_LETTER(letter) - 1);
+	int index = 0;
+
+	while (before != 0)
+	{
+		before &= before - 1;
+		index++;
+	}
+
+	return Values()[index];
+}
+
+/// <summary>
+/// Gets the mask of GCODE_LETTER bits of the words in the line.
+/// </summary>
+unsigned long GCodeParsedBlock::Words() const
+{
+	return present;
+}
+
+/// <summary>
+/// Gets the mask of GCODE_LETTER bits of the words which appear more than once in the line.
+/// </summary>
+unsigned long GCodeParsedBlock::DuplicateWords() const
+{
+	return duplicate;
+}
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeParsedBlock_h
+#define GCodeParsedBlock_h
+
+class GCodeParser;
+
+/// <summary>
+/// A parsed line of G-Code (block) which owns its code, comments and word values.
+/// </summary>
+/// <remark>
+/// Built by GCodeParser::GetBlock after ParseLine. Everything is kept in a single allocation
+/// sized to the line: the values of the words present (in letter order), the comment spans,
+/// the code and the comments. The block cannot be changed once built and cannot be copied,
+/// only moved, which transfers the allocation without copying it. A block can therefore be
+/// passed through queues cheaply and read by several threads at once, while the parser goes
+/// on to the next line.
+///
+///   GCodeParsedBlock block;
+///   if (GCode.GetBlock(&block))
+///     queue.Push(std::move(block));
+/// </remark>
+class GCodeParsedBlock
+{
+	friend class GCodeParser;
+
+private:
+	char* storage;
+	unsigned long present;
+	unsigned long duplicate;
+	unsigned int codeLength;
+	unsigned int commentsLength;
+	unsigned int lastCommentOffset;
+	unsigned int commentCount;
+	unsigned char wordCount;
+	bool blockDelete;
+	bool beginEnd;
+
+	void Release();
+
+	const double* Values() const;
+	const unsigned int* Spans() const;
+
+public:
+	GCodeParsedBlock();
+	GCodeParsedBlock(GCodeParsedBlock&& other);
+	GCodeParsedBlock& operator=(GCodeParsedBlock&& other);
+	~GCodeParsedBlock();
+
+	GCodeParsedBlock(const GCodeParsedBlock&) = delete;
+	GCodeParsedBlock& operator=(const GCodeParsedBlock&) = delete;
+
+	bool IsEmpty() const;
+	const char* Code() const;
+	const char* Comments() const;
+	const char* LastComment() const;
+	int CommentCount() const;
+	const char* Comment(int index, int* length) const;
+	bool BlockDelete() const;
+	bool BeginEnd() const;
+
+	bool HasWord(char letter) const;
+	double GetWordValue(char letter) const;
+	unsigned long Words() const;
+	unsigned long DuplicateWords() const;
+};
+
+#endif
@@ -23,21 +23,44 @@ SOFTWARE.
 */
 
 #include "GCodeParser.h"
-#include <stdlib.h>
+#include "GCodeDialect.h"
+#include "GCodeParsedBlock.h"
+#include "GCodeLatency.h"
+#include "GCodeArena.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
 #include <string.h>
+#include <new>
 
  /// <summary>
  /// Initializizes class.
  /// </summary>
 void GCodeParser::Initialize()
 {
+	// Give a long line's arena memory back.
+	if (line != buffer)
+	{
+		if (lineArena != NULL)
+			lineArena->Release(arenaMark);
+
+		line = buffer;
+	}
+
 	lineCharCount = 0;
+	lineCapacity = MAX_LINE_SIZE;
+	lineStatus = GCODE_LINE_OK;
 	line[lineCharCount] = '\0';
 	comments = line;
 	lastComment = comments;
 	blockDelete = false;
 	beginEnd = false;
 	completeLineIsAvailableToParse = false;
+	commentLength = 0;
+	commentTail = false;
+	commentDecided = false;
+	commentSkipped = false;
+	parenthesisFound = false;
 }
 
 /// <summary>
@@ -51,17 +74,152 @@ void GCodeParser::Initialize()
 /// </remark>
 GCodeParser::GCodeParser()
 {
+	dialect = NULL;
+	clock = NULL;
+	latency = NULL;
+	firstCharTime = 0;
+	lineEndTime = 0;
+	parseDoneTime = 0;
+	lineArena = NULL;
+	commentMode = GCODE_COMMENTS_KEEP;
+	skipThumbnails = false;
+	commentCallback = NULL;
+	realtimeBytes = NULL;
+	realtimeCallback = NULL;
+	thumbnail = false;
+	line = buffer;
+	Initialize();
+}
+
+/// <summary>
+/// Class constructor for a specific G-Code dialect.
+/// </summary>
+/// <param name="dialect">The dialect (i.e. &amp;GCodeDialectGrbl) used by IsWord and Validate.</param>
+GCodeParser::GCodeParser(const GCodeDialect* dialect)
+{
+	this->dialect = dialect;
+	clock = NULL;
+	latency = NULL;
+	firstCharTime = 0;
+	lineEndTime = 0;
+	parseDoneTime = 0;
+	lineArena = NULL;
+	commentMode = GCODE_COMMENTS_KEEP;
+	skipThumbnails = false;
+	commentCallback = NULL;
+	realtimeBytes = NULL;
+	realtimeCallback = NULL;
+	thumbnail = false;
+	line = buffer;
 	Initialize();
 }
 
+/// <summary>
+/// Copy constructor.
+/// </summary>
+GCodeParser::GCodeParser(const GCodeParser& other)
+{
+	line = buffer;
+	lineArena = NULL;
+	CopyFrom(other);
+}
+
+/// <summary>
+/// Copy assignment.
+/// </summary>
+GCodeParser& GCodeParser::operator=(const GCodeParser& other)
+{
+	if (this != &other)
+	{
+		// Give back any long line held before taking the other's settings.
+		Initialize();
+		CopyFrom(other);
+	}
+
+	return *this;
+}
+
+/// <summary>
+/// Copies the settings and the line of another parser.
+/// </summary>
+/// <remark>
+/// The line pointers are moved to this parser's own buffer. A long line held in the other
+/// parser's arena cannot be copied without memory of its own, so the copy gets an empty
+/// line marked GCODE_LINE_OVERFLOW instead.
+/// </remark>
+void GCodeParser::CopyFrom(const GCodeParser& other)
+{
+	dialect = other.dialect;
+	lineArena = other.lineArena;
+	commentMode = other.commentMode;
+	skipThumbnails = other.skipThumbnails;
+	commentCallback = other.commentCallback;
+	realtimeBytes = other.realtimeBytes;
+	realtimeCallback = other.realtimeCallback;
+	thumbnail = other.thumbnail;
+	memcpy(commentBuffer, other.commentBuffer, sizeof(commentBuffer));
+	commentLength = other.commentLength;
+	commentTail = other.commentTail;
+	commentDecided = other.commentDecided;
+	commentSkipped = other.commentSkipped;
+	parenthesisFound = other.parenthesisFound;
+	clock = other.clock;
+	latency = other.latency;
+	firstCharTime = other.firstCharTime;
+	lineEndTime = other.lineEndTime;
+	parseDoneTime = other.parseDoneTime;
+	line = buffer;
+	lineCapacity = MAX_LINE_SIZE;
+	blockDelete = other.blockDelete;
+	beginEnd = other.beginEnd;
+	completeLineIsAvailableToParse = other.completeLineIsAvailableToParse;
+
+	if (other.line == other.buffer)
+	{
+		memcpy(buffer, other.buffer, sizeof(buffer));
+		lineCharCount = other.lineCharCount;
+		lineStatus = other.lineStatus;
+		comments = line + (other.comments - other.line);
+		lastComment = line + (other.lastComment - other.line);
+	}
+	else
+	{
+		lineCharCount = 0;
+		line[0] = '\0';
+		comments = line;
+		lastComment = comments;
+		lineStatus = GCODE_LINE_OVERFLOW;
+	}
+}
+
 /// <summary>
 /// Adds a character to the line to be parsed.
 /// </summary>
 /// <param name="letter">The character to add.</param>
 /// <returns>True if a complete line is available to parse.</returns>
-/// <remarks>Adding a character after a CR/LF (\r\n - Windows) or LF (\n - Linux, Mac) have been added will reset the line buffer.</remarks>
+/// <remarks>
+/// Adding a character after a CR/LF (\r\n - Windows) or LF (\n - Linux, Mac) have been added will reset the line buffer.
+/// When a clock is set the time of the first character and of the line feed are kept in firstCharTime and lineEndTime.
+/// A line longer than MAX_LINE_SIZE moves into lineArena when one is set and lineStatus becomes GCODE_LINE_LONG.
+/// Otherwise, or when the arena is full too, the line is discarded up to its line feed and lineStatus is
+/// GCODE_LINE_OVERFLOW, so the caller can reject it (i.e. ask for a resend) rather than run part of it.
+/// Unless commentMode is GCODE_COMMENTS_KEEP, a semicolon comment is taken out of the line as it arrives
+/// (see FlushComment), so it is never buffered or shifted by ParseLine.
+/// A byte in realtimeBytes is passed to realtimeCallback as soon as it is added and is not added to the line.
+/// It leaves the parser as it was, so a complete line is still available to parse.
+/// </remarks>
 bool GCodeParser::AddCharToLine(char c)
 {
+	// Real-time bytes go to the callback at once wherever they are, even inside a comment,
+	// and are left out of the line. They are checked before a complete line is reset.
+	if (realtimeBytes != NULL && c != '\0' && strchr(realtimeBytes, c) != NULL)
+	{
+		if (realtimeCallback != NULL)
+			realtimeCallback(c);
+
+		return false;
+	}
+
 	// Determine is a new line is being added.
 	if (completeLineIsAvailableToParse)
 		Initialize();
@@ -70,24 +228,260 @@ bool GCodeParser::AddCharToLine(char c)
 	if (c == '\r' || c == '\n')
 	{
 		if (c == '\n') // Ignore CR (\r)
+		{
+			if (commentTail)
+				FlushComment(true);
+
 			completeLineIsAvailableToParse = true;
+
+			if (clock != NULL)
+				lineEndTime = clock();
+		}
 	}
+	else if (commentTail)
+		AddCommentChar(c);
 	else
 	{
-		// Add character to line.
-		line[lineCharCount] = c;
-		lineCharCount++;
+		// The rest of an overflowed line is dropped.
+		if (lineStatus == GCODE_LINE_OVERFLOW)
+			return false;
 
-		// Deal with buffer overflow by initializing. TODO: Need a better solution.  i.e. Throw error?
-		if (lineCharCount > MAX_LINE_SIZE)
-			Initialize();
+		if (lineCharCount == 0 && clock != NULL)
+			firstCharTime = clock();
 
-		line[lineCharCount] = '\0';
+		// A semicolon runs the comment to the end of the line, unless it may be inside a
+		// parenthesis comment (ParseLine decides that by looking ahead).
+		if (c == ';' && !parenthesisFound && (commentMode != GCODE_COMMENTS_KEEP || skipThumbnails))
+		{
+			commentTail = true;
+			commentDecided = commentMode == GCODE_COMMENTS_SKIP;
+			commentSkipped = commentDecided;
+			AddCommentChar(c);
+
+			return false;
+		}
+
+		if (c == '(')
+			parenthesisFound = true;
+
+		AppendToLine(c);
 	}
 
 	return completeLineIsAvailableToParse;
 }
 
+/// <summary>
+/// Adds characters to the line to be parsed, up to and including the end of a line.
+/// </summary>
+/// <param name="text">The characters to add.</param>
+/// <param name="length">The number of characters.</param>
+/// <returns>The number of characters taken. Check completeLineIsAvailableToParse for a complete line.</returns>
+/// <remarks>
+/// The same as calling AddCharToLine for each character, except that once a streamed or skipped
+/// comment has been recognized the rest of it is found with memchr and passed to the callback (or
+/// dropped) in one piece. With realtimeBytes set comments are handled a character at a time.
+/// </remarks>
+int GCodeParser::AddCharsToLine(const char* text, int length)
+{
+	int taken = 0;
+
+	while (taken < length)
+	{
+		// The comment is only passed over in one piece when no real-time byte can be inside it.
+		if (commentTail && commentDecided && (commentSkipped || commentMode != GCODE_COMMENTS_KEEP) && realtimeBytes == NULL)
+		{
+			if (commentLength > 0)
+				FlushComment(false);
+
+			const char* start = text + taken;
+			const char* end = (const char*)memchr(start, '\n', length - taken);
+			int span = (int)((end != NULL ? end : text + length) - start);
+			int comment = span;
+
+			// The CR of a CR/LF is dropped as it is from the line.
+			if (comment > 0 && start[comment - 1] == '\r')
+				comment--;
+
+			if (comment > 0 && !commentSkipped && commentMode == GCODE_COMMENTS_STREAM && commentCallback != NULL)
+				commentCallback(start, comment, false);
+
+			taken += span;
+
+			if (end == NULL)
+				break;
+		}
+
+		if (AddCharToLine(text[taken++]))
+			break;
+	}
+
+	return taken;
+}
+
+/// <summary>
+/// Adds a character to the end of the line buffer.
+/// </summary>
+/// <returns>False if the line has overflowed.</returns>
+bool GCodeParser::AppendToLine(char c)
+{
+	if (lineStatus == GCODE_LINE_OVERFLOW)
+		return false;
+
+	if (lineCharCount == lineCapacity && !SpillLine())
+	{
+		lineStatus = GCODE_LINE_OVERFLOW;
+		lineCharCount = 0;
+		line[lineCharCount] = '\0';
+
+		return false;
+	}
+
+	// Add character to line.
+	line[lineCharCount] = c;
+	lineCharCount++;
+	line[lineCharCount] = '\0';
+
+	return true;
+}
+
+/// <summary>
+/// Adds a character of a semicolon comment, passing full chunks on.
+/// </summary>
+void GCodeParser::AddCommentChar(char c)
+{
+	if (commentLength == COMMENT_CHUNK_SIZE)
+		FlushComment(false);
+
+	commentBuffer[commentLength++] = c;
+}
+
+/// <summary>
+/// Gets whether a comment starts a thumbnail, ends one or neither.
+/// </summary>
+/// <remark>
+/// Slicers embed images as "; thumbnail begin 300x300 12345" (or thumbnail_JPG, thumbnail_QOI
+/// and so on), base64 comment lines and "; thumbnail end".
+/// </remark>
+/// <returns>1 for a begin marker, -1 for an end marker, otherwise 0.</returns>
+static int ThumbnailMarker(const char* text, int length)
+{
+	int pointer = 1;
+
+	while (pointer < length && text[pointer] == ' ')
+		pointer++;
+
+	if (length - pointer < 9 || strncmp(&text[pointer], "thumbnail", 9) != 0)
+		return 0;
+
+	pointer += 9;
+
+	if (pointer < length && text[pointer] == '_')
+	{
+		do
+			pointer++;
+		while (pointer < length && ((text[pointer] >= 'A' && text[pointer] <= 'Z') || (text[pointer] >= 'a' && text[pointer] <= 'z')));
+	}
+
+	if (pointer >= length || text[pointer] != ' ')
+		return 0;
+
+	pointer++;
+
+	if (length - pointer >= 5 && strncmp(&text[pointer], "begin", 5) == 0)
+		return 1;
+
+	if (length - pointer >= 3 && strncmp(&text[pointer], "end", 3) == 0)
+		return -1;
+
+	return 0;
+}
+
+/// <summary>
+/// Passes the held comment characters on according to commentMode.
+/// </summary>
+/// <param name="end">True at the end of the line, which ends the comment.</param>
+/// <remark>
+/// The first chunk (or the whole comment when it is shorter) decides whether the comment is
+/// skipped: in GCODE_COMMENTS_SKIP mode, or with skipThumbnails when it is a thumbnail marker or
+/// lies between the markers. Otherwise the comment goes to commentCallback in
+/// GCODE_COMMENTS_STREAM mode, the last call with end set, or back to the line in
+/// GCODE_COMMENTS_KEEP mode (used with skipThumbnails alone).
+/// </remark>
+void GCodeParser::FlushComment(bool end)
+{
+	if (!commentDecided)
+	{
+		int marker = skipThumbnails ? ThumbnailMarker(commentBuffer, commentLength) : 0;
+
+		if (marker > 0)
+			thumbnail = true;
+
+		commentSkipped = thumbnail;
+
+		if (marker < 0)
+			thumbnail = false;
+
+		commentDecided = true;
+	}
+
+	if (!commentSkipped)
+	{
+		if (commentMode == GCODE_COMMENTS_STREAM)
+		{
+			if (commentCallback != NULL)
+				commentCallback(commentBuffer, commentLength, end);
+		}
+		else
+		{
+			for (int i = 0; i < commentLength; i++)
+				AppendToLine(commentBuffer[i]);
+		}
+	}
+
+	commentLength = 0;
+
+	if (end)
+		commentTail = false;
+}
+
+/// <summary>
+/// Moves a line that has filled the buffer into the free space of the line arena.
+/// </summary>
+/// <remark>
+/// The line takes all the space left in the arena, so it can keep growing without copying,
+/// and gives it back when the next line starts.
+/// </remark>
+/// <returns>False if there is no arena or it has no more room than the buffer.</returns>
+bool GCodeParser::SpillLine()
+{
+	if (lineArena == NULL || line != buffer)
+		return false;
+
+	size_t mark = lineArena->Mark();
+	size_t size;
+	char* spill = (char*)lineArena->AllocateRest(&size);
+
+	if (spill == NULL || size < (size_t)MAX_LINE_SIZE + 3)
+	{
+		lineArena->Release(mark);
+		return false;
+	}
+
+	// Room for ParseLine's extra null, and int positions on 16 bit processors.
+	if (size - 2 > (size_t)INT_MAX)
+		size = (size_t)INT_MAX + 2;
+
+	memcpy(spill, buffer, lineCharCount + 1);
+	arenaMark = mark;
+	line = spill;
+	comments = line;
+	lastComment = line;
+	lineCapacity = (int)(size - 2);
+	lineStatus = GCODE_LINE_LONG;
+
+	return true;
+}
+
 /// <summary>
 /// Parses the line passed removing spaces, tabs and comments. Comments are shifted to the end of the line buffer.
 /// </summary>
@@ -110,6 +504,10 @@ void GCodeParser::ParseLine(char* gCode)
 /// <summary>
 /// Parses the line removing spaces, tabs and comments. Comments are shifted to the end of the line buffer.
 /// </summary>
+/// <remark>
+/// When a clock is set the time parsing finished is kept in parseDoneTime and, when a latency
+/// histogram is set, the time from the line feed to the end of parsing is recorded in it.
+/// </remark>
 void GCodeParser::ParseLine()
 {
 	int lineLength = strlen(line);
@@ -246,6 +644,14 @@ void GCodeParser::ParseLine()
 
 	// The '%' is used to demarcate the beginning (first line) and end (last line) of the program. It is optional if the file has an 'M2' or 'M30'. 
 	beginEnd = (line[0] == '%');
+
+	if (clock != NULL)
+	{
+		parseDoneTime = clock();
+
+		if (latency != NULL)
+			latency->Record(parseDoneTime - lineEndTime);
+	}
 }
 
 /// <summary>
@@ -372,7 +778,7 @@ bool GCodeParser::HasWord(char letter)
 	return true;
 }
 
-char wordLetter[] = { 'A', 'B', 'C', 'D', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '\0' };
+static const char wordLetter[] = { 'A', 'B', 'C', 'D', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '\0' };
 
 /// <summary>
 /// Determine if the letter provided represents a valid GCode word.
@@ -416,9 +822,14 @@ char wordLetter[] = { 'A', 'B', 'C', 'D', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M'
 /// ^ - Polar coordinate for the angle. Polar coordinates are not considered words.
 /// / - The block delete character causes the processor to skips the line and is not considered a word.
 /// % - Indicated the beginning and end of a program and is not considered a word.
+/// 
+/// When a dialect has been selected the dialect's letters are used instead of the table.
 /// </remark>
 bool GCodeParser::IsWord(char letter)
 {	
+	if (dialect != NULL)
+		return letter >= 'A' && letter <= 'Z' && (dialect->letters & GCODE_LETTER(letter));
+
 	int pointer = 0;
 	while (wordLetter[pointer] != '\0')
 	{
@@ -446,9 +857,9 @@ bool GCodeParser::NoWords()
 	}
 
 	int pointer = 0;
-	while (wordLetter[pointer] != '\0')
+	while (line[pointer] != '\0')
 	{
-		if (HasWord(wordLetter[pointer]))
+		if (IsWord(line[pointer]))
 		{
 			return false;
 		}
@@ -459,6 +870,35 @@ bool GCodeParser::NoWords()
 	return true;
 }
 
+/// <summary>
+/// Validates the line against the selected dialect.
+/// </summary>
+/// <returns>GCODE_VALID or the first problem found. Always GCODE_VALID if no dialect was selected.</returns>
+/// <remarks>Should be used after the line is parsed. See GCodeDialect::Validate.</remarks>
+GCodeValidation GCodeParser::Validate()
+{
+	return Validate(NULL);
+}
+
+/// <summary>
+/// Validates the line against the selected dialect.
+/// </summary>
+/// <param name="errorPosition">Receives the position in the line of the problem or -1. May be NULL.</param>
+/// <returns>GCODE_VALID or the first problem found. Always GCODE_VALID if no dialect was selected.</returns>
+/// <remarks>Should be used after the line is parsed. See GCodeDialect::Validate.</remarks>
+GCodeValidation GCodeParser::Validate(int* errorPosition)
+{
+	if (dialect == NULL)
+	{
+		if (errorPosition != NULL)
+			*errorPosition = -1;
+
+		return GCODE_VALID;
+	}
+
+	return dialect->Validate(line, errorPosition);
+}
+
 /// <summary>
 /// Gets the value following the word.
 /// </summary>
@@ -473,7 +913,683 @@ double GCodeParser::GetWordValue(char letter)
 	int pointer = FindWord(letter);
 
 	if (line[pointer] != '\0')
-		return (double)strtod(&line[pointer + 1], NULL);
+	{
+		// G, M, T and N words are almost always whole numbers. Convert them without the fraction path.
+		if (letter == 'G' || letter == 'M' || letter == 'T' || letter == 'N')
+		{
+			long code;
+			int count = ParseInteger(&line[pointer + 1], &code);
+
+			if (count > 0 && line[pointer + 1 + count] != '.')
+				return (double)code;
+		}
+
+		double value;
+		ParseNumber(&line[pointer + 1], &value);
+
+		return value;
+	}
 
 	return 0.0;
 }
+
+/// <summary>
+/// Gets the whole number value following the word.
+/// </summary>
+/// <param name="letter">The letter of the word to look for in the line.</param>
+/// <returns>The whole number value following the letter for the word.</returns>
+/// <remarks>
+/// Intended for G, M, T and N words. Any fraction is ignored (G38.2 returns 38). If the
+/// word does not exist in the command line zero is returned.
+/// </remarks>
+long GCodeParser::GetWordIntegerValue(char letter)
+{
+	int pointer = FindWord(letter);
+	long value = 0;
+
+	if (line[pointer] != '\0')
+		ParseInteger(&line[pointer + 1], &value);
+
+	return value;
+}
+
+/// <summary>
+/// Gets the value following the word as a fixed point (scaled) whole number.
+/// </summary>
+/// <param name="letter">The letter of the word to look for in the line.</param>
+/// <param name="decimals">The number of decimal places kept (0 to MAX_FIXED_DECIMALS). 3 returns thousandths (microns for millimeters).</param>
+/// <returns>The value following the letter for the word multiplied by 10^decimals.</returns>
+/// <remarks>See ParseFixedNumber. If the word does not exist in the command line zero is returned.</remarks>
+long GCodeParser::GetWordFixedValue(char letter, int decimals)
+{
+	return GetWordFixedValue(letter, decimals, NULL);
+}
+
+/// <summary>
+/// Gets the value following the word as a fixed point (scaled) whole number.
+/// </summary>
+/// <param name="letter">The letter of the word to look for in the line.</param>
+/// <param name="decimals">The number of decimal places kept (0 to MAX_FIXED_DECIMALS). 3 returns thousandths (microns for millimeters).</param>
+/// <param name="saturated">Set true if the value did not fit in a long and was clamped. May be NULL.</param>
+/// <returns>The value following the letter for the word multiplied by 10^decimals.</returns>
+/// <remarks>See ParseFixedNumber. If the word does not exist in the command line zero is returned.</remarks>
+long GCodeParser::GetWordFixedValue(char letter, int decimals, bool* saturated)
+{
+	int pointer = FindWord(letter);
+	long value = 0;
+	bool clamped = false;
+
+	if (line[pointer] != '\0')
+		ParseFixedNumber(&line[pointer + 1], decimals, &value, &clamped);
+
+	if (saturated != NULL)
+		*saturated = clamped;
+
+	return value;
+}
+
+/// <summary>
+/// Gets the values for a set of words in a single pass over the line.
+/// </summary>
+/// <param name="letterMask">The letters wanted as a mask of GCODE_LETTER bits (i.e. GCODE_LETTER('X') | GCODE_LETTER('Y')).</param>
+/// <param name="words">Receives the values, the present mask and the duplicate mask.</param>
+/// <returns>The mask of requested letters found on the line.</returns>
+/// <remarks>
+/// Equivalent to calling HasWord and GetWordValue for each letter but the line is only walked
+/// once. Like FindWord the letters are not validated so E and other non-RS274 letters can be used.
+/// </remarks>
+unsigned long GCodeParser::GetWords(unsigned long letterMask, GCodeWords* words)
+{
+	words->present = 0;
+	words->duplicate = 0;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (letterMask & (1UL << i))
+			words->value[i] = 0.0;
+	}
+
+	int pointer = 0;
+
+	while (line[pointer] != '\0')
+	{
+		char c = line[pointer];
+		pointer++;
+
+		if (c < 'A' || c > 'Z')
+			continue;
+
+		unsigned long bit = GCODE_LETTER(c);
+
+		if (!(letterMask & bit))
+			continue;
+
+		if (words->present & bit)
+		{
+			words->duplicate |= bit;
+			continue;
+		}
+
+		words->present |= bit;
+		pointer += ParseNumber(&line[pointer], &words->value[c - 'A']);
+	}
+
+	return words->present;
+}
+
+/// <summary>
+/// Gets the values for a set of words in a single pass over the line.
+/// </summary>
+/// <param name="letters">The letters wanted (i.e. "XYZEF").</param>
+/// <param name="words">Receives the values, the present mask and the duplicate mask.</param>
+/// <returns>The mask of requested letters found on the line.</returns>
+/// <remarks>When called repeatedly with the same letters, build the mask once with LetterMask.</remarks>
+unsigned long GCodeParser::GetWords(const char* letters, GCodeWords* words)
+{
+	return GetWords(LetterMask(letters), words);
+}
+
+/// <summary>
+/// Finds the next comment in the comments.
+/// </summary>
+/// <param name="comments">The comments.</param>
+/// <param name="pointer">Where to start looking.</param>
+/// <param name="start">Receives the start of the comment.</param>
+/// <returns>The position after the comment or -1 if there are no more comments.</returns>
+static int NextComment(const char* comments, int pointer, int* start)
+{
+	while (comments[pointer] != '\0')
+	{
+		if (comments[pointer] == ';')
+		{
+			*start = pointer;
+			return pointer + strlen(&comments[pointer]);
+		}
+
+		if (comments[pointer] == '(')
+		{
+			*start = pointer;
+			int depth = 0;
+
+			do {
+				if (comments[pointer] == '(')
+					depth++;
+				else if (comments[pointer] == ')')
+					depth--;
+
+				pointer++;
+			} while (depth > 0 && comments[pointer] != '\0');
+
+			return pointer;
+		}
+
+		pointer++;
+	}
+
+	return -1;
+}
+
+/// <summary>
+/// Copies the parsed line into a self-contained block.
+/// </summary>
+/// <param name="block">Receives the block. Anything it held before is freed.</param>
+/// <returns>False if no memory was available, the block is left empty.</returns>
+/// <remarks>
+/// Use after ParseLine and before RemoveCommentSeparators. The block keeps the code, the
+/// comments split into spans and the value of every word on the line, so it no longer
+/// depends on the parser and can be moved to another thread while the next line is read.
+/// </remarks>
+bool GCodeParser::GetBlock(GCodeParsedBlock* block)
+{
+	block->Release();
+
+	GCodeWords words;
+	GetWords(GCODE_ALL_LETTERS, &words);
+
+	int wordCount = 0;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (words.present & (1UL << i))
+			wordCount++;
+	}
+
+	int commentCount = 0;
+	int start;
+	int pointer = 0;
+
+	while ((pointer = NextComment(comments, pointer, &start)) >= 0)
+		commentCount++;
+
+	int codeLength = strlen(line);
+	int commentsLength = strlen(comments);
+	int size = wordCount * sizeof(double) + 2 * commentCount * sizeof(unsigned int) + codeLength + commentsLength + 2;
+
+	block->storage = new (std::nothrow) char[size];
+
+	if (block->storage == NULL)
+		return false;
+
+	block->present = words.present;
+	block->duplicate = words.duplicate;
+	block->wordCount = wordCount;
+	block->commentCount = commentCount;
+	block->codeLength = codeLength;
+	block->commentsLength = commentsLength;
+	block->lastCommentOffset = lastComment - comments;
+	block->blockDelete = blockDelete;
+	block->beginEnd = beginEnd;
+
+	double* values = (double*)block->storage;
+
+	for (int i = 0; i < WORD_LETTER_COUNT; i++)
+	{
+		if (words.present & (1UL << i))
+			*values++ = words.value[i];
+	}
+
+	unsigned int* spans = (unsigned int*)values;
+	pointer = 0;
+
+	while ((pointer = NextComment(comments, pointer, &start)) >= 0)
+	{
+		*spans++ = start;
+		*spans++ = pointer - start;
+	}
+
+	char* text = (char*)spans;
+	memcpy(text, line, codeLength + 1);
+	memcpy(text + codeLength + 1, comments, commentsLength + 1);
+
+	return true;
+}
+
+/// <summary>
+/// Builds a letter mask for GetWords.
+/// </summary>
+/// <param name="letters">The letters (A through Z) to include. Other characters are ignored.</param>
+/// <returns>The mask of GCODE_LETTER bits.</returns>
+unsigned long GCodeParser::LetterMask(const char* letters)
+{
+	unsigned long mask = 0;
+
+	int pointer = 0;
+	while (letters[pointer] != '\0')
+	{
+		if (letters[pointer] >= 'A' && letters[pointer] <= 'Z')
+			mask |= GCODE_LETTER(letters[pointer]);
+
+		pointer++;
+	}
+
+	return mask;
+}
+
+const int MAX_EXACT_POWER_OF_TEN = 22; // Largest power of ten exactly representable as a double.
+
+const double powerOfTen[MAX_EXACT_POWER_OF_TEN + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+const int MAX_MANTISSA_DIGITS = 19; // Significant digits that fit in an unsigned long long.
+
+/// <summary>
+/// Multiplies two 64 bit values into a 128 bit result.
+/// </summary>
+/// <param name="a">The first value.</param>
+/// <param name="b">The second value.</param>
+/// <param name="high">Receives the upper 64 bits.</param>
+/// <param name="low">Receives the lower 64 bits.</param>
+/// <remarks>
+/// Built from 32 bit halves so it works on every compiler the library targets.
+/// </remarks>
+static void MultiplyWide(unsigned long long a, unsigned long long b, unsigned long long* high, unsigned long long* low)
+{
+	unsigned long long aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+	unsigned long long bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+
+	unsigned long long lowLow = aLow * bLow;
+	unsigned long long highLow = aHigh * bLow;
+	unsigned long long lowHigh = aLow * bHigh;
+	unsigned long long highHigh = aHigh * bHigh;
+
+	unsigned long long middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + (lowHigh & 0xFFFFFFFFULL);
+
+	*low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+	*high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+}
+
+/// <summary>
+/// Compares two 128 bit values.
+/// </summary>
+static int CompareWide(unsigned long long aHigh, unsigned long long aLow, unsigned long long bHigh, unsigned long long bLow)
+{
+	if (aHigh != bHigh)
+		return aHigh < bHigh ? -1 : 1;
+
+	if (aLow != bLow)
+		return aLow < bLow ? -1 : 1;
+
+	return 0;
+}
+
+/// <summary>
+/// Shifts a 128 bit value left by 0 to 63 bits. Other counts leave it unchanged.
+/// </summary>
+static void ShiftWide(unsigned long long* high, unsigned long long* low, int count)
+{
+	if (count <= 0 || count > 63)
+		return;
+
+	*high = (*high << count) | (*low >> (64 - count));
+	*low <<= count;
+}
+
+/// <summary>
+/// Corrects a quotient of mantissa / 10^places to the nearest double.
+/// </summary>
+/// <remarks>
+/// Converting a mantissa wider than a double and then dividing rounds twice, which can
+/// leave the estimate one unit in the last place off. The estimate's halfway points are
+/// compared exactly against the mantissa in 128 bit integers and the estimate is moved
+/// one step when needed. Estimates whose comparison does not fit in 128 bits are kept.
+/// </remarks>
+static double NearestQuotient(unsigned long long mantissa, int places, double estimate)
+{
+	if (places > MAX_MANTISSA_DIGITS || estimate == 0.0)
+		return estimate;
+
+	unsigned long long power = 1;
+
+	for (int i = 0; i < places; i++)
+		power *= 10;
+
+	int exponent;
+	unsigned long long bits = (unsigned long long)ldexp(frexp(estimate, &exponent), DBL_MANT_DIG);
+	exponent -= DBL_MANT_DIG;
+
+	// mantissa * 2^shift is compared with the halfway points (2 * bits +/- 1) * power. From
+	// 2^53 up the shift is negative and the halfway points are shifted left instead.
+	int shift = 1 - exponent;
+
+	if (shift > 63)
+		return estimate;
+
+	unsigned long long valueHigh = 0;
+	unsigned long long valueLow = mantissa;
+	unsigned long long high, low;
+
+	ShiftWide(&valueHigh, &valueLow, shift);
+
+	MultiplyWide(2 * bits + 1, power, &high, &low);
+	ShiftWide(&high, &low, -shift);
+	int compare = CompareWide(valueHigh, valueLow, high, low);
+
+	if (compare > 0 || (compare == 0 && (bits & 1)))
+		return ldexp((double)(bits + 1), exponent);
+
+	// Below a power of two the next double down is closer, the estimate is kept there.
+	if (bits == (1ULL << (DBL_MANT_DIG - 1)))
+		return estimate;
+
+	MultiplyWide(2 * bits - 1, power, &high, &low);
+	ShiftWide(&high, &low, -shift);
+	compare = CompareWide(valueHigh, valueLow, high, low);
+
+	if (compare < 0 || (compare == 0 && (bits & 1)))
+		return ldexp((double)(bits - 1), exponent);
+
+	return estimate;
+}
+
+/// <summary>
+/// Converts the G-Code number at the start of the text.
+/// </summary>
+/// <param name="text">The text to convert, normally the character after the word letter.</param>
+/// <param name="value">Receives the value. Set to 0.0 when no number is found.</param>
+/// <returns>The number of characters consumed. Zero when the text does not start with a number.</returns>
+/// <remarks>
+/// G-Code numbers are an optional sign, digits and an optional fraction. Unlike strtod
+/// exponents, hex, inf/nan and leading whitespace are not accepted and the decimal point
+/// is always '.' regardless of locale. Comparing the count returned to the characters
+/// remaining can be used to validate the whole word.
+/// 
+/// Digits are accumulated in an integer mantissa and scaled once by an exact power of ten,
+/// so the result is correctly rounded when the number has no more than 15 significant
+/// digits and 22 decimal places (all practical G-Code). Numbers of up to 19 significant
+/// digits are corrected to the nearest double with exact integer math when their value is
+/// at least 0.001 and has no more than 19 decimal places. Digits past the 19th are dropped,
+/// which can leave the result one unit in the last place off. Smaller values and numbers
+/// with more decimal places are scaled in several steps and can be two units off.
+/// </remarks>
+int GCodeParser::ParseNumber(const char* text, double* value)
+{
+	int pointer = 0;
+	bool negative = false;
+
+	if (text[pointer] == '+' || text[pointer] == '-')
+	{
+		negative = (text[pointer] == '-');
+		pointer++;
+	}
+
+	// The first nine significant digits fit in an unsigned long which keeps 8 bit controllers on 32 bit math.
+	unsigned long shortMantissa = 0;
+	unsigned long long mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool digitFound = false;
+	bool fraction = false;
+
+	while (true)
+	{
+		char c = text[pointer];
+
+		if (c == '.' && !fraction)
+		{
+			fraction = true;
+			pointer++;
+			continue;
+		}
+
+		if (c < '0' || c > '9')
+			break;
+
+		digitFound = true;
+		pointer++;
+
+		if (significantDigits < 9)
+		{
+			shortMantissa = shortMantissa * 10 + (c - '0');
+
+			if (shortMantissa != 0)
+				significantDigits++;
+		}
+		else if (significantDigits < MAX_MANTISSA_DIGITS)
+		{
+			if (significantDigits == 9)
+				mantissa = shortMantissa;
+
+			mantissa = mantissa * 10 + (c - '0');
+			significantDigits++;
+		}
+		else
+		{
+			// Digits beyond what the mantissa holds only matter before the decimal point.
+			if (!fraction)
+				exponent++;
+
+			continue;
+		}
+
+		if (fraction)
+			exponent--;
+	}
+
+	if (!digitFound)
+	{
+		*value = 0.0;
+		return 0;
+	}
+
+	double result;
+
+	if (significantDigits <= 9)
+		result = (double)shortMantissa;
+	else
+		result = (double)mantissa;
+
+	if (exponent < 0)
+	{
+		while (exponent < -MAX_EXACT_POWER_OF_TEN)
+		{
+			result /= powerOfTen[MAX_EXACT_POWER_OF_TEN];
+			exponent += MAX_EXACT_POWER_OF_TEN;
+		}
+
+		result /= powerOfTen[-exponent];
+
+		if (significantDigits > 9 && (mantissa >> DBL_MANT_DIG) != 0)
+			result = NearestQuotient(mantissa, -exponent, result);
+	}
+	else if (exponent > 0)
+	{
+		while (exponent > MAX_EXACT_POWER_OF_TEN)
+		{
+			result *= powerOfTen[MAX_EXACT_POWER_OF_TEN];
+			exponent -= MAX_EXACT_POWER_OF_TEN;
+		}
+
+		result *= powerOfTen[exponent];
+	}
+
+	*value = negative ? -result : result;
+
+	return pointer;
+}
+
+/// <summary>
+/// Converts the whole number at the start of the text.
+/// </summary>
+/// <param name="text">The text to convert, normally the character after the word letter.</param>
+/// <param name="value">Receives the value. Set to 0 when no number is found.</param>
+/// <returns>The number of characters consumed. Zero when the text does not start with a whole number.</returns>
+/// <remarks>
+/// The integer fast path used for G, M, T and N words. Conversion stops at the decimal point
+/// so a fraction (i.e. the .2 of G38.2) is left for the caller. Values beyond the range of a
+/// long are saturated.
+/// </remarks>
+int GCodeParser::ParseInteger(const char* text, long* value)
+{
+	int pointer = 0;
+	bool negative = false;
+
+	if (text[pointer] == '+' || text[pointer] == '-')
+	{
+		negative = (text[pointer] == '-');
+		pointer++;
+	}
+
+	int firstDigit = pointer;
+	unsigned long result = 0;
+	bool saturated = false;
+
+	while (text[pointer] >= '0' && text[pointer] <= '9')
+	{
+		unsigned long digit = text[pointer] - '0';
+
+		if (result > (LONG_MAX - digit) / 10)
+			saturated = true;
+		else
+			result = result * 10 + digit;
+
+		pointer++;
+	}
+
+	if (pointer == firstDigit)
+	{
+		*value = 0;
+		return 0;
+	}
+
+	if (saturated)
+		*value = negative ? LONG_MIN : LONG_MAX;
+	else
+		*value = negative ? -(long)result : (long)result;
+
+	return pointer;
+}
+
+/// <summary>
+/// Appends a digit to an unsigned accumulator without exceeding the limit.
+/// </summary>
+/// <returns>False if the digit would exceed the limit. The accumulator is then set to the limit.</returns>
+static bool AppendDigit(unsigned long* accumulator, unsigned long digit, unsigned long limit)
+{
+	if (*accumulator > (limit - digit) / 10)
+	{
+		*accumulator = limit;
+		return false;
+	}
+
+	*accumulator = *accumulator * 10 + digit;
+
+	return true;
+}
+
+/// <summary>
+/// Converts the G-Code number at the start of the text to a fixed point (scaled) whole number.
+/// </summary>
+/// <param name="text">The text to convert, normally the character after the word letter.</param>
+/// <param name="decimals">The number of decimal places kept (0 to MAX_FIXED_DECIMALS).</param>
+/// <param name="value">Receives the number multiplied by 10^decimals. Set to 0 when no number is found.</param>
+/// <param name="saturated">Set true if the value did not fit in a long and was clamped to LONG_MIN/LONG_MAX.</param>
+/// <returns>The number of characters consumed. Zero when the text does not start with a number.</returns>
+/// <remarks>
+/// The value is built directly from the digit characters with integer math only, so controllers
+/// without a floating point unit can go from bytes to step counts without soft-float. Digits
+/// beyond the decimal places requested are rounded half away from zero.
+/// </remarks>
+int GCodeParser::ParseFixedNumber(const char* text, int decimals, long* value, bool* saturated)
+{
+	if (decimals < 0)
+		decimals = 0;
+
+	if (decimals > MAX_FIXED_DECIMALS)
+		decimals = MAX_FIXED_DECIMALS;
+
+	int pointer = 0;
+	bool negative = false;
+
+	if (text[pointer] == '+' || text[pointer] == '-')
+	{
+		negative = (text[pointer] == '-');
+		pointer++;
+	}
+
+	unsigned long limit = negative ? (unsigned long)LONG_MAX + 1 : (unsigned long)LONG_MAX;
+	unsigned long result = 0;
+	bool inRange = true;
+	bool digitFound = false;
+
+	while (text[pointer] >= '0' && text[pointer] <= '9')
+	{
+		digitFound = true;
+
+		if (inRange)
+			inRange = AppendDigit(&result, text[pointer] - '0', limit);
+
+		pointer++;
+	}
+
+	int fractionDigits = 0;
+	bool roundUp = false;
+
+	if (text[pointer] == '.')
+	{
+		pointer++;
+
+		while (text[pointer] >= '0' && text[pointer] <= '9')
+		{
+			digitFound = true;
+
+			if (fractionDigits < decimals)
+			{
+				if (inRange)
+					inRange = AppendDigit(&result, text[pointer] - '0', limit);
+			}
+			else if (fractionDigits == decimals)
+				roundUp = (text[pointer] >= '5');
+
+			fractionDigits++;
+			pointer++;
+		}
+	}
+
+	if (!digitFound)
+	{
+		*value = 0;
+		*saturated = false;
+		return 0;
+	}
+
+	// Scale up when fewer fraction digits were given than decimal places requested.
+	for (int i = fractionDigits; i < decimals && inRange; i++)
+		inRange = AppendDigit(&result, 0, limit);
+
+	if (roundUp && inRange)
+	{
+		if (result < limit)
+			result++;
+		else
+			inRange = false;
+	}
+
+	*saturated = !inRange;
+
+	if (negative)
+		*value = (result == (unsigned long)LONG_MAX + 1) ? LONG_MIN : -(long)result;
+	else
+		*value = (long)result;
+
+	return pointer;
+}
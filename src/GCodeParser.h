@@ -25,7 +25,72 @@ SOFTWARE.
 #ifndef GCodeParser_h
 #define GCodeParser_h
 
+#include <stddef.h>
+
 const int MAX_LINE_SIZE = 256; // Maximun GCode line size.
+const int MAX_FIXED_DECIMALS = 9; // Maximum decimal places for fixed point values.
+const int WORD_LETTER_COUNT = 26; // Letters A through Z.
+const int COMMENT_CHUNK_SIZE = 24; // Comment bytes held before they are streamed.
+
+#define GCODE_LETTER(letter) (1UL << ((letter) - 'A')) // Letter mask bit for GetWords.
+#define GCODE_ALL_LETTERS 0x3FFFFFFUL // Letter mask of A through Z.
+
+// Grbl 1.1 real-time commands: status, feed hold, cycle start, soft reset, safety door,
+// jog cancel, feed, rapid and spindle overrides and coolant toggles. See realtimeBytes.
+#define GCODE_GRBL_REALTIME "?!~\x18\x84\x85\x90\x91\x92\x93\x94\x95\x96\x97\x99\x9A\x9B\x9C\x9D\x9E\xA0\xA1"
+
+/// <summary>
+/// The result of validating a line against a dialect.
+/// </summary>
+enum GCodeValidation
+{
+	GCODE_VALID = 0,
+	GCODE_INVALID_LETTER,       // A character that is not a word letter in the dialect.
+	GCODE_INVALID_NUMBER,       // A word without a valid number.
+	GCODE_UNKNOWN_COMMAND,      // A G or M code the dialect does not support.
+	GCODE_WORD_NOT_ALLOWED,     // A word not accepted by any command on the line.
+	GCODE_MODAL_GROUP_CONFLICT  // Two commands from the same modal group.
+};
+
+/// <summary>
+/// The state of the line being collected by AddCharToLine.
+/// </summary>
+enum GCodeLineStatus
+{
+	GCODE_LINE_OK = 0,
+	GCODE_LINE_LONG,            // Longer than MAX_LINE_SIZE, held in the line arena.
+	GCODE_LINE_OVERFLOW         // Too long for the buffer (and arena), the line was discarded.
+};
+
+/// <summary>
+/// What AddCharToLine does with semicolon comments.
+/// </summary>
+enum GCodeCommentMode
+{
+	GCODE_COMMENTS_KEEP = 0,    // Collect them in the line for ParseLine (the default).
+	GCODE_COMMENTS_STREAM,      // Pass them to the comment callback as they arrive.
+	GCODE_COMMENTS_SKIP         // Drop them as they arrive.
+};
+
+struct GCodeDialect;
+class GCodeParsedBlock;
+class GCodeLatencyHistogram;
+class GCodeArena;
+
+/// <summary>
+/// Word values collected in a single pass over the line by GetWords.
+/// </summary>
+/// <remark>
+/// Values are indexed by letter - 'A' (i.e. value['X' - 'A']). Letters requested but not
+/// found on the line have a value of 0.0 and their present bit cleared. When a letter
+/// appears more than once the first value is kept and its duplicate bit is set.
+/// </remark>
+struct GCodeWords
+{
+	unsigned long present;
+	unsigned long duplicate;
+	double value[WORD_LETTER_COUNT];
+};
 
 /// <summary>
 /// The GCodeParser library is a lightweight G-Code parser for the Arduino using only
@@ -51,18 +116,54 @@ class GCodeParser
 {
 private:
 	int lineCharCount;
+	int lineCapacity;
+	size_t arenaMark;
+	char buffer[MAX_LINE_SIZE + 2];
+	char commentBuffer[COMMENT_CHUNK_SIZE];
+	int commentLength;
+	bool commentTail;
+	bool commentDecided;
+	bool commentSkipped;
+	bool parenthesisFound;
+	bool thumbnail;
+
+	bool AppendToLine(char c);
+	bool SpillLine();
+	void AddCommentChar(char c);
+	void FlushComment(bool end);
+	void CopyFrom(const GCodeParser& other);
 
 public:
-	char line[MAX_LINE_SIZE + 2];
+	const GCodeDialect* dialect;
+	char* line;
 	char* comments;
 	char* lastComment;
 	bool blockDelete;
 	bool beginEnd;
 	bool completeLineIsAvailableToParse;
+	GCodeLineStatus lineStatus;
+
+	GCodeArena* lineArena;            // Optional memory for lines longer than MAX_LINE_SIZE.
+	GCodeCommentMode commentMode;     // What happens to semicolon comments as they arrive.
+	bool skipThumbnails;              // Drop comments between "; thumbnail begin" and "; thumbnail end".
+	void (*commentCallback)(const char* text, int length, bool end); // Receives streamed comments.
+	const char* realtimeBytes;        // Bytes taken out of the stream as they arrive (i.e. GCODE_GRBL_REALTIME).
+	void (*realtimeCallback)(char c); // Receives the real-time bytes.
+	unsigned long (*clock)();         // Optional time source (i.e. micros) for the line timestamps.
+	GCodeLatencyHistogram* latency;   // Optional histogram of line end to parse done times.
+	unsigned long firstCharTime;      // When the first character of the line was added.
+	unsigned long lineEndTime;        // When the line feed was added.
+	unsigned long parseDoneTime;      // When ParseLine finished.
 
 	void Initialize();
 	GCodeParser();
+	GCodeParser(const GCodeDialect* dialect);
+
+	GCodeParser(const GCodeParser& other);
+	GCodeParser& operator=(const GCodeParser& other);
+
 	bool AddCharToLine(char c);
+	int AddCharsToLine(const char* text, int length);
 	void ParseLine();
 	void ParseLine(char* gCode);
 	void RemoveCommentSeparators();
@@ -71,8 +172,21 @@ public:
 	bool HasWord(char letter);
 	bool IsWord(char letter);
 	bool NoWords();
+	GCodeValidation Validate();
+	GCodeValidation Validate(int* errorPosition);
 
 	double GetWordValue(char letter);
+	long GetWordIntegerValue(char letter);
+	long GetWordFixedValue(char letter, int decimals);
+	long GetWordFixedValue(char letter, int decimals, bool* saturated);
+	unsigned long GetWords(unsigned long letterMask, GCodeWords* words);
+	unsigned long GetWords(const char* letters, GCodeWords* words);
+	bool GetBlock(GCodeParsedBlock* block);
+
+	static int ParseNumber(const char* text, double* value);
+	static int ParseInteger(const char* text, long* value);
+	static unsigned long LetterMask(const char* letters);
+	static int ParseFixedNumber(const char* text, int decimals, long* value, bool* saturated);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,636 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GCodeWriter.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+const int MAX_SHORTEST_DECIMALS = 19; // Most decimal places written for the shortest text.
+const double MAX_SCALED_VALUE = 9.2e18; // Scaled values must fit in an unsigned long long.
+
+/// <summary>
+/// Class constructor.
+/// </summary>
+/// <param name="buffer">The buffer lines are written into.</param>
+/// <param name="size">The size of the buffer including room for the null.</param>
+GCodeWriter::GCodeWriter(char* buffer, int size)
+{
+	this->buffer = buffer;
+	this->size = size;
+	precision = GCODE_SHORTEST;
+	spaces = true;
+	checksum = false;
+	length = 0;
+
+	Begin();
+}
+
+/// <summary>
+/// Starts a new line at the beginning of the buffer.
+/// </summary>
+void GCodeWriter::Begin()
+{
+	length = 0;
+	lineStart = 0;
+	wordWritten = false;
+	overflow = false;
+
+	if (size > 0)
+		buffer[0] = '\0';
+}
+
+/// <summary>
+/// Appends text to the line.
+/// </summary>
+/// <returns>False, with overflow set, if the text does not fit.</returns>
+bool GCodeWriter::Append(const char* text, int count)
+{
+	if (length + count >= size)
+	{
+		overflow = true;
+		return false;
+	}
+
+	memcpy(buffer + length, text, count);
+	length += count;
+	buffer[length] = '\0';
+
+	return true;
+}
+
+/// <summary>
+/// Appends the word separator if a word has already been written.
+/// </summary>
+bool GCodeWriter::AppendSeparator()
+{
+	if (wordWritten && spaces)
+		return Append(" ", 1);
+
+	return true;
+}
+
+/// <summary>
+/// Adds a word.
+/// </summary>
+/// <param name="letter">The letter of the word.</param>
+/// <param name="value">The value, formatted according to precision.</param>
+/// <returns>False if the word does not fit. The line is left as it was.</returns>
+bool GCodeWriter::AddWord(char letter, double value)
+{
+	char text[MAX_NUMBER_SIZE + 2];
+	int pointer = 0;
+
+	if (wordWritten && spaces)
+		text[pointer++] = ' ';
+
+	text[pointer++] = letter;
+
+	int count = FormatNumber(&text[pointer], MAX_NUMBER_SIZE, value, precision);
+
+	if (count == 0)
+		return false;
+
+	if (!Append(text, pointer + count))
+		return false;
+
+	wordWritten = true;
+
+	return true;
+}
+
+/// <summary>
+/// Adds a G or M (or any other whole number) command.
+/// </summary>
+/// <param name="letter">The letter of the command.</param>
+/// <param name="code">The command number.</param>
+/// <param name="subcode">The digit after the decimal point (i.e. 2 for G38.2) or -1 if none.</param>
+/// <returns>False if the command does not fit. The line is left as it was.</returns>
+bool GCodeWriter::AddCommand(char letter, long code, int subcode)
+{
+	char text[MAX_NUMBER_SIZE + 4];
+	int pointer = 0;
+
+	if (wordWritten && spaces)
+		text[pointer++] = ' ';
+
+	text[pointer++] = letter;
+	pointer += FormatNumber(&text[pointer], MAX_NUMBER_SIZE, (double)code, 0);
+
+	if (subcode >= 0 && subcode <= 9)
+	{
+		text[pointer++] = '.';
+		text[pointer++] = '0' + subcode;
+	}
+
+	if (!Append(text, pointer))
+		return false;
+
+	wordWritten = true;
+
+	return true;
+}
+
+/// <summary>
+/// Adds the words of a word table in the order given.
+/// </summary>
+/// <param name="words">The word table, i.e. from GCodeParser::GetWords.</param>
+/// <param name="letters">The letters to write in order (i.e. "GMXYZEF"). Letters not present are skipped.</param>
+/// <returns>False if a word does not fit.</returns>
+bool GCodeWriter::AddWords(const GCodeWords* words, const char* letters)
+{
+	int pointer = 0;
+	while (letters[pointer] != '\0')
+	{
+		char letter = letters[pointer];
+
+		if (letter >= 'A' && letter <= 'Z' && (words->present & GCODE_LETTER(letter)))
+		{
+			if (!AddWord(letter, words->value[letter - 'A']))
+				return false;
+		}
+
+		pointer++;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Adds a parsed block: its words, reformatted according to precision, and its comments.
+/// </summary>
+/// <param name="parser">A parser after ParseLine.</param>
+/// <returns>False if the block does not fit.</returns>
+/// <remarks>
+/// Characters which are not words (i.e. the block delete slash) are copied as is. Any
+/// existing checksum is dropped since it no longer matches; set checksum to write a new one.
+/// </remarks>
+bool GCodeWriter::AddBlock(GCodeParser* parser)
+{
+	const char* line = parser->line;
+	int pointer = 0;
+
+	while (line[pointer] != '\0' && line[pointer] != '*')
+	{
+		char letter = line[pointer];
+
+		if (letter < 'A' || letter > 'Z')
+		{
+			if (!Append(&line[pointer], 1))
+				return false;
+
+			pointer++;
+			continue;
+		}
+
+		double value;
+		int count = GCodeParser::ParseNumber(&line[pointer + 1], &value);
+
+		if (count == 0)
+		{
+			// A bare letter (i.e. Marlin G28 X).
+			if (!AppendSeparator() || !Append(&letter, 1))
+				return false;
+
+			wordWritten = true;
+		}
+		else if (!AddWord(letter, value))
+			return false;
+
+		pointer += 1 + count;
+	}
+
+	if (parser->comments[0] != '\0')
+		return AddComment(parser->comments);
+
+	return true;
+}
+
+/// <summary>
+/// Adds a comment.
+/// </summary>
+/// <param name="comment">The comment. If it does not start with ( or ; it is written as a ; comment.</param>
+/// <returns>False if the comment does not fit.</returns>
+/// <remarks>A ; comment runs to the end of the line so nothing but End should follow it.</remarks>
+bool GCodeWriter::AddComment(const char* comment)
+{
+	if (!AppendSeparator())
+		return false;
+
+	if (comment[0] != '(' && comment[0] != ';' && !Append(";", 1))
+		return false;
+
+	if (!Append(comment, strlen(comment)))
+		return false;
+
+	wordWritten = true;
+
+	return true;
+}
+
+/// <summary>
+/// Ends the line, appending the checksum if enabled and a line feed.
+/// </summary>
+/// <returns>The length of the text in the buffer.</returns>
+/// <remarks>
+/// The checksum is the RepRap/Marlin XOR of every character of the line before the *.
+/// Lines are appended to the buffer so several can be written before calling Begin again.
+/// </remarks>
+int GCodeWriter::End()
+{
+	if (checksum)
+	{
+		unsigned char sum = 0;
+
+		for (int i = lineStart; i < length; i++)
+			sum ^= (unsigned char)buffer[i];
+
+		char text[5];
+		int pointer = 0;
+		text[pointer++] = '*';
+
+		if (sum >= 100)
+			text[pointer++] = '0' + sum / 100;
+
+		if (sum >= 10)
+			text[pointer++] = '0' + (sum / 10) % 10;
+
+		text[pointer++] = '0' + sum % 10;
+
+		Append(text, pointer);
+	}
+
+	Append("\n", 1);
+
+	lineStart = length;
+	wordWritten = false;
+
+	return length;
+}
+
+/// <summary>
+/// Gets the length of the text in the buffer.
+/// </summary>
+int GCodeWriter::Length()
+{
+	return length;
+}
+
+/// <summary>
+/// Gets the text in the buffer.
+/// </summary>
+const char* GCodeWriter::Text()
+{
+	return buffer;
+}
+
+/// <summary>
+/// Multiplies two 64 bit values into a 128 bit result, from 32 bit halves.
+/// </summary>
+static void MultiplyWide(unsigned long long a, unsigned long long b, unsigned long long* high, unsigned long long* low)
+{
+	unsigned long long aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+	unsigned long long bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+
+	unsigned long long lowLow = aLow * bLow;
+	unsigned long long highLow = aHigh * bLow;
+	unsigned long long lowHigh = aLow * bHigh;
+	unsigned long long highHigh = aHigh * bHigh;
+
+	unsigned long long middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + (lowHigh & 0xFFFFFFFFULL);
+
+	*low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+	*high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+}
+
+/// <summary>
+/// Gets 10^decimals for 0 to 19 decimals.
+/// </summary>
+static unsigned long long PowerOfTen(int decimals)
+{
+	unsigned long long power = 1;
+
+	for (int i = 0; i < decimals; i++)
+		power *= 10;
+
+	return power;
+}
+
+/// <summary>
+/// Computes factor * 10^decimals / 2^shift rounded down, exactly.
+/// </summary>
+/// <param name="exact">Receives true if nothing was rounded off.</param>
+/// <remarks>The caller keeps the result within 64 bits.</remarks>
+static unsigned long long ScaleDown(unsigned long long factor, int decimals, int shift, bool* exact)
+{
+	unsigned long long high, low;
+	MultiplyWide(factor, PowerOfTen(decimals), &high, &low);
+
+	if (shift >= 128)
+	{
+		*exact = high == 0 && low == 0;
+		return 0;
+	}
+
+	if (shift >= 64)
+	{
+		*exact = low == 0 && (shift == 64 || (high << (128 - shift)) == 0);
+		return high >> (shift - 64);
+	}
+
+	if (shift == 0)
+	{
+		*exact = true;
+		return low;
+	}
+
+	*exact = (low << (64 - shift)) == 0;
+	return (low >> shift) | (high << (64 - shift));
+}
+
+/// <summary>
+/// Computes |value| * 10^decimals rounded half away from zero, exactly.
+/// </summary>
+/// <returns>False if the result does not fit in 63 bits.</returns>
+/// <remarks>
+/// The double is split into its integer mantissa and binary exponent so the product with
+/// the power of ten is exact (up to 117 bits) before the single rounding shift. Scaling in
+/// floating point instead would get the last digits of 16 and 17 digit numbers wrong.
+/// </remarks>
+static bool ScaleExactly(double magnitude, int decimals, unsigned long long* scaled)
+{
+	if (magnitude == 0.0)
+	{
+		*scaled = 0;
+		return true;
+	}
+
+	if (!(magnitude < MAX_SCALED_VALUE))
+		return false;
+
+	int exponent;
+	double fraction = frexp(magnitude, &exponent);
+	unsigned long long mantissa = (unsigned long long)ldexp(fraction, DBL_MANT_DIG);
+	exponent -= DBL_MANT_DIG;
+
+	unsigned long long high, low;
+	MultiplyWide(mantissa, PowerOfTen(decimals), &high, &low);
+
+	if (exponent >= 0)
+	{
+		if (high != 0 || exponent >= 63 || (low >> (63 - exponent)) != 0)
+			return false;
+
+		*scaled = low << exponent;
+		return true;
+	}
+
+	int shift = -exponent;
+
+	if (shift >= 118)
+	{
+		*scaled = 0;
+		return true;
+	}
+
+	// Add half of the last unit kept, then shift the 128 bit value right.
+	unsigned long long halfHigh = shift - 1 >= 64 ? 1ULL << (shift - 1 - 64) : 0;
+	unsigned long long halfLow = shift - 1 < 64 ? 1ULL << (shift - 1) : 0;
+
+	low += halfLow;
+	high += halfHigh + (low < halfLow ? 1 : 0);
+
+	unsigned long long result;
+
+	if (shift >= 64)
+		result = high >> (shift - 64);
+	else
+	{
+		if ((high >> shift) != 0)
+			return false;
+
+		result = (low >> shift) | (shift == 0 ? 0 : high << (64 - shift));
+	}
+
+	if (result >> 63)
+		return false;
+
+	*scaled = result;
+
+	return true;
+}
+
+/// <summary>
+/// Writes a scaled whole number with a fixed number of decimal places, dropping trailing zeros.
+/// </summary>
+/// <returns>The length written or zero if it does not fit. The text is untouched on failure.</returns>
+static int WriteScaled(char* text, int size, bool negative, unsigned long long scaled, int decimals)
+{
+	char digits[MAX_NUMBER_SIZE];
+	int count = 0;
+
+	// Use 32 bit division when possible, it is much cheaper on 8 bit controllers.
+	if (scaled <= 0xFFFFFFFFULL)
+	{
+		unsigned long n = (unsigned long)scaled;
+
+		do {
+			digits[count++] = '0' + n % 10;
+			n /= 10;
+		} while (n != 0);
+	}
+	else
+	{
+		do {
+			digits[count++] = '0' + scaled % 10;
+			scaled /= 10;
+		} while (scaled != 0);
+	}
+
+	while (count <= decimals)
+		digits[count++] = '0';
+
+	// Trailing zeros of the fraction are dropped and negative zero is written as 0.
+	int skip = 0;
+
+	while (skip < decimals && digits[skip] == '0')
+		skip++;
+
+	bool zero = true;
+
+	for (int i = skip; i < count; i++)
+	{
+		if (digits[i] != '0')
+			zero = false;
+	}
+
+	bool sign = negative && !zero;
+	int needed = (sign ? 1 : 0) + (count - decimals) + (decimals > skip ? 1 + decimals - skip : 0);
+
+	if (needed >= size)
+		return 0;
+
+	int pointer = 0;
+
+	if (sign)
+		text[pointer++] = '-';
+
+	for (int i = count - 1; i >= decimals; i--)
+		text[pointer++] = digits[i];
+
+	if (decimals > skip)
+	{
+		text[pointer++] = '.';
+
+		for (int i = decimals - 1; i >= skip; i--)
+			text[pointer++] = digits[i];
+	}
+
+	text[pointer] = '\0';
+
+	return pointer;
+}
+
+/// <summary>
+/// Formats a number for G-Code.
+/// </summary>
+/// <param name="text">Receives the number and a null.</param>
+/// <param name="size">The size of text (MAX_NUMBER_SIZE is always enough).</param>
+/// <param name="value">The value.</param>
+/// <param name="decimals">The decimal places or GCODE_SHORTEST.</param>
+/// <returns>The length written or zero if the value is out of range (|value| of 9.2e18 or more) or does not fit.</returns>
+/// <remarks>
+/// Fixed precision rounds half away from zero and drops trailing zeros. GCODE_SHORTEST
+/// writes the fewest decimal places whose text parses back to exactly the same value, so
+/// 0.1 is written as 0.1 rather than 0.1000000000000000055511. Numbers are never written
+/// with an exponent.
+///
+/// The shortest digits are generated directly, as Ryu and Grisu do, but with exact 128 bit
+/// integer math rather than their tables to stay small enough for 8 bit controllers: the
+/// interval of numbers which round to the value is scaled to a few more decimal places than
+/// the value needs, then digits are dropped while the interval still holds a number with
+/// fewer places. The result is parsed back once to check it, since ParseNumber may be a
+/// unit in the last place off for values below 0.001; the few texts it misreads are
+/// written with the next longer text that it reads back exactly. The round trip is exact
+/// from 0.001 up, smaller values that need more than 19 decimal places are written with 19.
+/// </remarks>
+int GCodeWriter::FormatNumber(char* text, int size, double value, int decimals)
+{
+	bool negative = value < 0;
+	double magnitude = negative ? -value : value;
+	unsigned long long scaled;
+
+	if (decimals >= 0)
+	{
+		if (!ScaleExactly(magnitude, decimals, &scaled))
+			return 0;
+
+		return WriteScaled(text, size, negative, scaled, decimals);
+	}
+
+	if (!(magnitude < MAX_SCALED_VALUE))
+		return 0;
+
+	int exponent = 0;
+	unsigned long long mantissa = 0;
+
+	if (magnitude != 0.0)
+	{
+		double fraction = frexp(magnitude, &exponent);
+		mantissa = (unsigned long long)ldexp(fraction, DBL_MANT_DIG);
+		exponent -= DBL_MANT_DIG;
+	}
+
+	// Whole numbers have nothing to shorten.
+	if (exponent >= 0)
+	{
+		ScaleExactly(magnitude, 0, &scaled);
+		return WriteScaled(text, size, negative, scaled, 0);
+	}
+
+	// The value is mantissa * 2^exponent and the numbers strictly between the neighbouring
+	// midpoints parse back to it. In units of 2^(exponent - 2) the value is 4 * mantissa and
+	// the midpoints are 2 units away, or 1 below a power of two where the next double down
+	// is closer.
+	int shift = 2 - exponent;
+	unsigned long long below = mantissa == (1ULL << (DBL_MANT_DIG - 1)) ? 1 : 2;
+
+	// Enough places for the interval to hold at least two numbers, 0.30103 approximating log10(2).
+	int places = (int)((-exponent * 78913L) >> 18) + 2;
+
+	if (places > MAX_SHORTEST_DECIMALS)
+		places = MAX_SHORTEST_DECIMALS;
+
+	bool exact;
+	unsigned long long lower = ScaleDown(4 * mantissa - below, places, shift, &exact) + 1;
+	unsigned long long upper = ScaleDown(4 * mantissa + 2, places, shift, &exact);
+
+	if (exact)
+		upper--;
+
+	int longest = places;
+
+	while (places > 0 && (lower + 9) / 10 <= upper / 10)
+	{
+		lower = (lower + 9) / 10;
+		upper /= 10;
+		places--;
+	}
+
+	// The closest of the shortest numbers. Below 0.001 the interval may hold none at 19 places.
+	ScaleExactly(magnitude, places, &scaled);
+
+	if (lower <= upper)
+	{
+		if (scaled < lower)
+			scaled = lower;
+		else if (scaled > upper)
+			scaled = upper;
+	}
+
+	char candidate[MAX_NUMBER_SIZE];
+	int count = WriteScaled(candidate, sizeof(candidate), negative, scaled, places);
+	double parsed;
+
+	if (count != 0 && (GCodeParser::ParseNumber(candidate, &parsed) != count || parsed != value))
+	{
+		// Misread by ParseNumber, try the correctly rounded texts with more places.
+		while (places < longest)
+		{
+			places++;
+			ScaleExactly(magnitude, places, &scaled);
+			count = WriteScaled(candidate, sizeof(candidate), negative, scaled, places);
+
+			if (GCodeParser::ParseNumber(candidate, &parsed) == count && parsed == value)
+				break;
+		}
+	}
+
+	if (count == 0 || count >= size)
+		return 0;
+
+	memcpy(text, candidate, count + 1);
+
+	return count;
+}
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2021 Terence Golla
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GCodeWriter_h
+#define GCodeWriter_h
+
+#include "GCodeParser.h"
+
+const int GCODE_SHORTEST = -1; // Precision for the shortest text that parses back to the same value.
+const int MAX_NUMBER_SIZE = 24; // Largest formatted number including the null.
+
+/// <summary>
+/// Writes G-Code lines into a caller provided buffer without allocating.
+/// </summary>
+/// <remark>
+/// A line is built with Begin, any number of AddWord, AddCommand, AddBlock, AddWords and
+/// AddComment calls, then End which appends the optional checksum and the line feed.
+/// Numbers are written with the shortest text that parses back to the same value through
+/// ParseNumber (and therefore GetWordValue), or with a fixed number of decimal places
+/// (trailing zeros dropped) when precision is set. When the buffer is too small the line
+/// is truncated at the last complete word and overflow is set.
+/// 
+///   char buffer[64];
+///   GCodeWriter writer(buffer, sizeof(buffer));
+///   writer.Begin();
+///   writer.AddCommand('G', 1, -1);
+///   writer.AddWord('X', 10.5);
+///   writer.End(); // "G1 X10.5\n"
+/// </remark>
+class GCodeWriter
+{
+private:
+	char* buffer;
+	int size;
+	int length;
+	int lineStart;
+	bool wordWritten;
+
+	bool Append(const char* text, int count);
+	bool AppendSeparator();
+
+public:
+	int precision;      // Decimal places or GCODE_SHORTEST (default).
+	bool spaces;        // Separate words with a space (default true).
+	bool checksum;      // Append a RepRap/Marlin *nn checksum at End (default false).
+	bool overflow;      // Set when the buffer was too small.
+
+	GCodeWriter(char* buffer, int size);
+
+	void Begin();
+	bool AddWord(char letter, double value);
+	bool AddCommand(char letter, long code, int subcode);
+	bool AddWords(const GCodeWords* words, const char* letters);
+	bool AddBlock(GCodeParser* parser);
+	bool AddComment(const char* comment);
+	int End();
+
+	int Length();
+	const char* Text();
+
+	static int FormatNumber(char* text, int size, double value, int decimals);
+};
+
+#endif